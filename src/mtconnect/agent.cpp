@@ -92,7 +92,8 @@ namespace mtconnect {
       m_circularBuffer(GetOption<int>(options, config::BufferSize).value_or(17),
                        GetOption<int>(options, config::CheckpointFrequency).value_or(1000)),
       m_pretty(IsOptionSet(options, mtconnect::configuration::Pretty)),
-      m_validation(IsOptionSet(options, mtconnect::configuration::Validation))
+      m_validation(IsOptionSet(options, mtconnect::configuration::Validation)),
+      m_snapshotTimer(m_context)
   {
     using namespace asset;
 
@@ -112,6 +113,26 @@ namespace mtconnect {
     Task::registerAsset();
     TaskArchetype::registerAsset();
 
+    if (auto limit = ConvertFileSize(options, config::BufferMemoryLimit); limit > 0)
+      m_circularBuffer.setMemoryLimit(size_t(limit));
+
+    // Compression without a path keeps the compressed segments in memory
+    auto archive = GetOption<string>(options, config::ArchivePath).value_or("");
+    auto compress = IsOptionSet(options, config::ArchiveCompression);
+    if (!archive.empty() || compress)
+    {
+      m_circularBuffer.setArchive(make_unique<buffer::ObservationArchive>(
+          archive, ConvertFileSize(options, config::ArchiveSegmentSize, 64 * 1024 * 1024),
+          GetOption<int>(options, config::ArchiveMaxSegments).value_or(64), compress));
+    }
+
+    auto snapshot = GetOption<string>(options, config::SnapshotFile);
+    if (snapshot && !snapshot->empty())
+    {
+      m_snapshot = make_unique<buffer::Snapshot>(*snapshot);
+      m_snapshotInterval = GetOption<Seconds>(options, config::SnapshotInterval).value_or(60s);
+    }
+
     m_assetStorage = make_unique<AssetBuffer>(
         GetOption<int>(options, mtconnect::configuration::MaxAssets).value_or(1024));
     m_versionDeviceXml = IsOptionSet(options, mtconnect::configuration::VersionDeviceXml);
@@ -193,8 +214,12 @@ namespace mtconnect {
           printer.second->setValidation(false);
       }
 
+      if (m_snapshot)
+        restoreSnapshot();
+
       for (auto device : m_deviceIndex)
         initializeDataItems(device);
+      m_restoredDataItems.clear();
 
       if (m_agentDevice)
       {
@@ -256,6 +281,9 @@ namespace mtconnect {
       for (auto source : m_sources)
         source->start();
 
+      if (m_snapshot)
+        scheduleSnapshot();
+
       m_afterStartHooks.exec(*this);
     }
     catch (std::runtime_error &e)
@@ -284,6 +312,12 @@ namespace mtconnect {
     for (auto source : m_sources)
       source->stop();
 
+    if (m_snapshot)
+    {
+      m_snapshotTimer.cancel();
+      saveSnapshot();
+    }
+
     // Signal all observers
     LOG(info) << "Signaling observers to close sessions";
     for (auto di : m_dataItemMap)
@@ -302,16 +336,103 @@ namespace mtconnect {
     m_started = false;
   }
 
+  void Agent::saveSnapshot()
+  {
+    if (m_snapshot)
+      m_snapshot->save(m_circularBuffer, m_assetStorage.get());
+  }
+
+  void Agent::scheduleSnapshot()
+  {
+    m_snapshotTimer.expires_after(m_snapshotInterval);
+    m_snapshotTimer.async_wait(
+        boost::asio::bind_executor(m_strand, [this](boost::system::error_code ec) {
+          if (!ec)
+          {
+            saveSnapshot();
+            scheduleSnapshot();
+          }
+        }));
+  }
+
+  void Agent::restoreSnapshot()
+  {
+    NAMED_SCOPE("Agent::restoreSnapshot");
+
+    auto start = chrono::steady_clock::now();
+
+    // The state of the agent device and the availability of devices describe this process and
+    // the adapter connections, they are not restored.
+    buffer::ObservationCodec::DataItemMap dataItems;
+    for (auto device : m_deviceIndex)
+    {
+      if (m_agentDevice && device.get() == m_agentDevice.get())
+        continue;
+      for (auto &item : device->getDeviceDataItems())
+      {
+        auto di = item.lock();
+        if (di && di->getType() != "AVAILABILITY")
+          dataItems.emplace(di->getId(), item);
+      }
+    }
+
+    auto contents = m_snapshot->load(dataItems);
+    if (!contents)
+      return;
+
+    // The sinks use the start time as the instanceId. The sequence can only continue if the
+    // instanceId is guaranteed to change, so the snapshot must be older than this agent.
+    if (contents->m_written >= m_startTime)
+    {
+      LOG(warning) << "Snapshot " << m_snapshot->getFile()
+                   << " was written after the agent started, ignoring";
+      return;
+    }
+    if (m_circularBuffer.getSequence() != 1)
+    {
+      LOG(warning) << "Observations were added before the snapshot was restored, ignoring";
+      return;
+    }
+
+    m_circularBuffer.setSequence(contents->m_sequence);
+    for (auto &obs : contents->m_observations)
+    {
+      m_restoredDataItems.insert(obs->getDataItem()->getId());
+      receiveObservation(obs);
+    }
+
+    for (auto &asset : contents->m_assets)
+    {
+      // Remove after adding so the removed counts are kept
+      bool removed = asset->isRemoved();
+      asset->setProperty("removed", false);
+      asset->erase("removed");
+      m_assetStorage->addAsset(asset);
+      if (removed)
+        m_assetStorage->removeAsset(asset->getAssetId(), asset->getTimestamp());
+    }
+
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+    LOG(info) << "Restored " << contents->m_observations.size() << " observations and "
+              << contents->m_assets.size() << " assets at sequence " << contents->m_sequence
+              << " from " << m_snapshot->getFile() << " in " << elapsed.count() << "ms";
+  }
+
   // ---------------------------------------
   // Pipeline methods
   // ---------------------------------------
   void Agent::receiveObservation(observation::ObservationPtr observation)
   {
+    // The pin keeps the data item of the observation alive without changing its reference count
+    auto pin = m_circularBuffer.pin();
+    auto dataItem = observation->getDataItemPointer();
+
     // Check for availability
-    if (observation->getDataItem()->getType() == "AVAILABILITY" && !observation->isUnavailable())
+    if (dataItem != nullptr && dataItem->getType() == "AVAILABILITY" &&
+        !observation->isUnavailable())
     {
       // Set all the initial values.
-      auto device = observation->getDataItem()->getComponent()->getDevice();
+      auto device = dataItem->getComponent()->getDevice();
       for (auto item : device->getDeviceDataItems())
       {
         if (item.expired())
@@ -325,7 +446,11 @@ namespace mtconnect {
       }
     }
 
-    std::lock_guard<buffer::CircularBuffer> lock(m_circularBuffer);
+    // Only the sequence number assignment is serialized by the buffer. The stripe keeps the
+    // buffer and sinks in the same order for each data item without blocking other data items.
+    // It is keyed on the registry ordinal so it stays with the data item across a repoint.
+    auto stripe = observation->getDataItemKey().m_ordinal % DeliveryStripes;
+    std::lock_guard<std::mutex> lock(m_deliveryStripes[stripe]);
     if (m_circularBuffer.addToBuffer(observation) != 0)
     {
       for (auto &sink : m_sinks)
@@ -623,12 +748,14 @@ namespace mtconnect {
 
         // Remove the old data items
         set<string> skip;
+        unordered_map<string, DataItemPtr> oldDataItems;
         for (auto &di : oldDev->getDeviceDataItems())
         {
-          if (!di.expired())
+          if (auto old = di.lock())
           {
-            m_dataItemMap.erase(di.lock()->getId());
-            skip.insert(di.lock()->getId());
+            m_dataItemMap.erase(old->getId());
+            skip.insert(old->getId());
+            oldDataItems.emplace(old->getId(), old);
           }
         }
 
@@ -642,10 +769,22 @@ namespace mtconnect {
           return false;
         }
 
+        // The observations of the old data items reference the new data items with the same id
+        for (auto &di : device->getDeviceDataItems())
+        {
+          auto ndi = di.lock();
+          if (!ndi)
+            continue;
+          if (auto it = oldDataItems.find(ndi->getId()); it != oldDataItems.end())
+            ndi->replace(*it->second);
+        }
+
         initializeDataItems(device, skip);
 
         LOG(info) << "Device " << *uuid << " updating circular buffer";
         m_circularBuffer.updateDataItems(m_dataItemMap);
+        m_circularBuffer.retire(oldDev);
+        m_deviceModelVersion++;
 
         if (m_intSchemaVersion > SCHEMA_VERSION(2, 2))
           device->addHash();
@@ -1007,7 +1146,9 @@ namespace mtconnect {
         else if (d->getConstantValue())
           value = &d->getConstantValue().value();
 
-        m_loopback->receive(d, *value);
+        // Restored data items already have their last value
+        if (m_restoredDataItems.count(d->getId()) == 0)
+          m_loopback->receive(d, *value);
         m_dataItemMap[d->getId()] = d;
       }
     }
@@ -1063,6 +1204,8 @@ namespace mtconnect {
     if (m_intSchemaVersion >= SCHEMA_VERSION(2, 2))
       device->addHash();
 
+    m_deviceModelVersion++;
+
     for (auto &printer : m_printers)
       printer.second->setModelChangeTime(getCurrentTime(GMT_UV_SEC));
   }
@@ -26,19 +26,24 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "mtconnect/asset/asset_buffer.hpp"
 #include "mtconnect/buffer/checkpoint.hpp"
 #include "mtconnect/buffer/circular_buffer.hpp"
+#include "mtconnect/buffer/snapshot.hpp"
 #include "mtconnect/config.hpp"
 #include "mtconnect/configuration/async_context.hpp"
 #include "mtconnect/configuration/hook_manager.hpp"
@@ -143,6 +148,9 @@ namespace mtconnect {
     /// @brief Stops all the sources and syncs.
     void stop();
 
+    /// @brief Write the warm restart snapshot if `SnapshotFile` is configured
+    void saveSnapshot();
+
     /// @brief Get the boost asio io context
     /// @return boost::asio::io_context
     auto &getContext() { return m_context; }
@@ -451,6 +459,12 @@ namespace mtconnect {
     /// @returns constant reference to option map
     const auto &getOptions() const { return m_options; }
 
+    /// @brief get the device model version
+    ///
+    /// The version is incremented whenever a device is added or changed.
+    /// @returns the current device model version
+    uint64_t getDeviceModelVersion() const { return m_deviceModelVersion; }
+
   protected:
     friend class AgentPipelineContract;
 
@@ -460,6 +474,8 @@ namespace mtconnect {
     void verifyDevice(DevicePtr device);
     void initializeDataItems(DevicePtr device,
                              std::optional<std::set<std::string>> skip = std::nullopt);
+    void restoreSnapshot();
+    void scheduleSnapshot();
     void loadCachedProbe();
     void versionDeviceXml();
 
@@ -537,6 +553,7 @@ namespace mtconnect {
 
     DeviceIndex m_deviceIndex;
     std::unordered_map<std::string, WeakDataItemPtr> m_dataItemMap;
+    std::atomic_uint64_t m_deviceModelVersion {0};
 
     // Xml Config
     std::optional<std::string> m_schemaVersion;
@@ -548,12 +565,25 @@ namespace mtconnect {
     // Circular Buffer
     buffer::CircularBuffer m_circularBuffer;
 
+    // Observation delivery. Pipelines deliver in parallel, observations for the same data item
+    // are kept in order by the delivery stripe for the data item. Sinks must accept concurrent
+    // publishes.
+    static constexpr size_t DeliveryStripes = 64;
+    std::array<std::mutex, DeliveryStripes> m_deliveryStripes;
+
     // For debugging
     bool m_pretty;
 
     // validation
     bool m_validation {false};
 
+    // Warm restart
+    std::unique_ptr<buffer::Snapshot> m_snapshot;
+    std::chrono::seconds m_snapshotInterval {60};
+    boost::asio::steady_timer m_snapshotTimer;
+    uint64_t m_startTime {getCurrentTimeInSec()};
+    std::unordered_set<std::string> m_restoredDataItems;
+
     // Agent hooks
     configuration::HookManager<Agent> m_beforeInitializeHooks;
     configuration::HookManager<Agent> m_afterInitializeHooks;
@@ -616,6 +646,7 @@ namespace mtconnect {
     {
       return m_agent->getCircularBuffer().checkDuplicate(obs);
     }
+    uint64_t getDeviceModelVersion() const override { return m_agent->getDeviceModelVersion(); }
 
   protected:
     Agent *m_agent;
@@ -654,6 +685,7 @@ namespace mtconnect {
       return m_agent->getDataItemById(id);
     }
     void addSource(source::SourcePtr source) override { m_agent->addSource(source); }
+    const source::SourceList &getSources() const override { return m_agent->getSources(); }
 
     // Asset information
     asset::AssetStorage *getAssetStorage() override { return m_agent->getAssetStorage(); }
@@ -0,0 +1,396 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "block_codec.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include "mtconnect/device_model/data_item/data_item.hpp"
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+
+namespace mtconnect::buffer {
+  using namespace observation;
+  using namespace entity;
+
+  namespace {
+    template <typename T>
+    inline void Put(string &out, T value)
+    {
+      out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    inline void Patch(string &out, size_t pos, T value)
+    {
+      memcpy(out.data() + pos, &value, sizeof(T));
+    }
+
+    template <typename T>
+    inline T Load(const char *&pos)
+    {
+      T value;
+      memcpy(&value, pos, sizeof(T));
+      pos += sizeof(T);
+      return value;
+    }
+
+    /// @brief Writes bits most significant first
+    struct BitWriter
+    {
+      void put(uint64_t value, unsigned n)
+      {
+        while (n > 0)
+        {
+          unsigned take = std::min(n, 8u - m_count);
+          m_current = (m_current << take) | unsigned((value >> (n - take)) & ((1u << take) - 1));
+          m_count += take;
+          n -= take;
+          if (m_count == 8)
+          {
+            m_out.push_back(char(m_current));
+            m_current = 0;
+            m_count = 0;
+          }
+        }
+      }
+
+      void flush()
+      {
+        if (m_count > 0)
+          m_out.push_back(char(m_current << (8 - m_count)));
+        m_current = 0;
+        m_count = 0;
+      }
+
+      string &m_out;
+      unsigned m_current {0};
+      unsigned m_count {0};
+    };
+
+    /// @brief Reads bits most significant first
+    struct BitReader
+    {
+      uint64_t get(unsigned n)
+      {
+        uint64_t value = 0;
+        while (n > 0)
+        {
+          if (m_count == 0)
+          {
+            m_current = uint8_t(*m_pos++);
+            m_count = 8;
+          }
+          unsigned take = std::min(n, m_count);
+          value = (value << take) | ((m_current >> (m_count - take)) & ((1u << take) - 1));
+          m_count -= take;
+          n -= take;
+        }
+        return value;
+      }
+
+      bool bit() { return get(1) != 0; }
+
+      const char *m_pos;
+      unsigned m_current {0};
+      unsigned m_count {0};
+    };
+
+    inline uint64_t ZigZag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+    inline int64_t UnZigZag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+    void PutDelta(BitWriter &writer, int64_t dod)
+    {
+      auto z = ZigZag(dod);
+      if (z == 0)
+        writer.put(0b0, 1);
+      else if (z < (1u << 7))
+      {
+        writer.put(0b10, 2);
+        writer.put(z, 7);
+      }
+      else if (z < (1u << 9))
+      {
+        writer.put(0b110, 3);
+        writer.put(z, 9);
+      }
+      else if (z < (1u << 12))
+      {
+        writer.put(0b1110, 4);
+        writer.put(z, 12);
+      }
+      else
+      {
+        writer.put(0b1111, 4);
+        writer.put(z, 64);
+      }
+    }
+
+    int64_t GetDelta(BitReader &reader)
+    {
+      if (!reader.bit())
+        return 0;
+      if (!reader.bit())
+        return UnZigZag(reader.get(7));
+      if (!reader.bit())
+        return UnZigZag(reader.get(9));
+      if (!reader.bit())
+        return UnZigZag(reader.get(12));
+      return UnZigZag(reader.get(64));
+    }
+
+    /// @brief Gorilla XOR state for one data item
+    struct ValueState
+    {
+      uint64_t m_previous {0};
+      unsigned m_leading {0};
+      unsigned m_trailing {0};
+      bool m_window {false};
+    };
+
+    void PutValue(BitWriter &writer, ValueState &state, double value)
+    {
+      auto bits = bit_cast<uint64_t>(value);
+      auto x = bits ^ state.m_previous;
+      state.m_previous = bits;
+
+      if (x == 0)
+      {
+        writer.put(0b0, 1);
+        return;
+      }
+
+      unsigned leading = std::min(countl_zero(x), 31);
+      unsigned trailing = countr_zero(x);
+      if (state.m_window && leading >= state.m_leading && trailing >= state.m_trailing)
+      {
+        writer.put(0b10, 2);
+        writer.put(x >> state.m_trailing, 64 - state.m_leading - state.m_trailing);
+      }
+      else
+      {
+        unsigned length = 64 - leading - trailing;
+        writer.put(0b11, 2);
+        writer.put(leading, 5);
+        writer.put(length - 1, 6);
+        writer.put(x >> trailing, length);
+        state.m_leading = leading;
+        state.m_trailing = trailing;
+        state.m_window = true;
+      }
+    }
+
+    double GetValue(BitReader &reader, ValueState &state)
+    {
+      uint64_t x = 0;
+      if (reader.bit())
+      {
+        if (!reader.bit())
+        {
+          x = reader.get(64 - state.m_leading - state.m_trailing) << state.m_trailing;
+        }
+        else
+        {
+          state.m_leading = unsigned(reader.get(5));
+          unsigned length = unsigned(reader.get(6)) + 1;
+          state.m_trailing = 64 - state.m_leading - length;
+          x = reader.get(length) << state.m_trailing;
+        }
+      }
+
+      state.m_previous ^= x;
+      return bit_cast<double>(state.m_previous);
+    }
+
+    /// @brief get the value of an observation whose only property is a double value
+    const double *DoubleValue(const ObservationPtr &obs, const DataItemPtr &dataItem)
+    {
+      if (dynamic_pointer_cast<Condition>(obs))
+        return nullptr;
+
+      const double *result = nullptr;
+      const auto &diProps = dataItem->getObservationProperties();
+      for (const auto &[key, value] : obs->getProperties())
+      {
+        if (key == "timestamp" || key == "sequence")
+          continue;
+        if (auto p = diProps.find(key); p != diProps.end() && p->second == value)
+          continue;
+        if (key != "VALUE" || result)
+          return nullptr;
+        result = get_if<double>(&value);
+        if (!result)
+          return nullptr;
+      }
+      return result;
+    }
+
+    inline int64_t Micros(const Timestamp &ts)
+    {
+      return chrono::duration_cast<chrono::microseconds>(ts.time_since_epoch()).count();
+    }
+  }  // namespace
+
+  void BlockCodec::encode(std::string &out, const std::vector<ObservationPtr> &observations,
+                          Dictionary &dictionary, const std::vector<bool> *placeholders)
+  {
+    if (observations.empty())
+      return;
+
+    auto start = out.size();
+    Put<uint32_t>(out, 0);
+    Put<uint16_t>(out, uint16_t(observations.size()));
+
+    // Add the new ids to the dictionary
+    vector<uint32_t> ordinals;
+    ordinals.reserve(observations.size());
+    auto firstNew = dictionary.m_ids.size();
+    for (size_t i = 0; i < observations.size(); i++)
+    {
+      auto dataItem = observations[i]->getDataItem();
+      string id = dataItem && !(placeholders && (*placeholders)[i]) ? dataItem->getId() : "";
+      auto [it, added] = dictionary.m_ordinals.try_emplace(id, uint32_t(dictionary.m_ids.size()));
+      if (added)
+        dictionary.m_ids.emplace_back(id);
+      ordinals.push_back(it->second);
+    }
+
+    auto idBits = unsigned(bit_width(dictionary.m_ids.size() - 1));
+    Put<uint8_t>(out, uint8_t(idBits));
+    Put<uint16_t>(out, uint16_t(dictionary.m_ids.size() - firstNew));
+    for (auto i = firstNew; i < dictionary.m_ids.size(); i++)
+    {
+      Put<uint16_t>(out, uint16_t(dictionary.m_ids[i].size()));
+      out.append(dictionary.m_ids[i]);
+    }
+
+    int64_t previous = Micros(observations.front()->getTimestamp());
+    int64_t delta = 0;
+    Put<int64_t>(out, previous);
+
+    auto bitsPos = out.size();
+    Put<uint32_t>(out, 0);
+
+    string records;
+    vector<ValueState> states(dictionary.m_ids.size());
+    BitWriter writer {out};
+    for (size_t i = 0; i < observations.size(); i++)
+    {
+      const auto &obs = observations[i];
+      writer.put(ordinals[i], idBits);
+
+      if (i > 0)
+      {
+        auto ts = Micros(obs->getTimestamp());
+        PutDelta(writer, (ts - previous) - delta);
+        delta = ts - previous;
+        previous = ts;
+      }
+
+      bool placeholder = dictionary.m_ids[ordinals[i]].empty();
+      auto dataItem = obs->getDataItem();
+      const double *value = placeholder ? nullptr : DoubleValue(obs, dataItem);
+      if (value)
+      {
+        writer.put(0b1, 1);
+        PutValue(writer, states[ordinals[i]], *value);
+      }
+      else
+      {
+        writer.put(0b0, 1);
+        ObservationCodec::encode(records, obs, placeholder);
+      }
+    }
+    writer.flush();
+    Patch<uint32_t>(out, bitsPos, uint32_t(out.size() - bitsPos - sizeof(uint32_t)));
+
+    out.append(records);
+    Patch<uint32_t>(out, start, uint32_t(out.size() - start));
+  }
+
+  void BlockCodec::decode(const char *block, const std::vector<std::string> &ids,
+                          const ObservationCodec::DataItemMap &dataItems,
+                          const FilterSetOpt &filterSet, std::vector<ObservationPtr> &out)
+  {
+    const char *pos = block + sizeof(uint32_t);
+    auto count = Load<uint16_t>(pos);
+    auto idBits = Load<uint8_t>(pos);
+
+    // The ids are in the dictionary
+    for (auto newIds = Load<uint16_t>(pos); newIds > 0; newIds--)
+      pos += Load<uint16_t>(pos);
+
+    auto previous = Load<int64_t>(pos);
+    int64_t delta = 0;
+    auto bitsLength = Load<uint32_t>(pos);
+    const char *records = pos + bitsLength;
+
+    // Resolve the data items once for each ordinal
+    vector<DataItemPtr> resolved(ids.size());
+    vector<bool> looked(ids.size(), false);
+    vector<ValueState> states(ids.size());
+
+    out.assign(count, nullptr);
+    BitReader reader {pos};
+    for (size_t i = 0; i < count; i++)
+    {
+      auto ordinal = size_t(reader.get(idBits));
+      if (i > 0)
+      {
+        delta += GetDelta(reader);
+        previous += delta;
+      }
+
+      const auto &id = ids[ordinal];
+      if (!looked[ordinal])
+      {
+        looked[ordinal] = true;
+        if (!id.empty() && (!filterSet || filterSet->count(id) > 0))
+        {
+          if (auto it = dataItems.find(id); it != dataItems.end())
+            resolved[ordinal] = it->second.lock();
+        }
+      }
+
+      if (reader.bit())
+      {
+        double value = GetValue(reader, states[ordinal]);
+        if (auto &dataItem = resolved[ordinal])
+        {
+          try
+          {
+            ErrorList errors;
+            out[i] = Observation::make(dataItem, {{"VALUE", value}},
+                                       Timestamp(chrono::microseconds(previous)), errors);
+          }
+          catch (entity::EntityError &e)
+          {
+            LOG(warning) << "Cannot decode observation for " << id << ": " << e.what();
+          }
+        }
+      }
+      else
+      {
+        if (resolved[ordinal])
+          out[i] = ObservationCodec::decode(records, dataItems);
+        records += ObservationCodec::recordLength(records);
+      }
+    }
+  }
+}  // namespace mtconnect::buffer
@@ -0,0 +1,90 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/utilities.hpp"
+#include "observation_codec.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief Columnar compression of a block of consecutive observations
+  ///
+  /// The data item ids are replaced by ordinals into a dictionary shared by the blocks of a
+  /// segment. Timestamps are stored as delta-of-delta and double sample values with Gorilla
+  /// XOR compression against the previous value of the same data item in the block. All other
+  /// observations are stored as `ObservationCodec` records after the bit stream.
+  /// ```
+  /// block   := length:u32 count:u16 idBits:u8 newIds:u16 { idLength:u16 id }*
+  ///            first:i64 bitsLength:u32 bits { record }*
+  /// bits    := { ordinal:idBits [ dod ] kind:1 [ value ] }*
+  /// dod     := '0' | '10' zigzag:7 | '110' zigzag:9 | '1110' zigzag:12 | '1111' zigzag:64
+  /// value   := '0' | '10' meaningful | '11' leading:5 length:6 meaningful
+  /// ```
+  /// Timestamps are in microseconds and `first` is the timestamp of the first observation, `dod`
+  /// is omitted for it. The ids first used in the block are written in order so a segment can be
+  /// read without the dictionary in memory.
+  class AGENT_LIB_API BlockCodec
+  {
+  public:
+    /// @brief Ordinals for the data item ids in a segment
+    struct Dictionary
+    {
+      std::vector<std::string> m_ids;
+      std::unordered_map<std::string, uint32_t> m_ordinals;
+    };
+
+    /// @brief Append a compressed block
+    /// @param[out] out the buffer to append to
+    /// @param[in] observations the observations in sequence order, at most 65535
+    /// @param[in,out] dictionary the dictionary for the segment, new ids are added
+    /// @param[in] placeholders optional flags for observations to only store as placeholders
+    static void encode(std::string &out,
+                       const std::vector<observation::ObservationPtr> &observations,
+                       Dictionary &dictionary, const std::vector<bool> *placeholders = nullptr);
+
+    /// @brief Decode a block
+    ///
+    /// Only the observations with data items in the filter set are created.
+    /// @param[in] block pointer to the start of the block
+    /// @param[in] ids the ids of the dictionary for the segment
+    /// @param[in] dataItems map of data item ids to data items
+    /// @param[in] filterSet optional set of data item ids
+    /// @param[out] out the observations, `nullptr` if filtered or the data item does not exist
+    static void decode(const char *block, const std::vector<std::string> &ids,
+                       const ObservationCodec::DataItemMap &dataItems,
+                       const FilterSetOpt &filterSet,
+                       std::vector<observation::ObservationPtr> &out);
+
+    /// @brief get the length of a block
+    /// @param[in] block pointer to the start of the block
+    /// @return the length including the length field
+    static uint32_t blockLength(const char *block)
+    {
+      uint32_t length;
+      std::memcpy(&length, block, sizeof(length));
+      return length;
+    }
+  };
+}  // namespace mtconnect::buffer
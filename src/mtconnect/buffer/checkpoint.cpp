@@ -36,41 +36,101 @@ namespace mtconnect {
       copy(checkpoint, filter);
     }
 
-    void Checkpoint::clear() { m_observations.clear(); }
+    void Checkpoint::clear()
+    {
+      m_observations.clear();
+      m_conditions.clear();
+    }
 
     Checkpoint::~Checkpoint() { clear(); }
 
-    void Checkpoint::addObservation(ConditionPtr event, ObservationPtr &&old)
+    Checkpoint::ActiveConditions &Checkpoint::getActiveConditions(const string &id,
+                                                                  const ObservationPtr &head)
+    {
+      auto [pos, created] = m_conditions.try_emplace(id);
+      if (created)
+        index(pos->second, head);
+      return pos->second;
+    }
+
+    ConditionPtr Checkpoint::findCondition(const string &id, const ObservationPtr &head,
+                                           const string &code) const
+    {
+      auto active = m_conditions.find(id);
+      if (active != m_conditions.end())
+      {
+        auto pos = active->second.find(code);
+        if (pos == active->second.end())
+          return nullptr;
+        if (auto cond = pos->second.lock())
+          return cond;
+      }
+
+      // The chain has not been indexed or was relinked when the event was added to another
+      // checkpoint
+      return static_pointer_cast<Condition>(head)->find(code);
+    }
+
+    void Checkpoint::index(ActiveConditions &active, const ObservationPtr &head)
+    {
+      active.clear();
+      for (auto cond = static_pointer_cast<Condition>(head); cond; cond = cond->getPrev())
+        active.try_emplace(cond->getCode(), cond);
+    }
+
+    void Checkpoint::addCondition(ActiveConditions &active, ConditionPtr event,
+                                  ObservationPtr &head)
+    {
+      event->appendTo(static_pointer_cast<Condition>(head));
+      active.insert_or_assign(event->getCode(), event);
+      head = event;
+    }
+
+    bool Checkpoint::removeCondition(ActiveConditions &active, const string &code,
+                                     ObservationPtr &head)
+    {
+      auto pos = active.find(code);
+      if (pos == active.end())
+        return false;
+
+      auto chain = static_pointer_cast<Condition>(head);
+      auto removed = pos->second.lock();
+      if (!removed)
+        removed = chain->find(code);
+
+      // Clear the one condition by removing it from a copy of the chain
+      head = chain->deepCopyAndRemove(removed);
+      index(active, head);
+      return true;
+    }
+
+    void Checkpoint::addObservation(const string &id, ConditionPtr event, ObservationPtr &&old)
     {
       bool assign = true;
-      Condition *cond = dynamic_cast<Condition *>(old.get());
+      auto cond = static_cast<Condition *>(old.get());
       if (cond->getLevel() != Condition::NORMAL && event->getLevel() != Condition::NORMAL &&
           cond->getLevel() != Condition::UNAVAILABLE && event->getLevel() != Condition::UNAVAILABLE)
       {
         // Check to see if the native code matches an existing
-        // active condition
-        if (auto e = cond->find(event->getCode()))
-        {
-          // Replace in chain.
-          old = cond->deepCopyAndRemove(e);
-          // Check if this is the only event...
-          // ??
-        }
+        // active condition and replace it in the chain.
+        auto &active = getActiveConditions(id, old);
+        removeCondition(active, event->getCode(), old);
 
         // Chain the event
         if (old)
-          event->appendTo(dynamic_pointer_cast<Condition>(old));
+        {
+          addCondition(active, event, old);
+          return;
+        }
       }
       else if (event->getLevel() == Condition::NORMAL)
       {
         // Check for a normal that clears an active condition by code
         if (!event->getCode().empty())
         {
-          if (auto e = cond->find(event->getCode()))
+          auto &active = getActiveConditions(id, old);
+          if (removeCondition(active, event->getCode(), old))
           {
-            // Clear the one condition by removing it from the chain
-            old = cond->deepCopyAndRemove(e);
-
             if (!old)
             {
               // Need to put a normal event in with no code since this
@@ -78,6 +138,7 @@ namespace mtconnect {
               auto n = make_shared<Condition>(*event);
               n->normal();
               old = n;
+              m_conditions.erase(id);
             }
             assign = false;
           }
@@ -90,25 +151,21 @@ namespace mtconnect {
         }
       }
       if (assign)
+      {
+        // The event replaces the chain, index it when it is next used
         old = event;
+        m_conditions.erase(id);
+      }
     }
 
     void Checkpoint::addObservation(const DataSetEventPtr event, ObservationPtr &&old)
     {
       if (!event->isUnavailable() && !old->isUnavailable() && !event->hasProperty("resetTriggered"))
       {
-        // Get the existing data set from the existing event
+        // Get the existing data set from the existing event and merge the changes. The rows of
+        // tables are shared with the existing data set.
         DataSet set = old->getValue<DataSet>();
-
-        // For data sets merge the maps together
-        for (auto &e : event->getValue<DataSet>())
-        {
-          const auto &oe = set.find(e);
-          if (oe != set.end())
-            set.erase(oe);
-          if (!e.m_removed)
-            set.insert(e);
-        }
+        set.apply(event->getValue<DataSet>());
 
         // Replace the old event with a copy of the new event with sets merged
         // Do not modify the new event.
@@ -124,12 +181,12 @@ namespace mtconnect {
 
     void Checkpoint::addObservation(ObservationPtr obs)
     {
-      if (obs->isOrphan() || (m_filter && m_filter->count(obs->getDataItem()->getId()) == 0))
+      auto item = obs->getDataItemPointer();
+      if (!item || (m_filter && m_filter->count(item->getId()) == 0))
       {
         return;
       }
 
-      auto item = obs->getDataItem();
       const auto &id = item->getId();
       auto old = m_observations.find(id);
 
@@ -137,10 +194,10 @@ namespace mtconnect {
       {
         if (item->isCondition())
         {
-          auto cond = dynamic_pointer_cast<Condition>(obs);
+          auto cond = static_pointer_cast<Condition>(obs);
           // Chain event only if it is normal or unavailable and the
           // previous condition was not normal or unavailable
-          addObservation(cond, std::forward<ObservationPtr>(old->second));
+          addObservation(id, cond, std::forward<ObservationPtr>(old->second));
         }
         else if (item->isDataSet())
         {
@@ -155,6 +212,7 @@ namespace mtconnect {
       else
       {
         m_observations[id] = dynamic_pointer_cast<Observation>(obs->getptr());
+        m_conditions.erase(id);
       }
     }
 
@@ -176,7 +234,7 @@ namespace mtconnect {
 
     static inline void addToList(ObservationList &list, ObservationPtr obs)
     {
-      if (obs->getDataItem()->isCondition())
+      if (obs->getDataItemPointer()->isCondition())
       {
         for (auto ev = dynamic_pointer_cast<Condition>(obs); ev; ev = ev->getPrev())
         {
@@ -217,6 +275,7 @@ namespace mtconnect {
     void Checkpoint::filter(const FilterSet &filterSet)
     {
       m_filter = filterSet;
+      m_conditions.clear();
 
       if (m_filter->empty())
         return;
@@ -241,7 +300,7 @@ namespace mtconnect {
     }
 
     ObservationPtr Checkpoint::dataSetDifference(const ObservationPtr &obs,
-                                                 const ConstObservationPtr &old) const
+                                                 const ConstObservationPtr &old)
     {
       if (obs->isOrphan())
         return nullptr;
@@ -253,21 +312,7 @@ namespace mtconnect {
         auto oldEvent = dynamic_pointer_cast<const DataSetEvent>(old);
         auto &oldSet = oldEvent->getDataSet();
         DataSet eventSet = setEvent->getDataSet();
-        bool changed = false;
-
-        for (auto it = eventSet.begin(); it != eventSet.end();)
-        {
-          const auto v = oldSet.find(*it);
-          if (v == oldSet.end() || !v->same(*it))
-          {
-            it++;
-          }
-          else
-          {
-            changed = true;
-            eventSet.erase(it++);
-          }
-        }
+        bool changed = eventSet.removeSame(oldSet);
 
         // If the data set has changed and been edited by delting it against the current latest.
         if (changed)
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -50,101 +51,168 @@ namespace mtconnect::buffer {
     /// @param[in] observation the data set observation
     /// @param[in] old the previous value of the data set
     /// @return The observation or a copy  if the data set changed
-    observation::ObservationPtr dataSetDifference(
+    static observation::ObservationPtr dataSetDifference(
         const observation::ObservationPtr &observation,
-        const observation::ConstObservationPtr &old) const;
+        const observation::ConstObservationPtr &old);
 
     /// @brief Checks if the observation is a duplicate with existing observations
+    ///
+    /// Active conditions are found by code in the condition index instead of walking the chain.
+    ///
     /// @param[in] obs the observation
     /// @return an observation, possibly changed if it is not a duplicate. `nullptr` if it is a
     /// duplicate..
     const observation::ObservationPtr checkDuplicate(const observation::ObservationPtr &obs) const
+    {
+      using namespace observation;
+
+      auto di = obs->getDataItemPointer();
+      auto old = m_observations.find(di->getId());
+      if (old == m_observations.end())
+        return obs;
+
+      if (!di->isCondition() || obs->isUnavailable() || old->second->isUnavailable())
+        return checkDuplicate(obs, old->second);
+
+      auto &code = static_cast<const Condition *>(obs.get())->getCode();
+      auto active = findCondition(di->getId(), old->second, code);
+      return checkDuplicate(obs, static_cast<const Condition *>(old->second.get()), active.get());
+    }
+
+    /// @brief Checks if the observation is a duplicate of the previous observation
+    /// @param[in] obs the observation
+    /// @param[in] oldObs the previous observation for the same data item
+    /// @return an observation, possibly changed if it is not a duplicate. `nullptr` if it is a
+    /// duplicate..
+    static const observation::ObservationPtr checkDuplicate(
+        const observation::ObservationPtr &obs, const observation::ObservationPtr &oldObs)
     {
       using namespace observation;
       using namespace std;
 
-      auto di = obs->getDataItem();
-      const auto &id = di->getId();
-      auto old = m_observations.find(id);
+      auto di = obs->getDataItemPointer();
 
-      if (old != m_observations.end())
-      {
-        auto &oldObs = old->second;
-        // Filter out unavailable duplicates, only allow through changed
-        // state. If both are unavailable, disregard.
-        if (obs->isUnavailable() != oldObs->isUnavailable())
-          return obs;
-        else if (obs->isUnavailable())
-          return nullptr;
+      // Filter out unavailable duplicates, only allow through changed
+      // state. If both are unavailable, disregard.
+      if (obs->isUnavailable() != oldObs->isUnavailable())
+        return obs;
+      else if (obs->isUnavailable())
+        return nullptr;
 
-        if (di->isCondition())
+      if (di->isCondition())
+      {
+        auto *oldCond = static_cast<const Condition *>(oldObs.get());
+        auto &code = static_cast<const Condition *>(obs.get())->getCode();
+        return checkDuplicate(obs, oldCond, oldCond->find(code).get());
+      }
+      else if (!di->isDiscrete())
+      {
+        if (di->isDataSet())
+        {
+          return dataSetDifference(obs, oldObs);
+        }
+        else
         {
-          auto *cond = dynamic_cast<Condition *>(obs.get());
-          auto *oldCond = dynamic_cast<Condition *>(oldObs.get());
-
-          // Check for normal resetting all conditions. If there are
-          // no active conditions, then this is a duplicate normal
-          if (cond->getLevel() == Condition::NORMAL && cond->getCode().empty())
-          {
-            if (oldCond->getLevel() == Condition::NORMAL && oldCond->getCode().empty())
-              return nullptr;
-            else
-              return obs;
-          }
-
-          // If there is already an active condition with this code,
-          // then check if nothing has changed between activations.
-          if (const auto &e = oldCond->find(cond->getCode()))
-          {
-            if (cond->getLevel() != e->getLevel())
-              return obs;
-
-            if ((cond->hasValue() != e->hasValue()) ||
-                (cond->hasValue() && cond->getValue() != e->getValue()))
-              return obs;
-
-            if ((cond->hasProperty("qualifier") != e->hasProperty("qualifier")) ||
-                (cond->hasProperty("qualifier") &&
-                 cond->get<string>("qualifier") != e->get<string>("qualifier")))
-              return obs;
-
-            if ((cond->hasProperty("nativeSeverity") != e->hasProperty("nativeSeverity")) ||
-                (cond->hasProperty("nativeSeverity") &&
-                 cond->get<string>("nativeSeverity") != e->get<string>("nativeSeverity")))
-              return obs;
+          auto &value = obs->getValue();
+          auto &oldValue = oldObs->getValue();
 
+          if (value == oldValue)
             return nullptr;
-          }
-          else if (cond->getLevel() == Condition::NORMAL)
-          {
-            return nullptr;
-          }
           else
-          {
             return obs;
-          }
-        }
-        else if (!di->isDiscrete())
-        {
-          if (di->isDataSet())
-          {
-            return dataSetDifference(obs, oldObs);
-          }
-          else
-          {
-            auto &value = obs->getValue();
-            auto &oldValue = oldObs->getValue();
-
-            if (value == oldValue)
-              return nullptr;
-            else
-              return obs;
-          }
         }
       }
       return obs;
     }
 
+    /// @brief Checks if a condition is a duplicate by walking a short chain of conditions
+    ///
+    /// Allows checking without the index or the buffer lock. The links of a published chain do
+    /// not change, conditions are removed from a copy of the chain.
+    ///
+    /// @param[in] obs the condition
+    /// @param[in] oldObs the previous condition for the same data item
+    /// @param[in] limit the maximum number of conditions to walk
+    /// @return the result of the check or `std::nullopt` if the chain is longer than `limit`
+    static std::optional<observation::ObservationPtr> checkDuplicate(
+        const observation::ObservationPtr &obs, const observation::ObservationPtr &oldObs,
+        size_t limit)
+    {
+      using namespace observation;
+
+      if (obs->isUnavailable() || oldObs->isUnavailable())
+        return checkDuplicate(obs, oldObs);
+
+      auto *oldCond = static_cast<const Condition *>(oldObs.get());
+      auto &code = static_cast<const Condition *>(obs.get())->getCode();
+      size_t count = 0;
+      for (auto cond = oldCond; cond; cond = cond->getPrev().get())
+      {
+        if (++count > limit)
+          return std::nullopt;
+        if (cond->getCode() == code)
+          return checkDuplicate(obs, oldCond, cond);
+      }
+      return checkDuplicate(obs, oldCond, nullptr);
+    }
+
+    /// @brief Checks if a condition is a duplicate of the active condition with the same code
+    /// @param[in] obs the condition
+    /// @param[in] oldCond the previous condition for the same data item
+    /// @param[in] active the active condition with the same code or `nullptr`
+    /// @return the condition if it is not a duplicate. `nullptr` if it is a duplicate.
+    static const observation::ObservationPtr checkDuplicate(
+        const observation::ObservationPtr &obs, const observation::Condition *oldCond,
+        const observation::Condition *active)
+    {
+      using namespace observation;
+      using namespace std;
+
+      auto *cond = static_cast<const Condition *>(obs.get());
+
+      // Check for normal resetting all conditions. If there are
+      // no active conditions, then this is a duplicate normal
+      if (cond->getLevel() == Condition::NORMAL && cond->getCode().empty())
+      {
+        if (oldCond->getLevel() == Condition::NORMAL && oldCond->getCode().empty())
+          return nullptr;
+        else
+          return obs;
+      }
+
+      // If there is already an active condition with this code,
+      // then check if nothing has changed between activations.
+      if (const auto e = active)
+      {
+        if (cond->getLevel() != e->getLevel())
+          return obs;
+
+        if ((cond->hasValue() != e->hasValue()) ||
+            (cond->hasValue() && cond->getValue() != e->getValue()))
+          return obs;
+
+        if ((cond->hasProperty("qualifier") != e->hasProperty("qualifier")) ||
+            (cond->hasProperty("qualifier") &&
+             cond->get<string>("qualifier") != e->get<string>("qualifier")))
+          return obs;
+
+        if ((cond->hasProperty("nativeSeverity") != e->hasProperty("nativeSeverity")) ||
+            (cond->hasProperty("nativeSeverity") &&
+             cond->get<string>("nativeSeverity") != e->get<string>("nativeSeverity")))
+          return obs;
+
+        return nullptr;
+      }
+      else if (cond->getLevel() == Condition::NORMAL)
+      {
+        return nullptr;
+      }
+      else
+      {
+        return obs;
+      }
+    }
+
     /// @brief copy another checkpoint to this checkpoint
     /// @param[in] checkpoint a checkpoint to copy
     /// @param[in] filterSet an optional filter set
@@ -166,27 +234,22 @@ namespace mtconnect::buffer {
       return m_observations;
     }
 
-    /// @brief updates the data item reference of an observation in a checkpoint
+    /// @brief remove the observations of data items that were removed from the device model
     ///
-    /// Used when the device model is modified and data items may have been removed or
-    /// changed. The new data item shared pointer will replace the old.
-    ///
-    /// @param[in] diMap the map of data ids to data item pointers
-    void updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
+    /// Used when the device model is modified. Observations of changed data items already
+    /// reference the new data item through the data item handle.
+    void removeOrphans()
     {
       auto iter = m_observations.begin();
       while (iter != m_observations.end())
       {
-        auto item = *iter;
-        if (item.second->isOrphan())
+        if (iter->second->isOrphan())
         {
+          m_conditions.erase(iter->first);
           iter = m_observations.erase(iter);
         }
         else
-        {
-          item.second->updateDataItem(diMap);
           iter++;
-        }
       }
     }
 
@@ -208,12 +271,61 @@ namespace mtconnect::buffer {
     }
 
   protected:
-    void addObservation(observation::ConditionPtr event, observation::ObservationPtr &&old);
+    /// @brief The active conditions of a condition data item by native code
+    ///
+    /// The conditions are owned by the chain, which is shared with the buffer and the printers.
+    /// The newest condition with a code is indexed, the same as `Condition::find()`.
+    using ActiveConditions =
+        std::unordered_map<std::string, std::weak_ptr<observation::Condition>>;
+    using ConditionIndex = std::unordered_map<std::string, ActiveConditions>;
+
+    void addObservation(const std::string &id, observation::ConditionPtr event,
+                        observation::ObservationPtr &&old);
     void addObservation(const observation::DataSetEventPtr event,
                         observation::ObservationPtr &&old);
 
-  protected:
+    /// @brief Get the active conditions of a chain, indexed when first used
+    /// @param[in] id the data item id
+    /// @param[in] head the first condition in the chain
+    /// @return the active conditions
+    ActiveConditions &getActiveConditions(const std::string &id,
+                                          const observation::ObservationPtr &head);
+    /// @brief Find an active condition by code
+    ///
+    /// Uses the index if the chain has been indexed, otherwise walks the chain.
+    ///
+    /// @param[in] id the data item id
+    /// @param[in] head the first condition in the chain
+    /// @param[in] code the code of the condition
+    /// @return the condition or `nullptr` if there is no active condition with the code
+    observation::ConditionPtr findCondition(const std::string &id,
+                                            const observation::ObservationPtr &head,
+                                            const std::string &code) const;
+    /// @brief Index the conditions of a chain
+    /// @param[out] active the active conditions
+    /// @param[in] head the first condition in the chain
+    static void index(ActiveConditions &active, const observation::ObservationPtr &head);
+    /// @brief Chain a condition to the head
+    /// @param[in,out] active the active conditions
+    /// @param[in] event the condition
+    /// @param[in,out] head the first condition in the chain
+    static void addCondition(ActiveConditions &active, observation::ConditionPtr event,
+                             observation::ObservationPtr &head);
+    /// @brief Remove an active condition by code
+    ///
+    /// The chain is copied without the condition so chains held by the buffer and the printers
+    /// do not change.
+    ///
+    /// @param[in,out] active the active conditions
+    /// @param[in] code the code of the condition
+    /// @param[in,out] head the first condition in the chain, `nullptr` if it was the last
+    /// @return `true` if there was an active condition with the code
+    static bool removeCondition(ActiveConditions &active, const std::string &code,
+                                observation::ObservationPtr &head);
+
     std::unordered_map<std::string, observation::ObservationPtr> m_observations;
+    // Active conditions by data item id. Not copied with the checkpoint.
+    ConditionIndex m_conditions;
     FilterSetOpt m_filter;
   };
 }  // namespace mtconnect::buffer
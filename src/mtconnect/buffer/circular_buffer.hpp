@@ -19,11 +19,16 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <optional>
 
 #include "checkpoint.hpp"
+#include "epoch.hpp"
+#include "observation_archive.hpp"
 #include "mtconnect/config.hpp"
 #include "mtconnect/entity/requirement.hpp"
 #include "mtconnect/logging.hpp"
@@ -37,6 +42,11 @@ namespace mtconnect::buffer {
   class AGENT_LIB_API CircularBuffer
   {
   public:
+    /// @brief Sequences between time index entries
+    static constexpr SequenceNumber_t TimeIndexStride = 64;
+    /// @brief The longest condition chain checked for duplicates without the buffer lock
+    static constexpr size_t LockFreeConditions = 8;
+
     /// @brief Create a circular buffer
     /// @param bufferSize the size of the circular buffer
     /// @param checkpointFreq how often to create checkpoints
@@ -47,7 +57,8 @@ namespace mtconnect::buffer {
         m_slidingBuffer(m_slidingBufferSize),
         m_checkpointFreq(checkpointFreq),
         m_checkpointCount(m_slidingBufferSize / checkpointFreq),
-        m_checkpoints(m_checkpointCount)
+        m_checkpoints(m_checkpointCount),
+        m_timeIndex(m_slidingBufferSize / TimeIndexStride + 2)
     {}
 
     ~CircularBuffer() { m_checkpoints.clear(); }
@@ -58,7 +69,7 @@ namespace mtconnect::buffer {
     observation::ObservationPtr getFromBuffer(uint64_t seq) const
     {
       auto off = seq - m_firstSequence;
-      if (off < m_slidingBufferSize)
+      if (off < m_slidingBuffer.size())
         return m_slidingBuffer[off];
       else
         return observation::ObservationPtr();
@@ -76,42 +87,133 @@ namespace mtconnect::buffer {
     /// @return the buffer size
     unsigned int getBufferSize() const { return m_slidingBufferSize; }
 
-    /// @brief get the first sequence number in the circular buffer
+    /// @brief get the first sequence number retained by the agent
+    ///
+    /// If there is an archive, this is the first archived sequence.
     /// @return first sequence
-    SequenceNumber_t getFirstSequence() const { return m_firstSequence; }
+    SequenceNumber_t getFirstSequence() const
+    {
+      if (m_archive)
+      {
+        auto first = m_archive->getFirstSequence();
+        if (first > 0 && first < m_firstSequence)
+          return first;
+      }
+      return m_firstSequence;
+    }
+    /// @brief get the first sequence number in the circular buffer
+    /// @return first sequence in memory
+    SequenceNumber_t getBufferFirstSequence() const { return m_firstSequence; }
 
-    /// @brief update the data item references when device model changes
-    /// @param diMap the map of data item ids to new data item entities
-    void updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
+    /// @brief Set an archive for the observations evicted from the circular buffer
+    /// @param[in] archive the archive
+    void setArchive(std::unique_ptr<ObservationArchive> archive)
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+      m_archive = std::move(archive);
+    }
+    /// @brief get the archive
+    /// @return the archive or `nullptr` if observations are not archived
+    const ObservationArchive *getArchive() const { return m_archive.get(); }
+
+    /// @brief Limit the approximate memory used by the observations in the circular buffer
+    ///
+    /// When the limit is exceeded, observations are evicted from the front of the buffer even
+    /// if there are free slots. Must be set before observations are added.
+    /// @param[in] limit the limit in bytes, `0` for no limit
+    void setMemoryLimit(size_t limit)
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+      m_memoryLimit = limit;
+      m_sizes.set_capacity(limit > 0 ? m_slidingBufferSize : 0);
+    }
+    /// @brief get the memory limit
+    /// @return the limit in bytes or `0` if there is no limit
+    size_t getMemoryLimit() const { return m_memoryLimit; }
+    /// @brief get the approximate memory used by the observations in the circular buffer
+    /// @return the bytes used, only tracked when there is a memory limit
+    size_t getMemoryUsage() const { return m_memoryUsage; }
+    /// @brief get the number of observations in the circular buffer
+    size_t getObservationCount() const { return m_slidingBuffer.size(); }
+
+    /// @brief Approximate the memory used by an observation
+    ///
+    /// Counts the observation, its properties, and the contents of strings, vectors, and data
+    /// sets. Shared data such as the data item is not counted.
+    /// @param[in] obs the observation
+    /// @return the approximate size in bytes
+    static size_t approximateSize(const observation::ObservationPtr &obs)
     {
-      for (auto &o : m_slidingBuffer)
+      using namespace entity;
+      // Map node overhead for each property
+      constexpr size_t PropertySize = sizeof(Properties::value_type) + 32;
+
+      auto entrySize = [](const auto &entry) {
+        size_t size = sizeof(entry) + entry.m_key.size();
+        if (auto s = std::get_if<std::string>(&entry.m_value))
+          size += s->size();
+        return size;
+      };
+
+      size_t size = sizeof(observation::Condition);
+      for (const auto &[key, value] : obs->getProperties())
       {
-        if (o->isOrphan())
-        {
-          continue;
-        }
-        o->updateDataItem(diMap);
+        size += PropertySize;
+        std::visit(overloaded {[&](const std::string &v) { size += v.size(); },
+                               [&](const Vector &v) { size += v.size() * sizeof(double); },
+                               [&](const DataSet &v) {
+                                 for (const auto &entry : v)
+                                 {
+                                   size += entrySize(entry);
+                                   if (auto row = std::get_if<TableRow>(&entry.m_value))
+                                   {
+                                     for (const auto &cell : *row)
+                                       size += entrySize(cell);
+                                   }
+                                 }
+                               },
+                               [](const auto &) {}},
+                   value);
       }
 
-      // checkpoints will remove orphans from its observations
-      m_first.updateDataItems(diMap);
-      m_latest.updateDataItems(diMap);
+      return size;
+    }
+
+    /// @brief update the data item references when device model changes
+    ///
+    /// The observations reference their data items through handles the agent repoints to the
+    /// new data items, so only the first and latest checkpoints and the archive are visited. The
+    /// orphaned observations in the buffer and the other checkpoints are skipped when read.
+    ///
+    /// @param diMap the map of data item ids to new data item entities
+    void updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
+    {
+      m_first.removeOrphans();
+      m_latest.removeOrphans();
 
-      for (auto &cp : m_checkpoints)
+      // Publish the latest observations to the new data items
+      for (auto &o : m_latest.getObservations())
       {
-        cp->updateDataItems(diMap);
+        if (auto di = o.second->getDataItem())
+          di->setLatestObservation(o.second);
       }
+
+      if (m_archive)
+        m_archive->updateDataItems(diMap);
     }
 
     /// @brief Set the sequence number
     ///
-    /// recomputes the first sequence if the sequence is larger than the circular buffer size.
+    /// recomputes the first sequence if the sequence is larger than the circular buffer size or
+    /// the buffer is empty.
     ///
     /// @param seq the new sequence number
     void setSequence(SequenceNumber_t seq)
     {
       m_sequence = seq;
-      if (seq > m_slidingBufferSize)
+      if (m_slidingBuffer.empty())
+        m_firstSequence = seq;
+      else if (seq > m_slidingBufferSize)
         m_firstSequence = seq - m_slidingBuffer.size();
     }
 
@@ -127,15 +229,49 @@ namespace mtconnect::buffer {
         return 0;
 
       std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
-      auto dataItem = observation->getDataItem();
+      auto dataItem = observation->getDataItemPointer();
       auto seq = m_sequence;
 
       observation->setSequence(seq);
+
+      // Keep the observation that is about to be evicted for the archive and the readers
+      observation::ObservationPtr evicted;
+      if (m_slidingBuffer.full())
+        evicted = m_slidingBuffer.front();
+
+      if (m_memoryLimit > 0)
+      {
+        if (m_sizes.full())
+          m_memoryUsage -= m_sizes.front();
+        auto size = approximateSize(observation);
+        m_sizes.push_back(size);
+        m_memoryUsage += size;
+      }
+
       m_slidingBuffer.push_back(observation);
       m_latest.addObservation(observation);
 
+      // The index keeps the highest timestamp so it stays ordered if timestamps are not
+      if (observation->getTimestamp() > m_highestTimestamp)
+        m_highestTimestamp = observation->getTimestamp();
+      if (observation->getTimestamp() < m_blockLowest)
+        m_blockLowest = observation->getTimestamp();
+      if (seq % TimeIndexStride == 0)
+      {
+        m_timeIndex.push_back({seq, m_highestTimestamp});
+
+        // A block with a lower timestamp hides the earlier blocks that are not lower
+        while (!m_lowestIndex.empty() && m_lowestIndex.back().m_timestamp >= m_blockLowest)
+          m_lowestIndex.pop_back();
+        m_lowestIndex.push_back({seq, m_blockLowest});
+        m_blockLowest = Timestamp::max();
+        while (m_lowestIndex.front().m_sequence < m_firstSequence)
+          m_lowestIndex.pop_front();
+      }
+      dataItem->setLatestObservation(m_latest.getObservation(dataItem->getId()));
+
       // Special case for the first event in the series to prime the first checkpoint.
-      if (seq == 1)
+      if (seq == m_firstSequence)
         m_first.addObservation(observation);
       else if (m_slidingBuffer.full())
       {
@@ -146,6 +282,17 @@ namespace mtconnect::buffer {
         // assert(old->getSequence() == m_firstSequence);
       }
 
+      if (evicted)
+      {
+        // The archive writes on its own thread
+        if (m_archive)
+          m_archive->append(evicted);
+        m_epochs.retire(std::move(evicted));
+      }
+
+      if (m_memoryLimit > 0)
+        evictToMemoryLimit();
+
       // Checkpoint management
       if (m_checkpointCount > 0 && (seq % m_checkpointFreq) == 0)
       {
@@ -153,6 +300,15 @@ namespace mtconnect::buffer {
         m_checkpoints.push_back(std::make_unique<Checkpoint>(m_latest));
       }
 
+      // The checkpoints must start after the first sequence when the memory limit has evicted
+      // observations before the buffer is full
+      if (m_memoryLimit > 0)
+      {
+        auto count = seq / m_checkpointFreq - m_firstSequence / m_checkpointFreq;
+        while (m_checkpoints.size() > count)
+          m_checkpoints.pop_front();
+      }
+
       dataItem->signalObservers(m_sequence);
 
       m_sequence++;
@@ -173,10 +329,25 @@ namespace mtconnect::buffer {
     auto getCheckpointCount() const { return m_checkpointCount; }
 
     /// @brief Check if observation is a duplicate by validating against the latest checkpoint
+    ///
+    /// Uses the latest observation published to the data item without taking the buffer lock.
+    /// Only falls back to the latest checkpoint if nothing has been published. Conditions are
+    /// checked against the published chain if it has at most `LockFreeConditions` conditions,
+    /// longer chains use the index of active conditions in the latest checkpoint.
+    ///
     /// @param[in] obs the observation to check
     /// @return `true` if the observation is a duplicate
     const observation::ObservationPtr checkDuplicate(const observation::ObservationPtr &obs) const
     {
+      auto di = obs->getDataItemPointer();
+      if (auto latest = di->getLatestObservation())
+      {
+        if (!di->isCondition())
+          return Checkpoint::checkDuplicate(obs, latest);
+        if (auto result = Checkpoint::checkDuplicate(obs, latest, LockFreeConditions))
+          return *result;
+      }
+
       std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
       return m_latest.checkDuplicate(obs);
     }
@@ -233,6 +404,86 @@ namespace mtconnect::buffer {
     }
     ///@}
 
+    /// @brief Find the first sequence in the circular buffer at or after a time
+    ///
+    /// Timestamps may be out of order, for example from adapters using relative time. The search
+    /// uses the highest timestamp up to each sequence, so every observation in the circular
+    /// buffer with a timestamp at or after `time` has a sequence at or after the result.
+    ///
+    /// A binary search of the time index finds the block, then at most `TimeIndexStride`
+    /// observations are scanned.
+    /// @param[in] time the time
+    /// @return the sequence, or the next sequence if there is nothing at or after `time`
+    SequenceNumber_t getSequenceAtTime(const Timestamp &time) const
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+
+      auto it = std::lower_bound(
+          m_timeIndex.begin(), m_timeIndex.end(), time,
+          [](const TimeIndexEntry &entry, const Timestamp &t) { return entry.m_timestamp < t; });
+
+      // Everything up to the previous entry is before the time, the result is at or before the
+      // entry found.
+      auto seq = m_firstSequence;
+      if (it != m_timeIndex.begin())
+        seq = std::max(seq, std::prev(it)->m_sequence + 1);
+      auto last = it == m_timeIndex.end() ? m_sequence : std::max(it->m_sequence, seq);
+
+      for (; seq < last; seq++)
+      {
+        if (m_slidingBuffer[seq - m_firstSequence]->getTimestamp() >= time)
+          return seq;
+      }
+
+      return last;
+    }
+
+    /// @brief Find the last sequence in the circular buffer at or before a time
+    ///
+    /// The mirror of getSequenceAtTime(): every observation in the circular buffer with a
+    /// timestamp at or before `time` has a sequence at or before the result. If timestamps are
+    /// out of order, observations after `time` may also be in the range up to the result.
+    ///
+    /// The index keeps the lowest timestamp of each block that is lower than all the blocks
+    /// after it, so the last block with a timestamp at or before `time` is found with a binary
+    /// search and at most two blocks are scanned.
+    /// @param[in] time the time
+    /// @return the sequence, or one before the first sequence if nothing is at or before `time`
+    SequenceNumber_t getLastSequenceAtTime(const Timestamp &time) const
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+
+      // Scan the block ending at `last` backwards
+      auto scan = [&](SequenceNumber_t last) -> std::optional<SequenceNumber_t> {
+        auto first = std::max(m_firstSequence, last - (last - 1) % TimeIndexStride);
+        for (auto seq = std::min(last, m_sequence - 1); seq >= first; seq--)
+        {
+          if (m_slidingBuffer[seq - m_firstSequence]->getTimestamp() <= time)
+            return seq;
+        }
+        return std::nullopt;
+      };
+
+      // The block being filled is not in the index yet
+      if (m_sequence > m_firstSequence)
+      {
+        if (auto seq = scan(m_sequence - 1))
+          return *seq;
+      }
+
+      auto it = std::upper_bound(
+          m_lowestIndex.begin(), m_lowestIndex.end(), time,
+          [](const Timestamp &t, const TimeIndexEntry &entry) { return t < entry.m_timestamp; });
+      if (it != m_lowestIndex.begin())
+      {
+        // Nothing after this block is at or before the time. The lowest may have been evicted.
+        if (auto seq = scan(std::prev(it)->m_sequence))
+          return *seq;
+      }
+
+      return m_firstSequence - 1;
+    }
+
     /// @brief Get a list of observations from the circular buffer
     /// @param[in] count maximum number of observations to get
     /// @param[in] filterSet optional filter set of data item ids
@@ -248,79 +499,218 @@ namespace mtconnect::buffer {
         bool &endOfBuffer) const
     {
       auto results = std::make_unique<observation::ObservationList>();
+      visitObservations(count, filterSet, start, to, end, firstSeq, endOfBuffer,
+                        [&results](const observation::ObservationPtr &obs, bool) {
+                          results->push_back(obs);
+                        });
+      return results;
+    }
+
+    /// @brief Get pointers to observations from the circular buffer without taking references
+    ///
+    /// The caller must hold a guard from `pin()` that was taken before the call. The observations
+    /// in the buffer are not released until the guard is destroyed. Observations read from the
+    /// archive are not in the buffer and are kept in `archived`.
+    ///
+    /// @param[out] results the observations
+    /// @param[out] archived owns the observations read from the archive
+    /// @param[in] count maximum number of observations to get
+    /// @param[in] filterSet optional filter set of data item ids
+    /// @param[in] start optional starting sequence
+    /// @param[in] to optional ending sequence
+    /// @param[out] end last sequence number in the list
+    /// @param[out] firstSeq first sequence number in the list
+    /// @param[out] endOfBuffer `true` if the last sequence is at the end of the buffer
+    void getObservations(observation::ObservationPointers &results,
+                         observation::ObservationList &archived, int count,
+                         const FilterSetOpt &filterSet, const std::optional<SequenceNumber_t> start,
+                         const std::optional<SequenceNumber_t> to, SequenceNumber_t &end,
+                         SequenceNumber_t &firstSeq, bool &endOfBuffer) const
+    {
+      visitObservations(count, filterSet, start, to, end, firstSeq, endOfBuffer,
+                        [&](const observation::ObservationPtr &obs, bool fromArchive) {
+                          if (fromArchive)
+                            archived.push_back(obs);
+                          results.push_back(obs.get());
+                        });
+    }
 
+    /// @brief Pin the current epoch so evicted observations are not released
+    ///
+    /// Must be taken before the buffer lock.
+    /// @return a guard that unpins the epoch when destroyed
+    EpochManager::Guard pin() const { return m_epochs.pin(); }
+    /// @brief get the epoch manager for the evicted observations
+    const EpochManager &getEpochs() const { return m_epochs; }
+    /// @brief Keep a replaced part of the device model until the pinned readers have left
+    ///
+    /// Observations reference their data items without a reference count, so the data items of
+    /// a replaced device are released like evicted observations.
+    /// @param[in] model the replaced device
+    void retire(std::shared_ptr<const void> model)
+    {
       std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
-      firstSeq = m_firstSequence;
+      m_epochs.retire(std::move(model));
+    }
+
+    /// @name Mutex lock  management
+    ///@{
+
+    /// @brief lock the mutex
+    auto lock() { return m_sequenceLock.lock(); }
+    /// @brief unlock the mutex
+    auto unlock() { return m_sequenceLock.unlock(); }
+    /// @brief try to lock the mutex
+    auto try_lock() { return m_sequenceLock.try_lock(); }
+    ///@}
+
+  protected:
+    // Evict observations from the front of the buffer until they fit in the memory limit. The
+    // last observation is always kept.
+    void evictToMemoryLimit()
+    {
+      while (m_memoryUsage > m_memoryLimit && m_slidingBuffer.size() > 1)
+      {
+        auto old = m_slidingBuffer.front();
+        m_memoryUsage -= m_sizes.front();
+        m_sizes.pop_front();
+        m_slidingBuffer.pop_front();
+
+        if (m_archive)
+          m_archive->append(old);
+        m_epochs.retire(std::move(old));
+
+        // Roll the first checkpoint forward to the new first observation
+        m_first.addObservation(m_slidingBuffer.front());
+        m_firstSequence++;
+      }
+    }
+
+    // Walks the buffer and the archive for `getObservations()`, `add` is called with each
+    // observation and `true` if it was read from the archive. The archive is read after the
+    // buffer lock is released.
+    template <typename Add>
+    void visitObservations(int count, const FilterSetOpt &filterSet,
+                           const std::optional<SequenceNumber_t> start,
+                           const std::optional<SequenceNumber_t> to, SequenceNumber_t &end,
+                           SequenceNumber_t &firstSeq, bool &endOfBuffer, Add &&add) const
+    {
       int limit, inc;
+      int added = 0;
+      SequenceNumber_t first, seq, lowest, bufferFirst, sequence;
+      bool readArchive = false;
 
-      SequenceNumber_t first;
-      size_t max = m_slidingBuffer.size();
+      // When reading forward from the archive, the observations in the buffer that follow the
+      // archived observations are kept until the archive has been read
+      std::vector<std::pair<SequenceNumber_t, observation::ObservationPtr>> following;
 
-      // Determine where to start and direction of iteration.
-      if (count >= 0)
       {
-        if (to)
+        std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+        lowest = getFirstSequence();
+        firstSeq = lowest;
+        bufferFirst = m_firstSequence;
+        sequence = m_sequence;
+
+        // Determine where to start and direction of iteration.
+        if (count >= 0)
+        {
+          if (to)
+          {
+            if (start && *start > lowest)
+              firstSeq = *start;
+            first = *to;
+            inc = -1;
+          }
+          else
+          {
+            first = (start && *start > firstSeq) ? *start : firstSeq;
+            inc = 1;
+          }
+          limit = count;
+        }
+        else
         {
-          if (start && *start > m_firstSequence)
-            firstSeq = *start;
-          first = *to;
+          first = (start && *start < m_sequence) ? *start : m_sequence - 1;
+          limit = -count;
           inc = -1;
         }
+
+        seq = first;
+        if (m_archive && inc > 0 && limit > 0 && seq < m_firstSequence)
+        {
+          readArchive = true;
+          for (auto s = m_firstSequence; following.size() < size_t(limit) && s < m_sequence; s++)
+          {
+            auto &event = m_slidingBuffer[s - m_firstSequence];
+            if (!event->isOrphan() &&
+                (!filterSet || filterSet->count(event->getDataItemPointer()->getId()) > 0))
+              following.emplace_back(s, event);
+          }
+        }
         else
         {
-          first = (start && *start > firstSeq) ? *start : firstSeq;
-          inc = 1;
+          for (; added < limit && seq >= m_firstSequence && seq < m_sequence && seq >= firstSeq;
+               seq += inc)
+          {
+            // Filter out according to if it exists in the list
+            auto &event = m_slidingBuffer[seq - m_firstSequence];
+            if (!event->isOrphan())
+            {
+              const std::string &dataId = event->getDataItemPointer()->getId();
+              if (!filterSet || filterSet->count(dataId) > 0)
+              {
+                add(event, false);
+                added++;
+              }
+            }
+          }
+
+          readArchive = m_archive && inc < 0 && added < limit && seq < m_firstSequence &&
+                        seq >= firstSeq;
         }
-        limit = count;
-      }
-      else
-      {
-        first = (start && *start < m_sequence) ? *start : m_sequence - 1;
-        limit = -count;
-        inc = -1;
       }
 
-      size_t min = firstSeq - m_firstSequence;
-      size_t i = first - m_firstSequence;
-      for (int added = 0; added < limit && i < max && i >= min; i += inc)
+      if (readArchive)
       {
-        // Filter out according to if it exists in the list
-        auto &event = m_slidingBuffer[i];
-        if (!event->isOrphan())
+        auto visitor = [&](SequenceNumber_t, const observation::ObservationPtr &obs) {
+          add(obs, true);
+          return ++added < limit;
+        };
+
+        if (inc > 0)
         {
-          const std::string &dataId = event->getDataItem()->getId();
-          if (!filterSet || filterSet->count(dataId) > 0)
+          // Observations before the circular buffer are read from the archive
+          seq = m_archive->read(seq, bufferFirst, filterSet, visitor);
+          if (added < limit)
           {
-            results->push_back(event);
-            added++;
+            for (auto &[s, event] : following)
+            {
+              add(event, false);
+              seq = s + 1;
+              if (++added == limit)
+                break;
+            }
+            if (added < limit)
+              seq = sequence;
           }
         }
+        else
+        {
+          seq = m_archive->readReverse(seq, firstSeq, filterSet, visitor);
+        }
       }
 
       if (to)
-        end = first < m_sequence ? first + 1 : m_sequence;
+        end = first < sequence ? first + 1 : sequence;
       else
-        end = m_firstSequence + i;
+        end = seq;
 
       if (count >= 0)
-        endOfBuffer = i + m_firstSequence >= m_sequence;
+        endOfBuffer = seq >= sequence;
       else
-        endOfBuffer = i + m_firstSequence <= m_firstSequence;
-
-      return results;
+        endOfBuffer = seq <= lowest;
     }
 
-    /// @name Mutex lock  management
-    ///@{
-
-    /// @brief lock the mutex
-    auto lock() { return m_sequenceLock.lock(); }
-    /// @brief unlock the mutex
-    auto unlock() { return m_sequenceLock.unlock(); }
-    /// @brief try to lock the mutex
-    auto try_lock() { return m_sequenceLock.try_lock(); }
-    ///@}
-
   protected:
     // Access control to the buffer
     mutable std::recursive_mutex m_sequenceLock;
@@ -340,5 +730,30 @@ namespace mtconnect::buffer {
     Checkpoint m_latest;
     Checkpoint m_first;
     boost::circular_buffer<std::unique_ptr<Checkpoint>> m_checkpoints;
+
+    // Sparse time index with the highest timestamp at every `TimeIndexStride` sequence
+    struct TimeIndexEntry
+    {
+      SequenceNumber_t m_sequence;
+      Timestamp m_timestamp;
+    };
+    boost::circular_buffer<TimeIndexEntry> m_timeIndex;
+    Timestamp m_highestTimestamp;
+
+    // Lowest timestamp of the blocks ending at each sequence that are lower than every later
+    // block, increasing from front to back
+    std::deque<TimeIndexEntry> m_lowestIndex;
+    Timestamp m_blockLowest {Timestamp::max()};
+
+    // Approximate memory use of the observations when there is a memory limit
+    size_t m_memoryLimit {0};
+    size_t m_memoryUsage {0};
+    boost::circular_buffer<size_t> m_sizes;
+
+    // Optional on-disk tier for evicted observations
+    std::unique_ptr<ObservationArchive> m_archive;
+
+    // Defers the release of evicted observations while readers use them without a reference
+    mutable EpochManager m_epochs;
   };
 }  // namespace mtconnect::buffer
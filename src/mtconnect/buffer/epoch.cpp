@@ -0,0 +1,71 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "epoch.hpp"
+
+#include <functional>
+#include <limits>
+#include <thread>
+
+using namespace std;
+
+namespace mtconnect::buffer {
+  EpochManager::Guard EpochManager::pin()
+  {
+    // Start each thread at a different slot so readers rarely collide
+    thread_local const size_t start = hash<thread::id>()(this_thread::get_id()) % MaxReaders;
+
+    for (;;)
+    {
+      auto epoch = m_epoch.load(memory_order_acquire);
+      for (size_t i = 0; i < MaxReaders; i++)
+      {
+        auto &slot = m_readers[(start + i) % MaxReaders].m_epoch;
+        Epoch idle = 0;
+        if (slot.load(memory_order_relaxed) == 0 &&
+            slot.compare_exchange_strong(idle, epoch, memory_order_seq_cst))
+          return Guard(&slot);
+      }
+      this_thread::yield();
+    }
+  }
+
+  size_t EpochManager::reclaim()
+  {
+    m_sinceReclaim = 0;
+
+    // Observations retired from now on have a later epoch than any reader that pinned before
+    m_epoch.fetch_add(1, memory_order_acq_rel);
+
+    auto oldest = numeric_limits<Epoch>::max();
+    for (const auto &reader : m_readers)
+    {
+      auto epoch = reader.m_epoch.load(memory_order_acquire);
+      if (epoch != 0 && epoch < oldest)
+        oldest = epoch;
+    }
+
+    size_t released = 0;
+    while (!m_retired.empty() && m_retired.front().first < oldest)
+    {
+      m_retired.pop_front();
+      released++;
+    }
+
+    return released;
+  }
+}  // namespace mtconnect::buffer
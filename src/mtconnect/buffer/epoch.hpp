@@ -0,0 +1,110 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/observation/observation.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief Epoch based reclamation of observations evicted from the circular buffer
+  ///
+  /// A reader pins the current epoch before it takes the buffer lock and can then use raw
+  /// observation pointers after the lock is released. Evicted observations are retired with the
+  /// epoch of the eviction and are only released when every pinned reader has a later epoch.
+  ///
+  /// Since a reader pins before it takes the lock, any observation it sees is retired after the
+  /// pin and with an epoch at least as large as the pinned epoch. Replaced device models are
+  /// retired the same way so the data items of the observations outlive the readers.
+  ///
+  /// @note `retire()` and `reclaim()` must be called with the buffer lock held, `pin()` is lock
+  ///       free.
+  class AGENT_LIB_API EpochManager
+  {
+  public:
+    using Epoch = uint64_t;
+
+    /// @brief Number of readers that can be pinned at the same time
+    static constexpr size_t MaxReaders = 64;
+    /// @brief Number of retired observations between reclaims
+    static constexpr size_t ReclaimInterval = 64;
+
+    /// @brief Unpins the epoch when it goes out of scope
+    class Guard
+    {
+    public:
+      Guard(std::atomic<Epoch> *slot) : m_slot(slot) {}
+      Guard(Guard &&other) noexcept : m_slot(other.m_slot) { other.m_slot = nullptr; }
+      Guard(const Guard &) = delete;
+      Guard &operator=(const Guard &) = delete;
+      ~Guard()
+      {
+        if (m_slot)
+          m_slot->store(0, std::memory_order_release);
+      }
+
+    protected:
+      std::atomic<Epoch> *m_slot;
+    };
+
+    EpochManager() = default;
+    EpochManager(const EpochManager &) = delete;
+
+    /// @brief Pin the current epoch
+    ///
+    /// Waits for a free slot if `MaxReaders` readers are already pinned.
+    /// @return a guard that unpins the epoch when destroyed
+    Guard pin();
+
+    /// @brief Defer the release of an evicted observation until the readers have left
+    /// @param[in] obs the observation, or a replaced device
+    void retire(std::shared_ptr<const void> &&obs)
+    {
+      m_retired.emplace_back(m_epoch.load(std::memory_order_relaxed), std::move(obs));
+      if (++m_sinceReclaim >= ReclaimInterval)
+        reclaim();
+    }
+
+    /// @brief Advance the epoch and release the observations no pinned reader can see
+    /// @return the number of observations released
+    size_t reclaim();
+
+    /// @brief get the current epoch
+    Epoch getEpoch() const { return m_epoch.load(std::memory_order_relaxed); }
+    /// @brief get the number of retired observations that have not been released
+    size_t getRetiredCount() const { return m_retired.size(); }
+
+  protected:
+    // Each reader slot is on its own cache line so readers on different cores do not contend
+    struct alignas(64) Reader
+    {
+      std::atomic<Epoch> m_epoch {0};
+    };
+
+    std::atomic<Epoch> m_epoch {1};
+    std::array<Reader, MaxReaders> m_readers;
+    std::deque<std::pair<Epoch, std::shared_ptr<const void>>> m_retired;
+    size_t m_sinceReclaim {0};
+  };
+}  // namespace mtconnect::buffer
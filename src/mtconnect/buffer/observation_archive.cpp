@@ -0,0 +1,666 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "observation_archive.hpp"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "mtconnect/logging.hpp"
+#include "observation_codec.hpp"
+
+using namespace std;
+namespace bip = boost::interprocess;
+namespace fs = std::filesystem;
+
+namespace mtconnect::buffer {
+  using namespace observation;
+  using namespace entity;
+
+  ObservationArchive::ObservationArchive(const std::filesystem::path &directory,
+                                         size_t segmentSize, size_t maxSegments, bool compress)
+    : m_directory(directory),
+      m_segmentSize(std::clamp<size_t>(segmentSize, HeaderSize + 1024,
+                                       numeric_limits<uint32_t>::max())),
+      m_maxSegments(std::max<size_t>(maxSegments, 1)),
+      m_compress(compress)
+  {
+    NAMED_SCOPE("ObservationArchive");
+
+    if (isInMemory())
+    {
+      LOG(info) << "Archiving " << (m_compress ? "compressed " : "") << "observations in memory"
+                << " in " << m_maxSegments << " segments of " << m_segmentSize << " bytes";
+    }
+    else
+    {
+      fs::create_directories(m_directory);
+      for (auto &entry : fs::directory_iterator(m_directory))
+      {
+        auto name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.starts_with("observations-") &&
+            entry.path().extension() == ".seg")
+        {
+          std::error_code ec;
+          fs::remove(entry.path(), ec);
+          if (ec)
+            LOG(warning) << "Cannot remove archive segment " << entry.path() << ": "
+                         << ec.message();
+        }
+      }
+
+      LOG(info) << "Archiving " << (m_compress ? "compressed " : "") << "observations to "
+                << m_directory << " in " << m_maxSegments << " segments of " << m_segmentSize
+                << " bytes";
+    }
+
+    m_writer = std::thread([this]() { run(); });
+  }
+
+  ObservationArchive::~ObservationArchive()
+  {
+    {
+      std::lock_guard<std::mutex> queue(m_queueMutex);
+      m_stop = true;
+    }
+    m_queued.notify_one();
+    m_writer.join();
+
+    try
+    {
+      if (m_compress && !m_failed)
+        writeBlock();
+      if (m_write)
+        sealSegment();
+    }
+    catch (std::exception &e)
+    {
+      LOG(warning) << "Cannot seal archive segment: " << e.what();
+    }
+  }
+
+  void ObservationArchive::startSegment(SequenceNumber_t first)
+  {
+    Segment segment;
+    segment.m_first = first;
+
+    if (isInMemory())
+    {
+      // The pages are not touched until they are written
+      segment.m_memory.reset(new char[m_segmentSize]);
+      m_write = segment.m_memory.get();
+    }
+    else
+    {
+      std::ostringstream name;
+      name << "observations-" << setw(20) << setfill('0') << first << ".seg";
+      segment.m_path = m_directory / name.str();
+
+      {
+        std::ofstream file(segment.m_path, ios::binary | ios::trunc);
+      }
+      fs::resize_file(segment.m_path, m_segmentSize);
+
+      bip::file_mapping file(segment.m_path.string().c_str(), bip::read_write);
+      segment.m_region = make_shared<bip::mapped_region>(file, bip::read_write);
+      m_write = static_cast<char *>(segment.m_region->get_address());
+    }
+
+    memcpy(m_write, &Magic, sizeof(Magic));
+    memcpy(m_write + 4, &Version, sizeof(Version));
+    memcpy(m_write + 8, &first, sizeof(first));
+
+    m_segments.emplace_back(std::move(segment));
+
+    // Drop the oldest segments
+    while (m_segments.size() > m_maxSegments)
+    {
+      auto &oldest = m_segments.front();
+      if (auto it = std::find(m_mapped.begin(), m_mapped.end(), &oldest); it != m_mapped.end())
+        m_mapped.erase(it);
+      oldest.m_region.reset();
+
+      if (!oldest.m_path.empty())
+      {
+        std::error_code ec;
+        fs::remove(oldest.m_path, ec);
+        if (ec)
+          LOG(warning) << "Cannot remove archive segment " << oldest.m_path << ": "
+                       << ec.message();
+      }
+      m_segments.pop_front();
+    }
+  }
+
+  void ObservationArchive::sealSegment()
+  {
+    auto &segment = m_segments.back();
+    segment.m_region.reset();
+    segment.m_dictionary.m_ordinals.clear();
+    m_write = nullptr;
+
+    // Trim the unused space at the end of the segment
+    if (segment.m_memory)
+    {
+      std::unique_ptr<char[]> memory(new char[segment.m_size]);
+      memcpy(memory.get(), segment.m_memory.get(), segment.m_size);
+      segment.m_memory = std::move(memory);
+    }
+    else
+    {
+      fs::resize_file(segment.m_path, segment.m_size);
+    }
+  }
+
+  const char *ObservationArchive::map(const Segment &segment) const
+  {
+    if (m_write && &segment == &m_segments.back())
+      return m_write;
+    if (segment.m_memory)
+      return segment.m_memory.get();
+
+    if (!segment.m_region)
+    {
+      bip::file_mapping file(segment.m_path.string().c_str(), bip::read_only);
+      segment.m_region = make_shared<bip::mapped_region>(file, bip::read_only);
+
+      m_mapped.push_back(&segment);
+      if (m_mapped.size() > MappedSegments)
+      {
+        m_mapped.front()->m_region.reset();
+        m_mapped.pop_front();
+      }
+    }
+
+    return static_cast<const char *>(segment.m_region->get_address());
+  }
+
+
+  ObservationPtr ObservationArchive::decode(const char *record, SequenceNumber_t seq) const
+  {
+    auto obs = ObservationCodec::decode(record, m_dataItems);
+    if (obs)
+      obs->setSequence(seq);
+    return obs;
+  }
+
+  void ObservationArchive::append(const ObservationPtr &obs)
+  {
+    if (m_failed)
+      return;
+
+    SequenceNumber_t none = 0;
+    m_firstSequence.compare_exchange_strong(none, obs->getSequence(), std::memory_order_acq_rel);
+
+    bool wake;
+    {
+      std::lock_guard<std::mutex> queue(m_queueMutex);
+      wake = m_queue.empty();
+      m_queue.push_back({obs, obs->getDataItem()});
+    }
+    if (wake)
+      m_queued.notify_one();
+  }
+
+  void ObservationArchive::flush() const
+  {
+    std::unique_lock<std::mutex> queue(m_queueMutex);
+    m_written.wait(queue, [this]() { return m_queue.empty() && !m_writing; });
+  }
+
+  void ObservationArchive::run()
+  {
+    std::deque<Queued> batch;
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> queue(m_queueMutex);
+        m_queued.wait(queue, [this]() { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty())
+          return;
+      }
+
+      // Take the batch while holding the archive mutex so readers find each observation either
+      // in the queue or in the segments
+      std::lock_guard<std::mutex> lock(m_mutex);
+      {
+        std::lock_guard<std::mutex> queue(m_queueMutex);
+        batch.swap(m_queue);
+        m_writing = true;
+      }
+
+      for (const auto &queued : batch)
+        write(queued);
+      batch.clear();
+
+      if (!m_segments.empty())
+        m_firstSequence.store(m_segments.front().m_first, std::memory_order_release);
+
+      {
+        std::lock_guard<std::mutex> queue(m_queueMutex);
+        m_writing = false;
+      }
+      m_written.notify_all();
+    }
+  }
+
+  void ObservationArchive::write(const Queued &queued)
+  {
+    NAMED_SCOPE("ObservationArchive::write");
+
+    if (m_failed)
+      return;
+
+    const auto &obs = queued.m_observation;
+    try
+    {
+      if (auto &dataItem = queued.m_dataItem)
+      {
+        auto &weak = m_dataItems[dataItem->getId()];
+        if (weak.expired())
+          weak = dataItem;
+      }
+
+      if (m_compress)
+      {
+        appendCompressed(obs);
+        return;
+      }
+
+      auto seq = obs->getSequence();
+      if (!m_write || seq != getNextSequence())
+      {
+        if (m_write)
+          sealSegment();
+        startSegment(seq);
+      }
+
+      m_record.clear();
+      ObservationCodec::encode(m_record, obs);
+      if (m_record.size() > m_segmentSize - HeaderSize)
+      {
+        LOG(warning) << "Observation " << seq << " is too large to archive";
+        m_record.clear();
+        ObservationCodec::encode(m_record, obs, true);
+      }
+
+      if (m_segments.back().m_size + m_record.size() > m_segmentSize)
+      {
+        sealSegment();
+        startSegment(seq);
+      }
+
+      auto &segment = m_segments.back();
+      if (segment.m_count % IndexStride == 0)
+        segment.m_index.push_back(uint32_t(segment.m_size));
+      memcpy(m_write + segment.m_size, m_record.data(), m_record.size());
+      segment.m_size += m_record.size();
+      segment.m_count++;
+    }
+    catch (std::exception &e)
+    {
+      LOG(error) << "Cannot write to observation archive in " << m_directory << ": " << e.what();
+      LOG(error) << "Observation archiving is disabled";
+      m_failed = true;
+    }
+  }
+
+  void ObservationArchive::appendCompressed(const ObservationPtr &obs)
+  {
+    auto seq = obs->getSequence();
+    if (!m_pending.empty() && seq != m_pendingFirst + m_pending.size())
+      writeBlock();
+
+    if (m_pending.empty())
+      m_pendingFirst = seq;
+    m_pending.push_back(obs);
+    if (m_pending.size() == IndexStride)
+      writeBlock();
+  }
+
+  void ObservationArchive::writeBlock()
+  {
+    if (m_pending.empty())
+      return;
+
+    // Only the last block of a segment can be partial
+    if (!m_write || m_pendingFirst != getSegmentsNext())
+    {
+      if (m_write)
+        sealSegment();
+      startSegment(m_pendingFirst);
+    }
+
+    // Encode the block, discarding the ids added to the dictionary by a previous attempt
+    size_t known = m_segments.back().m_dictionary.m_ids.size();
+    auto encode = [this, &known](const vector<bool> *placeholders) {
+      auto &dictionary = m_segments.back().m_dictionary;
+      while (dictionary.m_ids.size() > known)
+      {
+        dictionary.m_ordinals.erase(dictionary.m_ids.back());
+        dictionary.m_ids.pop_back();
+      }
+      m_record.clear();
+      BlockCodec::encode(m_record, m_pending, dictionary, placeholders);
+    };
+
+    encode(nullptr);
+    if (m_segments.back().m_count > 0 && m_segments.back().m_size + m_record.size() > m_segmentSize)
+    {
+      sealSegment();
+      startSegment(m_pendingFirst);
+      known = 0;
+      encode(nullptr);
+    }
+
+    // Store the largest observations as placeholders until the block fits in a segment
+    if (m_record.size() > m_segmentSize - HeaderSize)
+    {
+      vector<pair<size_t, size_t>> sizes;
+      for (size_t i = 0; i < m_pending.size(); i++)
+      {
+        m_record.clear();
+        ObservationCodec::encode(m_record, m_pending[i]);
+        sizes.emplace_back(m_record.size(), i);
+      }
+      sort(sizes.rbegin(), sizes.rend());
+
+      vector<bool> placeholders(m_pending.size(), false);
+      for (auto &[size, i] : sizes)
+      {
+        LOG(warning) << "Observation " << m_pendingFirst + i << " is too large to archive";
+        placeholders[i] = true;
+        encode(&placeholders);
+        if (m_record.size() <= m_segmentSize - HeaderSize)
+          break;
+      }
+      if (m_record.size() > m_segmentSize - HeaderSize)
+        throw std::length_error("Block does not fit in a segment");
+    }
+
+    auto &segment = m_segments.back();
+    segment.m_index.push_back(uint32_t(segment.m_size));
+    memcpy(m_write + segment.m_size, m_record.data(), m_record.size());
+    segment.m_size += m_record.size();
+    segment.m_count += m_pending.size();
+    m_pending.clear();
+  }
+
+  void ObservationArchive::decodeBlock(const Segment &segment, size_t block,
+                                       const FilterSetOpt &filterSet,
+                                       std::vector<ObservationPtr> &out) const
+  {
+    auto base = map(segment);
+    BlockCodec::decode(base + segment.m_index[block], segment.m_dictionary.m_ids, m_dataItems,
+                       filterSet, out);
+
+    auto first = segment.m_first + block * IndexStride;
+    for (size_t i = 0; i < out.size(); i++)
+    {
+      if (out[i])
+        out[i]->setSequence(first + i);
+    }
+  }
+
+  bool ObservationArchive::visit(SequenceNumber_t seq, const ObservationPtr &obs,
+                                 const FilterSetOpt &filterSet, const Visitor &visitor) const
+  {
+    auto dataItem = obs->getDataItemPointer();
+    if (!dataItem)
+      return true;
+    if (filterSet && filterSet->count(dataItem->getId()) == 0)
+      return true;
+    return visitor(seq, obs);
+  }
+
+  template <typename F>
+  ObservationArchive::SequenceNumber_t ObservationArchive::scan(const Segment &segment,
+                                                                SequenceNumber_t from,
+                                                                SequenceNumber_t to,
+                                                                const FilterSetOpt &filterSet,
+                                                                F &&f) const
+  {
+    auto base = map(segment);
+    auto ordinal = from - segment.m_first;
+    auto block = ordinal / IndexStride;
+
+    // Skip forward from the nearest index entry
+    const char *pos = base + segment.m_index[block];
+    for (auto i = block * IndexStride; i < ordinal; i++)
+      pos += ObservationCodec::recordLength(pos);
+
+    for (auto seq = from; seq < to; seq++)
+    {
+      auto length = ObservationCodec::recordLength(pos);
+      auto id = ObservationCodec::dataItemId(pos);
+      if (!id.empty() && (!filterSet || filterSet->count(string(id)) > 0))
+      {
+        if (!f(seq, pos))
+          return seq;
+      }
+      pos += length;
+    }
+
+    return to;
+  }
+
+  ObservationArchive::SequenceNumber_t ObservationArchive::read(SequenceNumber_t from,
+                                                                SequenceNumber_t to,
+                                                                const FilterSetOpt &filterSet,
+                                                                const Visitor &visitor) const
+  {
+    NAMED_SCOPE("ObservationArchive::read");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    try
+    {
+      auto seq = from;
+      for (const auto &segment : m_segments)
+      {
+        auto end = segment.m_first + segment.m_count;
+        if (end <= seq)
+          continue;
+        if (segment.m_first >= to)
+          break;
+
+        seq = std::max(seq, segment.m_first);
+        auto last = std::min(to, end);
+        if (m_compress)
+        {
+          for (auto block = (seq - segment.m_first) / IndexStride; seq < last; block++)
+          {
+            decodeBlock(segment, block, filterSet, m_block);
+            auto blockFirst = segment.m_first + block * IndexStride;
+            for (auto blockEnd = std::min(last, blockFirst + m_block.size()); seq < blockEnd; seq++)
+            {
+              const auto &obs = m_block[seq - blockFirst];
+              if (obs && !visitor(seq, obs))
+                return seq + 1;
+            }
+          }
+          continue;
+        }
+
+        auto stop = scan(segment, seq, last, filterSet, [&](SequenceNumber_t s, const char *rec) {
+          auto obs = decode(rec, s);
+          return !obs || visitor(s, obs);
+        });
+        if (stop < last)
+          return stop + 1;
+        seq = last;
+      }
+
+      // The partial block is still in memory
+      if (!m_pending.empty())
+      {
+        auto end = std::min(to, m_pendingFirst + m_pending.size());
+        for (seq = std::max(seq, m_pendingFirst); seq < end; seq++)
+        {
+          if (!visit(seq, m_pending[seq - m_pendingFirst], filterSet, visitor))
+            return seq + 1;
+        }
+      }
+
+      // The queued observations are not written yet
+      std::lock_guard<std::mutex> queue(m_queueMutex);
+      for (const auto &queued : m_queue)
+      {
+        auto s = queued.m_observation->getSequence();
+        if (s < seq)
+          continue;
+        if (s >= to)
+          break;
+        if (!visit(s, queued.m_observation, filterSet, visitor))
+          return s + 1;
+      }
+    }
+    catch (std::exception &e)
+    {
+      LOG(error) << "Cannot read from observation archive: " << e.what();
+    }
+
+    return to;
+  }
+
+  ObservationArchive::SequenceNumber_t ObservationArchive::readReverse(
+      SequenceNumber_t from, SequenceNumber_t to, const FilterSetOpt &filterSet,
+      const Visitor &visitor) const
+  {
+    NAMED_SCOPE("ObservationArchive::readReverse");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    try
+    {
+      auto seq = from;
+      vector<pair<SequenceNumber_t, const char *>> records;
+      records.reserve(IndexStride);
+
+      // The queued observations are the newest
+      {
+        std::lock_guard<std::mutex> queue(m_queueMutex);
+        if (!m_queue.empty())
+        {
+          for (auto it = m_queue.rbegin(); it != m_queue.rend(); it++)
+          {
+            auto s = it->m_observation->getSequence();
+            if (s > seq)
+              continue;
+            if (s < to)
+              return to - 1;
+            if (!visit(s, it->m_observation, filterSet, visitor))
+              return s - 1;
+          }
+
+          auto front = m_queue.front().m_observation->getSequence();
+          if (front <= to)
+            return to - 1;
+          seq = std::min(seq, front - 1);
+        }
+      }
+
+      // The partial block is newer than the segments
+      if (!m_pending.empty() && seq >= m_pendingFirst)
+      {
+        auto low = std::max(to, m_pendingFirst);
+        for (seq = std::min(seq, m_pendingFirst + m_pending.size() - 1); seq >= low; seq--)
+        {
+          if (!visit(seq, m_pending[seq - m_pendingFirst], filterSet, visitor))
+            return seq - 1;
+        }
+        if (low == to)
+          return to - 1;
+      }
+
+      for (auto it = m_segments.rbegin(); it != m_segments.rend(); it++)
+      {
+        const auto &segment = *it;
+        if (segment.m_count == 0 || segment.m_first > seq)
+          continue;
+        auto end = segment.m_first + segment.m_count;
+        if (end <= to)
+          break;
+
+        seq = std::min(seq, end - 1);
+        auto low = std::max(to, segment.m_first);
+
+        // Collect one index block at a time and visit it backwards
+        while (true)
+        {
+          auto blockFirst =
+              segment.m_first + ((seq - segment.m_first) / IndexStride) * IndexStride;
+          auto start = std::max(blockFirst, low);
+
+          if (m_compress)
+          {
+            decodeBlock(segment, (blockFirst - segment.m_first) / IndexStride, filterSet, m_block);
+            for (auto s = seq + 1; s-- > start;)
+            {
+              const auto &obs = m_block[s - blockFirst];
+              if (obs && !visitor(s, obs))
+                return s - 1;
+            }
+          }
+          else
+          {
+            records.clear();
+            scan(segment, start, seq + 1, filterSet, [&](SequenceNumber_t s, const char *rec) {
+              records.emplace_back(s, rec);
+              return true;
+            });
+            for (auto r = records.rbegin(); r != records.rend(); r++)
+            {
+              auto obs = decode(r->second, r->first);
+              if (obs && !visitor(r->first, obs))
+                return r->first - 1;
+            }
+          }
+
+          if (start == low)
+            break;
+          seq = start - 1;
+        }
+
+        if (low == to)
+          break;
+        seq = segment.m_first - 1;
+      }
+    }
+    catch (std::exception &e)
+    {
+      LOG(error) << "Cannot read from observation archive: " << e.what();
+    }
+
+    return to - 1;
+  }
+
+  void ObservationArchive::updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &[id, weak] : m_dataItems)
+    {
+      if (auto it = diMap.find(id); it != diMap.end())
+        weak = it->second;
+    }
+  }
+}  // namespace mtconnect::buffer
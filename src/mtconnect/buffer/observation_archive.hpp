@@ -0,0 +1,253 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "block_codec.hpp"
+#include "mtconnect/config.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace boost::interprocess {
+  class mapped_region;
+}
+
+namespace mtconnect::buffer {
+  /// @brief On-disk or in-memory tier for observations evicted from the circular buffer
+  ///
+  /// Observations are appended to memory-mapped segment files in a compact binary encoding.
+  /// Without a directory the segments are kept in memory instead, which with compression gives
+  /// compressed closed segments behind the uncompressed circular buffer.
+  /// Each segment holds consecutive sequence numbers. A new segment is started when the current
+  /// one is full or the sequence is not contiguous. The oldest segment is deleted when there are
+  /// more than the maximum number of segments.
+  ///
+  /// Each segment has a sparse index with the offset of every `IndexStride` record, reads find
+  /// the nearest index entry and skip forward over the record lengths. Records are only decoded
+  /// into observations if the data item passes the filter.
+  ///
+  /// Segment layout:
+  /// ```
+  /// segment  := magic:u32 version:u32 first:u64 { record }*
+  /// ```
+  /// Records are encoded by the `ObservationCodec`. A record with an empty id is a placeholder
+  /// for an observation whose data item was removed.
+  ///
+  /// When compression is enabled, observations are collected into blocks of `IndexStride`
+  /// and written as `BlockCodec` blocks. The partial block at the end of the archive is kept in
+  /// memory until it is full.
+  ///
+  /// Segment files from a previous run are removed when the archive is created. If a segment
+  /// cannot be written, an error is logged and archiving stops.
+  ///
+  /// Appended observations are queued and written by a background thread, so the circular
+  /// buffer never waits for a segment to be created, mapped or removed. Queued observations are
+  /// read from the queue until they are written. Reads and writes are serialized by the archive
+  /// mutex, the first sequence can be read without it.
+  class AGENT_LIB_API ObservationArchive
+  {
+  public:
+    using SequenceNumber_t = uint64_t;
+    /// @brief Called for each observation read, return `false` to stop
+    using Visitor = std::function<bool(SequenceNumber_t, const observation::ObservationPtr &)>;
+
+    /// @brief Identifies a segment file: `MTCA`
+    static constexpr uint32_t Magic = 0x4143544D;
+    static constexpr uint32_t Version = 1;
+    static constexpr size_t HeaderSize = 16;
+    /// @brief Records between index entries
+    static constexpr size_t IndexStride = 64;
+    /// @brief Number of sealed segments kept mapped for reading
+    static constexpr size_t MappedSegments = 4;
+
+    /// @brief Create an archive
+    /// @param directory the directory for the segment files, created if it does not exist, or
+    ///                  empty to keep the segments in memory
+    /// @param segmentSize the size of each segment in bytes
+    /// @param maxSegments the number of segments to retain
+    /// @param compress `true` to write compressed blocks
+    ObservationArchive(const std::filesystem::path &directory, size_t segmentSize,
+                       size_t maxSegments, bool compress = false);
+    ~ObservationArchive();
+
+    /// @brief Append an observation
+    ///
+    /// The observation must have a sequence number greater than all archived observations. It
+    /// is queued for the writer thread.
+    /// @param[in] obs the observation
+    void append(const observation::ObservationPtr &obs);
+
+    /// @brief Wait until all the queued observations are written
+    void flush() const;
+
+    /// @brief Read observations in sequence order
+    /// @param[in] from the first sequence to read
+    /// @param[in] to one past the last sequence to read
+    /// @param[in] filterSet optional set of data item ids
+    /// @param[in] visitor called for each observation
+    /// @return the sequence after the last one visited, or `to` if all were visited
+    SequenceNumber_t read(SequenceNumber_t from, SequenceNumber_t to,
+                          const FilterSetOpt &filterSet, const Visitor &visitor) const;
+
+    /// @brief Read observations in reverse sequence order
+    /// @param[in] from the first sequence to read
+    /// @param[in] to the last sequence to read, `to <= from`
+    /// @param[in] filterSet optional set of data item ids
+    /// @param[in] visitor called for each observation
+    /// @return the sequence before the last one visited, or `to - 1` if all were visited
+    SequenceNumber_t readReverse(SequenceNumber_t from, SequenceNumber_t to,
+                                 const FilterSetOpt &filterSet, const Visitor &visitor) const;
+
+    /// @brief update the data item references when device model changes
+    /// @param diMap the map of data item ids to new data item entities
+    void updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap);
+
+    /// @brief get the first archived sequence
+    ///
+    /// Does not take the archive mutex.
+    /// @return the first sequence or `0` if the archive is empty
+    SequenceNumber_t getFirstSequence() const
+    {
+      return m_firstSequence.load(std::memory_order_acquire);
+    }
+    /// @brief get the sequence after the last archived or queued observation
+    /// @return the next sequence or `0` if the archive is empty
+    SequenceNumber_t getNextSequence() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      {
+        std::lock_guard<std::mutex> queue(m_queueMutex);
+        if (!m_queue.empty())
+          return m_queue.back().m_observation->getSequence() + 1;
+      }
+      if (!m_pending.empty())
+        return m_pendingFirst + m_pending.size();
+      return getSegmentsNext();
+    }
+    /// @brief get the number of segments after the queued observations are written
+    size_t getSegmentCount() const
+    {
+      flush();
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_segments.size();
+    }
+    /// @brief get the number of bytes used by the segments after the queued observations are
+    /// written
+    size_t getSize() const
+    {
+      flush();
+      std::lock_guard<std::mutex> lock(m_mutex);
+      size_t size = 0;
+      for (const auto &segment : m_segments)
+        size += segment.m_size;
+      return size;
+    }
+    /// @brief `true` if the archive writes compressed blocks
+    bool isCompressed() const { return m_compress; }
+    /// @brief get the directory of the segment files
+    const auto &getDirectory() const { return m_directory; }
+    /// @brief `true` if the segments are kept in memory
+    bool isInMemory() const { return m_directory.empty(); }
+
+  protected:
+    /// @brief An observation waiting for the writer thread
+    struct Queued
+    {
+      observation::ObservationPtr m_observation;
+      /// @brief the data item when the observation was appended, used to decode it
+      DataItemPtr m_dataItem;
+    };
+
+    struct Segment
+    {
+      std::filesystem::path m_path;
+      SequenceNumber_t m_first {0};
+      SequenceNumber_t m_count {0};
+      size_t m_size {HeaderSize};
+      std::vector<uint32_t> m_index;
+      BlockCodec::Dictionary m_dictionary;
+      mutable std::shared_ptr<boost::interprocess::mapped_region> m_region;
+      std::unique_ptr<char[]> m_memory;
+    };
+
+    void run();
+    void write(const Queued &queued);
+    void startSegment(SequenceNumber_t first);
+    void sealSegment();
+    const char *map(const Segment &segment) const;
+    observation::ObservationPtr decode(const char *record, SequenceNumber_t seq) const;
+    template <typename F>
+    SequenceNumber_t scan(const Segment &segment, SequenceNumber_t from, SequenceNumber_t to,
+                          const FilterSetOpt &filterSet, F &&f) const;
+
+    SequenceNumber_t getSegmentsNext() const
+    {
+      return m_segments.empty() ? 0 : m_segments.back().m_first + m_segments.back().m_count;
+    }
+    void appendCompressed(const observation::ObservationPtr &obs);
+    void writeBlock();
+    void decodeBlock(const Segment &segment, size_t block, const FilterSetOpt &filterSet,
+                     std::vector<observation::ObservationPtr> &out) const;
+    bool visit(SequenceNumber_t seq, const observation::ObservationPtr &obs,
+               const FilterSetOpt &filterSet, const Visitor &visitor) const;
+
+  protected:
+    std::filesystem::path m_directory;
+    size_t m_segmentSize;
+    size_t m_maxSegments;
+    std::deque<Segment> m_segments;
+    char *m_write {nullptr};
+    std::atomic_bool m_failed {false};
+    bool m_compress;
+    std::string m_record;
+
+    // The partial block when compressing
+    std::vector<observation::ObservationPtr> m_pending;
+    SequenceNumber_t m_pendingFirst {0};
+    mutable std::vector<observation::ObservationPtr> m_block;
+
+    std::unordered_map<std::string, WeakDataItemPtr> m_dataItems;
+    mutable std::deque<const Segment *> m_mapped;
+
+    // Guards the segments, the partial block and the mapped regions. Taken before the queue
+    // mutex.
+    mutable std::mutex m_mutex;
+    std::atomic<SequenceNumber_t> m_firstSequence {0};
+
+    // Observations waiting for the writer thread
+    mutable std::mutex m_queueMutex;
+    std::condition_variable m_queued;
+    mutable std::condition_variable m_written;
+    std::deque<Queued> m_queue;
+    bool m_writing {false};
+    bool m_stop {false};
+    std::thread m_writer;
+  };
+}  // namespace mtconnect::buffer
@@ -0,0 +1,382 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "observation_codec.hpp"
+
+#include <cstring>
+
+#include "mtconnect/device_model/data_item/data_item.hpp"
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+
+namespace mtconnect::buffer {
+  using namespace observation;
+  using namespace entity;
+
+  namespace {
+    template <typename T>
+    inline void Put(string &out, T value)
+    {
+      out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    inline void Patch(string &out, size_t pos, T value)
+    {
+      memcpy(out.data() + pos, &value, sizeof(T));
+    }
+
+    template <typename T>
+    inline T Load(const char *pos)
+    {
+      T value;
+      memcpy(&value, pos, sizeof(T));
+      return value;
+    }
+
+    inline void PutKey(string &out, string_view key)
+    {
+      Put<uint16_t>(out, uint16_t(key.size()));
+      out.append(key);
+    }
+
+    inline void PutString(string &out, string_view s)
+    {
+      Put<uint32_t>(out, uint32_t(s.size()));
+      out.append(s);
+    }
+
+    /// @brief Sequential reader over an encoded record
+    struct Reader
+    {
+      template <typename T>
+      T get()
+      {
+        auto value = Load<T>(m_pos);
+        m_pos += sizeof(T);
+        return value;
+      }
+
+      string key()
+      {
+        auto len = get<uint16_t>();
+        string s(m_pos, len);
+        m_pos += len;
+        return s;
+      }
+
+      string str()
+      {
+        auto len = get<uint32_t>();
+        string s(m_pos, len);
+        m_pos += len;
+        return s;
+      }
+
+      const char *m_pos;
+    };
+
+    /// @brief Encode a data set or table cell value tagged with its `DataSetValueType`
+    template <typename T>
+    void PutCell(string &out, const T &value)
+    {
+      visit(overloaded {[&](const monostate &) { Put<uint8_t>(out, 0x0); },
+                        [&](const string &v) {
+                          Put<uint8_t>(out, 0x2);
+                          PutString(out, v);
+                        },
+                        [&](const int64_t &v) {
+                          Put<uint8_t>(out, 0x3);
+                          Put<int64_t>(out, v);
+                        },
+                        [&](const double &v) {
+                          Put<uint8_t>(out, 0x4);
+                          Put<double>(out, v);
+                        },
+                        [&](const TableRow &row) {
+                          Put<uint8_t>(out, 0x1);
+                          Put<uint32_t>(out, uint32_t(row.size()));
+                          for (auto &cell : row)
+                          {
+                            PutKey(out, cell.m_key);
+                            Put<uint8_t>(out, cell.m_removed);
+                            PutCell(out, cell.m_value);
+                          }
+                        }},
+            value);
+    }
+
+    TableCellValue GetTableCell(Reader &reader)
+    {
+      switch (TabelCellType(reader.get<uint8_t>()))
+      {
+        case TabelCellType::STRING:
+          return reader.str();
+
+        case TabelCellType::INTEGER:
+          return reader.get<int64_t>();
+
+        case TabelCellType::DOUBLE:
+          return reader.get<double>();
+
+        default:
+          return monostate();
+      }
+    }
+
+    DataSetValue GetDataSetValue(Reader &reader)
+    {
+      switch (DataSetValueType(reader.get<uint8_t>()))
+      {
+        case DataSetValueType::TABLE_ROW:
+        {
+          TableRow row;
+          for (auto count = reader.get<uint32_t>(); count > 0; count--)
+          {
+            auto key = reader.key();
+            bool removed = reader.get<uint8_t>() != 0;
+            row.emplace(key, GetTableCell(reader), removed);
+          }
+          return row;
+        }
+
+        case DataSetValueType::STRING:
+          return reader.str();
+
+        case DataSetValueType::INTEGER:
+          return reader.get<int64_t>();
+
+        case DataSetValueType::DOUBLE:
+          return reader.get<double>();
+
+        default:
+          return monostate();
+      }
+    }
+
+    /// @brief Encode a property value
+    /// @return `false` if the value cannot be archived
+    bool PutValue(string &out, const Value &value)
+    {
+      return visit(overloaded {[&](const monostate &) {
+                                 Put<uint8_t>(out, uint8_t(ValueType::EMPTY));
+                                 return true;
+                               },
+                               [&](const string &v) {
+                                 Put<uint8_t>(out, uint8_t(ValueType::STRING));
+                                 PutString(out, v);
+                                 return true;
+                               },
+                               [&](const int64_t &v) {
+                                 Put<uint8_t>(out, uint8_t(ValueType::INTEGER));
+                                 Put<int64_t>(out, v);
+                                 return true;
+                               },
+                               [&](const double &v) {
+                                 Put<uint8_t>(out, uint8_t(ValueType::DOUBLE));
+                                 Put<double>(out, v);
+                                 return true;
+                               },
+                               [&](const bool &v) {
+                                 Put<uint8_t>(out, uint8_t(ValueType::BOOL));
+                                 Put<uint8_t>(out, v);
+                                 return true;
+                               },
+                               [&](const Vector &v) {
+                                 Put<uint8_t>(out, uint8_t(ValueType::VECTOR));
+                                 Put<uint32_t>(out, uint32_t(v.size()));
+                                 out.append(reinterpret_cast<const char *>(v.data()),
+                                            v.size() * sizeof(double));
+                                 return true;
+                               },
+                               [&](const DataSet &v) {
+                                 Put<uint8_t>(out, uint8_t(ValueType::DATA_SET));
+                                 Put<uint32_t>(out, uint32_t(v.size()));
+                                 for (auto &entry : v)
+                                 {
+                                   PutKey(out, entry.m_key);
+                                   Put<uint8_t>(out, entry.m_removed);
+                                   PutCell(out, entry.m_value);
+                                 }
+                                 return true;
+                               },
+                               [&](const Timestamp &v) {
+                                 Put<uint8_t>(out, uint8_t(ValueType::TIMESTAMP));
+                                 Put<int64_t>(
+                                     out, chrono::duration_cast<chrono::microseconds>(
+                                              v.time_since_epoch())
+                                              .count());
+                                 return true;
+                               },
+                               [&](const nullptr_t &) {
+                                 Put<uint8_t>(out, uint8_t(ValueType::NULL_VALUE));
+                                 return true;
+                               },
+                               [](const auto &) { return false; }},
+                   value);
+    }
+
+    Value GetValue(Reader &reader)
+    {
+      switch (ValueType(reader.get<uint8_t>()))
+      {
+        case ValueType::STRING:
+          return reader.str();
+
+        case ValueType::INTEGER:
+          return reader.get<int64_t>();
+
+        case ValueType::DOUBLE:
+          return reader.get<double>();
+
+        case ValueType::BOOL:
+          return reader.get<uint8_t>() != 0;
+
+        case ValueType::VECTOR:
+        {
+          Vector v(reader.get<uint32_t>());
+          memcpy(v.data(), reader.m_pos, v.size() * sizeof(double));
+          reader.m_pos += v.size() * sizeof(double);
+          return v;
+        }
+
+        case ValueType::DATA_SET:
+        {
+          DataSet set;
+          for (auto count = reader.get<uint32_t>(); count > 0; count--)
+          {
+            auto key = reader.key();
+            bool removed = reader.get<uint8_t>() != 0;
+            set.emplace(key, GetDataSetValue(reader), removed);
+          }
+          return set;
+        }
+
+        case ValueType::TIMESTAMP:
+          return Timestamp(chrono::microseconds(reader.get<int64_t>()));
+
+        case ValueType::NULL_VALUE:
+          return nullptr;
+
+        default:
+          return monostate();
+      }
+    }
+  }  // namespace
+
+  void ObservationCodec::encode(std::string &out, const ObservationPtr &obs, bool placeholder)
+  {
+    auto start = out.size();
+    Put<uint32_t>(out, 0);
+    Put<int64_t>(out, chrono::duration_cast<chrono::microseconds>(
+                               obs->getTimestamp().time_since_epoch())
+                               .count());
+
+    auto dataItem = placeholder ? nullptr : obs->getDataItem();
+    if (!dataItem)
+    {
+      PutKey(out, "");
+      Put<uint8_t>(out, NotCondition);
+      Put<uint16_t>(out, 0);
+    }
+    else
+    {
+      PutKey(out, dataItem->getId());
+      if (auto cond = dynamic_pointer_cast<Condition>(obs))
+        Put<uint8_t>(out, uint8_t(cond->getLevel()));
+      else
+        Put<uint8_t>(out, NotCondition);
+
+      auto countPos = out.size();
+      Put<uint16_t>(out, 0);
+
+      // Properties copied from the data item are restored when decoded
+      const auto &diProps = dataItem->getObservationProperties();
+      uint16_t count = 0;
+      for (const auto &[key, value] : obs->getProperties())
+      {
+        if (key == "timestamp" || key == "sequence")
+          continue;
+        if (auto p = diProps.find(key); p != diProps.end() && p->second == value)
+          continue;
+
+        auto mark = out.size();
+        PutKey(out, key);
+        if (PutValue(out, value))
+          count++;
+        else
+          out.resize(mark);
+      }
+      Patch<uint16_t>(out, countPos, count);
+    }
+
+    Patch<uint32_t>(out, start, uint32_t(out.size() - start));
+  }
+
+  ObservationPtr ObservationCodec::decode(const char *record, const DataItemMap &dataItems)
+  {
+    Reader reader {record + sizeof(uint32_t)};
+    Timestamp timestamp {chrono::microseconds(reader.get<int64_t>())};
+    auto id = reader.key();
+    auto level = reader.get<uint8_t>();
+
+    auto it = dataItems.find(id);
+    if (it == dataItems.end())
+      return nullptr;
+    auto dataItem = it->second.lock();
+    if (!dataItem)
+      return nullptr;
+
+    Properties props;
+    for (auto count = reader.get<uint16_t>(); count > 0; count--)
+    {
+      auto key = reader.key();
+      props.insert_or_assign(key, GetValue(reader));
+    }
+
+    switch (level)
+    {
+      case Condition::NORMAL:
+        props.insert_or_assign("level", "normal"s);
+        break;
+
+      case Condition::WARNING:
+        props.insert_or_assign("level", "warning"s);
+        break;
+
+      case Condition::FAULT:
+        props.insert_or_assign("level", "fault"s);
+        break;
+
+      default:
+        break;
+    }
+
+    try
+    {
+      ErrorList errors;
+      return Observation::make(dataItem, props, timestamp, errors);
+    }
+    catch (entity::EntityError &e)
+    {
+      LOG(warning) << "Cannot decode observation for " << id << ": " << e.what();
+    }
+
+    return nullptr;
+  }
+}  // namespace mtconnect::buffer
@@ -0,0 +1,83 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief Compact binary encoding of observations
+  ///
+  /// Used to write observations to disk. Properties copied from the data item are not stored,
+  /// they are restored from the data item when the observation is decoded.
+  /// ```
+  /// record   := length:u32 timestamp:i64 idLength:u16 id level:u8 count:u16 { property }*
+  /// property := keyLength:u16 key type:u8 value
+  /// ```
+  /// The level is the condition level or `0xFF` if the observation is not a condition. Values
+  /// are encoded by type, see `entity::ValueType`. Integers are in native byte order.
+  class AGENT_LIB_API ObservationCodec
+  {
+  public:
+    using DataItemMap = std::unordered_map<std::string, WeakDataItemPtr>;
+
+    /// @brief The level of an observation that is not a condition
+    static constexpr uint8_t NotCondition = 0xFF;
+
+    /// @brief Append an encoded observation
+    /// @param[out] out the buffer to append to
+    /// @param[in] obs the observation
+    /// @param[in] placeholder `true` to only encode the timestamp with an empty id
+    static void encode(std::string &out, const observation::ObservationPtr &obs,
+                       bool placeholder = false);
+
+    /// @brief Decode an observation
+    /// @param[in] record pointer to the start of the record
+    /// @param[in] dataItems map of data item ids to data items
+    /// @return the observation or `nullptr` if the data item does not exist
+    static observation::ObservationPtr decode(const char *record, const DataItemMap &dataItems);
+
+    /// @brief get the length of an encoded record
+    /// @param[in] record pointer to the start of the record
+    /// @return the length including the length field
+    static uint32_t recordLength(const char *record)
+    {
+      uint32_t length;
+      std::memcpy(&length, record, sizeof(length));
+      return length;
+    }
+
+    /// @brief get the data item id of an encoded record without decoding it
+    /// @param[in] record pointer to the start of the record
+    /// @return the data item id, empty for a placeholder
+    static std::string_view dataItemId(const char *record)
+    {
+      constexpr size_t offset = sizeof(uint32_t) + sizeof(int64_t);
+      uint16_t length;
+      std::memcpy(&length, record + offset, sizeof(length));
+      return std::string_view(record + offset + sizeof(length), length);
+    }
+  };
+}  // namespace mtconnect::buffer
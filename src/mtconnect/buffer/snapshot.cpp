@@ -0,0 +1,218 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "snapshot.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "mtconnect/asset/asset.hpp"
+#include "mtconnect/entity/xml_parser.hpp"
+#include "mtconnect/entity/xml_printer.hpp"
+#include "mtconnect/logging.hpp"
+#include "mtconnect/printer/xml_printer_helper.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace mtconnect::buffer {
+  using namespace observation;
+  using namespace entity;
+
+  namespace {
+    template <typename T>
+    inline void Put(string &out, T value)
+    {
+      out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    inline void Patch(string &out, size_t pos, T value)
+    {
+      memcpy(out.data() + pos, &value, sizeof(T));
+    }
+
+    /// @brief Bounds checked reader over the snapshot file
+    struct Reader
+    {
+      template <typename T>
+      bool get(T &value)
+      {
+        if (m_end - m_pos < ptrdiff_t(sizeof(T)))
+          return false;
+        memcpy(&value, m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return true;
+      }
+
+      bool has(size_t length) const { return m_end - m_pos >= ptrdiff_t(length); }
+
+      const char *m_pos;
+      const char *m_end;
+    };
+  }  // namespace
+
+  bool Snapshot::save(CircularBuffer &buffer, const asset::AssetStorage *assets) const
+  {
+    NAMED_SCOPE("Snapshot::save");
+
+    string out;
+    Put<uint32_t>(out, Magic);
+    Put<uint32_t>(out, Version);
+    Put<uint64_t>(out, getCurrentTimeInSec());
+
+    {
+      std::lock_guard<CircularBuffer> lock(buffer);
+      const auto &latest = buffer.getLatest().getObservations();
+      out.reserve(latest.size() * 64);
+
+      Put<uint64_t>(out, buffer.getSequence());
+      auto countPos = out.size();
+      Put<uint32_t>(out, 0);
+
+      uint32_t count = 0;
+      vector<ConditionPtr> chain;
+      for (const auto &[id, obs] : latest)
+      {
+        if (obs->isOrphan())
+          continue;
+
+        if (auto cond = dynamic_pointer_cast<Condition>(obs))
+        {
+          // The chain is newest first
+          chain.clear();
+          for (; cond; cond = cond->getPrev())
+            chain.push_back(cond);
+          for (auto it = chain.rbegin(); it != chain.rend(); it++, count++)
+            ObservationCodec::encode(out, *it);
+        }
+        else
+        {
+          ObservationCodec::encode(out, obs);
+          count++;
+        }
+      }
+      Patch<uint32_t>(out, countPos, count);
+    }
+
+    auto assetPos = out.size();
+    Put<uint32_t>(out, 0);
+    if (assets)
+    {
+      asset::AssetList list;
+      assets->getAssets(list, numeric_limits<size_t>::max(), false);
+
+      // The list is newest first, write the oldest first so they can be added in order
+      entity::XmlPrinter xmlPrinter;
+      for (auto it = list.rbegin(); it != list.rend(); it++)
+      {
+        printer::XmlWriter writer(false);
+        xmlPrinter.print(writer, *it, {});
+        auto xml = writer.getContent();
+        Put<uint32_t>(out, uint32_t(xml.size()));
+        out.append(xml);
+      }
+      Patch<uint32_t>(out, assetPos, uint32_t(list.size()));
+    }
+
+    auto temp = m_file;
+    temp += ".tmp";
+    {
+      std::ofstream file(temp, ios::binary | ios::trunc);
+      file.write(out.data(), out.size());
+      if (!file)
+      {
+        LOG(error) << "Cannot write snapshot to " << temp;
+        return false;
+      }
+    }
+
+    std::error_code ec;
+    fs::rename(temp, m_file, ec);
+    if (ec)
+    {
+      LOG(error) << "Cannot rename snapshot " << temp << " to " << m_file << ": " << ec.message();
+      return false;
+    }
+
+    LOG(debug) << "Wrote snapshot of " << out.size() << " bytes to " << m_file;
+    return true;
+  }
+
+  std::optional<Snapshot::Contents> Snapshot::load(
+      const ObservationCodec::DataItemMap &dataItems) const
+  {
+    NAMED_SCOPE("Snapshot::load");
+
+    std::ifstream file(m_file, ios::binary);
+    if (!file)
+      return nullopt;
+    string data {istreambuf_iterator<char>(file), istreambuf_iterator<char>()};
+
+    Reader reader {data.data(), data.data() + data.size()};
+    uint32_t magic {0}, version {0}, count {0};
+    Contents contents;
+    if (!reader.get(magic) || magic != Magic || !reader.get(version) || version != Version ||
+        !reader.get(contents.m_written) || !reader.get(contents.m_sequence) || !reader.get(count))
+    {
+      LOG(warning) << "Invalid snapshot " << m_file << ", ignoring";
+      return nullopt;
+    }
+
+    for (; count > 0; count--)
+    {
+      uint32_t length {0};
+      if (!reader.has(sizeof(length)) ||
+          (length = ObservationCodec::recordLength(reader.m_pos)) < sizeof(length) ||
+          !reader.has(length))
+      {
+        LOG(warning) << "Truncated snapshot " << m_file << ", ignoring";
+        return nullopt;
+      }
+
+      if (auto obs = ObservationCodec::decode(reader.m_pos, dataItems))
+        contents.m_observations.emplace_back(obs);
+      reader.m_pos += length;
+    }
+
+    if (reader.get(count))
+    {
+      for (; count > 0; count--)
+      {
+        uint32_t length {0};
+        if (!reader.get(length) || !reader.has(length))
+        {
+          LOG(warning) << "Truncated assets in snapshot " << m_file;
+          break;
+        }
+
+        ErrorList errors;
+        auto parsed = entity::XmlParser::parse(asset::Asset::getRoot(),
+                                               string(reader.m_pos, length), errors);
+        if (auto asset = dynamic_pointer_cast<asset::Asset>(parsed))
+          contents.m_assets.emplace_back(asset);
+        else
+          LOG(warning) << "Cannot restore asset from snapshot";
+        reader.m_pos += length;
+      }
+    }
+
+    return contents;
+  }
+}  // namespace mtconnect::buffer
@@ -0,0 +1,81 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include "circular_buffer.hpp"
+#include "mtconnect/asset/asset_storage.hpp"
+#include "mtconnect/config.hpp"
+#include "observation_codec.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief Persists the latest observations, the sequence number, and the assets for a warm
+  ///        restart
+  ///
+  /// The snapshot is a single binary file. It is written to a temporary file and renamed so an
+  /// interrupted write leaves the previous snapshot intact.
+  /// ```
+  /// snapshot := magic:u32 version:u32 written:u64 sequence:u64
+  ///             count:u32 { record }* assetCount:u32 { length:u32 xml }*
+  /// ```
+  /// Observations are encoded by the `ObservationCodec` and assets as XML. `written` is the time
+  /// the snapshot was written in seconds since the epoch.
+  class AGENT_LIB_API Snapshot
+  {
+  public:
+    /// @brief Identifies a snapshot file: `MTCS`
+    static constexpr uint32_t Magic = 0x5343544D;
+    static constexpr uint32_t Version = 1;
+
+    /// @brief The contents of a snapshot
+    struct Contents
+    {
+      uint64_t m_written {0};
+      SequenceNumber_t m_sequence {0};
+      observation::ObservationList m_observations;
+      asset::AssetList m_assets;
+    };
+
+    /// @brief Create a snapshot for a file
+    /// @param file the snapshot file
+    Snapshot(const std::filesystem::path &file) : m_file(file) {}
+
+    /// @brief Write the latest observations and sequence number from the buffer and the assets
+    /// @param[in] buffer the circular buffer
+    /// @param[in] assets optional asset storage
+    /// @return `true` if the snapshot was written
+    bool save(CircularBuffer &buffer, const asset::AssetStorage *assets) const;
+
+    /// @brief Read the snapshot
+    ///
+    /// Observations for data items that are not in the map are skipped. Active conditions are
+    /// returned oldest first so they can be added in order.
+    /// @param[in] dataItems map of data item ids to data items
+    /// @return the contents or `std::nullopt` if there is no valid snapshot
+    std::optional<Contents> load(const ObservationCodec::DataItemMap &dataItems) const;
+
+    /// @brief get the snapshot file
+    const auto &getFile() const { return m_file; }
+
+  protected:
+    std::filesystem::path m_file;
+  };
+}  // namespace mtconnect::buffer
@@ -52,6 +52,7 @@
 #include <stdexcept>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <thread>
 #include <vector>
 
 #include "mtconnect/agent.hpp"
@@ -62,8 +63,14 @@
 #include "mtconnect/sink/mqtt_sink/mqtt_service.hpp"
 #include "mtconnect/sink/rest_sink/rest_service.hpp"
 #include "mtconnect/source/adapter/agent_adapter/agent_adapter.hpp"
+#include "mtconnect/source/adapter/binary/binary_adapter.hpp"
 #include "mtconnect/source/adapter/mqtt/mqtt_adapter.hpp"
+#include "mtconnect/source/adapter/replay/replay_adapter.hpp"
 #include "mtconnect/source/adapter/shdr/shdr_adapter.hpp"
+#include "mtconnect/source/adapter/udp/udp_adapter.hpp"
+#ifndef _WINDOWS
+#include "mtconnect/source/adapter/shm/shm_adapter.hpp"
+#endif
 #include "mtconnect/version.h"
 
 #ifdef WITH_PYTHON
@@ -116,6 +123,12 @@ namespace mtconnect::configuration {
     adapter::shdr::ShdrAdapter::registerFactory(m_sourceFactory);
     adapter::mqtt_adapter::MqttAdapter::registerFactory(m_sourceFactory);
     adapter::agent_adapter::AgentAdapter::registerFactory(m_sourceFactory);
+    adapter::binary::BinaryAdapter::registerFactory(m_sourceFactory);
+    adapter::udp::UdpAdapter::registerFactory(m_sourceFactory);
+    adapter::replay::ReplayAdapter::registerFactory(m_sourceFactory);
+#ifndef _WINDOWS
+    adapter::shm::ShmAdapter::registerFactory(m_sourceFactory);
+#endif
 
 #if _WINDOWS
     char execPath[MAX_PATH];
@@ -798,6 +811,13 @@ namespace mtconnect::configuration {
                 {configuration::BufferSize, int(DEFAULT_SLIDING_BUFFER_EXP)},
                 {configuration::MaxAssets, int(DEFAULT_MAX_ASSETS)},
                 {configuration::CheckpointFrequency, 1000},
+                {configuration::BufferMemoryLimit, ""s},
+                {configuration::ArchivePath, ""s},
+                {configuration::ArchiveSegmentSize, "64M"s},
+                {configuration::ArchiveMaxSegments, 64},
+                {configuration::ArchiveCompression, false},
+                {configuration::SnapshotFile, ""s},
+                {configuration::SnapshotInterval, 60s},
                 {configuration::LegacyTimeout, 600s},
                 {configuration::CreateUniqueIds, false},
                 {configuration::ReconnectInterval, 10000ms},
@@ -833,9 +853,12 @@ namespace mtconnect::configuration {
                 {configuration::SuppressIPAddress, false},
                 {configuration::AllowPutFrom, ""s},
                 {configuration::Validation, false},
-                {configuration::CorrectTimestamps, false}});
+                {configuration::CorrectTimestamps, false},
+                {configuration::PipelineMetrics, false}});
 
     m_workerThreadCount = *GetOption<int>(options, configuration::WorkerThreads);
+    if (m_workerThreadCount <= 0)
+      m_workerThreadCount = std::max(1, int(std::thread::hardware_concurrency()));
     m_monitorFiles = *GetOption<bool>(options, configuration::MonitorConfigFiles);
     m_monitorInterval = *GetOption<Seconds>(options, configuration::MonitorInterval);
     m_monitorDelay = *GetOption<Seconds>(options, configuration::MinimumConfigReloadAge);
@@ -1132,8 +1155,10 @@ namespace mtconnect::configuration {
       AddOptions(*ruby, rubyOptions,
                  {{"Module", string()},
                   {"Initialization", string()},
+                  {"Interpreters", int()},
                   {"module", string()},
-                  {"initialization", string()}});
+                  {"initialization", string()},
+                  {"interpreters", int()}});
     }
     m_ruby = make_unique<ruby::Embedded>(this, rubyOptions);
   }
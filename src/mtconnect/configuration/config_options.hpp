@@ -48,6 +48,13 @@ namespace mtconnect {
     DECLARE_CONFIGURATION(AllowPutFrom);
     DECLARE_CONFIGURATION(BufferSize);
     DECLARE_CONFIGURATION(CheckpointFrequency);
+    DECLARE_CONFIGURATION(BufferMemoryLimit);
+    DECLARE_CONFIGURATION(ArchivePath);
+    DECLARE_CONFIGURATION(ArchiveSegmentSize);
+    DECLARE_CONFIGURATION(ArchiveMaxSegments);
+    DECLARE_CONFIGURATION(ArchiveCompression);
+    DECLARE_CONFIGURATION(SnapshotFile);
+    DECLARE_CONFIGURATION(SnapshotInterval);
     DECLARE_CONFIGURATION(Devices);
     DECLARE_CONFIGURATION(HttpHeaders);
     DECLARE_CONFIGURATION(JsonVersion);
@@ -127,13 +134,20 @@ namespace mtconnect {
     DECLARE_CONFIGURATION(LegacyTimeout);
     DECLARE_CONFIGURATION(Manufacturer);
     DECLARE_CONFIGURATION(Path);
+    DECLARE_CONFIGURATION(PipelineMetrics);
     DECLARE_CONFIGURATION(PollingInterval);
     DECLARE_CONFIGURATION(PreserveUUID);
     DECLARE_CONFIGURATION(Protocol);
     DECLARE_CONFIGURATION(RealTime);
     DECLARE_CONFIGURATION(ReconnectInterval);
     DECLARE_CONFIGURATION(RelativeTime);
+    DECLARE_CONFIGURATION(ReplayFile);
+    DECLARE_CONFIGURATION(ReplayLoop);
+    DECLARE_CONFIGURATION(ReplaySpeed);
     DECLARE_CONFIGURATION(SerialNumber);
+    DECLARE_CONFIGURATION(SharedMemoryName);
+    DECLARE_CONFIGURATION(SharedMemorySlotSize);
+    DECLARE_CONFIGURATION(SharedMemorySlots);
     DECLARE_CONFIGURATION(ShdrVersion);
     DECLARE_CONFIGURATION(SourceDevice);
     DECLARE_CONFIGURATION(Station);
@@ -153,6 +153,32 @@ namespace mtconnect {
                                  errors);
         comp->addDataItem(di, errors);
       }
+
+      if (IsOptionSet(adapter->getOptions(), config::PipelineMetrics))
+      {
+        for (auto &[suffix, type] : {pair {"_pipeline_latency"s, "x:PIPELINE_LATENCY"s},
+                                     pair {"_pipeline_throughput"s, "x:PIPELINE_THROUGHPUT"s}})
+        {
+          ErrorList errors;
+          auto di = DataItem::make({{"type", type},
+                                    {"id", id + suffix},
+                                    {"category", "EVENT"s},
+                                    {"representation", "DATA_SET"s}},
+                                   errors);
+          comp->addDataItem(di, errors);
+        }
+      }
+
+      for (auto props : adapter->getAgentDataItems())
+      {
+        ErrorList errors;
+        props["id"] = id + get<string>(props["id"]);
+        auto di = DataItem::make(props, errors);
+        if (di)
+          comp->addDataItem(di, errors);
+        for (auto &e : errors)
+          LOG(warning) << "Cannot add adapter data item: " << e->what();
+      }
     }
 
     void AgentDevice::addRequiredDataItems()
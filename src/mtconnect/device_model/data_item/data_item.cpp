@@ -27,6 +27,7 @@
 #include "mtconnect/device_model/device.hpp"
 #include "mtconnect/entity/requirement.hpp"
 #include "mtconnect/logging.hpp"
+#include "mtconnect/validation/observations.hpp"
 
 using namespace std;
 
@@ -74,6 +75,7 @@ namespace mtconnect {
             {"ResetTrigger", false}});
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
           auto ptr = make_shared<DataItem>(name, props);
+          DataItemRegistry::instance().bind(ptr->m_registryKey, ptr);
           return dynamic_pointer_cast<Entity>(ptr);
         });
 
@@ -142,6 +144,7 @@ namespace mtconnect {
       {
         m_category = EVENT;
         m_categoryText = events;
+        m_vocabulary = validation::observations::GetCompiledVocabularies().index(m_observationName);
 
         if (type == "ALARM")
           m_specialClass = ALARM_CLS;
@@ -252,8 +255,13 @@ namespace mtconnect {
             m_key += ":DOUBLE";
         }
       }
+
+      // Register last so a data item that fails to construct is never referenced
+      m_registryKey = DataItemRegistry::instance().add(this);
     }
 
+    DataItem::~DataItem() { DataItemRegistry::instance().remove(m_registryKey); }
+
     bool DataItem::hasName(const string &name) const
     {
       return m_id == name || (m_name && *m_name == name) || (m_source && *m_source == name) ||
@@ -17,7 +17,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <limits>
 #include <map>
+#include <memory>
 
 #include "constraints.hpp"
 #include "definition.hpp"
@@ -26,6 +29,7 @@
 #include "mtconnect/device_model/component.hpp"
 #include "mtconnect/observation/change_observer.hpp"
 #include "mtconnect/utilities.hpp"
+#include "registry.hpp"
 #include "relationships.hpp"
 #include "source.hpp"
 #include "unit_conversion.hpp"
@@ -38,6 +42,9 @@ namespace mtconnect {
   namespace source::adapter {
     class Adapter;
   }
+  namespace observation {
+    class Observation;
+  }
   namespace device_model {
     class Composition;
     struct UpdateDataItemId;
@@ -100,7 +107,7 @@ namespace mtconnect {
         }
 
         // Destructor
-        ~DataItem() override = default;
+        ~DataItem() override;
 
         /// @name Cached transformed and derived property access methods
         ///@{
@@ -133,6 +140,10 @@ namespace mtconnect {
         /// @brief get the properties to build an observation
         /// @return observation properties
         const auto &getObservationProperties() const { return m_observatonProperties; }
+        /// @brief get the ordinal of the event type in the compiled controlled vocabularies
+        /// @return the ordinal, or `std::nullopt` if the data item is not an event or the type
+        ///         was not compiled
+        const auto &getVocabulary() const { return m_vocabulary; }
 
         /// @brief get the topic with the path
         /// @return data item topic
@@ -220,8 +231,59 @@ namespace mtconnect {
         /// @return source if available
         const std::optional<std::string> &getDataSource() const { return m_dataSource; }
         /// @brief set the data source
+        ///
+        /// Called for every observation, only writes when the source changes so pipelines
+        /// sharing a data item in parallel do not race on the string.
         /// @param[in] source the source
-        void setDataSource(const std::string &source) { m_dataSource = source; }
+        void setDataSource(const std::string &source)
+        {
+          if (m_dataSource != source)
+            m_dataSource = source;
+        }
+
+        /// @name Latest values
+        ///
+        /// Read by the pipeline filters without taking the circular buffer lock.
+        ///@{
+
+        /// @brief get the latest observation in the circular buffer for this data item
+        /// @return the observation or `nullptr` if none has been published
+        std::shared_ptr<observation::Observation> getLatestObservation() const
+        {
+          return std::atomic_load_explicit(&m_latestObservation, std::memory_order_acquire);
+        }
+        /// @brief publish the latest observation, called by the circular buffer
+        /// @param[in] obs the observation from the latest checkpoint
+        void setLatestObservation(std::shared_ptr<observation::Observation> obs)
+        {
+          std::atomic_store_explicit(&m_latestObservation, std::move(obs),
+                                     std::memory_order_release);
+        }
+        /// @brief get the last value that passed the minimum delta filter
+        /// @return the value or `NaN` if there is none
+        double getLastDeltaValue() const
+        {
+          return m_lastDeltaValue.load(std::memory_order_relaxed);
+        }
+        /// @brief set the last value that passed the minimum delta filter
+        /// @param[in] value the value or `NaN` to clear
+        void setLastDeltaValue(double value)
+        {
+          m_lastDeltaValue.store(value, std::memory_order_relaxed);
+        }
+        ///@}
+        /// @brief get the registry key observations use to reference this data item
+        /// @return the key
+        const auto &getRegistryKey() const { return m_registryKey; }
+        /// @brief take over the registry slot of the data item this data item replaces
+        ///
+        /// The observations of the old data item will reference this data item.
+        /// @param[in] old the data item with the same id in the previous device model
+        void replace(DataItem &old)
+        {
+          DataItemRegistry::instance().exchange(old.m_registryKey, m_registryKey, &old, this);
+        }
+
         /// @brief set the topic for the data item
         /// @param[in] topic the topic
         void setTopic(const std::string &topic) { m_topic = topic; }
@@ -300,6 +362,7 @@ namespace mtconnect {
         // Type for observation
         entity::QName m_observationName;
         entity::Properties m_observatonProperties;
+        std::optional<size_t> m_vocabulary;
 
         // Representation of data item
         Representation m_representation {VALUE};
@@ -316,6 +379,13 @@ namespace mtconnect {
         // The data source for this data item
         std::optional<std::string> m_dataSource;
 
+        // Slot referenced by the observations
+        DataItemRegistry::Key m_registryKey;
+
+        // Latest values
+        std::shared_ptr<observation::Observation> m_latestObservation;
+        std::atomic<double> m_lastDeltaValue {std::numeric_limits<double>::quiet_NaN()};
+
         // Conversions
         std::unique_ptr<UnitConversion> m_converter;
       };
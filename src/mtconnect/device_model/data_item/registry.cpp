@@ -0,0 +1,109 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "registry.hpp"
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace mtconnect::device_model::data_item {
+  DataItemRegistry &DataItemRegistry::instance()
+  {
+    // Never destroyed so data items can be released during static destruction
+    static auto *registry = new DataItemRegistry();
+    return *registry;
+  }
+
+  DataItemRegistry::Key DataItemRegistry::add(DataItem *dataItem)
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    uint32_t ordinal;
+    if (!m_free.empty())
+    {
+      ordinal = m_free.back();
+      m_free.pop_back();
+    }
+    else
+    {
+      ordinal = m_next++;
+      if ((ordinal & (ChunkSize - 1)) == 0 || ordinal == 1)
+      {
+        auto chunk = ordinal >> ChunkBits;
+        if (chunk >= MaxChunks)
+          throw length_error("Too many data items");
+        m_storage.emplace_back(make_unique<Slot[]>(ChunkSize));
+        m_chunks[chunk].store(m_storage.back().get(), memory_order_release);
+      }
+    }
+
+    auto &slot = getSlot(ordinal);
+    slot.m_dataItem.store(dataItem, memory_order_release);
+    m_size++;
+    return {ordinal, slot.m_generation.load(memory_order_relaxed)};
+  }
+
+  void DataItemRegistry::bind(const Key &key, const shared_ptr<DataItem> &dataItem)
+  {
+    if (key.m_ordinal == 0)
+      return;
+
+    lock_guard<mutex> lock(m_mutex);
+    atomic_store_explicit(&getSlot(key.m_ordinal).m_owner,
+                          make_shared<const Owner>(Owner {dataItem}), memory_order_release);
+  }
+
+  void DataItemRegistry::remove(const Key &key)
+  {
+    if (key.m_ordinal == 0)
+      return;
+
+    lock_guard<mutex> lock(m_mutex);
+    auto &slot = getSlot(key.m_ordinal);
+    slot.m_dataItem.store(nullptr, memory_order_release);
+    atomic_store_explicit(&slot.m_owner, shared_ptr<const Owner>(), memory_order_release);
+    slot.m_generation.fetch_add(1, memory_order_acq_rel);
+    m_free.push_back(key.m_ordinal);
+    m_size--;
+  }
+
+  void DataItemRegistry::exchange(Key &from, Key &to, DataItem *fromItem, DataItem *toItem)
+  {
+    lock_guard<mutex> lock(m_mutex);
+    // The owners are only replaced with the registry mutex held
+    shared_ptr<const Owner> fromOwner, toOwner;
+    if (from.m_ordinal != 0)
+      fromOwner = getSlot(from.m_ordinal).m_owner;
+    if (to.m_ordinal != 0)
+      toOwner = getSlot(to.m_ordinal).m_owner;
+
+    if (from.m_ordinal != 0)
+    {
+      auto &slot = getSlot(from.m_ordinal);
+      slot.m_dataItem.store(toItem, memory_order_release);
+      atomic_store_explicit(&slot.m_owner, move(toOwner), memory_order_release);
+    }
+    if (to.m_ordinal != 0)
+    {
+      auto &slot = getSlot(to.m_ordinal);
+      slot.m_dataItem.store(fromItem, memory_order_release);
+      atomic_store_explicit(&slot.m_owner, move(fromOwner), memory_order_release);
+    }
+    swap(from, to);
+  }
+}  // namespace mtconnect::device_model::data_item
@@ -0,0 +1,158 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+
+namespace mtconnect::device_model::data_item {
+  class DataItem;
+
+  /// @brief Generation counted slots for all data items in the process
+  ///
+  /// Each data item is registered in a slot when it is created. Observations reference the data
+  /// item by the slot ordinal and the generation of the slot at the time. When a data item is
+  /// destroyed, the slot generation is incremented so the observations are orphaned, and the
+  /// slot can be reused by a new data item.
+  ///
+  /// Slots are allocated in chunks that never move, so lookups are a plain load validated by
+  /// the generation without a lock or reference count. When the device model changes, the new
+  /// data item takes over the slot of the data item with the same id.
+  ///
+  /// A raw pointer from `get()` does not keep the data item alive. It is only valid while the
+  /// circular buffer lock is held or the buffer epoch is pinned, since replaced device models
+  /// are retired through the buffer. Use `lock()` to keep the data item.
+  class AGENT_LIB_API DataItemRegistry
+  {
+  public:
+    /// @brief A slot ordinal and the generation of the slot
+    struct Key
+    {
+      uint32_t m_ordinal {0};
+      uint32_t m_generation {0};
+
+      bool operator==(const Key &other) const = default;
+    };
+
+    static constexpr size_t ChunkBits = 12;
+    static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+    static constexpr size_t MaxChunks = 1024;
+
+    /// @brief get the registry for the process
+    static DataItemRegistry &instance();
+
+    /// @brief register a data item
+    /// @param[in] dataItem the data item
+    /// @return the key for the data item, ordinal `0` is never used
+    Key add(DataItem *dataItem);
+    /// @brief set the owner of a registered data item so it can be locked
+    /// @param[in] key the key of the data item
+    /// @param[in] dataItem the shared pointer to the data item
+    void bind(const Key &key, const std::shared_ptr<DataItem> &dataItem);
+    /// @brief remove a data item and orphan its observations
+    /// @param[in] key the key of the data item
+    void remove(const Key &key);
+    /// @brief exchange the slots of two data items
+    ///
+    /// Used when `to` replaces `from`, the observations of `from` will reference `to`.
+    /// @param[in] from the key of the data item being replaced, receives the key of `to`
+    /// @param[in] to the key of the replacing data item, receives the key of `from`
+    /// @param[in] fromItem the data item being replaced
+    /// @param[in] toItem the replacing data item
+    void exchange(Key &from, Key &to, DataItem *fromItem, DataItem *toItem);
+
+    /// @brief get the data item for a key
+    /// @param[in] key the key
+    /// @return the data item or `nullptr` if it has been removed
+    DataItem *get(const Key &key) const
+    {
+      if (key.m_ordinal == 0)
+        return nullptr;
+      auto &slot = getSlot(key.m_ordinal);
+      if (slot.m_generation.load(std::memory_order_acquire) != key.m_generation)
+        return nullptr;
+      auto dataItem = slot.m_dataItem.load(std::memory_order_acquire);
+      // The slot may have been reused after the generation was read
+      if (slot.m_generation.load(std::memory_order_acquire) != key.m_generation)
+        return nullptr;
+      return dataItem;
+    }
+
+    /// @brief get a shared pointer to the data item for a key
+    /// @param[in] key the key
+    /// @return the data item or `nullptr` if it has been removed or is being destroyed
+    std::shared_ptr<DataItem> lock(const Key &key) const
+    {
+      if (key.m_ordinal == 0)
+        return nullptr;
+      auto &slot = getSlot(key.m_ordinal);
+      if (slot.m_generation.load(std::memory_order_acquire) != key.m_generation)
+        return nullptr;
+      auto owner = std::atomic_load_explicit(&slot.m_owner, std::memory_order_acquire);
+      if (!owner)
+        return nullptr;
+      auto dataItem = owner->m_dataItem.lock();
+      if (slot.m_generation.load(std::memory_order_acquire) != key.m_generation)
+        return nullptr;
+      return dataItem;
+    }
+
+    /// @brief get the number of registered data items
+    size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_size;
+    }
+
+  protected:
+    /// @brief The owner of the data item in a slot, never modified once published
+    struct Owner
+    {
+      std::weak_ptr<DataItem> m_dataItem;
+    };
+
+    struct Slot
+    {
+      std::atomic<DataItem *> m_dataItem {nullptr};
+      // Accessed with the atomic shared_ptr functions, libc++ has no std::atomic<std::weak_ptr>
+      std::shared_ptr<const Owner> m_owner;
+      std::atomic<uint32_t> m_generation {0};
+    };
+
+    DataItemRegistry() = default;
+    Slot &getSlot(uint32_t ordinal) const
+    {
+      auto chunk = m_chunks[ordinal >> ChunkBits].load(std::memory_order_acquire);
+      return chunk[ordinal & (ChunkSize - 1)];
+    }
+
+  protected:
+    mutable std::mutex m_mutex;
+    std::array<std::atomic<Slot *>, MaxChunks> m_chunks {};
+    std::vector<std::unique_ptr<Slot[]>> m_storage;
+    std::vector<uint32_t> m_free;
+    uint32_t m_next {1};
+    size_t m_size {0};
+  };
+}  // namespace mtconnect::device_model::data_item
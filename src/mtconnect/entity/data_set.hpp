@@ -17,10 +17,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <initializer_list>
+#include <memory>
+#include <optional>
 #include <regex>
-#include <set>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -89,6 +94,7 @@ namespace mtconnect::entity {
       /// @param key
       Entry(const std::string &key) : m_key(key), m_removed(false) {}
       Entry(const Entry &other) = default;
+      Entry(Entry &&other) = default;
       Entry() : m_removed(false) {}
 
       /// @brief copy a data set entry from another
@@ -99,6 +105,8 @@ namespace mtconnect::entity {
         m_removed = other.m_removed;
         return *this;
       }
+      /// @brief move a data set entry from another
+      Entry &operator=(Entry &&other) = default;
 
       /// @brief only compares keys for equality
       bool operator==(const Entry &other) const { return m_key == other.m_key; }
@@ -129,14 +137,192 @@ namespace mtconnect::entity {
       bool m_removed;     //! boolean indicator if this entry is removed.
     };
 
-    /// @brief A set of data set entries
-    /// @tparam ET the entry type for the set, must have < operator.
+    /// @brief A set of data set entries ordered by key in a flat vector
+    ///
+    /// Copies share the entries until one of them is modified, so a copy of a large set that is
+    /// updated does not copy the entries until the first change. `apply()` and `removeSame()`
+    /// walk both sets in key order and only allocate when the set changes.
+    ///
+    /// Iterators are invalidated when the set is modified.
+    /// @tparam ET the entry type for the set, must have a `m_key` string.
     template <typename ET>
-    class Set : public std::set<ET>
+    class Set
     {
     public:
-      using base = std::set<ET>;
-      using base::base;
+      using Entries = std::vector<ET>;
+      using key_type = ET;
+      using value_type = ET;
+      using size_type = typename Entries::size_type;
+      using difference_type = typename Entries::difference_type;
+      using reference = const ET &;
+      using const_reference = const ET &;
+      using iterator = typename Entries::const_iterator;
+      using const_iterator = typename Entries::const_iterator;
+      using reverse_iterator = typename Entries::const_reverse_iterator;
+      using const_reverse_iterator = typename Entries::const_reverse_iterator;
+
+      Set() = default;
+      Set(const Set &other) = default;
+      Set(Set &&other) = default;
+      /// @brief Create a set from a list of entries, the first entry for a key is kept
+      Set(std::initializer_list<ET> entries) : Set(entries.begin(), entries.end()) {}
+      /// @brief Create a set from a range of entries, the first entry for a key is kept
+      template <typename It>
+      Set(It first, It last)
+      {
+        for (; first != last; first++)
+          insert(*first);
+      }
+
+      Set &operator=(const Set &other) = default;
+      Set &operator=(Set &&other) = default;
+
+      /// @name Iteration
+      ///@{
+      const_iterator begin() const { return entries().begin(); }
+      const_iterator end() const { return entries().end(); }
+      const_iterator cbegin() const { return entries().begin(); }
+      const_iterator cend() const { return entries().end(); }
+      const_reverse_iterator rbegin() const { return entries().rbegin(); }
+      const_reverse_iterator rend() const { return entries().rend(); }
+      ///@}
+
+      /// @brief get the number of entries
+      size_type size() const { return entries().size(); }
+      /// @brief `true` if the set has no entries
+      bool empty() const { return entries().empty(); }
+      /// @brief remove all the entries
+      void clear() { m_entries.reset(); }
+
+      /// @brief Find an entry by key
+      /// @tparam K a string type or an entry type
+      /// @param key the key or an entry with the key
+      /// @return an iterator to the entry or `end()`
+      template <typename K>
+      const_iterator find(const K &key) const
+      {
+        std::string_view k;
+        if constexpr (requires { key.m_key; })
+          k = key.m_key;
+        else
+          k = key;
+
+        auto it = lowerBound(k);
+        if (it != end() && it->m_key == k)
+          return it;
+        return end();
+      }
+      /// @brief count the entries with the same key
+      size_type count(const ET &entry) const { return find(entry) == end() ? 0 : 1; }
+
+      /// @brief Insert an entry if there is no entry with the same key
+      /// @param entry the entry
+      /// @return the entry with the key and `true` if it was inserted
+      std::pair<const_iterator, bool> insert(ET entry)
+      {
+        auto pos = lowerBound(entry.m_key) - begin();
+        if (pos < difference_type(size()) && entries()[pos].m_key == entry.m_key)
+          return {begin() + pos, false};
+
+        auto &values = mutate();
+        values.insert(values.begin() + pos, std::move(entry));
+        return {begin() + pos, true};
+      }
+      /// @brief Insert an entry, the position is ignored
+      const_iterator insert(const_iterator, ET entry) { return insert(std::move(entry)).first; }
+      /// @brief Construct an entry and insert it if there is no entry with the same key
+      /// @return the entry with the key and `true` if it was inserted
+      template <typename... Args>
+      std::pair<const_iterator, bool> emplace(Args &&...args)
+      {
+        return insert(ET(std::forward<Args>(args)...));
+      }
+
+      /// @brief Remove an entry
+      /// @param pos iterator to the entry
+      /// @return an iterator to the entry after the removed entry
+      const_iterator erase(const_iterator pos)
+      {
+        auto index = pos - begin();
+        auto &values = mutate();
+        values.erase(values.begin() + index);
+        return begin() + index;
+      }
+      /// @brief Remove the entry with the same key
+      /// @return the number of entries removed
+      size_type erase(const ET &entry)
+      {
+        auto it = find(entry);
+        if (it == end())
+          return 0;
+        erase(it);
+        return 1;
+      }
+
+      /// @brief Apply changes to the set
+      ///
+      /// Entries in `changes` replace the entries with the same key, removed entries delete the
+      /// key.
+      /// @param changes the changed entries
+      void apply(const Set &changes)
+      {
+        if (changes.empty())
+          return;
+
+        auto entries = std::make_shared<Entries>();
+        entries->reserve(size() + changes.size());
+
+        auto it = begin();
+        for (const auto &change : changes)
+        {
+          for (; it != end() && it->m_key < change.m_key; it++)
+            entries->push_back(*it);
+          if (it != end() && it->m_key == change.m_key)
+            it++;
+          if (!change.m_removed)
+            entries->push_back(change);
+        }
+        entries->insert(entries->end(), it, end());
+
+        m_entries = std::move(entries);
+      }
+
+      /// @brief Remove the entries that are the same in another set
+      /// @param other the other set
+      /// @return `true` if any entries were removed
+      bool removeSame(const Set &other)
+      {
+        std::shared_ptr<Entries> entries;
+        auto o = other.begin();
+        for (auto it = begin(); it != end(); it++)
+        {
+          for (; o != other.end() && o->m_key < it->m_key; o++)
+            ;
+          bool same = o != other.end() && o->same(*it);
+          if (same && !entries)
+          {
+            // Only copy the entries once the first one is removed
+            entries = std::make_shared<Entries>(begin(), it);
+            entries->reserve(size() - 1);
+          }
+          else if (!same && entries)
+          {
+            entries->push_back(*it);
+          }
+        }
+
+        if (!entries)
+          return false;
+        m_entries = std::move(entries);
+        return true;
+      }
+
+      /// @brief `true` if the two sets have the same keys
+      bool operator==(const Set &other) const
+      {
+        return m_entries == other.m_entries ||
+               std::equal(begin(), end(), other.begin(), other.end());
+      }
 
       /// @brief Get a entry for a key
       /// @tparam T the entry type
@@ -145,7 +331,7 @@ namespace mtconnect::entity {
       template <typename T>
       const T &get(const std::string &key) const
       {
-        auto v = base::find(ET(key));
+        auto v = find(key);
         if (v == this->end())
           throw std::logic_error("DataSet get: key not found '" + key + "'");
         else
@@ -159,12 +345,45 @@ namespace mtconnect::entity {
       template <typename T>
       const std::optional<T> maybeGet(const std::string &key) const
       {
-        auto v = base::find(ET(key));
+        auto v = find(key);
         if (v == this->end())
           return std::nullopt;
         else
           return std::get<T>(v->m_value);
       }
+
+      /// @brief `true` if the sets share their entries
+      bool shares(const Set &other) const
+      {
+        return m_entries != nullptr && m_entries == other.m_entries;
+      }
+
+    protected:
+      const Entries &entries() const
+      {
+        static const Entries empty;
+        return m_entries ? *m_entries : empty;
+      }
+
+      // Copy the entries if they are shared with another set
+      Entries &mutate()
+      {
+        if (!m_entries)
+          m_entries = std::make_shared<Entries>();
+        else if (m_entries.use_count() > 1)
+          m_entries = std::make_shared<Entries>(*m_entries);
+        return *m_entries;
+      }
+
+      const_iterator lowerBound(std::string_view key) const
+      {
+        return std::lower_bound(begin(), end(), key, [](const ET &entry, std::string_view k) {
+          return std::string_view(entry.m_key) < k;
+        });
+      }
+
+    protected:
+      std::shared_ptr<Entries> m_entries;
     };
   }  // namespace data_set
 
@@ -199,17 +418,15 @@ namespace mtconnect::entity {
 
       const auto &orow = std::get<TableRow>(v1);
 
+      if (row.shares(orow))
+        return true;
       if (row.size() != orow.size())
         return false;
 
-      for (const auto &c1 : row)
-      {
-        const auto &c2 = orow.find(c1);
-        if (c2 == orow.end() || !c2->sameValue(c1))
-          return false;
-      }
-
-      return true;
+      // Both rows are ordered by key
+      return std::equal(row.begin(), row.end(), orow.begin(), [](const auto &c1, const auto &c2) {
+        return c1.m_key == c2.m_key && c2.sameValue(c1);
+      });
     }
   }  // namespace data_set
 
@@ -178,20 +178,20 @@ namespace mtconnect {
       }
     }
 
-    void XmlPrinter::print(xmlTextWriterPtr writer, const EntityPtr entity,
+    void XmlPrinter::print(xmlTextWriterPtr writer, const Entity &entity,
                            const std::unordered_set<std::string> &namespaces)
     {
       NAMED_SCOPE("entity.xml_printer");
-      const auto &properties = entity->getProperties();
-      const auto order = entity->getOrder();
+      const auto &properties = entity.getProperties();
+      const auto order = entity.getOrder();
       const auto *localNamespaces = &namespaces;
 
       // If this element has a namespace and there is a xmlns delcaration, create a new set of
       // namespaces with this one added
       std::unique_ptr<std::unordered_set<std::string>> entityNamespaces;
-      if (entity->getName().hasNs())
+      if (entity.getName().hasNs())
       {
-        string ns(entity->getName().getNs());
+        string ns(entity.getName().getNs());
         if (namespaces.count(ns) == 0)
         {
           auto attr = properties.find(string("xmlns:") + ns);
@@ -204,18 +204,18 @@ namespace mtconnect {
         }
       }
 
-      string qname = stripUndeclaredNamespace(entity->getName(), *localNamespaces);
+      string qname = stripUndeclaredNamespace(entity.getName(), *localNamespaces);
       AutoElement element(writer, qname);
 
       list<Property> attributes;
       list<Property> elements;
 
       // Partition the properties
-      const auto &attrs = entity->getAttributes();
+      const auto &attrs = entity.getAttributes();
       for (const auto &prop : properties)
       {
         auto &key = prop.first;
-        if (m_includeHidden || !entity->isHidden(key))
+        if (m_includeHidden || !entity.isHidden(key))
         {
           if (islower(key.getName()[0]) || attrs.count(key) > 0)
             attributes.emplace_back(prop);
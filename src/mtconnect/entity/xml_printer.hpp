@@ -41,6 +41,15 @@ namespace mtconnect {
       /// @param entity the entity
       /// @param namespaces a set of namespaces to use in the document
       void print(xmlTextWriterPtr writer, const EntityPtr entity,
+                 const std::unordered_set<std::string> &namespaces)
+      {
+        print(writer, *entity, namespaces);
+      }
+      /// @brief convert an entity to a XML document using `libxml2`
+      /// @param writer libxml2 `xmlTextWriterPtr`
+      /// @param entity the entity
+      /// @param namespaces a set of namespaces to use in the document
+      void print(xmlTextWriterPtr writer, const Entity &entity,
                  const std::unordered_set<std::string> &namespaces);
 
     protected:
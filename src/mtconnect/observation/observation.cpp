@@ -162,7 +162,7 @@ namespace mtconnect {
 
       auto obs = dynamic_pointer_cast<Observation>(ent);
       obs->m_timestamp = timestamp;
-      obs->m_dataItem = dataItem;
+      obs->m_dataItemKey = dataItem->getRegistryKey();
 
       if (unavailable)
         obs->makeUnavailable();
@@ -37,6 +37,8 @@ namespace mtconnect::observation {
   using ObservationPtr = std::shared_ptr<Observation>;
   using ConstObservationPtr = std::shared_ptr<const Observation>;
   using ObservationList = std::list<ObservationPtr>;
+  /// @brief Observations referenced without ownership, the owner must keep them alive
+  using ObservationPointers = std::vector<const Observation *>;
 
   /// @brief Abstract observation
   class AGENT_LIB_API Observation : public entity::Entity
@@ -74,29 +76,32 @@ namespace mtconnect::observation {
     /// @param[in] dataItem the data item
     void setDataItem(const DataItemPtr dataItem)
     {
-      m_dataItem = dataItem;
+      m_dataItemKey = dataItem->getRegistryKey();
       setProperties(dataItem, m_properties);
     }
 
     /// @brief get the associated data item
     /// @return shared pointer to the data item
-    const auto getDataItem() const { return m_dataItem.lock(); }
+    DataItemPtr getDataItem() const
+    {
+      return device_model::data_item::DataItemRegistry::instance().lock(m_dataItemKey);
+    }
+    /// @brief get the associated data item without changing its reference count
+    ///
+    /// The pointer does not keep the data item alive. It is only valid while the circular buffer
+    /// lock is held or the buffer epoch is pinned, use `getDataItem()` otherwise.
+    /// @return the data item or `nullptr` if it was removed
+    device_model::data_item::DataItem *getDataItemPointer() const
+    {
+      return device_model::data_item::DataItemRegistry::instance().get(m_dataItemKey);
+    }
+    /// @brief get the registry key of the associated data item
+    /// @return the key
+    const auto &getDataItemKey() const { return m_dataItemKey; }
     /// @brief get the sequence number of the observation
     /// @return the sequence number
     auto getSequence() const { return m_sequence; }
 
-    /// @brief update related data item when the device is updated
-    /// @param[in] diMap a map of data item ids to data items
-    void updateDataItem(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
-    {
-      auto old = m_dataItem.lock();
-      auto ndi = diMap.find(old->getId());
-      if (ndi != diMap.end())
-        m_dataItem = ndi->second;
-      else
-        LOG(trace) << "Observation cannot find data item: " << old->getId();
-    }
-
     /// @brief set the timestamp
     /// @param[in] ts the timestamp
     void setTimestamp(const Timestamp &ts)
@@ -128,7 +133,7 @@ namespace mtconnect::observation {
     /// @brief set the entity name (QName) from the data item observation name
     virtual void setEntityName()
     {
-      auto di = m_dataItem.lock();
+      auto di = getDataItemPointer();
       if (di)
         Entity::setQName(di->getObservationName());
     }
@@ -139,14 +144,16 @@ namespace mtconnect::observation {
     /// @return `true` if this observation is less than `another`
     bool operator<(const Observation &another) const
     {
-      auto di = m_dataItem.lock();
+      auto di = getDataItemPointer();
       if (!di)
         return false;
-      auto odi = another.m_dataItem.lock();
+      auto odi = another.getDataItemPointer();
       if (!odi)
         return true;
 
-      if ((*di) < (*odi))
+      if (di == odi)
+        return m_sequence < another.m_sequence;
+      else if ((*di) < (*odi))
         return true;
       else if (*di == *odi)
         return m_sequence < another.m_sequence;
@@ -159,13 +166,13 @@ namespace mtconnect::observation {
     bool isOrphan() const
     {
 #ifdef NDEBUG
-      return m_dataItem.expired();
+      return getDataItemPointer() == nullptr;
 #else
-      if (m_dataItem.expired())
+      auto di = getDataItemPointer();
+      if (!di)
         return true;
-      if (m_dataItem.lock()->isOrphan())
+      if (di->isOrphan())
       {
-        auto di = m_dataItem.lock();
         LOG(trace) << "!!! DataItem " << di->getTopicName() << " orphaned";
         return true;
       }
@@ -179,7 +186,7 @@ namespace mtconnect::observation {
   protected:
     Timestamp m_timestamp;
     bool m_unavailable {false};
-    std::weak_ptr<device_model::data_item::DataItem> m_dataItem;
+    device_model::data_item::DataItemRegistry::Key m_dataItemKey;
     uint64_t m_sequence {0};
   };
 
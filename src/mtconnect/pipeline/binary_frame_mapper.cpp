@@ -0,0 +1,233 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "binary_frame_mapper.hpp"
+
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+
+namespace mtconnect {
+  using namespace observation;
+  using namespace source::adapter::binary;
+
+  namespace pipeline {
+    DataItemPtr BinaryFrameMapper::resolve(std::string_view key)
+    {
+      string name, device;
+      auto c = key.find(':');
+      if (c != string_view::npos)
+      {
+        name = key.substr(c + 1);
+        device = key.substr(0, c);
+      }
+      else
+      {
+        name = key;
+        device = m_defaultDevice.value_or("");
+      }
+
+      auto dataItem = m_contract->findDataItem(device, name);
+      if (dataItem == nullptr)
+      {
+        if (m_logOnce.count(name) > 0)
+          LOG(trace) << "Could not find data item: " << name;
+        else
+        {
+          LOG(info) << "Could not find data item: " << name;
+          m_logOnce.insert(name);
+        }
+      }
+
+      return dataItem;
+    }
+
+    DataItemPtr BinaryFrameMapper::bindOrdinal(uint16_t ordinal, std::string_view key)
+    {
+      if (ordinal >= m_bindings.size())
+        m_bindings.resize(size_t(ordinal) + 1);
+
+      auto &binding = m_bindings[ordinal];
+      binding.m_key = key;
+      binding.m_dataItem = resolve(key);
+      return binding.m_dataItem;
+    }
+
+    void BinaryFrameMapper::checkDeviceModelVersion()
+    {
+      auto version = m_contract->getDeviceModelVersion();
+      if (version != m_deviceModelVersion)
+      {
+        for (auto &binding : m_bindings)
+        {
+          if (!binding.m_key.empty())
+            binding.m_dataItem = resolve(binding.m_key);
+        }
+        m_deviceModelVersion = version;
+      }
+    }
+
+    EntityPtr BinaryFrameMapper::mapObservations(BinaryFrameReader &reader,
+                                                 const std::optional<std::string> &source)
+    {
+      NAMED_SCOPE("BinaryFrameMapper::mapObservations");
+
+      checkDeviceModelVersion();
+
+      Timestamp timestamp {chrono::microseconds(reader.read<int64_t>())};
+      if (m_ignoreTimestamps)
+        timestamp = chrono::system_clock::now();
+
+      auto res = make_shared<Observations>("Observations", Properties {});
+      res->m_timestamp = timestamp;
+      EntityList entities;
+
+      while (!reader.atEnd())
+      {
+        auto ordinal = reader.read<uint16_t>();
+        auto type = ValueType(reader.read<uint8_t>());
+
+        // Always consume the value so the reader stays aligned with the next record
+        Properties props;
+        switch (type)
+        {
+          case ValueType::UNAVAILABLE:
+            break;
+
+          case ValueType::DOUBLE:
+            props.insert_or_assign("VALUE", reader.read<double>());
+            break;
+
+          case ValueType::INTEGER:
+            props.insert_or_assign("VALUE", reader.read<int64_t>());
+            break;
+
+          case ValueType::STRING:
+            props.insert_or_assign("VALUE", string(reader.readString()));
+            break;
+
+          case ValueType::VECTOR:
+          {
+            entity::Vector values;
+            reader.readArray<double>(values, reader.read<uint16_t>());
+            props.insert_or_assign("VALUE", std::move(values));
+            break;
+          }
+
+          case ValueType::TIMESERIES:
+          {
+            auto count = reader.read<uint32_t>();
+            auto rate = reader.read<double>();
+            entity::Vector values;
+            reader.readArray<float>(values, count);
+            props.insert_or_assign("sampleCount", int64_t(count));
+            props.insert_or_assign("sampleRate", rate);
+            props.insert_or_assign("VALUE", std::move(values));
+            break;
+          }
+
+          default:
+            throw BinaryFrameError("Unknown binary value type " + to_string(int(type)));
+        }
+
+        auto dataItem = getDataItem(ordinal);
+        if (!dataItem)
+        {
+          LOG(trace) << "No data item bound to ordinal " << ordinal;
+          continue;
+        }
+        if (dataItem->getConstantValue())
+          continue;
+
+        // Condition levels are sent as strings
+        if (dataItem->isCondition())
+        {
+          if (auto v = props.find("VALUE"); v != props.end())
+          {
+            props.insert_or_assign("level", v->second);
+            props.erase(v);
+          }
+        }
+
+        try
+        {
+          ErrorList errors;
+          auto obs = Observation::make(dataItem, props, timestamp, errors);
+          if (obs && errors.empty())
+          {
+            if (source)
+              dataItem->setDataSource(*source);
+            auto fwd = next(std::move(obs));
+            if (fwd)
+              entities.emplace_back(fwd);
+          }
+          for (auto &e : errors)
+            LOG(warning) << "Error while mapping binary observation: " << e->what();
+        }
+        catch (entity::EntityError &e)
+        {
+          LOG(error) << "Could not create observation: " << e.what();
+        }
+      }
+
+      res->setValue(entities);
+      return next(res);
+    }
+
+    EntityPtr BinaryFrameMapper::operator()(EntityPtr &&entity)
+    {
+      NAMED_SCOPE("BinaryFrameMapper::operator");
+
+      auto &body = entity->getValue<string>();
+      auto source = entity->maybeGet<string>("source");
+
+      try
+      {
+        BinaryFrameReader reader(body);
+        auto type = FrameType(reader.read<uint8_t>());
+        switch (type)
+        {
+          case FrameType::OBSERVATIONS:
+            return mapObservations(reader, source);
+
+          case FrameType::BINDING:
+            while (!reader.atEnd())
+            {
+              auto ordinal = reader.read<uint16_t>();
+              bindOrdinal(ordinal, reader.readString());
+            }
+            break;
+
+          case FrameType::HEARTBEAT:
+            // Handled by the connection
+            break;
+
+          default:
+            LOG(warning) << "Unknown binary frame type: " << int(type);
+            break;
+        }
+      }
+      catch (BinaryFrameError &e)
+      {
+        LOG(error) << "Invalid binary frame: " << e.what();
+      }
+
+      return nullptr;
+    }
+  }  // namespace pipeline
+}  // namespace mtconnect
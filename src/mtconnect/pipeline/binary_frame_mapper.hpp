@@ -0,0 +1,97 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <optional>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/entity/entity.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/source/adapter/binary/binary_protocol.hpp"
+#include "shdr_token_mapper.hpp"
+#include "transform.hpp"
+
+namespace mtconnect::pipeline {
+  /// @brief Map binary adapter frames directly to observations
+  ///
+  /// Takes the place of the tokenizer, timestamp extractor, and token mapper in the SHDR
+  /// pipeline. The output is the same: each observation is forwarded and then an `Observations`
+  /// entity with all the observations from the frame.
+  class AGENT_LIB_API BinaryFrameMapper : public Transform
+  {
+  public:
+    BinaryFrameMapper(const BinaryFrameMapper &) = default;
+    /// @brief Create a binary frame mapper
+    /// @param context the pipeline context
+    /// @param device the default device for keys without a device prefix
+    /// @param ignoreTimestamps use the current time instead of the frame timestamp
+    BinaryFrameMapper(PipelineContextPtr context,
+                      const std::optional<std::string> &device = std::nullopt,
+                      bool ignoreTimestamps = false)
+      : Transform("BinaryFrameMapper"),
+        m_contract(context->m_contract.get()),
+        m_defaultDevice(device),
+        m_ignoreTimestamps(ignoreTimestamps)
+    {
+      m_guard = EntityNameGuard("Data", RUN);
+    }
+    EntityPtr operator()(entity::EntityPtr &&entity) override;
+
+    /// @brief Associate an ordinal with a data item key
+    /// @param[in] ordinal the ordinal used in observation records
+    /// @param[in] key the data item key as `[device:]name`
+    /// @return the data item if it could be resolved
+    DataItemPtr bindOrdinal(uint16_t ordinal, std::string_view key);
+
+    /// @brief get the data item bound to an ordinal
+    /// @param[in] ordinal the ordinal
+    /// @return the data item or `nullptr` if it is not bound
+    DataItemPtr getDataItem(uint16_t ordinal) const
+    {
+      if (ordinal < m_bindings.size())
+        return m_bindings[ordinal].m_dataItem;
+      else
+        return nullptr;
+    }
+
+  protected:
+    DataItemPtr resolve(std::string_view key);
+    void checkDeviceModelVersion();
+    EntityPtr mapObservations(source::adapter::binary::BinaryFrameReader &reader,
+                              const std::optional<std::string> &source);
+
+    /// @brief An ordinal binding
+    struct Binding
+    {
+      std::string m_key;
+      DataItemPtr m_dataItem;
+    };
+
+  protected:
+    // Logging Context
+    std::set<std::string> m_logOnce;
+    PipelineContract *m_contract;
+    std::optional<std::string> m_defaultDevice;
+    std::vector<Binding> m_bindings;
+    uint64_t m_deviceModelVersion {0};
+    bool m_ignoreTimestamps {false};
+  };
+}  // namespace mtconnect::pipeline
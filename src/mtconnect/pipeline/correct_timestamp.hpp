@@ -25,10 +25,11 @@ namespace mtconnect::pipeline {
   class AGENT_LIB_API CorrectTimestamp : public Transform
   {
   protected:
-    struct State : TransformState
+    struct Shard : TransformState
     {
       std::unordered_map<std::string, Timestamp> m_timestamps;
     };
+    using State = ShardedTransformState<Shard>;
 
   public:
     CorrectTimestamp(const CorrectTimestamp &) = default;
@@ -58,23 +59,26 @@ namespace mtconnect::pipeline {
       auto &id = di->getId();
       auto ts = obs->getTimestamp();
 
-      std::lock_guard<TransformState> guard(*m_state);
-
-      auto last = m_state->m_timestamps.find(id);
-      if (last != m_state->m_timestamps.end())
       {
-        if (ts < last->second)
+        auto &shard = m_state->shard(id);
+        std::lock_guard<TransformState> guard(shard);
+
+        auto last = shard.m_timestamps.find(id);
+        if (last != shard.m_timestamps.end())
         {
-          LOG(debug) << "Observation for data item " << id << " has timestamp " << format(ts)
-                     << " thats is before " << format(last->second);
+          if (ts < last->second)
+          {
+            LOG(debug) << "Observation for data item " << id << " has timestamp " << format(ts)
+                       << " thats is before " << format(last->second);
 
-          // Set the timestamp to now.
-          ts = std::chrono::system_clock::now();
-          obs->setTimestamp(ts);
+            // Set the timestamp to now.
+            ts = std::chrono::system_clock::now();
+            obs->setTimestamp(ts);
+          }
         }
-      }
 
-      m_state->m_timestamps.insert_or_assign(id, ts);
+        shard.m_timestamps.insert_or_assign(id, ts);
+      }
 
       return next(std::move(obs));
     }
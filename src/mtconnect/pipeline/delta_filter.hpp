@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include <cmath>
+#include <limits>
+
 #include "mtconnect/config.hpp"
 #include "mtconnect/observation/observation.hpp"
 #include "transform.hpp"
@@ -25,21 +28,16 @@ namespace mtconnect {
   class Agent;
   namespace pipeline {
     /// @brief Provide MTConnect DataItem delta filter behavior
+    ///
+    /// The last value is kept on the data item so pipelines can filter in parallel without
+    /// locking.
     class AGENT_LIB_API DeltaFilter : public Transform
     {
     public:
-      /// @brief shared values associated with data items
-      struct State : TransformState
-      {
-        std::unordered_map<std::string, double> m_lastSampleValue;
-      };
-
       /// @brief Construct a delta filter
       /// @param[in] context the context for shared state
       DeltaFilter(PipelineContextPtr context)
-        : Transform("DeltaFilter"),
-          m_state(context->getSharedState<State>(m_name)),
-          m_contract(context->m_contract.get())
+        : Transform("DeltaFilter"), m_contract(context->m_contract.get())
       {
         using namespace observation;
         constexpr static auto lambda = [](const Sample &s) {
@@ -57,51 +55,38 @@ namespace mtconnect {
         using namespace observation;
         using namespace entity;
 
-        std::lock_guard<TransformState> guard(*m_state);
-
         auto o = std::dynamic_pointer_cast<Observation>(entity);
         if (o->isOrphan())
           return EntityPtr();
         auto di = o->getDataItem();
-        auto &id = di->getId();
 
         if (o->isUnavailable())
         {
-          m_state->m_lastSampleValue.erase(id);
+          di->setLastDeltaValue(numeric_limits<double>::quiet_NaN());
           return next(std::move(entity));
         }
 
         auto filter = *di->getMinimumDelta();
         double value = o->getValue<double>();
-        if (filterMinimumDelta(id, value, filter))
+        if (filterMinimumDelta(*di, value, filter))
           return EntityPtr();
 
         return next(std::move(entity));
       }
 
     protected:
-      bool filterMinimumDelta(const std::string &id, const double value, const double fv)
+      bool filterMinimumDelta(device_model::data_item::DataItem &di, const double value,
+                              const double fv)
       {
-        auto last = m_state->m_lastSampleValue.find(id);
-        if (last != m_state->m_lastSampleValue.end())
-        {
-          double lv = last->second;
-          if (value > (lv - fv) && value < (lv + fv))
-          {
-            return true;
-          }
-          last->second = value;
-        }
-        else
-        {
-          m_state->m_lastSampleValue[id] = value;
-        }
+        double lv = di.getLastDeltaValue();
+        if (!std::isnan(lv) && value > (lv - fv) && value < (lv + fv))
+          return true;
 
+        di.setLastDeltaValue(value);
         return false;
       }
 
     protected:
-      std::shared_ptr<State> m_state;
       PipelineContract *m_contract;
     };
   }  // namespace pipeline
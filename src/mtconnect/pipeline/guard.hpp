@@ -17,6 +17,10 @@
 
 #pragma once
 
+#include <functional>
+#include <optional>
+#include <type_traits>
+
 #include "mtconnect/config.hpp"
 #include "mtconnect/entity/entity.hpp"
 
@@ -30,8 +34,76 @@ namespace mtconnect {
       SKIP       ///< Skip the transform and move to the next
     };
 
+    /// @brief The entity properties a guard uses to make its decision
+    enum GuardDependency
+    {
+      TYPE_DEPENDENCY = 1,  ///< The dynamic type of the entity
+      NAME_DEPENDENCY = 2   ///< The name of the entity
+    };
+
+    class GuardCls;
+
     /// @brief Guard is a lambda function returning a `GuardAction` taking an entity
-    using Guard = std::function<GuardAction(const entity::Entity *entity)>;
+    ///
+    /// Guards built from `GuardCls` subclasses can also resolve their action from only the
+    /// dynamic type and name of an entity. This allows transforms to cache the routing for
+    /// each type of entity. Any other function is evaluated for every entity.
+    class AGENT_LIB_API Guard
+    {
+    public:
+      using Function = std::function<GuardAction(const entity::Entity *entity)>;
+      using Resolver = std::function<std::optional<GuardAction>(const entity::Entity *entity)>;
+
+      Guard() = default;
+      Guard(const Guard &) = default;
+      Guard(Guard &&) = default;
+      /// @brief Create a guard from a guard class or a function
+      /// @tparam F a callable taking a `const entity::Entity *` and returning a `GuardAction`
+      /// @param f the callable
+      template <typename F,
+                typename = std::enable_if_t<
+                    !std::is_same_v<std::decay_t<F>, Guard> &&
+                    std::is_invocable_r_v<GuardAction, std::decay_t<F> &, const entity::Entity *>>>
+      Guard(F &&f)
+      {
+        using G = std::decay_t<F>;
+        if constexpr (std::is_base_of_v<GuardCls, G>)
+        {
+          m_resolver = [g = G(f)](const entity::Entity *entity) mutable {
+            return g.resolve(entity);
+          };
+          m_dependencies = f.dependencies();
+        }
+        m_function = std::forward<F>(f);
+      }
+
+      Guard &operator=(const Guard &other) = default;
+      Guard &operator=(Guard &&other) = default;
+
+      /// @brief get the action for the entity
+      GuardAction operator()(const entity::Entity *entity) const { return m_function(entity); }
+      /// @brief `true` if the guard has a function
+      explicit operator bool() const { return bool(m_function); }
+
+      /// @brief Try to get the action using only the entity type and name
+      /// @param[in] entity the entity
+      /// @return the action or `nullopt` if the guard must be evaluated for every entity
+      std::optional<GuardAction> resolve(const entity::Entity *entity) const
+      {
+        if (m_resolver)
+          return m_resolver(entity);
+        else
+          return std::nullopt;
+      }
+
+      /// @brief the `GuardDependency` flags of the resolvable part of the guard
+      int getDependencies() const { return m_dependencies; }
+
+    protected:
+      Function m_function;
+      Resolver m_resolver;
+      int m_dependencies {0};
+    };
 
     /// @brief A simple GuardClass returning a simple match
     ///
@@ -45,6 +117,10 @@ namespace mtconnect {
       GuardCls(const GuardCls &) = default;
 
       GuardAction operator()(const entity::Entity *entity) { return m_action; }
+      /// @brief resolve the action from the entity type and name
+      std::optional<GuardAction> resolve(const entity::Entity *entity) { return m_action; }
+      /// @brief the `GuardDependency` flags of this guard and its alternative
+      int dependencies() const { return alternativeDependencies(); }
 
       /// @brief set the alternative guard
       /// @param alt alternative
@@ -64,6 +140,26 @@ namespace mtconnect {
           return CONTINUE;
       }
 
+      /// @brief resolve the matched state and the alternative without evaluating functions
+      /// @param matched if `true` return the action otherwise resolve the alternative
+      /// @param entity an entity
+      /// @return the guard action or `nullopt` if the alternative cannot be resolved
+      std::optional<GuardAction> resolveCheck(bool matched, const entity::Entity *entity)
+      {
+        if (matched)
+          return m_action;
+        else if (m_alternative)
+          return m_alternative.resolve(entity);
+        else
+          return CONTINUE;
+      }
+
+      /// @brief the dependencies of the alternative
+      int alternativeDependencies() const
+      {
+        return m_alternative ? m_alternative.getDependencies() : 0;
+      }
+
       /// @brief set the alternative to the other
       /// @param other a guard
       /// @return this
@@ -122,6 +218,13 @@ namespace mtconnect {
       {
         return check(matches(entity), entity);
       }
+      /// @brief resolve the action from the entity type
+      std::optional<GuardAction> resolve(const entity::Entity *entity)
+      {
+        return resolveCheck(matches(entity), entity);
+      }
+      /// @brief the `GuardDependency` flags of this guard and its alternative
+      int dependencies() const { return TYPE_DEPENDENCY | alternativeDependencies(); }
 
       /// @brief set the alternative action if this guard does not match
       auto &operator||(Guard other)
@@ -170,6 +273,13 @@ namespace mtconnect {
       {
         return check(matches(entity), entity);
       }
+      /// @brief resolve the action from the entity type
+      std::optional<GuardAction> resolve(const entity::Entity *entity)
+      {
+        return resolveCheck(matches(entity), entity);
+      }
+      /// @brief the `GuardDependency` flags of this guard and its alternative
+      int dependencies() const { return TYPE_DEPENDENCY | alternativeDependencies(); }
 
       /// @brief set the alternative action if this guard does not match
       auto &operator||(Guard other)
@@ -194,6 +304,13 @@ namespace mtconnect {
       {
         return check(matches(entity), entity);
       }
+      /// @brief resolve the action from the entity name
+      std::optional<GuardAction> resolve(const entity::Entity *entity)
+      {
+        return resolveCheck(matches(entity), entity);
+      }
+      /// @brief the `GuardDependency` flags of this guard and its alternative
+      int dependencies() const { return NAME_DEPENDENCY | alternativeDependencies(); }
 
       /// @brief set the alternative action if this guard does not match
       auto &operator||(Guard other)
@@ -244,6 +361,18 @@ namespace mtconnect {
       {
         return B::check(matches(entity), entity);
       }
+      /// @brief resolve the action if the base guard does not match
+      ///
+      /// The lambda must be evaluated for every entity that matches the base guard.
+      std::optional<GuardAction> resolve(const entity::Entity *entity)
+      {
+        if (B::matches(entity))
+          return std::nullopt;
+        else
+          return B::resolveCheck(false, entity);
+      }
+      /// @brief the `GuardDependency` flags of the base guard and its alternative
+      int dependencies() const { return B::dependencies(); }
 
       /// @brief set the alternative action if this guard does not match
       auto &operator||(Guard other)
@@ -32,6 +32,7 @@
 #include "mtconnect/entity/xml_parser.hpp"
 #include "mtconnect/observation/observation.hpp"
 #include "mtconnect/pipeline/timestamp_extractor.hpp"
+#include "shdr_token_mapper.hpp"
 #include "shdr_tokenizer.hpp"
 #include "timestamp_extractor.hpp"
 #include "topic_mapper.hpp"
@@ -42,6 +43,11 @@ namespace rj = ::rapidjson;
 
 namespace mtconnect::pipeline {
   using namespace mtconnect::entity;
+
+  /// @brief Messages are parsed in place, strings are decoded into the message buffer
+  constexpr unsigned ParseFlags = rj::kParseNanAndInfFlag | rj::kParseInsituFlag;
+  using JsonStream = rj::InsituStringStream;
+
   enum class Expectation
   {
     NONE,
@@ -108,6 +114,28 @@ namespace mtconnect::pipeline {
       return m_pipelineContext->m_contract->findDevice({name.data(), name.length()});
     }
 
+    /// @brief Resolve a key to a device or a data item of the current device
+    ///
+    /// Resolutions are cached by the mapper for each device, keys that cannot be resolved are
+    /// looked up every time.
+    /// @param[in] sv the key
+    /// @return the resolution or `nullptr` if the key is not a device or data item
+    const JsonMapper::Resolution *resolve(const std::string_view &sv)
+    {
+      auto &keys = (*m_resolutions)[getDevice().get()];
+      if (auto it = keys.find(sv); it != keys.end())
+        return &it->second;
+
+      JsonMapper::Resolution res;
+      res.m_device = getDevice(sv);
+      if (!res.m_device)
+        res.m_dataItem = getDataItemForDevice(sv);
+      if (!res.m_device && !res.m_dataItem)
+        return nullptr;
+
+      return &keys.emplace(std::string(sv), std::move(res)).first->second;
+    }
+
     /// @brief set the timestamp
     void setTimestamp(Timestamp &ts, optional<double> &duration)
     {
@@ -181,6 +209,7 @@ namespace mtconnect::pipeline {
 
     EntityList m_entities;
     PipelineContextPtr m_pipelineContext;
+    JsonMapper::DeviceResolutionMap *m_resolutions {nullptr};
     Forward m_forward;
     std::list<pair<DataItemPtr, entity::Properties>> m_queue;
   };
@@ -213,17 +242,17 @@ namespace mtconnect::pipeline {
       return true;
     }
 
-    bool operator()(rj::Reader &reader, rj::StringStream &buff)
+    bool operator()(rj::Reader &reader, JsonStream &buff)
     {
       LOG(warning) << "Consuming value due to error";
 
-      if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+      if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
         return false;
 
       while (m_depth > 0 && !reader.IterativeParseComplete())
       {
         // Read the key
-        if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+        if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
           return false;
       }
 
@@ -327,11 +356,11 @@ namespace mtconnect::pipeline {
     bool StartArray() { return false; }
     bool EndArray(rj::SizeType elementCount) { return false; }
 
-    bool operator()(rj::Reader &reader, rj::StringStream &buff)
+    bool operator()(rj::Reader &reader, JsonStream &buff)
     {
       // Parse initial object
       if (m_expectation == Expectation::OBJECT &&
-          !reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+          !reader.IterativeParseNext<ParseFlags>(buff, *this))
         return false;
 
       while (!reader.IterativeParseComplete() && !m_done)
@@ -339,7 +368,7 @@ namespace mtconnect::pipeline {
         // Read the key
         if (m_expectation == Expectation::KEY)
         {
-          if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+          if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
             return false;
           else if (m_done)
             break;
@@ -362,7 +391,7 @@ namespace mtconnect::pipeline {
         else
         {
           // Read the value
-          if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+          if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
             return false;
 
           if (m_expectation == Expectation::ROW)
@@ -436,7 +465,7 @@ namespace mtconnect::pipeline {
     template <typename T>
     void setValue(T value)
     {
-      m_props.insert_or_assign(m_key, value);
+      m_props.insert_or_assign(std::string(m_key), value);
     }
 
     bool Null()
@@ -579,13 +608,13 @@ namespace mtconnect::pipeline {
       return false;
     }
 
-    bool operator()(rj::Reader &reader, rj::StringStream &buff)
+    bool operator()(rj::Reader &reader, JsonStream &buff)
     {
       while (!reader.IterativeParseComplete() && !m_done)
       {
         if (m_expectation == Expectation::KEY)
         {
-          if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+          if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
             return false;
         }
 
@@ -603,14 +632,15 @@ namespace mtconnect::pipeline {
           {
             auto &value = m_props["VALUE"];
             DataSet &set = value.emplace<DataSet>();
-            DataSetHandler<DataSet, DataSetEntry> handler(set, m_key, m_dataItem->isTable());
+            DataSetHandler<DataSet, DataSetEntry> handler(set, string(m_key),
+                                                          m_dataItem->isTable());
             if (!handler(reader, buff))
               return false;
             m_expectation = Expectation::KEY;
           }
           else
           {
-            if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+            if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
               return false;
             else if (m_expectation != Expectation::VECTOR)
             {
@@ -635,7 +665,7 @@ namespace mtconnect::pipeline {
     Vector *m_vector {nullptr};
     bool m_done {false};
     bool m_object {false};
-    std::string m_key;
+    std::string_view m_key;
     Expectation m_expectation {Expectation::NONE};
     int m_depth {0};
   };
@@ -659,10 +689,10 @@ namespace mtconnect::pipeline {
       return true;
     }
 
-    bool operator()(rj::Reader &reader, rj::StringStream &buff)
+    bool operator()(rj::Reader &reader, JsonStream &buff)
     {
       auto success = (!reader.IterativeParseComplete() &&
-                      reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this));
+                      reader.IterativeParseNext<ParseFlags>(buff, *this));
       return success;
     }
 
@@ -733,12 +763,12 @@ namespace mtconnect::pipeline {
       return true;
     }
 
-    bool operator()(rj::Reader &reader, rj::StringStream &buff)
+    bool operator()(rj::Reader &reader, JsonStream &buff)
     {
       // Consume start object
       if (m_expectation == Expectation::OBJECT)
       {
-        if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+        if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
           return false;
       }
 
@@ -747,7 +777,7 @@ namespace mtconnect::pipeline {
       while (!m_done && !reader.IterativeParseComplete())
       {
         // Consume the key
-        if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+        if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
           return false;
 
         if (!m_done)
@@ -755,7 +785,7 @@ namespace mtconnect::pipeline {
           if (m_expectation == Expectation::ASSET)
           {
             // Consume the value
-            if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+            if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
               return false;
           }
           else
@@ -794,15 +824,16 @@ namespace mtconnect::pipeline {
         m_expectation = Expectation::ASSET;
       else
       {
-        auto device = m_context.getDevice(sv);
-        if (device)
+        auto res = m_context.resolve(sv);
+        if (res && res->m_device)
         {
-          m_context.m_device = device;
+          m_context.m_device = res->m_device;
           m_expectation = Expectation::OBJECT;
         }
         else
         {
-          m_dataItem = m_context.getDataItemForDevice(sv);
+          if (res)
+            m_dataItem = res->m_dataItem;
           if (!m_dataItem)
           {
             LOG(warning) << "Cannot find data item for " << sv;
@@ -831,14 +862,14 @@ namespace mtconnect::pipeline {
       return true;
     }
 
-    bool operator()(rj::Reader &reader, rj::StringStream &buff)
+    bool operator()(rj::Reader &reader, JsonStream &buff)
     {
       while (!m_complete && !reader.IterativeParseComplete())
       {
         // Consume the key
         if (m_expectation == Expectation::KEY)
         {
-          if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+          if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
             return false;
         }
 
@@ -954,11 +985,11 @@ namespace mtconnect::pipeline {
       return true;
     }
 
-    bool operator()(rj::Reader &reader, rj::StringStream &buff)
+    bool operator()(rj::Reader &reader, JsonStream &buff)
     {
       while (!reader.IterativeParseComplete() && !m_complete)
       {
-        if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+        if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
           return false;
 
         if (m_expectation == Expectation::OBJECT)
@@ -1003,11 +1034,11 @@ namespace mtconnect::pipeline {
     }
     bool EndArray(rj::SizeType elementCount) { return true; }
 
-    bool operator()(rj::Reader &reader, rj::StringStream &buff)
+    bool operator()(rj::Reader &reader, JsonStream &buff)
     {
       while (!reader.IterativeParseComplete())
       {
-        if (!reader.IterativeParseNext<rj::kParseNanAndInfFlag>(buff, *this))
+        if (!reader.IterativeParseNext<ParseFlags>(buff, *this))
           return false;
         if (m_expectation == Expectation::OBJECT)
         {
@@ -1038,15 +1069,21 @@ namespace mtconnect::pipeline {
   {
     static const auto GetParseError = rj::GetParseError_En;
 
+    checkDeviceModelVersion();
+
     auto source = entity->maybeGet<string>("source");
     auto json = std::dynamic_pointer_cast<JsonMessage>(entity);
     DevicePtr device = json->m_device.lock();
-    auto &body = entity->getValue<std::string>();
 
-    rj::StringStream buff(body.c_str());
+    // The message owns the buffer, parse it in place
+    auto &body = std::get<std::string>(entity->getValue());
+    auto size = body.size();
+
+    JsonStream buff(body.data());
     rj::Reader reader;
     reader.IterativeParseInit();
     ParserContext context(m_context);
+    context.m_resolutions = &m_resolutions;
     context.m_forward = [this](entity::EntityPtr &&entity) { next(std::move(entity)); };
     context.m_source = source;
 
@@ -1055,19 +1092,24 @@ namespace mtconnect::pipeline {
       handler.m_context.m_defaultDevice = device;
     handler(reader, buff);
 
-    EntityPtr res;
+    // End the message the same way the SHDR mapper ends a line so the transforms spliced after
+    // the mapper, such as a batch transform, see where the message ends
+    auto res = std::make_shared<Observations>("Observations", Properties {});
+    res->setValue(handler.m_context.m_entities);
+    auto fwd = next(res);
+
     if (reader.HasParseError())
     {
-      LOG(error) << "Error parsing json: " << body;
+      // The buffer has been modified by the parser up to the error
+      LOG(error) << "Error parsing json message of " << size << " bytes";
       LOG(error) << "Error code: " << GetParseError(reader.GetParseErrorCode()) << " at "
                  << reader.GetErrorOffset();
+      LOG(debug) << "Remainder of message: " << std::string_view(body).substr(
+                        std::min(size_t(reader.GetErrorOffset()), size));
+      return nullptr;
     }
-    else
-    {
-      res = std::make_shared<Entity>("JsonEntities");
-      res->setValue(handler.m_context.m_entities);
-    }
-    return res;
+
+    return fwd;
   }
 
 }  // namespace mtconnect::pipeline
@@ -17,6 +17,9 @@
 #pragma once
 
 #include <boost/algorithm/string.hpp>
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include <string_view>
 
 #include "mtconnect/asset/asset.hpp"
 #include "mtconnect/config.hpp"
@@ -28,12 +31,21 @@
 #include "transform.hpp"
 
 namespace mtconnect::pipeline {
-  /// @brief JsonMapper does nothing, it is a placeholder for a json interpreter
+  /// @brief Map JSON messages to observations and assets
+  ///
+  /// The message body is parsed in place: rapidjson decodes strings into the message's own
+  /// buffer and the handlers use views into it, so keys are never copied. The body is not
+  /// usable after the message is mapped. Keys are resolved to devices and data items once per
+  /// device and cached until the device model changes.
+  ///
+  /// Each message ends with an `Observations` entity holding the mapped entities, the same as
+  /// an SHDR line, and the pipeline must bind a transform for it.
   class AGENT_LIB_API JsonMapper : public Transform
   {
   public:
     JsonMapper(const JsonMapper &) = default;
-    JsonMapper(PipelineContextPtr context) : Transform("JsonMapper"), m_context(context)
+    JsonMapper(PipelineContextPtr context)
+      : Transform("JsonMapper"), m_context(context), m_contract(context->m_contract.get())
     {
       m_guard = TypeGuard<JsonMessage>(RUN);
     }
@@ -42,8 +54,46 @@ namespace mtconnect::pipeline {
     /// log the error.
     EntityPtr operator()(entity::EntityPtr &&entity) override;
 
+    /// @brief A JSON key resolved to a device or a data item
+    struct Resolution
+    {
+      DevicePtr m_device;      ///< set if the key is a device name or uuid
+      DataItemPtr m_dataItem;  ///< set if the key is a data item
+    };
+
+    /// @brief Resolutions by key
+    using ResolutionMap =
+        boost::unordered_flat_map<std::string, Resolution, StringViewHash, std::equal_to<>>;
+    /// @brief Resolutions by key for each device the keys are relative to
+    using DeviceResolutionMap =
+        boost::unordered_flat_map<const device_model::Device *, ResolutionMap>;
+
+    /// @brief Clear the cached resolutions if the device model has changed
+    void checkDeviceModelVersion()
+    {
+      auto version = m_contract->getDeviceModelVersion();
+      if (version != m_deviceModelVersion)
+      {
+        m_resolutions.clear();
+        m_deviceModelVersion = version;
+      }
+    }
+
+    /// @brief the number of cached key resolutions
+    /// @return the cache size
+    size_t getResolutionCacheSize() const
+    {
+      size_t size = 0;
+      for (auto &[device, keys] : m_resolutions)
+        size += keys.size();
+      return size;
+    }
+
   protected:
     PipelineContextPtr m_context;
+    PipelineContract *m_contract;
+    DeviceResolutionMap m_resolutions;
+    uint64_t m_deviceModelVersion {0};
   };
 
 }  // namespace mtconnect::pipeline
@@ -21,6 +21,7 @@
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/observation/observation.hpp"
+#include "timing_wheel.hpp"
 #include "transform.hpp"
 
 // #define DEBUG_PERIOD_FILTER 1
@@ -35,13 +36,7 @@ namespace mtconnect::pipeline {
     {
       /// @brief Construct a Last Observation
       /// @param p the amount of time in the period
-      /// @param st the strand to use for the time
-      LastObservation(std::chrono::milliseconds p, boost::asio::io_context::strand &st)
-        : m_timer(st.context()), m_period(p)
-      {}
-
-      /// @brief Make sure the timer is canceled.
-      ~LastObservation() { m_timer.cancel(); }
+      LastObservation(std::chrono::milliseconds p) : m_period(p) {}
 
       /// @brief The timestamp o the last observation or timestamp of the adjusted timestamp to
       /// the end of the last scheduled send time.
@@ -50,8 +45,8 @@ namespace mtconnect::pipeline {
       /// @brief The delayed observation.
       observation::ObservationPtr m_observation;
 
-      /// @brief A timer for delayed sends.
-      boost::asio::steady_timer m_timer;
+      /// @brief The timing wheel token for the delayed send, `0` if there is none.
+      uint64_t m_token {0};
 
       /// @brief Store the data item period here.
       std::chrono::milliseconds m_period;
@@ -60,20 +55,25 @@ namespace mtconnect::pipeline {
     using LastObservationMap = std::unordered_map<std::string, LastObservation>;
     using LastObservationIterator = LastObservationMap::iterator;
 
-    /// @brief A shared state variable containing the last observation
-    struct State : TransformState
+    /// @brief A shared state variable containing the last observation for a shard
+    struct Shard : TransformState
     {
       LastObservationMap m_lastObservation;
     };
+    /// @brief The last observations sharded by data item id
+    using State = ShardedTransformState<Shard>;
 
     /// @brief Construct a period filter with a context
+    ///
+    /// All the delayed sends for the pipeline are scheduled on one timing wheel.
     /// @param context the context
     /// @param st strand for the timer
     PeriodFilter(PipelineContextPtr context, boost::asio::io_context::strand &st)
       : Transform("PeriodFilter"),
         m_state(context->getSharedState<State>(m_name)),
         m_contract(context->m_contract.get()),
-        m_strand(st)
+        m_strand(st),
+        m_wheel(st, [this](const std::string &id, uint64_t token) { sendObservation(id, token); })
     {
       using namespace observation;
       constexpr static auto lambda = [](const Observation &s) {
@@ -92,26 +92,26 @@ namespace mtconnect::pipeline {
 
       auto obs = std::dynamic_pointer_cast<Observation>(entity);
       {
-        std::lock_guard<TransformState> guard(*m_state);
-
         if (obs->isOrphan())
           return EntityPtr();
 
         auto di = obs->getDataItem();
         auto &id = di->getId();
+        auto &shard = m_state->shard(id);
+        std::lock_guard<TransformState> guard(shard);
 
         if (obs->isUnavailable())
         {
-          m_state->m_lastObservation.erase(id);
+          shard.m_lastObservation.erase(id);
         }
         else
         {
-          auto last = m_state->m_lastObservation.find(id);
-          if (last == m_state->m_lastObservation.end())
+          auto last = shard.m_lastObservation.find(id);
+          if (last == shard.m_lastObservation.end())
           {
             auto period =
                 chrono::milliseconds(static_cast<int64_t>(*di->getMinimumPeriod() * 1000.0));
-            auto res = m_state->m_lastObservation.try_emplace(id, period, m_strand);
+            auto res = shard.m_lastObservation.try_emplace(id, period);
             if (res.second)
               last = res.first;
             else
@@ -177,7 +177,7 @@ namespace mtconnect::pipeline {
       {
         last.m_observation.reset();
         last.m_next += last.m_period;
-        last.m_timer.cancel();
+        last.m_token = 0;
 
 #ifdef DEBUG_PERIOD_FILTER
         std::cout << ">>>> On time, Sending " << format(ts) << std::endl;
@@ -212,7 +212,7 @@ namespace mtconnect::pipeline {
         // is an existing observation, then we send the last observation.
         if (last.m_observation)
         {
-          last.m_timer.cancel();
+          last.m_token = 0;
 #ifdef DEBUG_PERIOD_FILTER
           std::cout << "sending last: at " << format(last.m_observation->getTimestamp())
                     << std::endl;
@@ -235,52 +235,40 @@ namespace mtconnect::pipeline {
 
     void delayDelivery(LastObservation &last, const std::string &id)
     {
-      using std::placeholders::_1;
       using namespace std;
       using namespace chrono;
 
-      // Set the timer to expire in the remaining time left in the period given
-      // in last.m_delta
-      last.m_timer.cancel();
-      const auto now {system_clock::now()};
-      const auto delta = last.m_next - now;
-      last.m_timer.expires_after(delta);
+      // Schedule the send at the end of the period given in last.m_next. Replacing the token
+      // cancels any earlier send for this data item.
+      last.m_token = m_wheel.schedule(id, last.m_next);
 
 #ifdef DEBUG_PERIOD_FILTER
       std::cout << "Delaying " << format(last.m_observation->getTimestamp()) << " for "
-                << duration_cast<milliseconds>(delta).count() << std::endl;
+                << duration_cast<milliseconds>(last.m_next - system_clock::now()).count()
+                << std::endl;
 #endif
-      // Bind the strand so we do not have races. Use the data item id so there are
-      // no race conditions due to LastObservation lifecycle.
-      last.m_timer.async_wait([this, id](boost::system::error_code ec) {
-        boost::asio::dispatch(m_strand, boost::bind(&PeriodFilter::sendObservation, this, id, ec));
-      });
     }
 
-    void sendObservation(const std::string id, boost::system::error_code ec)
+    void sendObservation(const std::string &id, uint64_t token)
     {
-      if (ec)
-      {
-        // Do nothing if the delayed send was canceled.
-#ifdef DEBUG_PERIOD_FILTER
-        std::cout << "sendObservation: " << ec.message() << std::endl;
-#endif
-        return;
-      }
-
       using namespace std;
       using namespace chrono;
       using namespace observation;
 
       ObservationPtr obs;
       {
-        std::lock_guard<TransformState> guard(*m_state);
-
-        // Find the entry for this data item and make sure there is an observation
-        auto lastIt = m_state->m_lastObservation.find(id);
-        if (lastIt != m_state->m_lastObservation.end() && lastIt->second.m_observation)
+        auto &shard = m_state->shard(id);
+        std::lock_guard<TransformState> guard(shard);
+
+        // Find the entry for this data item and make sure this send was not canceled and
+        // there is an observation. Use the data item id so there are no race conditions due to
+        // LastObservation lifecycle.
+        auto lastIt = shard.m_lastObservation.find(id);
+        if (lastIt != shard.m_lastObservation.end() && lastIt->second.m_token == token &&
+            lastIt->second.m_observation)
         {
           auto &last = lastIt->second;
+          last.m_token = 0;
 
 #ifdef DEBUG_PERIOD_FILTER
           std::cout << "sendObservation: last timestamp is "
@@ -323,5 +311,6 @@ namespace mtconnect::pipeline {
     std::shared_ptr<State> m_state;
     PipelineContract *m_contract;
     boost::asio::io_context::strand &m_strand;
+    TimingWheel m_wheel;
   };
 }  // namespace mtconnect::pipeline
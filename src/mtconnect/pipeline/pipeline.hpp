@@ -20,6 +20,9 @@
 #include <boost/asio/dispatch.hpp>
 
 #include <future>
+#include <map>
+#include <mutex>
+#include <set>
 
 #include "mtconnect/config.hpp"
 #include "pipeline_context.hpp"
@@ -56,14 +59,20 @@ namespace mtconnect {
       /// @brief Pipeline constructor
       /// @param context The pipeline context
       /// @param st boost asio strand for for setting timers and running async operations
-      /// @note All pipelines run in a single strand (thread) and therefor all operations are
-      ///       thread-safe in one pipeline.
+      /// @note Each pipeline runs in its own strand and therefor all operations are thread-safe
+      ///       in one pipeline. Pipelines run in parallel on the worker threads, state shared
+      ///       between pipelines must be locked, see `ShardedTransformState`.
 
       Pipeline(PipelineContextPtr context, boost::asio::io_context::strand &st)
         : m_start(std::make_shared<Start>()), m_context(context), m_strand(st)
       {}
       /// @brief Destructor stops the pipeline
-      virtual ~Pipeline() { m_start->stop(); }
+      virtual ~Pipeline()
+      {
+        if (m_metricsPublisher)
+          m_metricsPublisher->stop();
+        m_start->stop();
+      }
       /// @brief Build the pipeline
       /// @param options A set of configuration options
       virtual void build(const ConfigOptions &options) = 0;
@@ -112,15 +121,42 @@ namespace mtconnect {
       }
 
       /// @brief start all the transforms that require asynchronous operations
+      ///
+      /// Also compiles the routing between the transforms.
       virtual void start()
       {
         if (m_start)
         {
+          m_start->compile(m_generation);
+          if (m_metricsEnabled)
+            instrument();
           m_start->start(m_strand);
           m_started = true;
         }
       }
 
+      /// @brief record the latency and entity count of every transform
+      ///
+      /// The transforms are instrumented when the pipeline starts. When disabled the only
+      /// overhead is a null check for each transform.
+      /// @param[in] enable `true` to instrument the transforms
+      /// @param[in] prefix if given, periodically publish the metrics to the agent data items
+      ///            `<prefix>_pipeline_latency` and `<prefix>_pipeline_throughput`
+      void setTransformMetrics(bool enable, const std::optional<std::string> &prefix = std::nullopt)
+      {
+        m_metricsEnabled = enable;
+        m_metricsPrefix = prefix;
+      }
+      /// @brief `true` if the transforms are instrumented when the pipeline starts
+      bool hasTransformMetrics() const { return m_metricsEnabled; }
+      /// @brief get the metrics for the instrumented transforms
+      /// @return the metrics in pipeline order
+      TransformMetricsList getTransformMetrics() const
+      {
+        std::lock_guard<std::mutex> lock(m_metricsMutex);
+        return m_transformMetrics;
+      }
+
       /// @brief Find all transforms that match the target
       /// @param[in] target the named transforms to find
       /// @return a list of all matching transforms
@@ -155,6 +191,7 @@ namespace mtconnect {
               [target, transform](Pipeline *pipe) { pipe->spliceBefore(target, transform, true); });
         }
 
+        recompile();
         return true;
       }
 
@@ -182,6 +219,7 @@ namespace mtconnect {
               [target, transform](Pipeline *pipe) { pipe->spliceAfter(target, transform, true); });
         }
 
+        recompile();
         return true;
       }
 
@@ -207,6 +245,7 @@ namespace mtconnect {
           m_splices.emplace_back(
               [target, transform](Pipeline *pipe) { pipe->firstAfter(target, transform, true); });
         }
+        recompile();
         return true;
       }
 
@@ -232,6 +271,7 @@ namespace mtconnect {
           m_splices.emplace_back(
               [target, transform](Pipeline *pipe) { pipe->lastAfter(target, transform, true); });
         }
+        recompile();
         return true;
       }
 
@@ -259,6 +299,7 @@ namespace mtconnect {
               [target, transform](Pipeline *pipe) { pipe->replace(target, transform, true); });
         }
 
+        recompile();
         return true;
       }
 
@@ -279,6 +320,7 @@ namespace mtconnect {
 
         m_splices.emplace_back([target](Pipeline *pipe) { pipe->remove(target); });
 
+        recompile();
         return true;
       }
 
@@ -293,6 +335,7 @@ namespace mtconnect {
       TransformPtr bind(TransformPtr transform)
       {
         m_start->bind(transform);
+        recompile();
         return transform;
       }
 
@@ -311,6 +354,13 @@ namespace mtconnect {
       const auto &getContract() { return m_context->m_contract; }
 
     protected:
+      /// @brief compile the routes of the transforms added to a started pipeline
+      void recompile()
+      {
+        if (m_started)
+          m_start->compile(m_generation);
+      }
+
       class AGENT_LIB_API Start : public Transform
       {
       public:
@@ -326,8 +376,59 @@ namespace mtconnect {
         }
       };
 
+      /// @brief attach metrics to each transform reachable from the start
+      void instrument()
+      {
+        TransformMetricsList metrics;
+        std::set<Transform *> visited;
+        std::map<std::string, int> names;
+
+        std::function<void(Transform *)> walk;
+        walk = [&](Transform *transform) {
+          for (auto &t : transform->getNext())
+          {
+            if (!visited.insert(t.get()).second)
+              continue;
+
+            auto name = t->getName();
+            if (auto n = ++names[name]; n > 1)
+              name += ":" + std::to_string(n);
+            auto m = std::make_shared<TransformMetrics>(name);
+            t->setMetrics(m);
+            metrics.emplace_back(m);
+            walk(t.get());
+          }
+        };
+        walk(m_start.get());
+
+        {
+          std::lock_guard<std::mutex> lock(m_metricsMutex);
+          m_transformMetrics = metrics;
+        }
+
+        if (m_metricsPublisher)
+          m_metricsPublisher->stop();
+        m_metricsPublisher.reset();
+        if (m_metricsPrefix && hasContract())
+        {
+          m_metricsPublisher = std::make_shared<PublishTransformMetrics>(
+              m_strand, m_context->m_contract.get(), *m_metricsPrefix, metrics);
+          m_metricsPublisher->start();
+        }
+      }
+
       void clearTransforms()
       {
+        if (m_metricsPublisher)
+        {
+          m_metricsPublisher->stop();
+          m_metricsPublisher.reset();
+        }
+        {
+          std::lock_guard<std::mutex> lock(m_metricsMutex);
+          m_transformMetrics.clear();
+        }
+
         m_start->stop();
         m_started = false;
         m_start->clear();
@@ -336,9 +437,16 @@ namespace mtconnect {
 
       bool m_started {false};
       TransformPtr m_start;
+      RouteGeneration m_generation {std::make_shared<std::atomic<uint64_t>>(0)};
       PipelineContextPtr m_context;
       boost::asio::io_context::strand m_strand;
       std::list<Splice> m_splices;
+
+      bool m_metricsEnabled {false};
+      std::optional<std::string> m_metricsPrefix;
+      TransformMetricsList m_transformMetrics;
+      std::shared_ptr<PublishTransformMetrics> m_metricsPublisher;
+      mutable std::mutex m_metricsMutex;
     };
   }  // namespace pipeline
 }  // namespace mtconnect
@@ -17,8 +17,11 @@
 
 #pragma once
 
+#include <array>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 
 #include "mtconnect/config.hpp"
@@ -44,6 +47,26 @@ namespace mtconnect::pipeline {
   };
   using TransformStatePtr = std::shared_ptr<TransformState>;
 
+  /// @brief Shared state split into independently locked shards by data item id
+  ///
+  /// Pipelines run in parallel, so a single lock for all data items serializes every
+  /// pipeline using the transform. With shards, pipelines only contend when they update data
+  /// items in the same shard.
+  ///
+  /// @tparam S the state for each shard. Must be a subclass of `TransformState`.
+  /// @tparam N the number of shards
+  template <typename S, size_t N = 32>
+  struct ShardedTransformState : TransformState
+  {
+    /// @brief get the shard for a data item
+    /// @param[in] id the data item id
+    /// @return the shard, lock it before accessing its state
+    S &shard(const std::string &id) { return m_shards[std::hash<std::string> {}(id) % N]; }
+
+    /// @brief the shards
+    std::array<S, N> m_shards;
+  };
+
   /// @brief Manages shared state across multiple pipelines
   ///
   /// Used for cases like duplicate detection and shared counters.
@@ -60,6 +83,7 @@ namespace mtconnect::pipeline {
     template <typename T>
     std::shared_ptr<T> getSharedState(const std::string &name)
     {
+      std::lock_guard<std::mutex> lock(m_mutex);
       auto &state = m_sharedState[name];
       if (!state)
         state = std::make_shared<T>();
@@ -72,6 +96,7 @@ namespace mtconnect::pipeline {
   protected:
     using SharedState = std::unordered_map<std::string, TransformStatePtr>;
     SharedState m_sharedState;
+    std::mutex m_mutex;
   };
 
   /// @brief Alias for a shared pointer to the pipeline context
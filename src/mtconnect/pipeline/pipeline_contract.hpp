@@ -116,6 +116,12 @@ namespace mtconnect {
       /// @returns `obs` if it is not a duplicate, `nullptr` if it is. The observation
       /// may be modified if the observation needs to be subset.
       virtual const ObservationPtr checkDuplicate(const ObservationPtr &obs) const = 0;
+
+      /// @brief get a counter that is incremented every time the device model changes
+      ///
+      /// Used by transforms that cache device model lookups to know when to invalidate.
+      /// @returns the device model version
+      virtual uint64_t getDeviceModelVersion() const { return 0; }
     };
   }  // namespace pipeline
 }  // namespace mtconnect
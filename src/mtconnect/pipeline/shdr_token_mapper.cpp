@@ -51,16 +51,6 @@ namespace mtconnect {
         return {sv, nullopt};
     }
 
-    inline static std::pair<std::string, std::optional<std::string>> splitKey(
-        const std::string &key)
-    {
-      auto c = key.find(':');
-      if (c != string::npos)
-        return {key.substr(c + 1, string::npos), key.substr(0, c)};
-      else
-        return {key, nullopt};
-    }
-
     // --------------------------------------
     // Mapping to data items
     static entity::Requirements s_condition {{"level", true},
@@ -203,84 +193,104 @@ namespace mtconnect {
       return Observation::make(dataItem, props, timestamp, errors);
     }
 
-    EntityPtr ShdrTokenMapper::mapTokensToDataItem(const Timestamp &timestamp,
-                                                   const std::optional<std::string> &source,
-                                                   TokenList::const_iterator &token,
-                                                   const TokenList::const_iterator &end,
-                                                   ErrorList &errors)
+    static inline const entity::Requirements *requirementsFor(const DataItemPtr &dataItem)
     {
-      NAMED_SCOPE("DataItemMapper.ShdrTokenMapper.mapTokensToDataItem");
-      auto key = *token++;
-      DataItemPtr dataItem;
-      auto dataItemIt = m_dataItemMap.find(key);
-      if (dataItemIt == m_dataItemMap.end() || !(dataItem = dataItemIt->second.lock()))
-      {
-        auto dataItemKey = splitKey(key);
-        string device {dataItemKey.second.value_or(m_defaultDevice.value_or(""))};
-        dataItem = m_contract->findDataItem(device, dataItemKey.first);
-
-        if (dataItem == nullptr)
-        {
-          // resync to next item
-          if (m_logOnce.count(dataItemKey.first) > 0)
-            LOG(trace) << "Could not find data item: " << dataItemKey.first;
-          else
-          {
-            LOG(info) << "Could not find data item: " << dataItemKey.first;
-            m_logOnce.insert(dataItemKey.first);
-          }
-
-          // Skip following tolken if we are in legacy mode
-          if (m_shdrVersion < 2 && token != end)
-            token++;
-
-          return nullptr;
-        }
-
-        m_dataItemMap[key] = dataItem;
-      }
-      //      else
-      //      {
-      //        LOG(trace) << "Mapped " << key;
-      //      }
-
-      entity::Requirements *reqs {nullptr};
-
       // Extract the remaining tokens
       if ((dataItem->isDataSet() || dataItem->isTable()) &&
           (dataItem->isSample() || dataItem->isEvent()))
       {
-        reqs = &s_dataSet;
+        return &s_dataSet;
       }
       else if (dataItem->isSample())
       {
         if (dataItem->isTimeSeries())
-          reqs = &s_timeseries;
+          return &s_timeseries;
         else if (dataItem->isThreeSpace())
-          reqs = &s_threeSpaceSample;
+          return &s_threeSpaceSample;
         else
-          reqs = &s_sample;
+          return &s_sample;
       }
       else if (dataItem->isEvent())
       {
         if (dataItem->isMessage())
-          reqs = &s_message;
+          return &s_message;
         else if (dataItem->isAlarm())
-          reqs = &s_alarm;
+          return &s_alarm;
         else if (dataItem->isAssetChanged() || dataItem->isAssetRemoved())
-          reqs = &s_assetEvent;
+          return &s_assetEvent;
         else
-          reqs = &s_event;
+          return &s_event;
       }
       else if (dataItem->isCondition())
       {
-        reqs = &s_condition;
+        return &s_condition;
+      }
+
+      return nullptr;
+    }
+
+    const ShdrTokenMapper::Resolution *ShdrTokenMapper::resolve(std::string_view key)
+    {
+      if (auto it = m_resolutions.find(key); it != m_resolutions.end())
+        return &it->second;
+
+      string name, device;
+      auto c = key.find(':');
+      if (c != string_view::npos)
+      {
+        name = key.substr(c + 1);
+        device = key.substr(0, c);
+      }
+      else
+      {
+        name = key;
+        device = m_defaultDevice.value_or("");
       }
 
-      if (reqs != nullptr)
+      auto dataItem = m_contract->findDataItem(device, name);
+      if (dataItem == nullptr)
       {
-        auto obs = zipProperties(dataItem, timestamp, *reqs, token, end, errors,
-                                 m_contract->getSchemaVersion(), m_contract->isValidating());
+        // resync to next item
+        if (m_logOnce.count(name) > 0)
+          LOG(trace) << "Could not find data item: " << name;
+        else
+        {
+          LOG(info) << "Could not find data item: " << name;
+          m_logOnce.insert(name);
+        }
+
+        return nullptr;
+      }
+
+      auto res =
+          m_resolutions.emplace(string(key), Resolution {dataItem, requirementsFor(dataItem)});
+      return &res.first->second;
+    }
+
+    EntityPtr ShdrTokenMapper::mapTokensToDataItem(const Timestamp &timestamp,
+                                                   const std::optional<std::string> &source,
+                                                   TokenList::const_iterator &token,
+                                                   const TokenList::const_iterator &end,
+                                                   ErrorList &errors)
+    {
+      NAMED_SCOPE("DataItemMapper.ShdrTokenMapper.mapTokensToDataItem");
+      const auto &key = *token++;
+      auto resolution = resolve(key);
+      if (resolution == nullptr)
+      {
+        // Skip following tolken if we are in legacy mode
+        if (m_shdrVersion < 2 && token != end)
+          token++;
+
+        return nullptr;
+      }
+
+      const auto &dataItem = resolution->m_dataItem;
+      if (resolution->m_requirements != nullptr)
+      {
+        auto obs = zipProperties(dataItem, timestamp, *resolution->m_requirements, token, end,
+                                 errors, m_contract->getSchemaVersion(),
+                                 m_contract->isValidating());
         if (dataItem->getConstantValue())
           return nullptr;
         if (obs && source)
@@ -374,6 +384,8 @@ namespace mtconnect {
       NAMED_SCOPE("DataItemMapper.ShdrTokenMapper.operator");
       if (auto timestamped = std::dynamic_pointer_cast<Timestamped>(entity))
       {
+        checkDeviceModelVersion();
+
         // Don't copy the tokens.
         auto res = std::make_shared<Observations>(*timestamped, TokenList {});
         EntityList entities;
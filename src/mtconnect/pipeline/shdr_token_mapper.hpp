@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include <boost/unordered/unordered_flat_map.hpp>
+
 #include <chrono>
 #include <regex>
+#include <string_view>
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/entity/entity.hpp"
@@ -73,12 +76,45 @@ namespace mtconnect::pipeline {
                                TokenList::const_iterator &token,
                                const TokenList::const_iterator &end, ErrorList &errors);
 
+    /// @brief A resolved SHDR key with the data item and the requirements to map its tokens
+    struct Resolution
+    {
+      DataItemPtr m_dataItem;
+      const entity::Requirements *m_requirements {nullptr};
+    };
+
+    /// @brief Resolve a SHDR key (`[device:]name`) to a data item using the resolution cache
+    ///
+    /// The cache is keyed by the raw key and is cleared when the device model version changes.
+    /// @param[in] key the key from the SHDR token stream
+    /// @return the resolution or `nullptr` if the data item cannot be found
+    const Resolution *resolve(std::string_view key);
+
+    /// @brief Clear the cached resolutions if the device model has changed
+    void checkDeviceModelVersion()
+    {
+      auto version = m_contract->getDeviceModelVersion();
+      if (version != m_deviceModelVersion)
+      {
+        m_resolutions.clear();
+        m_deviceModelVersion = version;
+      }
+    }
+
+    /// @brief the number of cached data item resolutions
+    /// @return the cache size
+    size_t getResolutionCacheSize() const { return m_resolutions.size(); }
+
   protected:
+    using ResolutionMap =
+        boost::unordered_flat_map<std::string, Resolution, StringViewHash, std::equal_to<>>;
+
     // Logging Context
     std::set<std::string> m_logOnce;
     PipelineContract *m_contract;
     std::optional<std::string> m_defaultDevice;
-    std::unordered_map<std::string, WeakDataItemPtr> m_dataItemMap;
+    ResolutionMap m_resolutions;
+    uint64_t m_deviceModelVersion {0};
     int m_shdrVersion {1};
   };
 }  // namespace mtconnect::pipeline
@@ -0,0 +1,104 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "timing_wheel.hpp"
+
+#include <boost/asio/bind_executor.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+namespace mtconnect::pipeline {
+  std::atomic_uint64_t TimingWheel::s_nextToken {1};
+
+  uint64_t TimingWheel::schedule(const std::string &key, Timestamp deadline)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Nothing is pending, so the wheel can start from the current time
+    if (m_size == 0)
+      m_current = tickFor(chrono::system_clock::now());
+
+    // Round up so a deadline never expires early
+    auto since = deadline.time_since_epoch();
+    auto tick = since / m_resolution;
+    if (since % m_resolution != decltype(since)::zero())
+      tick++;
+    tick = max<int64_t>(tick, m_current + 1);
+
+    auto token = s_nextToken++;
+    slot(tick).push_back({tick, token, key});
+    m_size++;
+
+    if (!m_armed || tick < m_armedTick)
+      arm();
+
+    return token;
+  }
+
+  void TimingWheel::arm()
+  {
+    // Skip over the empty slots so an idle wheel does not wake up every tick
+    auto next = m_current + 1;
+    auto end = m_current + int64_t(m_slots.size());
+    while (next < end && slot(next).empty())
+      next++;
+
+    m_armed = true;
+    m_armedTick = next;
+    m_timer.expires_after(Timestamp(m_resolution * next) - chrono::system_clock::now());
+    m_timer.async_wait(boost::asio::bind_executor(
+        m_strand, [this](boost::system::error_code ec) { tick(ec); }));
+  }
+
+  void TimingWheel::tick(boost::system::error_code ec)
+  {
+    // The timer is canceled when it is rearmed or the wheel is destroyed
+    if (ec)
+      return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_armed = false;
+    auto now = tickFor(chrono::system_clock::now());
+
+    // Visit each slot at most once if the timer was delayed for more than a revolution
+    vector<Entry> due;
+    auto last = min(now, m_current + int64_t(m_slots.size()));
+    for (auto t = m_current + 1; t <= last; t++)
+    {
+      auto &entries = slot(t);
+      auto it = partition(entries.begin(), entries.end(),
+                          [now](const Entry &e) { return e.m_tick > now; });
+      move(it, entries.end(), back_inserter(due));
+      entries.erase(it, entries.end());
+    }
+    m_current = max(m_current, now);
+    m_size -= due.size();
+
+    // The expired function may schedule new deadlines and takes the locks held by callers of
+    // schedule, so it is called without the mutex
+    lock.unlock();
+    for (auto &e : due)
+      m_expired(e.m_key, e.m_token);
+
+    lock.lock();
+    if (m_size > 0 && !m_armed)
+      arm();
+  }
+}  // namespace mtconnect::pipeline
@@ -0,0 +1,117 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <boost/asio/io_context_strand.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::pipeline {
+  /// @brief A hashed timing wheel that services many deadlines with a single timer
+  ///
+  /// Deadlines are rounded up to the next tick and placed in the slot for that tick modulo the
+  /// number of slots. The timer only runs while there are deadlines pending and all the
+  /// expired deadlines are delivered together from the strand.
+  ///
+  /// Entries cannot be removed. Each scheduled deadline has a unique token, the receiver
+  /// ignores a token it is no longer waiting for.
+  ///
+  /// Deadlines can be scheduled from any thread. The wheel state is protected by a mutex that
+  /// is not held while the expired function is called, so the expired function may take locks
+  /// that are held when scheduling.
+  class AGENT_LIB_API TimingWheel
+  {
+  public:
+    /// @brief Called with the key and token of each expired deadline
+    using Expired = std::function<void(const std::string &key, uint64_t token)>;
+
+    /// @brief Create a timing wheel
+    /// @param strand the strand for the timer and the callbacks
+    /// @param expired the function called for each expired deadline
+    /// @param resolution the time between ticks
+    /// @param slots the number of slots, deadlines more than `slots * resolution` in the future
+    ///        remain in the slot for more than one revolution
+    TimingWheel(boost::asio::io_context::strand &strand, Expired expired,
+                std::chrono::milliseconds resolution = std::chrono::milliseconds(1),
+                size_t slots = 1024)
+      : m_strand(strand),
+        m_timer(strand.context()),
+        m_expired(std::move(expired)),
+        m_resolution(resolution),
+        m_slots(slots)
+    {}
+    ~TimingWheel()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_timer.cancel();
+    }
+
+    /// @brief Schedule a deadline
+    /// @param key the key passed to the expired function
+    /// @param deadline the deadline, a deadline in the past expires on the next tick
+    /// @return the token for the deadline, never `0`
+    uint64_t schedule(const std::string &key, Timestamp deadline);
+
+    /// @brief get the number of pending deadlines
+    size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_size;
+    }
+    /// @brief get the time between ticks
+    auto getResolution() const { return m_resolution; }
+
+  protected:
+    struct Entry
+    {
+      int64_t m_tick;
+      uint64_t m_token;
+      std::string m_key;
+    };
+
+    int64_t tickFor(Timestamp time) const { return time.time_since_epoch() / m_resolution; }
+    std::vector<Entry> &slot(int64_t tick) { return m_slots[size_t(tick) % m_slots.size()]; }
+    /// @brief start the timer for the next pending slot, called with the mutex held
+    void arm();
+    void tick(boost::system::error_code ec);
+
+  protected:
+    mutable std::mutex m_mutex;
+    boost::asio::io_context::strand &m_strand;
+    boost::asio::steady_timer m_timer;
+    Expired m_expired;
+    std::chrono::milliseconds m_resolution;
+    std::vector<std::vector<Entry>> m_slots;
+    int64_t m_current {0};
+    int64_t m_armedTick {0};
+    size_t m_size {0};
+    bool m_armed {false};
+
+    static std::atomic_uint64_t s_nextToken;
+  };
+}  // namespace mtconnect::pipeline
@@ -17,10 +17,13 @@
 #pragma once
 
 #include <boost/algorithm/string.hpp>
+#include <boost/unordered/unordered_flat_map.hpp>
 
 #include <chrono>
-#include <regex>
-#include <unordered_map>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <vector>
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/device_model/device.hpp"
@@ -28,6 +31,7 @@
 #include "mtconnect/observation/observation.hpp"
 #include "shdr_tokenizer.hpp"
 #include "timestamp_extractor.hpp"
+#include "topic_trie.hpp"
 #include "transform.hpp"
 
 namespace mtconnect::pipeline {
@@ -58,16 +62,58 @@ namespace mtconnect::pipeline {
   };
 
   /// @brief A transform to map the topic to a data item
+  ///
+  /// Topics are matched against a TopicTrie built from the device model when the first message
+  /// arrives and rebuilt when the device model changes. For each subscription in `Topics`, the
+  /// levels before the trailing wildcards are a prefix followed by `<device>/<data item>` or
+  /// `<data item>` for the default device, where the device is the name or uuid and the data
+  /// item is the name or id. A topic that does not match is resolved by scanning its levels.
+  ///
+  /// The result for each exact topic, including topics that cannot be resolved, is remembered
+  /// until the device model changes.
   class AGENT_LIB_API TopicMapper : public Transform
   {
   public:
+    /// @brief The device and data item for a topic
+    struct Resolution
+    {
+      DevicePtr m_device;
+      DataItemPtr m_dataItem;
+    };
+    using ResolutionMap =
+        boost::unordered_flat_map<std::string, Resolution, StringViewHash, std::equal_to<>>;
+
     TopicMapper(const TopicMapper &) = default;
-    TopicMapper(PipelineContextPtr context, const std::optional<std::string> &device = std::nullopt)
-      : Transform("TopicMapper"), m_context(context), m_defaultDeviceName(device)
+    /// @brief Create a topic mapper
+    /// @param context the pipeline context
+    /// @param device the default device
+    /// @param topics the subscribed topic filters
+    TopicMapper(PipelineContextPtr context, const std::optional<std::string> &device = std::nullopt,
+                const StringList &topics = {})
+      : Transform("TopicMapper"),
+        m_context(context),
+        m_contract(context->m_contract.get()),
+        m_defaultDeviceName(device)
     {
       m_guard = EntityNameGuard("Message", RUN);
       if (m_defaultDeviceName)
-        m_defaultDevice = m_context->m_contract->findDevice(*m_defaultDeviceName);
+        m_defaultDevice = m_contract->findDevice(*m_defaultDeviceName);
+
+      for (auto &topic : topics)
+      {
+        // Remove the trailing wildcard levels to get the prefix before the device and data item
+        std::string_view prefix(topic);
+        while (!prefix.empty())
+        {
+          auto slash = prefix.rfind('/');
+          auto level = prefix.substr(slash == std::string_view::npos ? 0 : slash + 1);
+          if (level != "+" && level != "#")
+            break;
+          prefix = prefix.substr(0, slash == std::string_view::npos ? 0 : slash);
+        }
+        if (!prefix.empty())
+          m_prefixes.emplace_back(prefix);
+      }
     }
 
     /// @brief Try to find a matching data item for the given topic
@@ -77,10 +123,9 @@ namespace mtconnect::pipeline {
     /// 2. Try the default device and the data item name or id
     /// 3. Scan the path for any matching device and data item
     ///
-    /// If found, remember the mapping of the topic to the data item
     /// @param topic the topic
-    /// @return
-    auto resolve(const std::string &topic)
+    /// @return the device and data item, either may be `nullptr`
+    std::tuple<DevicePtr, DataItemPtr> resolve(const std::string &topic)
     {
       using namespace std;
       namespace algo = boost::algorithm;
@@ -97,27 +142,27 @@ namespace mtconnect::pipeline {
       {
         deviceName = path[0];
         name = path[1];
-        dataItem = m_context->m_contract->findDataItem(deviceName, name);
+        dataItem = m_contract->findDataItem(deviceName, name);
       }
 
       if (!dataItem)
       {
         deviceName = m_defaultDeviceName.value_or("");
         name = topic;
-        dataItem = m_context->m_contract->findDataItem(deviceName, name);
+        dataItem = m_contract->findDataItem(deviceName, name);
       }
 
       if (!dataItem && path.size() > 1)
       {
         name = path.back();
-        dataItem = m_context->m_contract->findDataItem(deviceName, name);
+        dataItem = m_contract->findDataItem(deviceName, name);
       }
 
       if (!dataItem)
       {
         for (auto &tok : path)
         {
-          device = m_context->m_contract->findDevice(tok);
+          device = m_contract->findDevice(tok);
           if (device)
             break;
         }
@@ -133,13 +178,54 @@ namespace mtconnect::pipeline {
         }
       }
 
+      return std::make_tuple(device, dataItem);
+    }
+
+    /// @brief Find the device and data item for a topic
+    ///
+    /// Uses the remembered result, the topic trie, and then resolve().
+    /// @param topic the topic
+    /// @return the resolution
+    const Resolution &lookup(std::string_view topic)
+    {
+      checkDeviceModelVersion();
+
+      if (auto it = m_resolved.find(topic); it != m_resolved.end())
+        return it->second;
+
+      Resolution res;
+      if (auto match = m_trie.match(topic))
+      {
+        res = *match;
+      }
+      else
+      {
+        std::tie(res.m_device, res.m_dataItem) = resolve(std::string(topic));
+      }
+
       // Note even if null so we don't have to try again
-      m_resolved[topic] = dataItem;
-      m_devices[topic] = device;
+      return m_resolved.emplace(std::string(topic), std::move(res)).first->second;
+    }
 
-      return std::make_tuple(device, dataItem);
+    /// @brief Rebuild the trie and forget resolved topics if the device model changed
+    void checkDeviceModelVersion()
+    {
+      auto version = m_contract->getDeviceModelVersion();
+      if (!m_deviceModelVersion || *m_deviceModelVersion != version)
+      {
+        m_resolved.clear();
+        if (m_defaultDeviceName)
+          m_defaultDevice = m_contract->findDevice(*m_defaultDeviceName);
+        buildTrie();
+        m_deviceModelVersion = version;
+      }
     }
 
+    /// @brief get the number of filters in the topic trie
+    size_t getTrieSize() const { return m_trie.size(); }
+    /// @brief get the number of topics with remembered results
+    size_t getResolvedCount() const { return m_resolved.size(); }
+
     EntityPtr operator()(entity::EntityPtr &&entity) override
     {
       PipelineMessagePtr result;
@@ -160,18 +246,9 @@ namespace mtconnect::pipeline {
         entity::Properties props {entity->getProperties()};
         if (auto topic = entity->maybeGet<std::string>("topic"))
         {
-          if (auto it = m_devices.find(*topic); it != m_devices.end())
-          {
-            device = it->second.lock();
-          }
-          if (auto it = m_resolved.find(*topic); it != m_resolved.end())
-          {
-            dataItem = it->second.lock();
-          }
-          if (!dataItem && !device)
-          {
-            std::tie(device, dataItem) = resolve(*topic);
-          }
+          auto &res = lookup(*topic);
+          device = res.m_device;
+          dataItem = res.m_dataItem;
         }
 
         result = std::make_shared<DataMessage>("DataMessage", props);
@@ -182,11 +259,57 @@ namespace mtconnect::pipeline {
       return next(result);
     }
 
+  protected:
+    void buildTrie()
+    {
+      m_trie.clear();
+
+      // Device qualified filters are inserted first so they take precedence
+      std::vector<std::pair<std::string, Resolution>> unqualified;
+      m_contract->eachDataItem([&](const DataItemPtr di) {
+        auto component = di->getComponent();
+        auto device = component ? component->getDevice() : nullptr;
+        if (!device)
+          return;
+
+        std::vector<std::string> devices, names {di->getId()};
+        if (auto &name = device->getComponentName())
+          devices.emplace_back(*name);
+        if (auto &uuid = device->getUuid())
+          devices.emplace_back(*uuid);
+        if (auto &name = di->getName(); name && *name != di->getId())
+          names.emplace_back(*name);
+
+        Resolution res {device, di};
+        for (auto &name : names)
+        {
+          for (auto &dev : devices)
+          {
+            auto filter = dev + '/' + name;
+            m_trie.insert(filter, res);
+            for (auto &prefix : m_prefixes)
+              m_trie.insert(prefix + '/' + filter, res);
+          }
+          if (device == m_defaultDevice)
+            unqualified.emplace_back(name, res);
+        }
+      });
+
+      for (auto &[name, res] : unqualified)
+      {
+        for (auto &prefix : m_prefixes)
+          m_trie.insert(prefix + '/' + name, res);
+      }
+    }
+
   protected:
     PipelineContextPtr m_context;
+    PipelineContract *m_contract;
     std::optional<std::string> m_defaultDeviceName;
     DevicePtr m_defaultDevice;
-    std::unordered_map<std::string, std::weak_ptr<device_model::data_item::DataItem>> m_resolved;
-    std::unordered_map<std::string, std::weak_ptr<device_model::Device>> m_devices;
+    std::vector<std::string> m_prefixes;
+    TopicTrie<Resolution> m_trie;
+    ResolutionMap m_resolved;
+    std::optional<uint64_t> m_deviceModelVersion;
   };
 }  // namespace mtconnect::pipeline
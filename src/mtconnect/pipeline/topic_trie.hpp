@@ -0,0 +1,135 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::pipeline {
+  /// @brief A trie of MQTT topic filters split on `/`
+  ///
+  /// Filters may contain the MQTT wildcards `+`, matching exactly one level, and `#`, matching
+  /// the remaining levels and only allowed as the last level. When more than one filter matches
+  /// a topic, the most specific one wins: at each level a literal match is preferred over `+`,
+  /// which is preferred over `#`.
+  ///
+  /// @tparam T the value associated with each filter
+  template <typename T>
+  class TopicTrie
+  {
+  public:
+    /// @brief Add a filter to the trie
+    /// @param[in] filter the topic filter
+    /// @param[in] value the value for the filter
+    /// @return `false` if the filter was already present, the existing value is kept
+    bool insert(std::string_view filter, T value)
+    {
+      Node *node = &m_root;
+      for (size_t pos = 0;;)
+      {
+        auto end = filter.find('/', pos);
+        auto level = filter.substr(pos, end == std::string_view::npos ? end : end - pos);
+        if (level == "#")
+        {
+          if (node->m_rest)
+            return false;
+          node->m_rest.emplace(std::move(value));
+          m_size++;
+          return true;
+        }
+
+        auto &child = level == "+" ? node->m_any
+                                   : node->m_children.try_emplace(std::string(level)).first->second;
+        if (!child)
+          child = std::make_unique<Node>();
+        node = child.get();
+
+        if (end == std::string_view::npos)
+          break;
+        pos = end + 1;
+      }
+
+      if (node->m_value)
+        return false;
+      node->m_value.emplace(std::move(value));
+      m_size++;
+      return true;
+    }
+
+    /// @brief Find the most specific filter matching a topic
+    /// @param[in] topic the topic, may not contain wildcards
+    /// @return the value for the filter or `nullptr` if no filter matches
+    const T *match(std::string_view topic) const { return match(m_root, topic, 0); }
+
+    /// @brief remove all filters
+    void clear()
+    {
+      m_root = Node();
+      m_size = 0;
+    }
+    /// @brief get the number of filters
+    size_t size() const { return m_size; }
+    /// @brief `true` if there are no filters
+    bool empty() const { return m_size == 0; }
+
+  protected:
+    struct Node
+    {
+      boost::unordered_flat_map<std::string, std::unique_ptr<Node>, StringViewHash,
+                                std::equal_to<>>
+          m_children;
+      std::unique_ptr<Node> m_any;
+      std::optional<T> m_value;
+      std::optional<T> m_rest;
+    };
+
+    const T *match(const Node &node, std::string_view topic, size_t pos) const
+    {
+      // Past the last level, `a/#` also matches `a`
+      if (pos > topic.size())
+        return node.m_value ? &*node.m_value : (node.m_rest ? &*node.m_rest : nullptr);
+
+      auto end = topic.find('/', pos);
+      auto level = topic.substr(pos, end == std::string_view::npos ? end : end - pos);
+      auto next = end == std::string_view::npos ? topic.size() + 1 : end + 1;
+
+      if (auto it = node.m_children.find(level); it != node.m_children.end())
+      {
+        if (auto res = match(*it->second, topic, next))
+          return res;
+      }
+      if (node.m_any)
+      {
+        if (auto res = match(*node.m_any, topic, next))
+          return res;
+      }
+      return node.m_rest ? &*node.m_rest : nullptr;
+    }
+
+  protected:
+    Node m_root;
+    size_t m_size {0};
+  };
+}  // namespace mtconnect::pipeline
@@ -20,10 +20,17 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/io_context_strand.hpp>
 
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <typeinfo>
+#include <vector>
+
 #include "guard.hpp"
 #include "mtconnect/config.hpp"
 #include "mtconnect/entity/entity.hpp"
 #include "pipeline_context.hpp"
+#include "transform_metrics.hpp"
 
 namespace mtconnect {
   namespace device_model::data_item {
@@ -43,6 +50,10 @@ namespace mtconnect {
     using TransformPtr = std::shared_ptr<Transform>;
     using TransformList = std::list<TransformPtr>;
 
+    /// @brief A counter shared by the transforms of a pipeline, incremented when the pipeline or
+    /// a guard changes
+    using RouteGeneration = std::shared_ptr<std::atomic<uint64_t>>;
+
     using ApplyDataItem = std::function<void(const DataItemPtr di)>;
     using EachDataItem = std::function<void(ApplyDataItem)>;
     using FindDataItem = std::function<DataItemPtr(const std::string &, const std::string &)>;
@@ -51,7 +62,14 @@ namespace mtconnect {
     class AGENT_LIB_API Transform : public std::enable_shared_from_this<Transform>
     {
     public:
-      Transform(const Transform &) = default;
+      Transform(const Transform &other)
+        : std::enable_shared_from_this<Transform>(other),
+          m_name(other.m_name),
+          m_next(other.m_next),
+          m_guard(other.m_guard),
+          m_metrics(other.m_metrics),
+          m_generation(other.m_generation)
+      {}
       /// @brief Construct a transform with a name
       /// @param[in] name transform name
       Transform(const std::string &name) : m_name(name) {}
@@ -85,7 +103,27 @@ namespace mtconnect {
       }
 
       /// @brief clear the list of next transforms
-      virtual void unlink() { m_next.clear(); }
+      virtual void unlink()
+      {
+        m_next.clear();
+        changed();
+      }
+
+      /// @brief enable routing for this transform and all the following transforms
+      ///
+      /// Called when the pipeline starts and when it is edited. Routes are only cached once the
+      /// transform is compiled. The routes are discarded when the pipeline generation changes.
+      /// @param[in] generation the generation of the pipeline, created if not given
+      void compile(RouteGeneration generation = nullptr)
+      {
+        if (!generation)
+          generation = std::make_shared<std::atomic<uint64_t>>(0);
+        m_generation = generation;
+        std::atomic_store_explicit(&m_routes, std::shared_ptr<const RouteTable>(),
+                                   std::memory_order_release);
+        for (auto &t : m_next)
+          t->compile(generation);
+      }
 
       /// @brief the transform method must be overloaded
       /// @param entity the entity
@@ -98,6 +136,9 @@ namespace mtconnect {
       TransformList &getNext() { return m_next; }
 
       /// @brief Find the next transform to forward the entity on to
+      ///
+      /// Uses the cached route for the entity's type and name. Guards that cannot be resolved
+      /// from the type and name are evaluated in order as if there were no cache.
       /// @param entity the entity
       /// @return return the result of the transformation
       entity::EntityPtr next(entity::EntityPtr &&entity)
@@ -108,19 +149,43 @@ namespace mtconnect {
         using namespace std;
         using namespace entity;
 
-        for (auto &t : m_next)
+        // The route table is immutable, holding it keeps the route valid
+        std::shared_ptr<const RouteTable> table;
+        if (auto route = findRoute(entity.get(), table))
         {
-          switch (t->check(entity.get()))
+          for (auto &step : route->m_steps)
           {
-            case RUN:
-              return (*t)(std::move(entity));
+            auto t = step.m_transform;
+            auto action = step.m_evaluate ? t->check(entity.get()) : step.m_action;
+            switch (action)
+            {
+              case RUN:
+                return t->dispatch(std::move(entity));
 
-            case SKIP:
-              return t->next(std::move(entity));
+              case SKIP:
+                return t->next(std::move(entity));
 
-            case CONTINUE:
-              // Move on to the next
-              break;
+              case CONTINUE:
+                break;
+            }
+          }
+        }
+        else
+        {
+          for (auto &t : m_next)
+          {
+            switch (t->check(entity.get()))
+            {
+              case RUN:
+                return t->dispatch(std::move(entity));
+
+              case SKIP:
+                return t->next(std::move(entity));
+
+              case CONTINUE:
+                // Move on to the next
+                break;
+            }
           }
         }
 
@@ -135,6 +200,7 @@ namespace mtconnect {
       TransformPtr bind(TransformPtr trans)
       {
         m_next.emplace_back(trans);
+        changed();
         return trans;
       }
 
@@ -149,12 +215,48 @@ namespace mtconnect {
           return m_guard(entity);
       }
 
+      /// @brief get the guard action using only the entity type and name
+      /// @param[in] entity the entity
+      /// @return the action or `nullopt` if the guard must be evaluated for each entity
+      std::optional<GuardAction> resolve(const entity::Entity *entity) const
+      {
+        if (!m_guard)
+          return RUN;
+        else
+          return m_guard.resolve(entity);
+      }
+
       /// @brief Get a reference to the guard
       /// @return the guard
       const Guard &getGuard() const { return m_guard; }
+
+      /// @brief Call the transform and record its latency if it is instrumented
+      /// @param entity the entity
+      /// @return the result of the transform
+      entity::EntityPtr dispatch(entity::EntityPtr &&entity)
+      {
+        if (!m_metrics)
+          return (*this)(std::move(entity));
+
+        TransformMetrics::Scope scope(*m_metrics);
+        return (*this)(std::move(entity));
+      }
+
+      /// @brief get the metrics if the transform is instrumented
+      const TransformMetricsPtr &getMetrics() const { return m_metrics; }
+      /// @brief instrument the transform
+      /// @param metrics the metrics or `nullptr` to remove the instrumentation
+      void setMetrics(TransformMetricsPtr metrics) { m_metrics = metrics; }
       /// @brief set the guard
+      ///
+      /// Discards the routes of the pipeline since the transforms before this transform route to
+      /// it using the guard.
       /// @param guard a guard
-      void setGuard(const Guard &guard) { m_guard = guard; }
+      void setGuard(const Guard &guard)
+      {
+        m_guard = guard;
+        changed();
+      }
 
       using TransformPair = std::pair<TransformPtr, TransformPtr>;
       using ListOfTransforms = std::list<TransformPair>;
@@ -198,6 +300,7 @@ namespace mtconnect {
           {
             xform->bind(old);
             *it = xform;
+            changed();
             return;
           }
         }
@@ -219,7 +322,11 @@ namespace mtconnect {
       }
       /// @brief Binds to the first position in the next list
       /// @param xform the transform
-      void firstAfter(TransformPtr xform) { m_next.emplace_front(xform); }
+      void firstAfter(TransformPtr xform)
+      {
+        m_next.emplace_front(xform);
+        changed();
+      }
       /// @brief Replace one transform with another
       ///
       /// Rebinds the new transform replacing the old transform
@@ -236,6 +343,7 @@ namespace mtconnect {
             {
               xform->bind(*nxt);
             }
+            changed();
           }
         }
       }
@@ -255,15 +363,132 @@ namespace mtconnect {
             {
               bind(*nxt);
             }
+            changed();
             break;
           }
         }
       }
 
+    protected:
+      /// @brief A step in a route to the next transform
+      struct Step
+      {
+        Transform *m_transform;
+        GuardAction m_action;  ///< the resolved action if it does not need to be evaluated
+        bool m_evaluate;       ///< `true` if the guard must be checked for each entity
+      };
+
+      /// @brief The routing for entities with the same type, and name if the guards use it
+      struct Route
+      {
+        const std::type_info *m_type;
+        std::string m_name;
+        std::vector<Step> m_steps;
+      };
+
+      /// @brief The routes of a transform for one generation of the pipeline
+      ///
+      /// Tables are never modified once published. A new route is added by publishing a copy.
+      struct RouteTable
+      {
+        uint64_t m_generation {0};
+        bool m_routeByName {false};
+        std::vector<Route> m_routes;
+
+        const Route *find(const entity::Entity *entity, const std::type_info *type) const
+        {
+          for (auto &route : m_routes)
+          {
+            if (route.m_type == type && (!m_routeByName || route.m_name == entity->getName()))
+              return &route;
+          }
+          return nullptr;
+        }
+      };
+
+      /// @brief The maximum number of cached routes. Entities are routed by evaluating the
+      /// guards if there are more.
+      static constexpr size_t MaxRoutes = 64;
+
+      /// @brief Discard the routes after the pipeline or a guard changed
+      void changed()
+      {
+        if (m_generation)
+          m_generation->fetch_add(1, std::memory_order_acq_rel);
+        std::atomic_store_explicit(&m_routes, std::shared_ptr<const RouteTable>(),
+                                   std::memory_order_release);
+      }
+
+      /// @brief Find or create the route for an entity
+      ///
+      /// The table is loaded and replaced atomically since pipelines run entities through the same
+      /// transforms on several threads.
+      /// @param[in] entity the entity
+      /// @param[out] table the table holding the route
+      /// @return the route or `nullptr` if the transform is not compiled or the table is full
+      const Route *findRoute(const entity::Entity *entity, std::shared_ptr<const RouteTable> &table)
+      {
+        if (!m_generation)
+          return nullptr;
+
+        auto &e = *entity;
+        auto type = &typeid(e);
+        auto generation = m_generation->load(std::memory_order_acquire);
+        table = std::atomic_load_explicit(&m_routes, std::memory_order_acquire);
+        if (table && table->m_generation == generation)
+        {
+          if (auto route = table->find(entity, type))
+            return route;
+          if (table->m_routes.size() >= MaxRoutes)
+            return nullptr;
+        }
+
+        auto next = std::make_shared<RouteTable>();
+        next->m_generation = generation;
+        if (table && table->m_generation == generation)
+        {
+          next->m_routeByName = table->m_routeByName;
+          next->m_routes = table->m_routes;
+        }
+        else
+        {
+          for (auto &t : m_next)
+            next->m_routeByName =
+                next->m_routeByName || (t->m_guard.getDependencies() & NAME_DEPENDENCY);
+        }
+
+        Route route {type, next->m_routeByName ? entity->getName() : std::string(), {}};
+        for (auto &t : m_next)
+        {
+          auto action = t->resolve(entity);
+          if (!action)
+          {
+            route.m_steps.push_back({t.get(), CONTINUE, true});
+          }
+          else if (*action != CONTINUE)
+          {
+            route.m_steps.push_back({t.get(), *action, false});
+            break;
+          }
+        }
+        next->m_routes.emplace_back(std::move(route));
+
+        // If another thread published a table first, this table is still used for the entity
+        std::shared_ptr<const RouteTable> expected = table;
+        table = next;
+        std::atomic_compare_exchange_strong(&m_routes, &expected, table);
+        return &table->m_routes.back();
+      }
+
     protected:
       std::string m_name;
       TransformList m_next;
       Guard m_guard;
+      TransformMetricsPtr m_metrics;
+
+      RouteGeneration m_generation;
+      // Accessed with the atomic shared_ptr functions, libc++ has no std::atomic<std::shared_ptr>
+      std::shared_ptr<const RouteTable> m_routes;
     };
 
     /// @brief A transform that just returns the entity. It does not call next.
@@ -0,0 +1,167 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "transform_metrics.hpp"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/bind/bind.hpp>
+
+#include <cmath>
+
+#include "mtconnect/device_model/data_item/data_item.hpp"
+#include "mtconnect/logging.hpp"
+#include "mtconnect/observation/observation.hpp"
+
+using namespace std;
+
+namespace mtconnect::pipeline {
+  using namespace entity;
+  using namespace observation;
+
+  uint64_t LatencyHistogram::Snapshot::percentile(double p) const
+  {
+    if (m_count == 0)
+      return 0;
+
+    auto target = uint64_t(ceil(p * double(m_count)));
+    if (target == 0)
+      target = 1;
+
+    uint64_t total = 0;
+    for (size_t b = 0; b < m_counts.size(); b++)
+    {
+      total += m_counts[b];
+      if (total >= target)
+        return std::min(highestValue(b), m_max);
+    }
+
+    return m_max;
+  }
+
+  LatencyHistogram::Snapshot LatencyHistogram::Snapshot::since(const Snapshot &earlier) const
+  {
+    Snapshot diff;
+    diff.m_counts.resize(m_counts.size(), 0);
+    for (size_t b = 0; b < m_counts.size(); b++)
+    {
+      auto before = b < earlier.m_counts.size() ? earlier.m_counts[b] : 0;
+      diff.m_counts[b] = m_counts[b] - before;
+      diff.m_count += diff.m_counts[b];
+      if (diff.m_counts[b] > 0)
+        diff.m_max = std::min(highestValue(b), m_max);
+    }
+    diff.m_sum = m_sum - earlier.m_sum;
+
+    return diff;
+  }
+
+  LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+  {
+    Snapshot snap;
+    snap.m_counts.resize(BucketCount);
+    for (size_t b = 0; b < BucketCount; b++)
+    {
+      snap.m_counts[b] = m_counts[b].load(memory_order_relaxed);
+      snap.m_count += snap.m_counts[b];
+    }
+    snap.m_sum = m_sum.load(memory_order_relaxed);
+    snap.m_max = m_max.load(memory_order_relaxed);
+
+    return snap;
+  }
+
+  void LatencyHistogram::reset()
+  {
+    for (auto &c : m_counts)
+      c.store(0, memory_order_relaxed);
+    m_count.store(0, memory_order_relaxed);
+    m_sum.store(0, memory_order_relaxed);
+    m_max.store(0, memory_order_relaxed);
+  }
+
+  uint64_t &TransformMetrics::nested()
+  {
+    static thread_local uint64_t nested {0};
+    return nested;
+  }
+
+  void PublishTransformMetrics::start()
+  {
+    m_timer.cancel();
+    m_stopped = false;
+    m_last.clear();
+    for (auto &m : m_metrics)
+      m_last.emplace_back(m->getLatency().snapshot());
+    m_lastTime = chrono::steady_clock::now();
+
+    using std::placeholders::_1;
+    m_timer.expires_after(m_interval);
+    m_timer.async_wait(boost::asio::bind_executor(
+        m_strand, boost::bind(&PublishTransformMetrics::publish, ptr(), _1)));
+  }
+
+  void PublishTransformMetrics::publish(boost::system::error_code ec)
+  {
+    NAMED_SCOPE("pipeline.transform_metrics");
+
+    if (ec || m_stopped)
+      return;
+
+    using namespace chrono;
+
+    auto latencyDi = m_contract->findDataItem("Agent", m_prefix + "_pipeline_latency");
+    auto throughputDi = m_contract->findDataItem("Agent", m_prefix + "_pipeline_throughput");
+
+    auto now = steady_clock::now();
+    duration<double> dt = now - m_lastTime;
+    m_lastTime = now;
+
+    DataSet latency, throughput;
+    auto last = m_last.begin();
+    for (auto &m : m_metrics)
+    {
+      auto snap = m->getLatency().snapshot();
+      auto interval = snap.since(*last);
+      *last++ = std::move(snap);
+
+      if (interval.m_count > 0)
+        latency.emplace(m->getName(), double(interval.percentile(0.99)) / 1000.0);
+      throughput.emplace(m->getName(), double(interval.m_count) / dt.count());
+
+      LOG(debug) << m_prefix << ": " << m->getName() << " - " << interval.m_count
+                 << " entities, p99 " << (double(interval.percentile(0.99)) / 1000.0) << "us";
+    }
+
+    auto deliver = [this](DataItemPtr di, const DataSet &set) {
+      if (di)
+      {
+        ErrorList errors;
+        auto obs =
+            Observation::make(di, Properties {{"VALUE", set}}, system_clock::now(), errors);
+        if (obs && errors.empty())
+          m_contract->deliverObservation(obs);
+      }
+    };
+    deliver(latencyDi, latency);
+    deliver(throughputDi, throughput);
+
+    using std::placeholders::_1;
+    m_timer.expires_after(m_interval);
+    m_timer.async_wait(boost::asio::bind_executor(
+        m_strand, boost::bind(&PublishTransformMetrics::publish, ptr(), _1)));
+  }
+}  // namespace mtconnect::pipeline
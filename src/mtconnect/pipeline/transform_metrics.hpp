@@ -0,0 +1,252 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <boost/asio/io_context_strand.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "pipeline_contract.hpp"
+
+namespace mtconnect::pipeline {
+  /// @brief A log-linear histogram of latencies in nanoseconds
+  ///
+  /// Each power of two is divided into `SubBuckets` linear buckets so the value reported for a
+  /// percentile is within 12.5% of the recorded value. Recording is lock-free and can be done
+  /// while another thread takes a snapshot.
+  class AGENT_LIB_API LatencyHistogram
+  {
+  public:
+    /// @brief The number of bits used for the linear buckets in each power of two
+    static constexpr unsigned SubBucketBits = 3;
+    /// @brief The number of linear buckets in each power of two
+    static constexpr unsigned SubBuckets = 1u << SubBucketBits;
+    /// @brief The largest power of two with its own buckets. Larger values are counted in the
+    /// last bucket.
+    static constexpr unsigned MaxExponent = 40;
+    /// @brief The total number of buckets
+    static constexpr size_t BucketCount = (MaxExponent - SubBucketBits + 2) * SubBuckets;
+
+    /// @brief A point in time copy of the histogram
+    struct Snapshot
+    {
+      std::vector<uint64_t> m_counts;
+      uint64_t m_count {0};
+      uint64_t m_sum {0};
+      uint64_t m_max {0};
+
+      /// @brief get the value at a percentile
+      /// @param[in] p the percentile between 0.0 and 1.0
+      /// @return the highest value in the bucket containing the percentile in nanoseconds
+      uint64_t percentile(double p) const;
+      /// @brief the mean value in nanoseconds
+      double mean() const { return m_count > 0 ? double(m_sum) / double(m_count) : 0.0; }
+      /// @brief the values recorded since an earlier snapshot
+      ///
+      /// The maximum is estimated from the highest bucket with values.
+      /// @param[in] earlier an earlier snapshot of the same histogram
+      /// @return the difference
+      Snapshot since(const Snapshot &earlier) const;
+    };
+
+    /// @brief get the bucket for a value
+    /// @param[in] v the value
+    /// @return the bucket index
+    static size_t bucket(uint64_t v)
+    {
+      if (v < SubBuckets)
+        return size_t(v);
+
+      unsigned exp = std::bit_width(v) - 1;
+      if (exp > MaxExponent)
+        return BucketCount - 1;
+
+      auto shift = exp - SubBucketBits;
+      return size_t(shift + 1) * SubBuckets + size_t((v >> shift) & (SubBuckets - 1));
+    }
+
+    /// @brief get the highest value counted in a bucket
+    /// @param[in] b the bucket index
+    /// @return the highest value
+    static uint64_t highestValue(size_t b)
+    {
+      if (b < SubBuckets)
+        return b;
+
+      auto shift = b / SubBuckets - 1;
+      auto sub = b % SubBuckets;
+      return ((SubBuckets + sub + 1) << shift) - 1;
+    }
+
+    /// @brief record a value
+    /// @param[in] v the value in nanoseconds
+    void record(uint64_t v)
+    {
+      m_counts[bucket(v)].fetch_add(1, std::memory_order_relaxed);
+      m_count.fetch_add(1, std::memory_order_relaxed);
+      m_sum.fetch_add(v, std::memory_order_relaxed);
+
+      auto max = m_max.load(std::memory_order_relaxed);
+      while (v > max && !m_max.compare_exchange_weak(max, v, std::memory_order_relaxed))
+        ;
+    }
+
+    /// @brief the number of recorded values
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+    /// @brief copy the current counts
+    /// @return the snapshot
+    Snapshot snapshot() const;
+
+    /// @brief clear all the counts
+    void reset();
+
+  protected:
+    std::array<std::atomic<uint64_t>, BucketCount> m_counts {};
+    std::atomic<uint64_t> m_count {0};
+    std::atomic<uint64_t> m_sum {0};
+    std::atomic<uint64_t> m_max {0};
+  };
+
+  /// @brief The latency and number of entities for one transform
+  ///
+  /// The latency only includes the time spent in the transform. Time spent in the
+  /// following instrumented transforms is subtracted.
+  class AGENT_LIB_API TransformMetrics
+  {
+  public:
+    /// @brief create the metrics for a transform
+    /// @param name the name used to report the metrics
+    TransformMetrics(const std::string &name)
+      : m_name(name), m_created(std::chrono::steady_clock::now())
+    {}
+
+    /// @brief Times a transform from construction to destruction
+    class Scope
+    {
+    public:
+      Scope(TransformMetrics &metrics)
+        : m_metrics(metrics),
+          m_nested(nested()),
+          m_outer(m_nested),
+          m_start(std::chrono::steady_clock::now())
+      {
+        m_nested = 0;
+      }
+      ~Scope()
+      {
+        using namespace std::chrono;
+        uint64_t elapsed = duration_cast<nanoseconds>(steady_clock::now() - m_start).count();
+        m_metrics.m_latency.record(elapsed > m_nested ? elapsed - m_nested : 0);
+        m_nested = m_outer + elapsed;
+      }
+
+    protected:
+      TransformMetrics &m_metrics;
+      uint64_t &m_nested;
+      uint64_t m_outer;
+      std::chrono::steady_clock::time_point m_start;
+    };
+
+    /// @brief the name of the transform
+    const auto &getName() const { return m_name; }
+    /// @brief the latency histogram
+    const auto &getLatency() const { return m_latency; }
+    /// @brief the number of entities the transform has processed
+    uint64_t getCount() const { return m_latency.count(); }
+    /// @brief the average number of entities per second since the metrics were created
+    double getRate() const
+    {
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_created;
+      return elapsed.count() > 0.0 ? double(getCount()) / elapsed.count() : 0.0;
+    }
+
+  protected:
+    /// @brief the time spent in nested instrumented transforms on this thread
+    static uint64_t &nested();
+
+  protected:
+    std::string m_name;
+    LatencyHistogram m_latency;
+    std::chrono::steady_clock::time_point m_created;
+  };
+
+  using TransformMetricsPtr = std::shared_ptr<TransformMetrics>;
+  using TransformMetricsList = std::list<TransformMetricsPtr>;
+
+  /// @brief Periodically publish the transform metrics as agent data set observations
+  ///
+  /// Publishes the 99th percentile latency in microseconds to `<prefix>_pipeline_latency`
+  /// and the entities per second to `<prefix>_pipeline_throughput` for each transform for the
+  /// last interval.
+  struct AGENT_LIB_API PublishTransformMetrics
+    : std::enable_shared_from_this<PublishTransformMetrics>
+  {
+    /// @brief create a publisher
+    /// @param st the strand for the timer
+    /// @param contract the contract to find the data items and deliver the observations
+    /// @param prefix the prefix of the data item ids
+    /// @param metrics the metrics to publish
+    PublishTransformMetrics(boost::asio::io_context::strand &st, PipelineContract *contract,
+                            const std::string &prefix, const TransformMetricsList &metrics)
+      : m_contract(contract),
+        m_prefix(prefix),
+        m_metrics(metrics),
+        m_timer(st.context()),
+        m_strand(st)
+    {}
+
+    std::shared_ptr<PublishTransformMetrics> ptr() { return shared_from_this(); }
+
+    /// @brief start the timer
+    void start();
+    /// @brief stop the timer
+    void stop()
+    {
+      m_stopped = true;
+      m_timer.cancel();
+    }
+    /// @brief publish the metrics for the last interval
+    /// @param ec an error code from the timer
+    void publish(boost::system::error_code ec);
+
+    /// @brief the interval between publications
+    std::chrono::milliseconds m_interval {std::chrono::seconds(10)};
+
+  protected:
+    PipelineContract *m_contract;
+    std::string m_prefix;
+    TransformMetricsList m_metrics;
+    std::vector<LatencyHistogram::Snapshot> m_last;
+    std::chrono::steady_clock::time_point m_lastTime;
+    boost::asio::steady_timer m_timer;
+    boost::asio::io_context::strand &m_strand;
+    bool m_stopped {false};
+  };
+}  // namespace mtconnect::pipeline
@@ -32,12 +32,16 @@ namespace mtconnect::pipeline {
   ///
   /// - Does not validate data sets and tables
   /// - Validates all events, not samples or conditions
+  /// - Event types are found by the ordinal stored in the data item and values are looked up
+  ///   in the perfect hash form of the vocabularies
   class AGENT_LIB_API Validator : public Transform
   {
   public:
     Validator(const Validator &) = default;
     Validator(PipelineContextPtr context)
-      : Transform("Validator"), m_contract(context->m_contract.get())
+      : Transform("Validator"),
+        m_contract(context->m_contract.get()),
+        m_vocabularies(validation::observations::GetCompiledVocabularies())
     {
       m_guard = TypeGuard<observation::Observation>(RUN) || TypeGuard<entity::Entity>(SKIP);
     }
@@ -58,35 +62,47 @@ namespace mtconnect::pipeline {
       {
         if (auto evt = std::dynamic_pointer_cast<observation::Event>(obs))
         {
-          auto vocab = ControlledVocabularies.find(evt->getName());
-          if (vocab != ControlledVocabularies.end())
-          {
-            auto sv = std::get_if<std::string>(&value);
-            auto &lits = vocab->second;
-            if (lits.size() != 0 && sv != nullptr)
+          auto sv = std::get_if<std::string>(&value);
+          auto check = [&](const std::pair<int32_t, int32_t> *lit) {
+            if (lit)
             {
-              auto lit = lits.find(*sv);
-              if (lit != lits.end())
-              {
-                // Check if it has not been introduced yet
-                if (lit->second.first > 0 && m_contract->getSchemaVersion() < lit->second.first)
-                  valid = false;
+              // Check if it has not been introduced yet
+              if (lit->first > 0 && m_contract->getSchemaVersion() < lit->first)
+                valid = false;
 
-                // Check if deprecated
-                if (lit->second.second > 0 && m_contract->getSchemaVersion() >= lit->second.second)
-                {
-                  evt->setProperty("deprecated", true);
-                }
-              }
-              else
+              // Check if deprecated
+              if (lit->second > 0 && m_contract->getSchemaVersion() >= lit->second)
               {
-                valid = false;
+                evt->setProperty("deprecated", true);
               }
             }
-            else if (lits.size() != 0)
+            else
             {
               valid = false;
             }
+          };
+
+          if (auto &ordinal = di->getVocabulary())
+          {
+            auto &lits = m_vocabularies.at(*ordinal);
+            if (lits.size() != 0)
+              check(sv != nullptr ? lits.find(*sv) : nullptr);
+          }
+          else if (auto vocab = ControlledVocabularies.find(evt->getName());
+                   vocab != ControlledVocabularies.end())
+          {
+            // Event types added after the vocabularies were compiled
+            auto &lits = vocab->second;
+            if (lits.size() != 0)
+            {
+              const std::pair<int32_t, int32_t> *lit = nullptr;
+              if (sv != nullptr)
+              {
+                if (auto it = lits.find(*sv); it != lits.end())
+                  lit = &it->second;
+              }
+              check(lit);
+            }
           }
           else
           {
@@ -129,6 +145,7 @@ namespace mtconnect::pipeline {
     // Logging Context
     std::set<std::string> m_logOnce;
     PipelineContract *m_contract;
+    const validation::observations::CompiledValidation &m_vocabularies;
     std::unordered_map<std::string, WeakDataItemPtr> m_dataItemMap;
   };
 }  // namespace mtconnect::pipeline
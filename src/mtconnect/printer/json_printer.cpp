@@ -227,13 +227,14 @@ namespace mtconnect::printer {
   /// Caches the data item, component, category, and device associated with the observation
   struct ObservationRef
   {
-    ObservationRef(const ObservationPtr &obs) : m_observation(obs)
-    {
-      m_dataItem = obs->getDataItem();
-      m_category = m_dataItem->getCategory();
-      m_component = m_dataItem->getComponent();
-      m_device = m_component->getDevice();
-    }
+    ObservationRef(const ObservationPtr &obs, const DataItemPtr &dataItem,
+                   const ComponentPtr &component, const DevicePtr &device)
+      : m_observation(obs),
+        m_component(component),
+        m_dataItem(dataItem),
+        m_device(device),
+        m_category(dataItem->getCategory())
+    {}
 
     std::string_view getDeviceId() const { return m_device->getId(); }
     std::string_view getComponentId() const { return m_component->getId(); }
@@ -414,11 +415,24 @@ namespace mtconnect::printer {
         if (!observations.empty())
         {
           // Order the observations by Device, Component, Category, Observation Type, and Sequence
+          // Hold the data item, component and device of each observation while printing. They
+          // are only looked up again when the data item changes.
           ObservationMap obs;
+          DataItemRegistry::Key last;
+          DataItemPtr dataItem;
+          ComponentPtr component;
+          DevicePtr device;
           for (const auto &o : observations)
           {
-            if (!o->isOrphan())
-              obs.emplace(o);
+            if (!dataItem || o->getDataItemKey() != last)
+            {
+              last = o->getDataItemKey();
+              dataItem = o->getDataItem();
+              component = dataItem ? dataItem->getComponent() : nullptr;
+              device = component ? component->getDevice() : nullptr;
+            }
+            if (device)
+              obs.emplace(o, dataItem, component, device);
           }
 
           if (m_jsonVersion == 1)
@@ -42,6 +42,7 @@ namespace mtconnect::printer {
         bool includeHidden = false, bool pretty = false,
         const std::optional<std::string> requestId = std::nullopt) const override;
 
+    using Printer::printSample;
     std::string printSample(
         const uint64_t instanceId, const unsigned int bufferSize, const uint64_t nextSeq,
         const uint64_t firstSeq, const uint64_t lastSeq, observation::ObservationList &results,
@@ -109,6 +109,28 @@ namespace mtconnect {
           const uint64_t instanceId, const unsigned int bufferSize, const uint64_t nextSeq,
           const uint64_t firstSeq, const uint64_t lastSeq, observation::ObservationList &results,
           bool pretty = false, const std::optional<std::string> requestId = std::nullopt) const = 0;
+      /// @brief Print a MTConnect Streams document from observations the caller keeps alive
+      ///
+      /// The default implementation takes references to the observations and prints the list.
+      /// @param[in] instanceId the instance id
+      /// @param[in] bufferSize the buffer size
+      /// @param[in] nextSeq the next sequence
+      /// @param[in] firstSeq the first sequence
+      /// @param[in] lastSeq the last sequnce
+      /// @param[in] results pointers to the observations
+      /// @return the MTConnect Streams document
+      virtual std::string printSample(
+          const uint64_t instanceId, const unsigned int bufferSize, const uint64_t nextSeq,
+          const uint64_t firstSeq, const uint64_t lastSeq,
+          const observation::ObservationPointers &results, bool pretty = false,
+          const std::optional<std::string> requestId = std::nullopt) const
+      {
+        observation::ObservationList list;
+        for (auto obs : results)
+          list.emplace_back(std::static_pointer_cast<observation::Observation>(obs->getptr()));
+        return printSample(instanceId, bufferSize, nextSeq, firstSeq, lastSeq, list, pretty,
+                           requestId);
+      }
       /// @brief Generate an MTConnect Assets document
       /// @param[in] anInstanceId the instance id
       /// @param[in] bufferSize the buffer size
@@ -19,6 +19,7 @@
 
 #include <boost/asio/ip/host_name.hpp>
 
+#include <algorithm>
 #include <set>
 #include <typeindex>
 #include <typeinfo>
@@ -456,6 +457,19 @@ namespace mtconnect::printer {
                                  const uint64_t nextSeq, const uint64_t firstSeq,
                                  const uint64_t lastSeq, ObservationList &observations, bool pretty,
                                  const std::optional<std::string> requestId) const
+  {
+    ObservationPointers pointers;
+    pointers.reserve(observations.size());
+    for (const auto &obs : observations)
+      pointers.push_back(obs.get());
+    return printSample(instanceId, bufferSize, nextSeq, firstSeq, lastSeq, pointers, pretty,
+                       requestId);
+  }
+
+  string XmlPrinter::printSample(const uint64_t instanceId, const unsigned int bufferSize,
+                                 const uint64_t nextSeq, const uint64_t firstSeq,
+                                 const uint64_t lastSeq, const ObservationPointers &results,
+                                 bool pretty, const std::optional<std::string> requestId) const
   {
     string ret;
 
@@ -469,9 +483,11 @@ namespace mtconnect::printer {
       AutoElement streams(writer, "Streams");
 
       // Sort the vector by category.
-      if (observations.size() > 0)
+      if (results.size() > 0)
       {
-        observations.sort(ObservationCompare);
+        ObservationPointers observations(results);
+        std::stable_sort(observations.begin(), observations.end(),
+                         [](const Observation *a, const Observation *b) { return *a < *b; });
 
         AutoElement deviceElement(writer);
         {
@@ -479,14 +495,25 @@ namespace mtconnect::printer {
           {
             AutoElement categoryElement(writer);
 
-            for (auto &observation : observations)
+            // The observations are sorted by data item, only look up the data item, component
+            // and device when the data item changes. The data item is held for the run of its
+            // observations.
+            device_model::data_item::DataItemRegistry::Key last;
+            DataItemPtr dataItem;
+            device_model::ComponentPtr component;
+            DevicePtr device;
+            for (auto observation : observations)
             {
-              if (!observation->isOrphan())
+              if (!dataItem || observation->getDataItemKey() != last)
               {
-                const auto &dataItem = observation->getDataItem();
-                const auto &component = dataItem->getComponent();
-                const auto &device = component->getDevice();
+                last = observation->getDataItemKey();
+                dataItem = observation->getDataItem();
+                component = dataItem ? dataItem->getComponent() : nullptr;
+                device = component ? component->getDevice() : nullptr;
+              }
 
+              if (device)
+              {
                 if (deviceElement.key() != device->getId())
                 {
                   categoryElement.reset("");
@@ -510,7 +537,7 @@ namespace mtconnect::printer {
 
                 categoryElement.reset(dataItem->getCategoryText());
 
-                addObservation(writer, observation);
+                addObservation(writer, *observation);
               }
             }
           }
@@ -569,7 +596,7 @@ namespace mtconnect::printer {
     return ret;
   }
 
-  void XmlPrinter::addObservation(xmlTextWriterPtr writer, ObservationPtr result) const
+  void XmlPrinter::addObservation(xmlTextWriterPtr writer, const Observation &result) const
   {
     entity::XmlPrinter printer;
     printer.print(writer, result, m_streamsNsSet);
@@ -60,6 +60,11 @@ namespace mtconnect {
           const uint64_t firstSeq, const uint64_t lastSeq, observation::ObservationList &results,
           bool pretty = false,
           const std::optional<std::string> requestId = std::nullopt) const override;
+      std::string printSample(
+          const uint64_t instanceId, const unsigned int bufferSize, const uint64_t nextSeq,
+          const uint64_t firstSeq, const uint64_t lastSeq,
+          const observation::ObservationPointers &results, bool pretty = false,
+          const std::optional<std::string> requestId = std::nullopt) const override;
       std::string printAssets(
           const uint64_t anInstanceId, const unsigned int bufferSize, const unsigned int assetCount,
           const asset::AssetList &asset, bool pretty = false,
@@ -183,7 +188,7 @@ namespace mtconnect {
       void printProbeHelper(xmlTextWriterPtr writer, device_model::ComponentPtr component,
                             const char *name) const;
       void printDataItem(xmlTextWriterPtr writer, DataItemPtr dataItem) const;
-      void addObservation(xmlTextWriterPtr writer, observation::ObservationPtr result) const;
+      void addObservation(xmlTextWriterPtr writer, const observation::Observation &result) const;
 
     protected:
       std::map<std::string, SchemaNamespace> m_devicesNamespaces;
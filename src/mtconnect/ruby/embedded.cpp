@@ -64,12 +64,10 @@ namespace mtconnect::ruby {
   using namespace std::literals;
   using namespace observation;
 
-  RClass *RubyObservation::m_eventClass;
-  RClass *RubyObservation::m_sampleClass;
-  RClass *RubyObservation::m_conditionClass;
-
-  std::recursive_mutex RubyVM::m_mutex;
   RubyVM *RubyVM::m_vm = nullptr;
+  std::mutex RubyVM::m_poolMutex;
+  std::condition_variable RubyVM::m_poolReleased;
+  std::set<RubyVM *> RubyVM::m_pool;
 
   static mrb_value LoadModule(mrb_state *mrb, mrb_value &filename)
   {
@@ -148,65 +146,148 @@ namespace mtconnect::ruby {
 
     if (!m_rubyVM)
     {
+      int interpreters = GetOption<int>(m_options, "Interpreters")
+                             .value_or(GetOption<int>(m_options, "interpreters").value_or(1));
+
       m_rubyVM = make_unique<RubyVM>();
+      load(*m_rubyVM, modulePath);
+
+      for (int i = 1; i < interpreters; i++)
+      {
+        auto &replica = m_replicas.emplace_back(make_unique<RubyVM>(true));
+        load(*replica, modulePath);
+      }
+      bindReplicas();
+    }
+  }
 
-      lock_guard guard(*m_rubyVM);
+  void Embedded::load(RubyVM &vm, const std::optional<std::filesystem::path> &modulePath)
+  {
+    using namespace std::filesystem;
 
-      auto mrb = m_rubyVM->state();
+    NAMED_SCOPE("Ruby::Embedded::load");
 
-      RubyAgent::initialize(mrb, m_rubyVM->mtconnect(), m_agent);
-      RubyPipeline::initialize(mrb, m_rubyVM->mtconnect());
-      RubyEntity::initialize(mrb, m_rubyVM->mtconnect());
-      RubyObservation::initialize(mrb, m_rubyVM->mtconnect());
-      RubyTransform::initialize(mrb, m_rubyVM->mtconnect());
+    lock_guard guard(vm);
 
-      if (modulePath)
-      {
-        LOG(info) << "Loading module: " << *modulePath;
+    auto mrb = vm.state();
 
-        std::error_code ec;
-        path file = canonical(*modulePath, ec);
-        if (ec)
-        {
-          LOG(error) << "Cannot open file: " << ec.message();
-        }
-        else
+    RubyAgent::initialize(mrb, vm.mtconnect(), m_agent);
+    RubyPipeline::initialize(mrb, vm.mtconnect());
+    RubyEntity::initialize(mrb, vm.mtconnect());
+    RubyObservation::initialize(mrb, vm.mtconnect());
+    RubyTransform::initialize(mrb, vm.mtconnect());
+    RubyBatchTransform::initialize(mrb, vm.mtconnect());
+
+    vm.setRecording(true);
+
+    if (modulePath)
+    {
+      LOG(info) << "Loading module: " << *modulePath;
+
+      std::error_code ec;
+      path file = canonical(*modulePath, ec);
+      if (ec)
+      {
+        LOG(error) << "Cannot open file: " << ec.message();
+      }
+      else
+      {
+        LOG(info) << "Resolved module path: " << file;
+        FILE *fp = nullptr;
+        try
         {
-          LOG(info) << "Resolved module path: " << file;
-          FILE *fp = nullptr;
-          try
-          {
-            int save = mrb_gc_arena_save(mrb);
-            mrb_value file = mrb_str_new_cstr(mrb, modulePath->string().c_str());
-            mrb_bool state = false;
-            mrb_value res = mrb_protect(
-                mrb, [](mrb_state *mrb, mrb_value filename) { return LoadModule(mrb, filename); },
-                file, &state);
-            mrb_gc_arena_restore(mrb, save);
-            if (mrb_false_p(res))
-            {
-              LOG(fatal) << "Error loading file " << *modulePath << ": exiting agent";
-              throw FatalException("Fatal error loading module");
-            }
-          }
-          catch (std::exception ex)
+          int save = mrb_gc_arena_save(mrb);
+          mrb_value file = mrb_str_new_cstr(mrb, modulePath->string().c_str());
+          mrb_bool state = false;
+          mrb_value res = mrb_protect(
+              mrb, [](mrb_state *mrb, mrb_value filename) { return LoadModule(mrb, filename); },
+              file, &state);
+          mrb_gc_arena_restore(mrb, save);
+          if (mrb_false_p(res))
           {
-            LOG(fatal) << "Failed to load module: " << *modulePath << ": " << ex.what();
+            LOG(fatal) << "Error loading file " << *modulePath << ": exiting agent";
             throw FatalException("Fatal error loading module");
           }
-          catch (...)
-          {
-            LOG(fatal) << "Failed to load module: " << *modulePath;
-            throw FatalException("Fatal error loading module");
-          }
-          if (fp != nullptr)
-          {
-            fclose(fp);
-          }
+        }
+        catch (std::exception ex)
+        {
+          LOG(fatal) << "Failed to load module: " << *modulePath << ": " << ex.what();
+          throw FatalException("Fatal error loading module");
+        }
+        catch (...)
+        {
+          LOG(fatal) << "Failed to load module: " << *modulePath;
+          throw FatalException("Fatal error loading module");
+        }
+        if (fp != nullptr)
+        {
+          fclose(fp);
         }
       }
     }
   }
 
-  Embedded::~Embedded() { m_rubyVM.reset(); }
+  void Embedded::bindReplicas()
+  {
+    NAMED_SCOPE("Ruby::Embedded::bindReplicas");
+
+    // Transforms are matched by the order they were added to pipelines while loading. If any
+    // replica spliced different transforms, the module is not safe to replicate and only the
+    // primary is used.
+    const auto &primary = m_rubyVM->getSpliced();
+    for (auto &replica : m_replicas)
+    {
+      const auto &spliced = replica->getSpliced();
+      bool same = spliced.size() == primary.size();
+      for (size_t i = 0; same && i < primary.size(); i++)
+        same = primary[i]->getName() == spliced[i]->getName();
+
+      if (!same)
+      {
+        LOG(warning) << "Ruby replica spliced " << spliced.size() << " transforms, primary spliced "
+                     << primary.size() << ", guard one-time setup with MTConnect.primary?; "
+                     << "transforms will only run on the primary interpreter";
+        m_rubyVM->setRecording(false);
+        m_replicas.clear();
+        return;
+      }
+    }
+
+    for (auto &replica : m_replicas)
+    {
+      const auto &spliced = replica->getSpliced();
+      for (size_t i = 0; i < primary.size(); i++)
+      {
+        auto trans = dynamic_pointer_cast<RubyTransform>(primary[i]);
+        auto copy = dynamic_pointer_cast<RubyTransform>(spliced[i]);
+        if (trans && copy)
+        {
+          if (trans->getReplicaCount() == 0)
+            m_bound.emplace_back(trans);
+          trans->addReplica(copy);
+        }
+      }
+    }
+
+    for (auto &replica : m_replicas)
+      replica->setRecording(false);
+    m_rubyVM->setRecording(false);
+
+    if (!m_replicas.empty())
+      LOG(info) << "Bound " << m_bound.size() << " ruby transforms to " << m_replicas.size()
+                << " replica interpreters";
+  }
+
+  Embedded::~Embedded()
+  {
+    // Release the replica transforms before their interpreters close
+    for (auto &weak : m_bound)
+    {
+      if (auto trans = weak.lock())
+        trans->clearReplicas();
+    }
+    m_bound.clear();
+    m_replicas.clear();
+    m_rubyVM.reset();
+  }
 }  // namespace mtconnect::ruby
@@ -19,7 +19,10 @@
 
 #include <boost/asio.hpp>
 
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/utilities.hpp"
@@ -32,19 +35,35 @@ namespace mtconnect {
   /// @brief Embedded MRuby namespace
   namespace ruby {
     class RubyVM;
+    class RubyTransform;
     /// @brief Static wrapper classes that add types to the Ruby instance
     class AGENT_LIB_API Embedded
     {
     public:
       /// @brief Create an embedded mruby instance
+      ///
+      /// When `Interpreters` is greater than one, replica interpreters are loaded with the same
+      /// module and the Ruby transforms they create are bound to the primary's transforms so
+      /// pipelines on different threads can run them concurrently. The module must guard one-time
+      /// setup with `MTConnect.primary?`; if a replica splices different transforms than the
+      /// primary, the replicas are discarded and only the primary is used.
       Embedded(configuration::AgentConfiguration *config, const ConfigOptions &options);
       ~Embedded();
 
+      /// @brief get the number of interpreters including the primary
+      size_t getInterpreterCount() const { return m_replicas.size() + (m_rubyVM ? 1 : 0); }
+
+    protected:
+      void load(RubyVM &vm, const std::optional<std::filesystem::path> &modulePath);
+      void bindReplicas();
+
     protected:
       Agent *m_agent;
       ConfigOptions m_options;
       boost::asio::io_context *m_context = nullptr;
       std::unique_ptr<RubyVM> m_rubyVM;
+      std::vector<std::unique_ptr<RubyVM>> m_replicas;
+      std::vector<std::weak_ptr<RubyTransform>> m_bound;
     };
   }  // namespace ruby
 }  // namespace mtconnect
@@ -22,6 +22,7 @@
 #include "mtconnect/device_model/device.hpp"
 #include "mtconnect/entity/entity.hpp"
 #include "ruby_smart_ptr.hpp"
+#include "ruby_vm.hpp"
 
 namespace mtconnect::ruby {
   using namespace mtconnect;
@@ -31,6 +32,23 @@ namespace mtconnect::ruby {
 
   struct RubyPipeline
   {
+    /// @brief Record a transform being added to a pipeline
+    ///
+    /// Only the primary interpreter edits pipelines. A replica keeps its transform alive so it
+    /// can be bound to the primary's transform once all interpreters have loaded.
+    /// @return `true` if this is a replica and the pipeline must not be changed
+    static bool recordSplice(mrb_state *mrb, mrb_value trans)
+    {
+      auto &vm = RubyVM::of(mrb);
+      vm.recordSplice(MRubySharedPtr<Transform>::unwrap(mrb, trans));
+      if (vm.isReplica())
+      {
+        mrb_gc_register(mrb, trans);
+        return true;
+      }
+      return false;
+    }
+
     static void initialize(mrb_state *mrb, RClass *module)
     {
       auto pipelineClass = mrb_define_class_under(mrb, module, "Pipeline", mrb->object_class);
@@ -68,6 +86,8 @@ namespace mtconnect::ruby {
 
             auto pipeline = MRubyPtr<Pipeline>::unwrap(self);
             mrb_get_args(mrb, "zo", &name, &trans);
+            if (recordSplice(mrb, trans))
+              return self;
             transform = MRubySharedPtr<Transform>::unwrap(mrb, trans);
             if (pipeline->spliceBefore(name, transform))
             {
@@ -91,6 +111,8 @@ namespace mtconnect::ruby {
 
             auto pipeline = MRubyPtr<Pipeline>::unwrap(self);
             mrb_get_args(mrb, "zo", &name, &trans);
+            if (recordSplice(mrb, trans))
+              return self;
             auto transform = MRubySharedPtr<Transform>::unwrap(mrb, trans);
             if (pipeline->spliceAfter(name, transform))
             {
@@ -114,6 +136,8 @@ namespace mtconnect::ruby {
 
             auto pipeline = MRubyPtr<Pipeline>::unwrap(self);
             mrb_get_args(mrb, "zo", &name, &trans);
+            if (recordSplice(mrb, trans))
+              return self;
             auto transform = MRubySharedPtr<Transform>::unwrap(mrb, trans);
             if (pipeline->firstAfter(name, transform))
             {
@@ -137,6 +161,8 @@ namespace mtconnect::ruby {
 
             auto pipeline = MRubyPtr<Pipeline>::unwrap(self);
             mrb_get_args(mrb, "zo", &name, &trans);
+            if (recordSplice(mrb, trans))
+              return self;
             auto transform = MRubySharedPtr<Transform>::unwrap(mrb, trans);
             if (pipeline->lastAfter(name, transform))
             {
@@ -159,6 +185,8 @@ namespace mtconnect::ruby {
 
             auto pipeline = MRubyPtr<Pipeline>::unwrap(self);
             mrb_get_args(mrb, "z", &name);
+            if (RubyVM::of(mrb).isReplica())
+              return self;
             if (!pipeline->remove(name))
             {
               LOG(error) << "Cannot remove " << name;
@@ -175,6 +203,8 @@ namespace mtconnect::ruby {
 
             auto pipeline = MRubyPtr<Pipeline>::unwrap(self);
             mrb_get_args(mrb, "zo", &name, &trans);
+            if (recordSplice(mrb, trans))
+              return self;
             auto transform = MRubySharedPtr<Transform>::unwrap(mrb, trans);
             if (pipeline->replace(name, transform))
             {
@@ -17,8 +17,15 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
 #include "mtconnect/config.hpp"
 #include "mtconnect/pipeline/guard.hpp"
+#include "mtconnect/pipeline/shdr_token_mapper.hpp"
 #include "mtconnect/pipeline/topic_mapper.hpp"
 #include "mtconnect/pipeline/transform.hpp"
 #include "ruby_entity.hpp"
@@ -90,7 +97,9 @@ namespace mtconnect::ruby {
 
             EntityPtr *ent;
             mrb_get_args(mrb, "d", &ent, MRubySharedPtr<Entity>::type());
-            auto nxt = trans->next(std::move(*ent));
+            // A replica forwards to the primary's pipeline
+            RubyTransform *target = trans->m_primary ? trans->m_primary : trans.get();
+            auto nxt = target->next(std::move(*ent));
             return MRubySharedPtr<Entity>::wrap(mrb, "Entity", nxt);
           },
           MRB_ARGS_REQ(1));
@@ -156,18 +165,16 @@ namespace mtconnect::ruby {
         m_method(mrb_intern_lit(mrb, "transform")),
         m_block(mrb_nil_value()),
         m_guardString(guard),
-        m_guardBlock(mrb_nil_value())
+        m_guardBlock(mrb_nil_value()),
+        m_vm(&RubyVM::of(mrb))
     {
       setGuard();
     }
 
     ~RubyTransform()
     {
-      std::lock_guard guard(RubyVM::rubyVM());
-      if (RubyVM::hasVM())
-      {
-        auto mrb = RubyVM::rubyVM().state();
-
+      clearReplicas();
+      RubyVM::withLive(m_vm, [this](mrb_state *mrb) {
         mrb_gc_unregister(mrb, m_self);
         m_self = mrb_nil_value();
         if (!mrb_nil_p(m_block))
@@ -176,28 +183,51 @@ namespace mtconnect::ruby {
           mrb_gc_unregister(mrb, m_guardBlock);
         m_block = mrb_nil_value();
         m_guardBlock = mrb_nil_value();
-      }
+      });
     }
 
     void setMethod(mrb_sym sym) { m_method = sym; }
 
-    void setGuard()
+    /// @brief Bind the same transform created by a replica interpreter
+    ///
+    /// Calls are spread across this transform and its replicas by thread. Must be called before
+    /// the pipeline starts.
+    /// @param[in] replica the transform created by the replica interpreter
+    void addReplica(std::shared_ptr<RubyTransform> replica)
+    {
+      replica->m_primary = this;
+      m_replicas.emplace_back(replica);
+    }
+    /// @brief Release the replica transforms
+    void clearReplicas()
+    {
+      for (auto &replica : m_replicas)
+        replica->m_primary = nullptr;
+      m_replicas.clear();
+    }
+    /// @brief get the number of replicas bound to this transform
+    size_t getReplicaCount() const { return m_replicas.size(); }
+
+    virtual void setGuard()
     {
       if (!mrb_nil_p(m_guardBlock))
       {
         m_guard = [this, old = m_guard](const entity::Entity *entity) -> GuardAction {
           using namespace entity;
           using namespace observation;
-          std::lock_guard guard(RubyVM::rubyVM());
+          RubyTransform *trans = &select();
+          if (mrb_nil_p(trans->m_guardBlock))
+            trans = this;
+          std::lock_guard guard(*trans->m_vm);
 
-          auto mrb = RubyVM::rubyVM().state();
+          auto mrb = trans->m_vm->state();
           int save = mrb_gc_arena_save(mrb);
 
           entity::EntityPtr ptr = entity->getptr();
           mrb_value ev = MRubySharedPtr<Entity>::wrap(mrb, "Entity", ptr);
 
           mrb_bool state = false;
-          mrb_value values[] = {m_guardBlock, ev};
+          mrb_value values[] = {trans->m_guardBlock, ev};
           mrb_value data = mrb_ary_new_from_values(mrb, 2, values);
           mrb_value rv = mrb_protect(
               mrb,
@@ -252,82 +282,114 @@ namespace mtconnect::ruby {
 
     entity::EntityPtr operator()(entity::EntityPtr &&entity) override
     {
-      NAMED_SCOPE("RubyTransform::operator()");
+      return select().invoke(std::move(entity));
+    }
 
-      using namespace entity;
-      using namespace observation;
+    auto &object() { return m_self; }
+    void setObject(mrb_value obj) { m_self = obj; }
 
-      EntityPtr res;
+  protected:
+    /// @brief choose this transform or one of its replicas for the calling thread
+    RubyTransform &select()
+    {
+      if (m_replicas.empty())
+        return *this;
+      auto i = RubyVM::threadSlot() % (m_replicas.size() + 1);
+      return i == 0 ? *this : *m_replicas[i - 1];
+    }
 
-      std::lock_guard guard(RubyVM::rubyVM());
-      auto mrb = RubyVM::rubyVM().state();
-      int save = mrb_gc_arena_save(mrb);
+    /// @brief get the Ruby class name used to wrap an entity
+    static const char *className(const Entity *ptr)
+    {
+      using namespace observation;
 
-      try
+      const char *klass = "Entity";
+      if (auto obs = dynamic_cast<const Observation *>(ptr); obs != nullptr)
       {
-        mrb_value ev;
-        const char *klass = "Entity";
-        Entity *ptr = entity.get();
-        Observation *obs;
-        if (obs = dynamic_cast<Observation *>(ptr); obs != nullptr)
+        switch (obs->getDataItem()->getCategory())
         {
-          switch (obs->getDataItem()->getCategory())
-          {
-            case device_model::data_item::DataItem::SAMPLE:
-              klass = "Sample";
-              break;
-            case device_model::data_item::DataItem::EVENT:
-              klass = "Event";
-              break;
-            case device_model::data_item::DataItem::CONDITION:
-              klass = "Condition";
-              break;
-          }
+          case device_model::data_item::DataItem::SAMPLE:
+            klass = "Sample";
+            break;
+          case device_model::data_item::DataItem::EVENT:
+            klass = "Event";
+            break;
+          case device_model::data_item::DataItem::CONDITION:
+            klass = "Condition";
+            break;
         }
-        else if (dynamic_cast<pipeline::Timestamped *>(ptr) != nullptr)
-          klass = "Timestamped";
-        else if (dynamic_cast<pipeline::Tokens *>(ptr) != nullptr)
-          klass = "Tokens";
+      }
+      else if (dynamic_cast<const pipeline::Timestamped *>(ptr) != nullptr)
+        klass = "Timestamped";
+      else if (dynamic_cast<const pipeline::Tokens *>(ptr) != nullptr)
+        klass = "Tokens";
 
-        ev = MRubySharedPtr<Entity>::wrap(mrb, klass, entity);
-        mrb_value rv;
+      return klass;
+    }
 
-        mrb_bool state = false;
-        if (!mrb_nil_p(m_block))
-        {
-          mrb_value values[] = {m_self, m_block, ev};
-          mrb_value data = mrb_ary_new_from_values(mrb, 3, values);
-          rv = mrb_protect(
-              mrb,
-              [](mrb_state *mrb, mrb_value data) {
-                mrb_value self = mrb_ary_ref(mrb, data, 0);
-                mrb_value block = mrb_ary_ref(mrb, data, 1);
-                mrb_value ev = mrb_ary_ref(mrb, data, 2);
-                return mrb_yield_with_class(mrb, block, 1, &ev, self, mrb_class(mrb, self));
-              },
-              data, &state);
-        }
-        else
-        {
-          mrb_value values[] = {m_self, mrb_symbol_value(m_method), ev};
-          mrb_value data = mrb_ary_new_from_values(mrb, 3, values);
-          rv = mrb_protect(
-              mrb,
-              [](mrb_state *mrb, mrb_value data) {
-                mrb_value self = mrb_ary_ref(mrb, data, 0);
-                mrb_sym method = mrb_symbol(mrb_ary_ref(mrb, data, 1));
-                mrb_value ev = mrb_ary_ref(mrb, data, 2);
-                return mrb_funcall_id(mrb, self, method, 1, ev);
-              },
-              data, &state);
-        }
-        if (state)
-        {
-          // auto str = mrb_any_to_s(mrb, rv);
-          LOG(error) << "Error in transform: " << mrb_str_to_cstr(mrb, mrb_inspect(mrb, rv));
-          rv = mrb_nil_value();
-        }
+    /// @brief call the transform block or method with a single argument
+    /// @param[in] mrb the interpreter, must be locked
+    /// @param[in] arg the argument
+    /// @return the result or `nil` if an error was raised
+    mrb_value call(mrb_state *mrb, mrb_value arg)
+    {
+      mrb_value rv;
 
+      mrb_bool state = false;
+      if (!mrb_nil_p(m_block))
+      {
+        mrb_value values[] = {m_self, m_block, arg};
+        mrb_value data = mrb_ary_new_from_values(mrb, 3, values);
+        rv = mrb_protect(
+            mrb,
+            [](mrb_state *mrb, mrb_value data) {
+              mrb_value self = mrb_ary_ref(mrb, data, 0);
+              mrb_value block = mrb_ary_ref(mrb, data, 1);
+              mrb_value ev = mrb_ary_ref(mrb, data, 2);
+              return mrb_yield_with_class(mrb, block, 1, &ev, self, mrb_class(mrb, self));
+            },
+            data, &state);
+      }
+      else
+      {
+        mrb_value values[] = {m_self, mrb_symbol_value(m_method), arg};
+        mrb_value data = mrb_ary_new_from_values(mrb, 3, values);
+        rv = mrb_protect(
+            mrb,
+            [](mrb_state *mrb, mrb_value data) {
+              mrb_value self = mrb_ary_ref(mrb, data, 0);
+              mrb_sym method = mrb_symbol(mrb_ary_ref(mrb, data, 1));
+              mrb_value ev = mrb_ary_ref(mrb, data, 2);
+              return mrb_funcall_id(mrb, self, method, 1, ev);
+            },
+            data, &state);
+      }
+      if (state)
+      {
+        LOG(error) << "Error in transform: " << mrb_str_to_cstr(mrb, mrb_inspect(mrb, rv));
+        rv = mrb_nil_value();
+      }
+
+      return rv;
+    }
+
+    /// @brief call the transform method or block in this transform's interpreter
+    entity::EntityPtr invoke(entity::EntityPtr &&entity)
+    {
+      NAMED_SCOPE("RubyTransform::operator()");
+
+      using namespace entity;
+
+      EntityPtr res;
+
+      std::lock_guard guard(*m_vm);
+      auto mrb = m_vm->state();
+      int save = mrb_gc_arena_save(mrb);
+
+      try
+      {
+        mrb_value ev = MRubySharedPtr<Entity>::wrap(mrb, className(entity.get()), entity);
+        mrb_value rv = call(mrb, ev);
         if (!mrb_nil_p(rv))
           res = MRubySharedPtr<Entity>::unwrap(rv);
       }
@@ -344,9 +406,6 @@ namespace mtconnect::ruby {
       return res;
     }
 
-    auto &object() { return m_self; }
-    void setObject(mrb_value obj) { m_self = obj; }
-
   protected:
     PipelineContract *m_contract;
     mrb_value m_self;
@@ -354,5 +413,411 @@ namespace mtconnect::ruby {
     mrb_value m_block;
     std::string m_guardString;
     mrb_value m_guardBlock;
+    RubyVM *m_vm;
+    std::vector<std::shared_ptr<RubyTransform>> m_replicas;
+    RubyTransform *m_primary {nullptr};
+  };
+
+  /// @brief The entities collected by a batch transform
+  struct RubyBatch
+  {
+    std::vector<EntityPtr> m_entities;
+  };
+
+  /// @brief A Ruby transform that is called once with all the entities from an adapter line
+  ///
+  /// Entities matching the guard are held until the `Observations` entity that ends each SHDR
+  /// line, binary frame, or JSON message reaches the transform, or `MaxBatchSize` entities are
+  /// held. The block or `transform` method is then called with a `MTConnect::Batch` and each
+  /// entity in the returned batch or array is forwarded. The transform must be spliced after the
+  /// mapper, for example `pipeline.splice_after('ShdrTokenMapper', trans)` or
+  /// `pipeline.splice_after('JsonMapper', trans)`.
+  ///
+  /// A line or message is mapped and forwarded to the end on one thread, so the entities are
+  /// held for each thread. Pipelines running in parallel never share a batch, even when the
+  /// transform is spliced into more than one pipeline.
+  ///
+  /// The batch gives access to each entity's value and data item id without wrapping the entity
+  /// in a Ruby object. `numbers` returns the numeric values packed as native doubles in one
+  /// string, `NaN` for entities without a numeric value, and `numbers=` sets them from a string
+  /// in the same format:
+  /// @code
+  /// class Batch
+  ///   def size
+  ///   def [](i) / []=(i, entity) / delete_at(i)
+  ///   def value(i) / set_value(i, value) / values
+  ///   def numbers / numbers=(packed)
+  ///   def data_item_id(i)
+  ///   def each / to_a
+  /// end
+  /// @endcode
+  class AGENT_LIB_API RubyBatchTransform : public RubyTransform
+  {
+  public:
+    using BatchPtr = std::shared_ptr<RubyBatch>;
+
+    /// @brief the largest number of entities held before the batch is sent
+    static constexpr size_t MaxBatchSize = 1024;
+
+    static void initialize(mrb_state *mrb, RClass *module)
+    {
+      auto rubyTrans = mrb_class_get_under(mrb, module, "RubyTransform");
+      auto batchTrans = mrb_define_class_under(mrb, module, "RubyBatchTransform", rubyTrans);
+      MRB_SET_INSTANCE_TT(batchTrans, MRB_TT_DATA);
+
+      mrb_define_method(
+          mrb, batchTrans, "initialize",
+          [](mrb_state *mrb, mrb_value self) {
+            const char *name;
+            mrb_value gv, block = mrb_nil_value();
+            string guard;
+
+            auto c = mrb_get_args(mrb, "z|o&", &name, &gv, &block);
+            if (c == 1)
+              guard = "Observation";
+            else
+              guard = stringFromRuby(mrb, gv);
+
+            auto trans = make_shared<RubyBatchTransform>(mrb, self, name, guard);
+            if (mrb_block_given_p(mrb))
+            {
+              trans->m_block = block;
+              mrb_gc_register(mrb, block);
+            }
+            MRubySharedPtr<Transform>::replace(mrb, self, trans);
+
+            return self;
+          },
+          MRB_ARGS_ARG(1, 1) | MRB_ARGS_BLOCK());
+
+      auto batchClass = mrb_define_class_under(mrb, module, "Batch", mrb->object_class);
+      MRB_SET_INSTANCE_TT(batchClass, MRB_TT_DATA);
+
+      mrb_define_method(
+          mrb, batchClass, "size",
+          [](mrb_state *mrb, mrb_value self) {
+            return mrb_int_value(mrb, mrb_int(batchOf(mrb, self).m_entities.size()));
+          },
+          MRB_ARGS_NONE());
+      mrb_alias_method(mrb, batchClass, mrb_intern_lit(mrb, "length"),
+                       mrb_intern_lit(mrb, "size"));
+
+      mrb_define_method(
+          mrb, batchClass, "[]",
+          [](mrb_state *mrb, mrb_value self) {
+            auto &entity = entityAt(mrb, self);
+            return MRubySharedPtr<Entity>::wrap(mrb, className(entity.get()), entity);
+          },
+          MRB_ARGS_REQ(1));
+
+      mrb_define_method(
+          mrb, batchClass, "[]=",
+          [](mrb_state *mrb, mrb_value self) {
+            mrb_int i;
+            mrb_value value;
+            mrb_get_args(mrb, "io", &i, &value);
+            auto &entity = entityAt(mrb, batchOf(mrb, self), i);
+            if (mrb_nil_p(value))
+              entity.reset();
+            else
+              entity = MRubySharedPtr<Entity>::unwrap(mrb, value);
+            return value;
+          },
+          MRB_ARGS_REQ(2));
+
+      mrb_define_method(
+          mrb, batchClass, "delete_at",
+          [](mrb_state *mrb, mrb_value self) {
+            entityAt(mrb, self).reset();
+            return self;
+          },
+          MRB_ARGS_REQ(1));
+
+      mrb_define_method(
+          mrb, batchClass, "value",
+          [](mrb_state *mrb, mrb_value self) {
+            auto &entity = entityAt(mrb, self);
+            if (!entity)
+              return mrb_nil_value();
+            return toRuby(mrb, entity->getValue());
+          },
+          MRB_ARGS_REQ(1));
+
+      mrb_define_method(
+          mrb, batchClass, "set_value",
+          [](mrb_state *mrb, mrb_value self) {
+            mrb_int i;
+            mrb_value value;
+            mrb_get_args(mrb, "io", &i, &value);
+            auto &entity = entityAt(mrb, batchOf(mrb, self), i);
+            if (entity)
+              entity->setValue(valueFromRuby(mrb, value));
+            return value;
+          },
+          MRB_ARGS_REQ(2));
+
+      mrb_define_method(
+          mrb, batchClass, "values",
+          [](mrb_state *mrb, mrb_value self) {
+            auto &batch = batchOf(mrb, self);
+            auto ary = mrb_ary_new_capa(mrb, mrb_int(batch.m_entities.size()));
+            for (auto &entity : batch.m_entities)
+              mrb_ary_push(mrb, ary, entity ? toRuby(mrb, entity->getValue()) : mrb_nil_value());
+            return ary;
+          },
+          MRB_ARGS_NONE());
+
+      mrb_define_method(
+          mrb, batchClass, "numbers",
+          [](mrb_state *mrb, mrb_value self) {
+            auto &batch = batchOf(mrb, self);
+            auto str = mrb_str_new(mrb, nullptr, mrb_int(batch.m_entities.size() * sizeof(double)));
+            auto ptr = RSTRING_PTR(str);
+            for (auto &entity : batch.m_entities)
+            {
+              double number = std::numeric_limits<double>::quiet_NaN();
+              if (entity)
+              {
+                auto &value = entity->getValue();
+                if (auto d = std::get_if<double>(&value))
+                  number = *d;
+                else if (auto i = std::get_if<int64_t>(&value))
+                  number = double(*i);
+              }
+              std::memcpy(ptr, &number, sizeof(double));
+              ptr += sizeof(double);
+            }
+            return str;
+          },
+          MRB_ARGS_NONE());
+
+      mrb_define_method(
+          mrb, batchClass, "numbers=",
+          [](mrb_state *mrb, mrb_value self) {
+            mrb_value str;
+            mrb_get_args(mrb, "S", &str);
+            auto &batch = batchOf(mrb, self);
+            if (size_t(RSTRING_LEN(str)) != batch.m_entities.size() * sizeof(double))
+              mrb_raise(mrb, E_ARGUMENT_ERROR, "packed numbers do not match the batch size");
+
+            auto ptr = RSTRING_PTR(str);
+            for (auto &entity : batch.m_entities)
+            {
+              double number;
+              std::memcpy(&number, ptr, sizeof(double));
+              ptr += sizeof(double);
+              if (entity && !std::isnan(number))
+                entity->setValue(number);
+            }
+            return str;
+          },
+          MRB_ARGS_REQ(1));
+
+      mrb_define_method(
+          mrb, batchClass, "data_item_id",
+          [](mrb_state *mrb, mrb_value self) {
+            auto obs = dynamic_cast<Observation *>(entityAt(mrb, self).get());
+            if (obs == nullptr || obs->isOrphan())
+              return mrb_nil_value();
+            auto dataItem = obs->getDataItem();
+            return mrb_str_new(mrb, dataItem->getId().data(), dataItem->getId().size());
+          },
+          MRB_ARGS_REQ(1));
+
+      mrb_define_method(
+          mrb, batchClass, "to_a",
+          [](mrb_state *mrb, mrb_value self) {
+            auto &batch = batchOf(mrb, self);
+            auto ary = mrb_ary_new_capa(mrb, mrb_int(batch.m_entities.size()));
+            for (auto &entity : batch.m_entities)
+            {
+              if (entity)
+                mrb_ary_push(mrb, ary,
+                             MRubySharedPtr<Entity>::wrap(mrb, className(entity.get()), entity));
+            }
+            return ary;
+          },
+          MRB_ARGS_NONE());
+
+      mrb_load_string(mrb, R"(
+class MTConnect::Batch
+  include Enumerable
+  def each(&block)
+    to_a.each(&block)
+    self
+  end
+end
+)");
+    }
+
+    RubyBatchTransform(mrb_state *mrb, mrb_value self, const std::string &name,
+                       const string &guard)
+      : RubyTransform(mrb, self, name, guard)
+    {
+      setGuard();
+    }
+
+    void setGuard() override
+    {
+      RubyTransform::setGuard();
+      m_guard = TypeGuard<pipeline::Observations>(RUN) || m_guard;
+    }
+
+    entity::EntityPtr operator()(entity::EntityPtr &&entity) override
+    {
+      if (auto marker = std::dynamic_pointer_cast<pipeline::Observations>(entity))
+      {
+        auto forwarded = flush(true);
+        if (!forwarded.empty())
+        {
+          auto list = marker->maybeGetValue<EntityList>().value_or(EntityList {});
+          list.splice(list.end(), forwarded);
+          marker->setValue(list);
+        }
+        return next(std::move(entity));
+      }
+
+      {
+        std::lock_guard lock(m_pendingMutex);
+        auto &pending = m_pending[std::this_thread::get_id()];
+        pending.m_entities.emplace_back(std::move(entity));
+        if (pending.m_entities.size() < MaxBatchSize)
+          return nullptr;
+      }
+
+      // Keep the results of a full batch for the marker that ends the line or message
+      auto forwarded = flush();
+      std::lock_guard lock(m_pendingMutex);
+      auto &pending = m_pending[std::this_thread::get_id()];
+      pending.m_forwarded.splice(pending.m_forwarded.end(), forwarded);
+      return nullptr;
+    }
+
+    /// @brief send the entities pending for the calling thread to Ruby and forward the results
+    /// @param[in] end `true` if the line or message ended, the results kept from full batches
+    ///                are returned as well
+    /// @return the entities returned by the next transforms
+    EntityList flush(bool end = false)
+    {
+      EntityList forwarded;
+      auto batch = std::make_shared<RubyBatch>();
+      {
+        std::lock_guard lock(m_pendingMutex);
+        auto pending = m_pending.find(std::this_thread::get_id());
+        if (pending == m_pending.end())
+          return forwarded;
+
+        batch->m_entities.swap(pending->second.m_entities);
+        if (end)
+          forwarded.swap(pending->second.m_forwarded);
+        if (pending->second.m_forwarded.empty())
+          m_pending.erase(pending);
+      }
+
+      if (!batch->m_entities.empty())
+      {
+        auto target = dynamic_cast<RubyBatchTransform *>(&select());
+        if (target == nullptr)
+          target = this;
+
+        for (auto &entity : target->invokeBatch(batch))
+        {
+          auto fwd = next(std::move(entity));
+          if (fwd)
+            forwarded.emplace_back(fwd);
+        }
+      }
+
+      return forwarded;
+    }
+
+  protected:
+    static RubyBatch &batchOf(mrb_state *mrb, mrb_value self)
+    {
+      return **static_cast<BatchPtr *>(
+          mrb_data_get_ptr(mrb, self, MRubySharedPtr<RubyBatch>::type()));
+    }
+
+    static EntityPtr &entityAt(mrb_state *mrb, RubyBatch &batch, mrb_int i)
+    {
+      auto size = mrb_int(batch.m_entities.size());
+      if (i < 0)
+        i += size;
+      if (i < 0 || i >= size)
+        mrb_raise(mrb, E_INDEX_ERROR, "batch index out of range");
+      return batch.m_entities[i];
+    }
+
+    static EntityPtr &entityAt(mrb_state *mrb, mrb_value self)
+    {
+      mrb_int i;
+      mrb_get_args(mrb, "i", &i);
+      return entityAt(mrb, batchOf(mrb, self), i);
+    }
+
+    /// @brief call the block or method once with the whole batch
+    std::vector<EntityPtr> invokeBatch(BatchPtr batch)
+    {
+      NAMED_SCOPE("RubyBatchTransform::invokeBatch");
+
+      std::vector<EntityPtr> res;
+
+      std::lock_guard guard(*m_vm);
+      auto mrb = m_vm->state();
+      int save = mrb_gc_arena_save(mrb);
+
+      try
+      {
+        mrb_value bv = MRubySharedPtr<RubyBatch>::wrap(mrb, "Batch", batch);
+        mrb_value rv = call(mrb, bv);
+
+        if (mrb_array_p(rv))
+        {
+          auto len = RARRAY_LEN(rv);
+          res.reserve(len);
+          for (mrb_int i = 0; i < len; i++)
+          {
+            auto v = mrb_ary_ref(mrb, rv, i);
+            if (!mrb_nil_p(v))
+              res.emplace_back(MRubySharedPtr<Entity>::unwrap(mrb, v));
+          }
+        }
+        else if (!mrb_nil_p(rv) &&
+                 mrb_data_check_get_ptr(mrb, rv, MRubySharedPtr<RubyBatch>::type()) != nullptr)
+        {
+          auto &returned = batchOf(mrb, rv);
+          res.reserve(returned.m_entities.size());
+          for (auto &entity : returned.m_entities)
+          {
+            if (entity)
+              res.emplace_back(entity);
+          }
+        }
+      }
+      catch (std::exception e)
+      {
+        LOG(error) << "Exception thrown in batch transform" << e.what();
+      }
+      catch (...)
+      {
+        LOG(error) << "Unknown Exception thrown in batch transform";
+      }
+
+      mrb_gc_arena_restore(mrb, save);
+      return res;
+    }
+
+  protected:
+    /// @brief The entities held for a thread until its line or message ends
+    struct Pending
+    {
+      std::vector<EntityPtr> m_entities;
+      EntityList m_forwarded;
+    };
+
+    // The transform may be spliced into more than one pipeline. The lock is not held while Ruby
+    // is called.
+    std::mutex m_pendingMutex;
+    std::unordered_map<std::thread::id, Pending> m_pending;
   };
 }  // namespace mtconnect::ruby
@@ -17,13 +17,35 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
 #include "mtconnect/config.hpp"
 
+namespace mtconnect::pipeline {
+  class Transform;
+}
+
 namespace mtconnect::ruby {
+  /// @brief An mruby interpreter
+  ///
+  /// The agent has one primary interpreter and, when configured with more than one
+  /// `Interpreters`, replicas loaded with the same module. Each interpreter has its own lock so
+  /// transforms running on different replicas do not contend.
+  ///
+  /// The pool mutex is never held while waiting for an interpreter lock. Ruby code running
+  /// under an interpreter lock can destroy transforms that call `withLive()`, so holding the
+  /// pool mutex while waiting would deadlock with that thread.
   class AGENT_LIB_API RubyVM
   {
   public:
-    RubyVM()
+    /// @brief Create an interpreter
+    /// @param replica `true` if this is a replica of the primary interpreter
+    RubyVM(bool replica = false) : m_replica(replica)
     {
       m_mrb = mrb_open();
       if (!m_mrb)
@@ -31,17 +53,28 @@ namespace mtconnect::ruby {
         /* handle error */
         throw std::runtime_error("Cannot start mrb");
       }
+      m_mrb->ud = this;
 
       createModule();
       defineLogger();
 
-      m_vm = this;
+      std::lock_guard pool(m_poolMutex);
+      m_pool.insert(this);
+      if (!m_replica)
+        m_vm = this;
     }
 
     ~RubyVM()
     {
-      m_vm = nullptr;
+      {
+        std::unique_lock pool(m_poolMutex);
+        m_pool.erase(this);
+        if (m_vm == this)
+          m_vm = nullptr;
+        m_poolReleased.wait(pool, [this] { return m_users == 0; });
+      }
       std::lock_guard guard(m_mutex);
+      m_spliced.clear();
       if (m_mrb)
       {
         mrb_close(m_mrb);
@@ -50,16 +83,90 @@ namespace mtconnect::ruby {
 
     auto state() { return m_mrb; }
     auto mtconnect() { return m_module; }
+    /// @brief `true` if this interpreter is a replica of the primary
+    bool isReplica() const { return m_replica; }
 
     void lock() { m_mutex.lock(); }
     void unlock() { m_mutex.unlock(); }
     [[nodiscard]] bool try_lock() { return m_mutex.try_lock(); }
 
+    /// @brief the primary interpreter
     static auto &rubyVM() { return *m_vm; }
     static bool hasVM() { return m_vm != nullptr; }
+    /// @brief get the interpreter that owns an mruby state
+    static RubyVM &of(mrb_state *mrb) { return *static_cast<RubyVM *>(mrb->ud); }
+
+    /// @brief Call `f` with the interpreter locked if it has not been destroyed
+    ///
+    /// The interpreter is pinned while the pool mutex is held so it cannot be destroyed, then the
+    /// pool mutex is released before the interpreter is locked.
+    ///
+    /// @param[in] vm the interpreter
+    /// @param[in] f function taking the `mrb_state`
+    /// @return `true` if the interpreter was live
+    template <typename F>
+    static bool withLive(RubyVM *vm, F f)
+    {
+      {
+        std::lock_guard pool(m_poolMutex);
+        if (vm == nullptr || m_pool.count(vm) == 0)
+          return false;
+        vm->m_users++;
+      }
+
+      struct Unpin
+      {
+        ~Unpin()
+        {
+          {
+            std::lock_guard pool(m_poolMutex);
+            m_pinned->m_users--;
+          }
+          m_poolReleased.notify_all();
+        }
+        RubyVM *m_pinned;
+      } unpin {vm};
+
+      std::lock_guard guard(*vm);
+      f(vm->m_mrb);
+      return true;
+    }
+
+    /// @brief A stable per-thread slot used to spread work across interpreters
+    static size_t threadSlot()
+    {
+      static std::atomic<size_t> next {0};
+      thread_local size_t slot = next++;
+      return slot;
+    }
+
+    /// @name Transform binding
+    /// While the module loads, the transforms given to the pipeline are recorded in order so the
+    /// transforms created by a replica can be bound to the matching transforms of the primary.
+    ///@{
+    void setRecording(bool recording)
+    {
+      m_recording = recording;
+      if (!recording)
+        m_spliced.clear();
+    }
+    void recordSplice(std::shared_ptr<pipeline::Transform> transform)
+    {
+      if (m_recording)
+        m_spliced.emplace_back(transform);
+    }
+    const auto &getSpliced() const { return m_spliced; }
+    ///@}
 
   protected:
-    void createModule() { m_module = mrb_define_module(m_mrb, "MTConnect"); }
+    void createModule()
+    {
+      m_module = mrb_define_module(m_mrb, "MTConnect");
+      mrb_define_class_method(
+          m_mrb, m_module, "primary?",
+          [](mrb_state *mrb, mrb_value self) { return mrb_bool_value(!of(mrb).isReplica()); },
+          MRB_ARGS_NONE());
+    }
 
     template <typename L>
     static inline void log(L level, mrb_state *mrb)
@@ -123,7 +230,15 @@ namespace mtconnect::ruby {
     Agent *m_agent;
     RClass *m_module = nullptr;
     mrb_state *m_mrb = nullptr;
-    static std::recursive_mutex m_mutex;
+    bool m_replica {false};
+    bool m_recording {false};
+    std::recursive_mutex m_mutex;
+    std::vector<std::shared_ptr<pipeline::Transform>> m_spliced;
+    size_t m_users {0};  // calls in withLive(), guarded by m_poolMutex
+
     static RubyVM *m_vm;
+    static std::mutex m_poolMutex;
+    static std::condition_variable m_poolReleased;
+    static std::set<RubyVM *> m_pool;
   };
 }  // namespace mtconnect::ruby
@@ -155,6 +155,7 @@ namespace mtconnect {
           if (m_client->isConnected())
           {
             auto qos = parseQos(m_options);
+            std::lock_guard<std::mutex> lock(m_clientMutex);
             m_client->publish(m_lastWillTopic, "UNAVAILABLE", true, qos);
           }
           m_client->stop();
@@ -490,6 +491,8 @@ namespace mtconnect {
 
         try
         {
+          // Format outside the client lock, only the hand off to the client is serialized
+          std::vector<std::string> payloads;
           auto condition = dynamic_pointer_cast<observation::Condition>(observation);
           if (condition)
           {
@@ -498,19 +501,22 @@ namespace mtconnect {
 
             for (auto& cond : condList)
             {
-              std::string payload = formatConditionJson(cond);
+              payloads.emplace_back(formatConditionJson(cond));
               LOG(debug) << "Publishing condition to: " << topic
-                         << ", payload size: " << payload.size();
-              m_client->publish(topic, payload, retain, qos);
+                         << ", payload size: " << payloads.back().size();
             }
           }
           else
           {
-            std::string payload = formatObservationJson(observation);
-            LOG(debug) << "Publishing observation to: " << topic << ", size: " << payload.size();
-            m_client->publish(topic, payload, retain, qos);
+            payloads.emplace_back(formatObservationJson(observation));
+            LOG(debug) << "Publishing observation to: " << topic
+                       << ", size: " << payloads.back().size();
           }
 
+          std::lock_guard<std::mutex> lock(m_clientMutex);
+          for (auto& payload : payloads)
+            m_client->publish(topic, payload, retain, qos);
+
           return true;
         }
         catch (const std::exception& e)
@@ -132,6 +132,7 @@ namespace mtconnect {
         std::shared_ptr<MqttClient> m_client;
         std::vector<observation::ObservationPtr> m_queuedObservations;
         std::mutex m_queueMutex;
+        std::mutex m_clientMutex;  //! Serializes publishes, agent pipelines publish in parallel
       };
     }  // namespace mqtt_entity_sink
   }    // namespace sink
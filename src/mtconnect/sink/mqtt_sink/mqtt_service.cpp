@@ -216,6 +216,9 @@ namespace mtconnect {
         std::string doc;
         SequenceNumber_t firstSeq, lastSeq;
 
+        // Keep the data items while printing without the lock
+        auto pinned = m_sinkContract->getCircularBuffer().pin();
+
         {
           auto &buffer = m_sinkContract->getCircularBuffer();
           std::lock_guard<buffer::CircularBuffer> lock(buffer);
@@ -268,6 +271,9 @@ namespace mtconnect {
           ObservationList observations;
           auto filterSet = filterForDevice(device);
 
+          // Keep the data items while printing without the lock
+          auto pinned = m_sinkContract->getCircularBuffer().pin();
+
           {
             auto &buffer = m_sinkContract->getCircularBuffer();
             std::lock_guard<buffer::CircularBuffer> lock(buffer);
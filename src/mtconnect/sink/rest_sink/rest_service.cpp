@@ -22,10 +22,13 @@
 #include "error.hpp"
 #include "mtconnect/configuration/config_options.hpp"
 #include "mtconnect/entity/xml_parser.hpp"
+#include "mtconnect/pipeline/pipeline.hpp"
 #include "mtconnect/pipeline/shdr_token_mapper.hpp"
 #include "mtconnect/pipeline/shdr_tokenizer.hpp"
 #include "mtconnect/pipeline/timestamp_extractor.hpp"
+#include "mtconnect/printer/json_printer_helper.hpp"
 #include "mtconnect/printer/xml_printer.hpp"
+#include "mtconnect/source/source.hpp"
 #include "server.hpp"
 
 namespace asio = boost::asio;
@@ -106,6 +109,8 @@ namespace mtconnect {
            {"at", QUERY, "Sequence number at which the observation snapshot is taken"},
            {"to", QUERY, "Sequence number at to stop reporting observations"},
            {"from", QUERY, "Sequence number at to start reporting observations"},
+           {"fromTime", QUERY, "Timestamp at which to start reporting observations"},
+           {"toTime", QUERY, "Timestamp at which to stop reporting observations"},
            {"interval", QUERY, "Time in ms between publishing data–starts streaming"},
            {"pretty", QUERY, "Instructs the result to be pretty printed"},
            {"format", QUERY, "The format of the response document: 'xml' or 'json'"},
@@ -118,6 +123,8 @@ namespace mtconnect {
       createAssetRoutings();
       createProbeRoutings();
       createPutObservationRoutings();
+      createPipelineMetricsRoutings();
+      createBufferMetricsRoutings();
       createFileRoutings();
       m_server->addCommands();
 
@@ -435,6 +442,91 @@ namespace mtconnect {
       session->writeResponse(std::move(response));
     }
 
+    void RestService::createPipelineMetricsRoutings()
+    {
+      using namespace rest_sink;
+      using namespace printer;
+      auto handler = [&](SessionPtr session, RequestPtr request) -> bool {
+        auto pretty = *request->parameter<bool>("pretty");
+
+        rapidjson::StringBuffer output;
+        RenderJson(output, pretty, [this](auto &writer) {
+          using W = std::decay_t<decltype(writer)>;
+          AutoJsonObject<W> obj(writer);
+          AutoJsonArray<W> pipelines(writer, "pipelines");
+          for (auto &source : m_sinkContract->getSources())
+          {
+            auto pipeline = source->getPipeline();
+            if (pipeline == nullptr || !pipeline->hasTransformMetrics())
+              continue;
+
+            AutoJsonObject<W> pobj(writer);
+            pobj.AddPairs("source", source->getIdentity());
+            AutoJsonArray<W> transforms(writer, "transforms");
+            for (auto &metrics : pipeline->getTransformMetrics())
+            {
+              auto latency = metrics->getLatency().snapshot();
+              AutoJsonObject<W> tobj(writer);
+              tobj.AddPairs("name", metrics->getName(), "count", latency.m_count, "rate",
+                            metrics->getRate());
+              AutoJsonObject<W> lobj(writer, "latency");
+              lobj.AddPairs("units", "MICROSECOND", "mean", latency.mean() / 1000.0, "p50",
+                            double(latency.percentile(0.5)) / 1000.0, "p90",
+                            double(latency.percentile(0.9)) / 1000.0, "p99",
+                            double(latency.percentile(0.99)) / 1000.0, "max",
+                            double(latency.m_max) / 1000.0);
+            }
+          }
+        });
+
+        session->writeResponse(
+            make_unique<Response>(status::ok, string(output.GetString()), "application/json"));
+        return true;
+      };
+
+      m_server
+          ->addRouting(
+              {boost::beast::http::verb::get, "/pipeline/metrics?pretty={bool:false}", handler})
+          .document("Pipeline transform metrics",
+                    "Latency percentiles in microseconds and entity counts for each transform "
+                    "of the adapter pipelines with `PipelineMetrics` enabled");
+    }
+
+    void RestService::createBufferMetricsRoutings()
+    {
+      using namespace rest_sink;
+      using namespace printer;
+      auto handler = [&](SessionPtr session, RequestPtr request) -> bool {
+        auto pretty = *request->parameter<bool>("pretty");
+
+        rapidjson::StringBuffer output;
+        RenderJson(output, pretty, [this](auto &writer) {
+          using W = std::decay_t<decltype(writer)>;
+          auto &buffer = m_sinkContract->getCircularBuffer();
+          std::lock_guard<CircularBuffer> lock(buffer);
+
+          AutoJsonObject<W> obj(writer);
+          obj.AddPairs("firstSequence", buffer.getBufferFirstSequence(), "nextSequence",
+                       buffer.getSequence(), "bufferSize", buffer.getBufferSize(), "observations",
+                       uint64_t(buffer.getObservationCount()));
+          if (buffer.getMemoryLimit() > 0)
+            obj.AddPairs("memoryLimit", uint64_t(buffer.getMemoryLimit()), "memoryUsage",
+                         uint64_t(buffer.getMemoryUsage()));
+        });
+
+        session->writeResponse(
+            make_unique<Response>(status::ok, string(output.GetString()), "application/json"));
+        return true;
+      };
+
+      m_server
+          ->addRouting(
+              {boost::beast::http::verb::get, "/buffer/metrics?pretty={bool:false}", handler})
+          .document("Circular buffer metrics",
+                    "The sequence range and number of observations in the circular buffer and the "
+                    "approximate memory used in bytes when `BufferMemoryLimit` is set");
+    }
+
     void RestService::createFileRoutings()
     {
       using namespace rest_sink;
@@ -743,31 +835,34 @@ namespace mtconnect {
         if (!request->parameter<int32_t>("count"))
           request->m_parameters["count"] = 100;
 
+        auto format = request->parameter<string>("format");
+        auto printer = getPrinter(request->m_accepts, format);
+
+        // The sequence numbers take precedence over the times
+        auto from = request->parameter<uint64_t>("from");
+        auto to = request->parameter<uint64_t>("to");
+        if (auto fromTime = request->parameter<string>("fromTime"); fromTime && !from)
+          from = sequenceForTime(printer, *fromTime, "fromTime");
+        if (auto toTime = request->parameter<string>("toTime"); toTime && !to)
+          to = sequenceForTime(printer, *toTime, "toTime", true);
+
         auto interval = request->parameter<int32_t>("interval");
         if (interval)
         {
-          auto format = request->parameter<string>("format");
-          auto printer = getPrinter(request->m_accepts, format);
-
           streamSampleRequest(
               session, printer, *interval, *request->parameter<int32_t>("heartbeat"),
-              *request->parameter<int32_t>("count"), request->parameter<string>("device"),
-              request->parameter<uint64_t>("from"), request->parameter<string>("path"),
-              *request->parameter<bool>("pretty"), request->parameter<string>("deviceType"),
-              request->m_requestId);
+              *request->parameter<int32_t>("count"), request->parameter<string>("device"), from,
+              request->parameter<string>("path"), *request->parameter<bool>("pretty"),
+              request->parameter<string>("deviceType"), request->m_requestId);
         }
         else
         {
-          auto format = request->parameter<string>("format");
-          auto printer = getPrinter(request->m_accepts, format);
-
           respond(session,
-                  sampleRequest(
-                      printer, *request->parameter<int32_t>("count"),
-                      request->parameter<string>("device"), request->parameter<uint64_t>("from"),
-                      request->parameter<uint64_t>("to"), request->parameter<string>("path"),
-                      *request->parameter<bool>("pretty"), request->parameter<string>("deviceType"),
-                      request->m_requestId),
+                  sampleRequest(printer, *request->parameter<int32_t>("count"),
+                                request->parameter<string>("device"), from, to,
+                                request->parameter<string>("path"),
+                                *request->parameter<bool>("pretty"),
+                                request->parameter<string>("deviceType"), request->m_requestId),
                   request->m_requestId);
         }
         return true;
@@ -795,18 +890,19 @@ namespace mtconnect {
           "path={string}&from={unsigned_integer}&"
           "interval={integer}&count={integer:100}&"
           "heartbeat={integer:10000}&to={unsigned_integer}&"
+          "fromTime={string}&toTime={string}&"
           "pretty={bool:false}&"
           "deviceType={string}&format={string}");
       m_server->addRouting({boost::beast::http::verb::get, "/sample?" + qp, handler})
           .document("MTConnect sample request",
                     "Gets a time series of at maximum `count` observations for all devices "
-                    "optionally filtered by the `path` and starting at `from`. By default, from is "
-                    "the first available observation known to the agent");
+                    "optionally filtered by the `path` and starting at `from` or `fromTime`. By "
+                    "default, from is the first available observation known to the agent");
       m_server->addRouting({boost::beast::http::verb::get, "/{device}/sample?" + qp, handler})
           .document("MTConnect sample request",
                     "Gets a time series of at maximum `count` observations for device `device` "
-                    "optionally filtered by the `path` and starting at `from`. By default, from is "
-                    "the first available observation known to the agent")
+                    "optionally filtered by the `path` and starting at `from` or `fromTime`. By "
+                    "default, from is the first available observation known to the agent")
           .command("sample");
       m_server->addRouting({boost::beast::http::verb::get, "/cancel/id={string}", cancelHandler})
           .document("MTConnect WebServices Cancel Stream", "Cancels a streaming sample request")
@@ -1516,6 +1612,46 @@ namespace mtconnect {
       }
     }
 
+    SequenceNumber_t RestService::sequenceForTime(const Printer *printer, const string &time,
+                                                  const string &param, bool last) const
+    {
+      Timestamp ts;
+      istringstream in(time);
+      date::from_stream(in, "%FT%T", ts);
+      bool valid = !in.fail();
+
+      // The time is UTC unless it ends with an offset of +hh:mm or -hh:mm
+      if (valid)
+      {
+        static const regex Offset("([+-])([0-9]{2}):?([0-9]{2})");
+        string zone;
+        getline(in, zone);
+        smatch match;
+        if (regex_match(zone, match, Offset) && stoi(match[2]) < 24 && stoi(match[3]) < 60)
+        {
+          auto offset = chrono::hours(stoi(match[2])) + chrono::minutes(stoi(match[3]));
+          if (match[1] == "+")
+            ts -= offset;
+          else
+            ts += offset;
+        }
+        else if (!zone.empty() && zone != "Z")
+        {
+          valid = false;
+        }
+      }
+
+      if (!valid)
+      {
+        auto error = InvalidParameterValue::make(param, time, "string", "date-time",
+                                                 "'" + param + "' must be an ISO 8601 timestamp");
+        throw RestError(error, printer);
+      }
+
+      auto &buffer = m_sinkContract->getCircularBuffer();
+      return last ? buffer.getLastSequenceAtTime(ts) : buffer.getSequenceAtTime(ts);
+    }
+
     void RestService::checkPath(const Printer *printer, const std::optional<std::string> &path,
                                 const DevicePtr device, FilterSet &filter,
                                 const std::optional<std::string> &deviceType) const
@@ -1563,6 +1699,10 @@ namespace mtconnect {
       ObservationList observations;
       SequenceNumber_t firstSeq, seq;
 
+      // Pin the epoch so the data items are not released if the device model changes while the
+      // observations are printed
+      auto pinned = m_sinkContract->getCircularBuffer().pin();
+
       {
         std::lock_guard<CircularBuffer> lock(m_sinkContract->getCircularBuffer());
 
@@ -1570,7 +1710,9 @@ namespace mtconnect {
         seq = m_sinkContract->getCircularBuffer().getSequence();
         if (at)
         {
-          checkRange(printer, *at, firstSeq - 1, seq, "at");
+          // Checkpoints are only kept for the observations in memory
+          auto bufferFirst = m_sinkContract->getCircularBuffer().getBufferFirstSequence();
+          checkRange(printer, *at, bufferFirst - 1, seq, "at");
 
           auto check = m_sinkContract->getCircularBuffer().getCheckpointAt(*at, filterSet);
           check->getObservations(observations);
@@ -1591,9 +1733,14 @@ namespace mtconnect {
                                         SequenceNumber_t &end, bool &endOfBuffer, bool pretty,
                                         const std::optional<std::string> &requestId)
     {
-      std::unique_ptr<ObservationList> observations;
+      ObservationPointers observations;
+      ObservationList archived;
       SequenceNumber_t firstSeq, lastSeq;
 
+      // Pin the epoch before taking the lock so the observations are not released while they
+      // are printed without the lock
+      auto pinned = m_sinkContract->getCircularBuffer().pin();
+
       {
         std::lock_guard<CircularBuffer> lock(m_sinkContract->getCircularBuffer());
         firstSeq = m_sinkContract->getCircularBuffer().getFirstSequence();
@@ -1614,12 +1761,12 @@ namespace mtconnect {
         }
         checkRange(printer, count, lowerCountLimit, upperCountLimit, "count", true);
 
-        observations = m_sinkContract->getCircularBuffer().getObservations(
-            count, filterSet, from, to, end, firstSeq, endOfBuffer);
+        m_sinkContract->getCircularBuffer().getObservations(
+            observations, archived, count, filterSet, from, to, end, firstSeq, endOfBuffer);
       }
 
       return printer->printSample(m_instanceId, m_sinkContract->getCircularBuffer().getBufferSize(),
-                                  end, firstSeq, lastSeq, *observations, pretty, requestId);
+                                  end, firstSeq, lastSeq, observations, pretty, requestId);
     }
 
   }  // namespace sink::rest_sink
@@ -346,6 +346,10 @@ namespace mtconnect {
 
       void createAssetRoutings();
 
+      void createPipelineMetricsRoutings();
+
+      void createBufferMetricsRoutings();
+
       // Current Data Collection
       std::string fetchCurrentData(const printer::Printer *printer, const FilterSetOpt &filterSet,
                                    const std::optional<SequenceNumber_t> &at, bool pretty = false,
@@ -369,6 +373,18 @@ namespace mtconnect {
 
       DevicePtr checkDevice(const printer::Printer *printer, const std::string &uuid) const;
 
+      /// @brief Find the sequence for a time for the `fromTime` and `toTime` parameters
+      ///
+      /// The time is UTC unless it ends with an offset of `+hh:mm` or `-hh:mm`.
+      /// @param[in] printer the printer for errors
+      /// @param[in] time the ISO 8601 timestamp
+      /// @param[in] param the name of the parameter
+      /// @param[in] last find the last sequence at or before the time instead of the first
+      ///                 sequence at or after the time
+      /// @return the sequence
+      SequenceNumber_t sequenceForTime(const printer::Printer *printer, const std::string &time,
+                                       const std::string &param, bool last = false) const;
+
     protected:
       // Loopback
       boost::asio::io_context &m_context;
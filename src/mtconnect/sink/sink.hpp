@@ -108,6 +108,9 @@ namespace mtconnect {
       ///
       /// @param source shared pointer to the source
       virtual void addSource(std::shared_ptr<source::Source> source) = 0;
+      /// @brief Get all the sources
+      /// @return the list of sources
+      virtual const std::list<std::shared_ptr<source::Source>> &getSources() const = 0;
       /// @brief Get the common circular buffer
       /// @return a reference to the circular buffer
       virtual buffer::CircularBuffer &getCircularBuffer() = 0;
@@ -160,6 +163,9 @@ namespace mtconnect {
       virtual void stop() = 0;
 
       /// @brief Receive an observation
+      ///
+      /// Called concurrently from the adapter pipelines. Observations for the same data item are
+      /// delivered in order.
       /// @param observation shared pointer to the observation
       /// @return `true` if the publishing was successful
       virtual bool publish(observation::ObservationPtr &observation) = 0;
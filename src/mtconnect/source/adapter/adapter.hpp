@@ -17,7 +17,10 @@
 
 #pragma once
 
+#include <list>
+
 #include "mtconnect/config.hpp"
+#include "mtconnect/entity/entity.hpp"
 #include "mtconnect/source/adapter/adapter_pipeline.hpp"
 #include "mtconnect/source/source.hpp"
 
@@ -51,6 +54,9 @@ namespace mtconnect::source::adapter {
     /// @brief Get the configuration options
     /// @return configuration options
     virtual const ConfigOptions &getOptions() const { return m_options; }
+    /// @brief Get additional data items for the adapter component of the Agent device
+    /// @return data item properties, the `id` is a suffix appended to the adapter identity
+    virtual std::list<entity::Properties> getAgentDataItems() const { return {}; }
 
     /// @brief set the adapter handler
     /// @param h the handler (takes ownership)
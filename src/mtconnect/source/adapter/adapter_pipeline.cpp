@@ -87,6 +87,13 @@ namespace mtconnect {
       m_options = options;
 
       m_identity = GetOption<string>(m_options, configuration::AdapterIdentity).value_or("unknown");
+      buildTransformMetrics();
+    }
+
+    void AdapterPipeline::buildTransformMetrics()
+    {
+      auto identity = GetOption<string>(m_options, configuration::AdapterIdentity);
+      setTransformMetrics(IsOptionSet(m_options, configuration::PipelineMetrics), identity);
     }
 
     void AdapterPipeline::buildDeviceList()
@@ -76,6 +76,7 @@ namespace mtconnect::source::adapter {
 
   protected:
     void buildDeviceList();
+    void buildTransformMetrics();
     void buildCommandAndStatusDelivery(pipeline::TransformPtr next = nullptr);
     void buildDeviceDelivery(pipeline::TransformPtr next);
     void buildAssetDelivery(pipeline::TransformPtr next);
@@ -48,6 +48,7 @@ namespace mtconnect::source::adapter::agent_adapter {
     m_uuid = GetOption<string>(options, configuration::UUID);
 
     buildDeviceList();
+    buildTransformMetrics();
     buildCommandAndStatusDelivery();
 
     TransformPtr next =
@@ -0,0 +1,198 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "binary_adapter.hpp"
+
+#include <boost/asio/read.hpp>
+
+#include <chrono>
+#include <sstream>
+
+#include "mtconnect/configuration/config_options.hpp"
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+using namespace std::literals;
+
+namespace asio = boost::asio;
+namespace sys = boost::system;
+
+namespace mtconnect::source::adapter::binary {
+  BinaryAdapter::BinaryAdapter(boost::asio::io_context &io,
+                               pipeline::PipelineContextPtr pipelineContext,
+                               const ConfigOptions &options,
+                               const boost::property_tree::ptree &block)
+    : Adapter("BinaryAdapter", io, options),
+      Connector(Source::m_strand, "", 0, 60s),
+      m_pipeline(pipelineContext, Source::m_strand)
+  {
+    GetOptions(block, m_options, options);
+    AddOptions(block, m_options,
+               {{configuration::Heartbeat, Milliseconds {0}},
+                {configuration::UUID, string()},
+                {configuration::Manufacturer, string()},
+                {configuration::AdapterIdentity, string()},
+                {configuration::Station, string()},
+                {configuration::Url, string()}});
+
+    m_options.erase(configuration::Host);
+    m_options.erase(configuration::Port);
+    m_heartbeatOverride = GetOption<Milliseconds>(m_options, configuration::Heartbeat);
+
+    AddDefaultedOptions(block, m_options,
+                        {{configuration::Host, "localhost"s},
+                         {configuration::Port, 7878},
+                         {configuration::AutoAvailable, false},
+                         {configuration::IgnoreTimestamps, false},
+                         {configuration::SuppressIPAddress, false}});
+
+    m_server = get<string>(m_options[configuration::Host]);
+    m_port = get<int>(m_options[configuration::Port]);
+
+    auto timeout = m_options.find(configuration::LegacyTimeout);
+    if (timeout != m_options.end())
+      m_legacyTimeout = get<Seconds>(timeout->second);
+
+    stringstream url;
+    url << "binary://" << m_server << ':' << m_port;
+    m_name = url.str();
+
+    stringstream identity;
+    identity << '_' << m_server << '_' << m_port;
+
+    if (auto ident = GetOption<string>(m_options, configuration::AdapterIdentity))
+    {
+      m_identity = *ident;
+    }
+    else
+    {
+      if (IsOptionSet(m_options, configuration::SuppressIPAddress))
+        m_identity = CreateIdentityHash(identity.str());
+      else
+        m_identity = identity.str();
+      m_options[configuration::AdapterIdentity] = m_identity;
+    }
+
+    m_handler = m_pipeline.makeHandler();
+    if (m_pipeline.hasContract())
+      m_pipeline.build(m_options);
+    auto intv = GetOption<Milliseconds>(options, configuration::ReconnectInterval);
+    if (intv)
+      m_reconnectInterval = *intv;
+
+    if (m_reconnectInterval < 500ms)
+    {
+      LOG(warning) << "Reconnection interval set to " << m_reconnectInterval.count()
+                   << "ms, limiting it to 500ms";
+      m_reconnectInterval = 500ms;
+    }
+  }
+
+  void BinaryAdapter::processData(const string &data)
+  {
+    if (m_handler && m_handler->m_processData)
+      m_handler->m_processData(data, getIdentity());
+  }
+
+  void BinaryAdapter::processFrame(std::string_view frame)
+  {
+    NAMED_SCOPE("BinaryAdapter::processFrame");
+
+    try
+    {
+      if (frame.empty())
+        return;
+
+      if (FrameType(frame[0]) == FrameType::HEARTBEAT)
+      {
+        BinaryFrameReader reader(frame.substr(1));
+        auto freq = reader.read<uint32_t>();
+        LOG(debug) << "(Port:" << m_localPort << ") Received a heartbeat for " << m_server
+                   << " on port " << m_port;
+        if (!m_heartbeats)
+          startHeartbeats("* PONG " + to_string(freq));
+      }
+      else
+      {
+        processData(string(frame));
+      }
+    }
+    catch (std::exception &e)
+    {
+      LOG(error) << "Error in processFrame: " << e.what();
+    }
+    catch (...)
+    {
+      LOG(error) << "Unknown exception in processFrame";
+    }
+  }
+
+  void BinaryAdapter::asyncRead()
+  {
+    // Read whatever is available, frames are split out of the buffer in parseSocketBuffer
+    asio::async_read(
+        m_socket, m_incoming, asio::transfer_at_least(1), [this](sys::error_code ec, size_t len) {
+          asio::dispatch(Connector::m_strand, [this, ec, len]() { reader(ec, len); });
+        });
+  }
+
+  bool BinaryAdapter::parseSocketBuffer()
+  {
+    NAMED_SCOPE("BinaryAdapter::parseSocketBuffer");
+
+    // Cancel receive time limit
+    setReceiveTimeout();
+
+    auto len = m_incoming.size();
+    if (len < FrameHeaderSize)
+      return false;
+
+    auto start = static_cast<const char *>(m_incoming.data().data());
+    auto length = BinaryFrameReader::frameLength(start);
+    if (length == 0 || length > MaxFrameLength)
+    {
+      // The stream cannot be resynchronized, start over with a new connection
+      LOG(error) << "(" << m_server << ":" << m_port << ") Invalid binary frame length "
+                 << length << ", reconnecting";
+      m_incoming.consume(len);
+      asio::post(Connector::m_strand, [this]() { reconnect(); });
+      return false;
+    }
+
+    if (len < FrameHeaderSize + length)
+    {
+      LOG(trace) << "(" << m_server << ":" << m_port << ") partial frame, waiting for "
+                 << (FrameHeaderSize + length - len) << " more bytes";
+      return false;
+    }
+
+    processFrame({start + FrameHeaderSize, length});
+
+    m_incoming.consume(FrameHeaderSize + length);
+    return m_incoming.size() > 0;
+  }
+
+  void BinaryAdapter::stop()
+  {
+    NAMED_SCOPE("BinaryAdapter::stop");
+    LOG(debug) << "Waiting for adapter to stop: " << m_name;
+    close();
+
+    m_pipeline.clear();
+    LOG(debug) << "Adapter exited: " << m_name;
+  }
+}  // namespace mtconnect::source::adapter::binary
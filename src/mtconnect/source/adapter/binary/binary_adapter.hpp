@@ -0,0 +1,119 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "binary_pipeline.hpp"
+#include "binary_protocol.hpp"
+#include "mtconnect/config.hpp"
+#include "mtconnect/source/adapter/adapter.hpp"
+#include "mtconnect/source/adapter/shdr/connector.hpp"
+#include "mtconnect/source/source.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect {
+  /// @brief namespace for binary adapter sources
+  namespace source::adapter::binary {
+    /// @brief The binary adapter client source
+    ///
+    /// Connects to an adapter like the SHDR adapter, but the adapter sends length prefixed
+    /// binary frames (see binary_protocol.hpp) instead of lines of text. Commands sent to the
+    /// adapter, such as `* PING`, are the same as SHDR.
+    class AGENT_LIB_API BinaryAdapter : public adapter::Adapter, public shdr::Connector
+    {
+    public:
+      /// @brief Associate adapter with a device & connect to the server & port
+      /// @param[in] io boost asio io conext
+      /// @param[in] pipelineContext pipeline context
+      /// @param[in] options configuration options
+      /// @param[in] block additional configuration options not in options
+      BinaryAdapter(boost::asio::io_context &io, pipeline::PipelineContextPtr pipelineContext,
+                    const ConfigOptions &options, const boost::property_tree::ptree &block);
+      BinaryAdapter(const BinaryAdapter &) = delete;
+
+      /// @brief Factory registration method associate this source with `binary`
+      /// @param[in] factory the source factory
+      static void registerFactory(SourceFactory &factory)
+      {
+        factory.registerFactory(
+            "binary",
+            [](const std::string &name, boost::asio::io_context &io,
+               pipeline::PipelineContextPtr context, const ConfigOptions &options,
+               const boost::property_tree::ptree &block) -> source::SourcePtr {
+              auto source = std::make_shared<BinaryAdapter>(io, context, options, block);
+              return source;
+            });
+      }
+
+      ~BinaryAdapter() override { stop(); }
+
+      /// @name Source interface
+      ///@{
+      void processData(const std::string &data) override;
+      void protocolCommand(const std::string &data) override {}
+
+      void connecting() override
+      {
+        if (m_handler && m_handler->m_connecting)
+          m_handler->m_connecting(getIdentity());
+      }
+      void disconnected() override
+      {
+        if (m_handler && m_handler->m_disconnected)
+          m_handler->m_disconnected(getIdentity());
+      }
+      void connected() override
+      {
+        if (m_handler && m_handler->m_connected)
+          m_handler->m_connected(getIdentity());
+      }
+      void stop() override;
+      bool start() override
+      {
+        if (Connector::start())
+        {
+          m_pipeline.start();
+          return true;
+        }
+        else
+          return false;
+      }
+      ///@}
+
+      /// @name Agent Device methods
+      ///@{
+      const std::string &getHost() const override { return m_server; }
+      unsigned int getPort() const override { return m_port; }
+      pipeline::Pipeline *getPipeline() override { return &m_pipeline; }
+      ///@}
+
+      /// @brief Process a frame without the length prefix
+      /// @param[in] frame the frame type and payload
+      void processFrame(std::string_view frame);
+
+    protected:
+      void asyncRead() override;
+      bool parseSocketBuffer() override;
+
+    protected:
+      BinaryPipeline m_pipeline;
+    };
+  }  // namespace source::adapter::binary
+}  // namespace mtconnect
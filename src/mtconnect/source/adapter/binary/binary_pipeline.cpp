@@ -0,0 +1,53 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "binary_pipeline.hpp"
+
+#include "mtconnect/configuration/config_options.hpp"
+#include "mtconnect/pipeline/binary_frame_mapper.hpp"
+#include "mtconnect/pipeline/deliver.hpp"
+
+using namespace std;
+using namespace std::literals;
+
+namespace mtconnect {
+  using namespace observation;
+  using namespace entity;
+  using namespace pipeline;
+
+  namespace source::adapter::binary {
+    void BinaryPipeline::build(const ConfigOptions &options)
+    {
+      AdapterPipeline::build(options);
+      buildDeviceList();
+
+      buildCommandAndStatusDelivery();
+
+      // Frames are decoded directly to observations, there is no tokenization or timestamp
+      // extraction step.
+      auto mapper = make_shared<BinaryFrameMapper>(
+          m_context, m_device, IsOptionSet(m_options, configuration::IgnoreTimestamps));
+      mapper->bind(make_shared<NullTransform>(TypeGuard<Observations>(RUN)));
+
+      TransformPtr next = bind(mapper);
+
+      // Handle the observations and send to nowhere
+      buildObservationDelivery(next);
+      applySplices();
+    }
+  }  // namespace source::adapter::binary
+}  // namespace mtconnect
@@ -0,0 +1,326 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+/// @file binary_protocol.hpp
+/// @brief Framing and value encoding for the binary adapter protocol
+///
+/// The binary protocol is a compact alternative to SHDR for high-rate adapters. All integers
+/// and floating point values are little-endian. Every frame is prefixed with its length:
+///
+/// ```
+/// frame        := length:u32 type:u8 payload[length - 1]
+/// HEARTBEAT    := frequency:u32 (milliseconds, sent in response to `* PING`)
+/// BINDING      := { ordinal:u16 keyLength:u16 key[keyLength] }*
+/// OBSERVATIONS := timestamp:i64 (microseconds since the Unix epoch) { record }*
+/// record       := ordinal:u16 valueType:u8 value
+/// ```
+///
+/// A `BINDING` frame associates an ordinal with a data item key using the same `[device:]name`
+/// syntax as SHDR. The ordinals are used for all subsequent observations on the connection.
+///
+/// This header has no dependencies on the rest of the agent so it can be used as the reference
+/// implementation for adapters written in C++.
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mtconnect::source::adapter::binary {
+  /// @brief The size of the length prefix
+  constexpr size_t FrameHeaderSize = sizeof(uint32_t);
+  /// @brief The largest frame (type and payload) the agent will accept
+  constexpr size_t MaxFrameLength = 512 * 1024;
+
+  /// @brief Frame types
+  enum class FrameType : uint8_t
+  {
+    HEARTBEAT = 1,    ///< Heartbeat frequency in response to a PING
+    BINDING = 2,      ///< Bind ordinals to data item keys
+    OBSERVATIONS = 3  ///< A timestamped set of observation records
+  };
+
+  /// @brief The type of the value in an observation record
+  enum class ValueType : uint8_t
+  {
+    UNAVAILABLE = 0,  ///< No value follows
+    DOUBLE = 1,       ///< 64 bit float
+    INTEGER = 2,      ///< 64 bit signed integer
+    STRING = 3,       ///< length:u16 followed by UTF-8 bytes
+    VECTOR = 4,       ///< count:u16 followed by count 64 bit floats
+    TIMESERIES = 5    ///< count:u32 sampleRate:f64 followed by count 32 bit floats
+  };
+
+  /// @brief Error raised when a frame is truncated or malformed
+  class BinaryFrameError : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  /// @brief Writes binary frames to a byte buffer
+  ///
+  /// Frames are appended to an internal buffer that can be written to a socket with
+  /// `data()`. Observations are written between `beginObservations()` and `endFrame()`.
+  class BinaryFrameWriter
+  {
+  public:
+    BinaryFrameWriter() { m_buffer.reserve(4096); }
+
+    /// @brief Write a heartbeat frame
+    /// @param frequency the heartbeat frequency
+    void heartbeat(std::chrono::milliseconds frequency)
+    {
+      beginFrame(FrameType::HEARTBEAT);
+      put<uint32_t>(uint32_t(frequency.count()));
+      endFrame();
+    }
+
+    /// @brief Write a binding frame with a single ordinal
+    /// @param ordinal the ordinal used for the data item
+    /// @param key the data item name or id, optionally prefixed with `device:`
+    void bind(uint16_t ordinal, std::string_view key)
+    {
+      beginFrame(FrameType::BINDING);
+      put<uint16_t>(ordinal);
+      putString(key);
+      endFrame();
+    }
+
+    /// @brief Start an observation frame
+    /// @param timestamp the timestamp of all the observations in the frame
+    void beginObservations(std::chrono::system_clock::time_point timestamp)
+    {
+      using namespace std::chrono;
+      beginFrame(FrameType::OBSERVATIONS);
+      put<int64_t>(duration_cast<microseconds>(timestamp.time_since_epoch()).count());
+    }
+
+    /// @name Observation records
+    ///@{
+    void unavailable(uint16_t ordinal) { record(ordinal, ValueType::UNAVAILABLE); }
+    void value(uint16_t ordinal, double v)
+    {
+      record(ordinal, ValueType::DOUBLE);
+      put<double>(v);
+    }
+    void value(uint16_t ordinal, int64_t v)
+    {
+      record(ordinal, ValueType::INTEGER);
+      put<int64_t>(v);
+    }
+    void value(uint16_t ordinal, std::string_view v)
+    {
+      record(ordinal, ValueType::STRING);
+      putString(v);
+    }
+    void vector(uint16_t ordinal, const double *values, uint16_t count)
+    {
+      record(ordinal, ValueType::VECTOR);
+      put<uint16_t>(count);
+      putArray(values, count);
+    }
+    void timeseries(uint16_t ordinal, double sampleRate, const float *samples, uint32_t count)
+    {
+      record(ordinal, ValueType::TIMESERIES);
+      put<uint32_t>(count);
+      put<double>(sampleRate);
+      putArray(samples, count);
+    }
+    ///@}
+
+    /// @brief Finish the current frame by writing its length
+    void endFrame()
+    {
+      auto length = m_buffer.size() - m_frameStart - FrameHeaderSize;
+      if (length > MaxFrameLength)
+        throw BinaryFrameError("Binary frame exceeds maximum length");
+      encode<uint32_t>(m_buffer.data() + m_frameStart, uint32_t(length));
+    }
+
+    /// @brief the encoded frames
+    const std::string &data() const { return m_buffer; }
+    /// @brief discard all encoded frames
+    void clear() { m_buffer.clear(); }
+
+    /// @brief Encode a value as little-endian bytes
+    /// @tparam T an arithmetic type
+    /// @param[out] out the destination with at least `sizeof(T)` bytes
+    /// @param[in] v the value
+    template <typename T>
+    static void encode(char *out, T v)
+    {
+      if constexpr (std::endian::native == std::endian::little)
+      {
+        std::memcpy(out, &v, sizeof(T));
+      }
+      else
+      {
+        using U = std::conditional_t<sizeof(T) == 8, uint64_t,
+                                     std::conditional_t<sizeof(T) == 4, uint32_t,
+                                                        std::conditional_t<sizeof(T) == 2,
+                                                                           uint16_t, uint8_t>>>;
+        auto u = std::bit_cast<U>(v);
+        for (size_t i = 0; i < sizeof(T); i++)
+          out[i] = char((u >> (i * 8)) & 0xFF);
+      }
+    }
+
+  protected:
+    void beginFrame(FrameType type)
+    {
+      m_frameStart = m_buffer.size();
+      m_buffer.append(FrameHeaderSize, '\0');
+      put<uint8_t>(uint8_t(type));
+    }
+
+    void record(uint16_t ordinal, ValueType type)
+    {
+      put<uint16_t>(ordinal);
+      put<uint8_t>(uint8_t(type));
+    }
+
+    template <typename T>
+    void put(T v)
+    {
+      auto pos = m_buffer.size();
+      m_buffer.resize(pos + sizeof(T));
+      encode<T>(m_buffer.data() + pos, v);
+    }
+
+    void putString(std::string_view s)
+    {
+      if (s.size() > UINT16_MAX)
+        throw BinaryFrameError("Binary string value exceeds 65535 bytes");
+      put<uint16_t>(uint16_t(s.size()));
+      m_buffer.append(s.data(), s.size());
+    }
+
+    template <typename T>
+    void putArray(const T *values, size_t count)
+    {
+      auto pos = m_buffer.size();
+      m_buffer.resize(pos + count * sizeof(T));
+      if constexpr (std::endian::native == std::endian::little)
+      {
+        std::memcpy(m_buffer.data() + pos, values, count * sizeof(T));
+      }
+      else
+      {
+        for (size_t i = 0; i < count; i++)
+          encode<T>(m_buffer.data() + pos + i * sizeof(T), values[i]);
+      }
+    }
+
+  protected:
+    std::string m_buffer;
+    size_t m_frameStart {0};
+  };
+
+  /// @brief Bounds checked reader over the type and payload of a single frame
+  class BinaryFrameReader
+  {
+  public:
+    /// @brief Create a reader for a frame without the length prefix
+    /// @param frame the frame type and payload
+    BinaryFrameReader(std::string_view frame) : m_data(frame) {}
+
+    /// @brief read the length prefix of a frame
+    /// @param[in] header pointer to at least `FrameHeaderSize` bytes
+    /// @return the length of the frame type and payload
+    static uint32_t frameLength(const char *header) { return decode<uint32_t>(header); }
+
+    /// @brief Decode a little-endian value
+    /// @tparam T an arithmetic type
+    /// @param[in] in pointer to at least `sizeof(T)` bytes
+    /// @return the value
+    template <typename T>
+    static T decode(const char *in)
+    {
+      if constexpr (std::endian::native == std::endian::little)
+      {
+        T v;
+        std::memcpy(&v, in, sizeof(T));
+        return v;
+      }
+      else
+      {
+        using U = std::conditional_t<sizeof(T) == 8, uint64_t,
+                                     std::conditional_t<sizeof(T) == 4, uint32_t,
+                                                        std::conditional_t<sizeof(T) == 2,
+                                                                           uint16_t, uint8_t>>>;
+        U u = 0;
+        for (size_t i = 0; i < sizeof(T); i++)
+          u |= U(uint8_t(in[i])) << (i * 8);
+        return std::bit_cast<T>(u);
+      }
+    }
+
+    /// @brief `true` when the payload has been consumed
+    bool atEnd() const { return m_pos >= m_data.size(); }
+
+    /// @brief read a value and advance
+    template <typename T>
+    T read()
+    {
+      need(sizeof(T));
+      auto v = decode<T>(m_data.data() + m_pos);
+      m_pos += sizeof(T);
+      return v;
+    }
+
+    /// @brief read a length prefixed string without copying
+    std::string_view readString()
+    {
+      auto len = read<uint16_t>();
+      need(len);
+      auto s = m_data.substr(m_pos, len);
+      m_pos += len;
+      return s;
+    }
+
+    /// @brief read `count` values into a vector of doubles
+    /// @tparam T the encoded type of each element
+    template <typename T>
+    void readArray(std::vector<double> &out, size_t count)
+    {
+      need(count * sizeof(T));
+      out.resize(count);
+      auto *in = m_data.data() + m_pos;
+      for (size_t i = 0; i < count; i++, in += sizeof(T))
+        out[i] = double(decode<T>(in));
+      m_pos += count * sizeof(T);
+    }
+
+  protected:
+    void need(size_t n) const
+    {
+      if (m_data.size() - m_pos < n)
+        throw BinaryFrameError("Binary frame truncated");
+    }
+
+  protected:
+    std::string_view m_data;
+    size_t m_pos {0};
+  };
+}  // namespace mtconnect::source::adapter::binary
@@ -258,9 +258,11 @@ namespace mtconnect {
 
       // Build topic mapper pipeline
       auto next = bind(make_shared<TopicMapper>(
-          m_context, GetOption<string>(m_options, configuration::Device).value_or("")));
+          m_context, GetOption<string>(m_options, configuration::Device).value_or(""),
+          GetOption<StringList>(m_options, configuration::Topics).value_or(StringList())));
 
       auto map1 = next->bind(make_shared<JsonMapper>(m_context));
+      map1->bind(make_shared<NullTransform>(TypeGuard<Observations>(RUN)));
       auto map2 = next->bind(make_shared<DataMapper>(m_context, m_handler));
 
       // SHDR Parsing Branch, if Data is sent down...
@@ -0,0 +1,288 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "replay_adapter.hpp"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+#include "mtconnect/configuration/config_options.hpp"
+#include "mtconnect/logging.hpp"
+#include "mtconnect/pipeline/timestamp_extractor.hpp"
+
+using namespace std;
+using namespace std::literals;
+
+namespace asio = boost::asio;
+
+namespace mtconnect::source::adapter::replay {
+  /// @brief Default the identity to the block name since there is no host and port
+  static ConfigOptions ReplayOptions(const string &name, const ConfigOptions &options)
+  {
+    ConfigOptions res(options);
+    if (!HasOption(res, configuration::AdapterIdentity))
+      res[configuration::AdapterIdentity] = "_replay_"s + name;
+    return res;
+  }
+
+  /// @brief `true` if the line starts with a `YYYY-MM-DD...|` timestamp like `run_scenario.rb`
+  static bool HasTimestamp(string_view line)
+  {
+    if (line.size() < 11 || line.find('|') == string_view::npos)
+      return false;
+    for (size_t i = 0; i < 10; i++)
+    {
+      bool dash = i == 4 || i == 7;
+      if (dash ? line[i] != '-' : !isdigit(static_cast<unsigned char>(line[i])))
+        return false;
+    }
+    return true;
+  }
+
+  LatencySummary LatencySummary::make(std::vector<int64_t> &latencies)
+  {
+    LatencySummary summary;
+    if (latencies.empty())
+      return summary;
+
+    auto at = [&latencies](size_t n) {
+      nth_element(latencies.begin(), latencies.begin() + n, latencies.end());
+      return chrono::nanoseconds(latencies[n]);
+    };
+    summary.m_p50 = at(latencies.size() / 2);
+    summary.m_p99 = at(latencies.size() * 99 / 100);
+    summary.m_max = chrono::nanoseconds(*max_element(latencies.begin(), latencies.end()));
+    return summary;
+  }
+
+  LatencySummary LatencySummary::make(const pipeline::LatencyHistogram::Snapshot &snapshot)
+  {
+    LatencySummary summary;
+    summary.m_p50 = chrono::nanoseconds(snapshot.percentile(0.5));
+    summary.m_p99 = chrono::nanoseconds(snapshot.percentile(0.99));
+    summary.m_max = chrono::nanoseconds(snapshot.m_max);
+    return summary;
+  }
+
+  ReplayAdapter::ReplayAdapter(const std::string &name, boost::asio::io_context &io,
+                               pipeline::PipelineContextPtr pipelineContext,
+                               const ConfigOptions &options,
+                               const boost::property_tree::ptree &block)
+    : ShdrAdapter(io, pipelineContext, ReplayOptions(name, options), block), m_timer(io)
+  {
+    AddOptions(block, m_options, {{configuration::ReplayFile, string()}});
+    AddDefaultedOptions(block, m_options,
+                        {{configuration::ReplaySpeed, 1.0}, {configuration::ReplayLoop, false}});
+
+    m_file = GetOption<string>(m_options, configuration::ReplayFile).value_or(""s);
+    m_speed = max(0.0, GetOption<double>(m_options, configuration::ReplaySpeed).value_or(1.0));
+    m_loop = IsOptionSet(m_options, configuration::ReplayLoop);
+
+    m_name = "replay://"s + m_file;
+  }
+
+  bool ReplayAdapter::load(const std::string &file)
+  {
+    NAMED_SCOPE("ReplayAdapter::load");
+
+    ifstream in(file);
+    if (!in)
+    {
+      LOG(error) << "Cannot open replay file: " << file;
+      return false;
+    }
+
+    m_lines.clear();
+    optional<Timestamp> first, base;
+    Microseconds tzOffset {0};
+    chrono::microseconds offset {0};
+
+    string text;
+    while (getline(in, text))
+    {
+      if (!text.empty() && text.back() == '\r')
+        text.pop_back();
+      if (text.empty())
+        continue;
+
+      if (HasTimestamp(text))
+      {
+        // Parse from a view of the whole line so the parser sees the `|` after the timestamp
+        string_view token(text);
+        token = token.substr(0, token.find('|'));
+        auto [timestamp, duration] = pipeline::ParseTimestamp(token, false, base, tzOffset);
+        if (!first)
+          first = timestamp;
+        offset = max(offset, chrono::duration_cast<chrono::microseconds>(timestamp - *first));
+      }
+
+      m_lines.push_back({offset, std::move(text)});
+    }
+
+    LOG(info) << "Loaded " << m_lines.size() << " lines spanning "
+              << chrono::duration<double>(offset).count() << "s from " << file;
+    return true;
+  }
+
+  bool ReplayAdapter::start()
+  {
+    NAMED_SCOPE("ReplayAdapter::start");
+
+    if (m_file.empty())
+    {
+      LOG(error) << "No ReplayFile given for replay adapter " << m_identity;
+      return false;
+    }
+    if (!load(m_file))
+      return false;
+
+    // Time every transform. The metrics are only published if PipelineMetrics is set.
+    if (!m_pipeline.hasTransformMetrics())
+      m_pipeline.setTransformMetrics(true);
+    m_pipeline.start();
+    m_replaying = true;
+    m_passes = 0;
+    asio::post(Source::m_strand, [this, ptr = getptr()]() {
+      connecting();
+      connected();
+      begin();
+      inject();
+    });
+
+    return true;
+  }
+
+  void ReplayAdapter::stop()
+  {
+    NAMED_SCOPE("ReplayAdapter::stop");
+
+    if (m_replaying)
+    {
+      m_replaying = false;
+      m_timer.cancel();
+      disconnected();
+    }
+
+    ShdrAdapter::stop();
+  }
+
+  void ReplayAdapter::begin()
+  {
+    m_next = 0;
+    m_bytes = 0;
+    m_transformStart.clear();
+    for (auto &metrics : m_pipeline.getTransformMetrics())
+      m_transformStart.push_back(metrics->getLatency().snapshot());
+    m_start = chrono::steady_clock::now();
+  }
+
+  void ReplayAdapter::inject()
+  {
+    NAMED_SCOPE("ReplayAdapter::inject");
+
+    if (!m_replaying)
+      return;
+
+    for (size_t batch = 0; batch < BatchSize && m_next < m_lines.size(); batch++)
+    {
+      auto &line = m_lines[m_next];
+      auto now = chrono::steady_clock::now();
+
+      if (m_speed > 0.0)
+      {
+        auto due = m_start + chrono::duration_cast<chrono::steady_clock::duration>(
+                                 chrono::duration<double, micro>(line.m_offset) / m_speed);
+        if (due > now)
+        {
+          m_timer.expires_at(due);
+          m_timer.async_wait(asio::bind_executor(
+              Source::m_strand, [this, ptr = getptr()](boost::system::error_code ec) {
+                if (!ec)
+                  inject();
+              }));
+          return;
+        }
+        m_scheduleLatencies.push_back(chrono::nanoseconds(now - due).count());
+      }
+
+      processData(line.m_text);
+      m_pipelineLatencies.push_back(
+          chrono::nanoseconds(chrono::steady_clock::now() - now).count());
+      m_bytes += line.m_text.size();
+      m_next++;
+    }
+
+    if (m_next < m_lines.size())
+      asio::post(Source::m_strand, [this, ptr = getptr()]() { inject(); });
+    else
+      finish();
+  }
+
+  void ReplayAdapter::finish()
+  {
+    NAMED_SCOPE("ReplayAdapter::finish");
+
+    ReplayStatistics stats;
+    stats.m_lines = m_pipelineLatencies.size();
+    stats.m_bytes = m_bytes;
+    stats.m_elapsed = chrono::steady_clock::now() - m_start;
+    stats.m_schedule = LatencySummary::make(m_scheduleLatencies);
+    stats.m_pipeline = LatencySummary::make(m_pipelineLatencies);
+
+    size_t i = 0;
+    for (auto &metrics : m_pipeline.getTransformMetrics())
+    {
+      auto snapshot = metrics->getLatency().snapshot();
+      if (i < m_transformStart.size())
+        snapshot = snapshot.since(m_transformStart[i]);
+      stats.m_transforms.push_back(
+          {metrics->getName(), snapshot.m_count, LatencySummary::make(snapshot)});
+      i++;
+    }
+    m_statistics = stats;
+    m_passes++;
+
+    auto us = [](chrono::nanoseconds d) { return double(d.count()) / 1000.0; };
+    LOG(info) << "Replay of " << m_file << " pass " << m_passes << ": " << stats.m_lines
+              << " lines, " << stats.m_bytes << " bytes in " << stats.m_elapsed.count()
+              << "s, " << stats.linesPerSecond() << " lines/s";
+    LOG(info) << "  schedule lag us p50 " << us(stats.m_schedule.m_p50) << ", p99 "
+              << us(stats.m_schedule.m_p99) << ", max " << us(stats.m_schedule.m_max);
+    LOG(info) << "  pipeline us p50 " << us(stats.m_pipeline.m_p50) << ", p99 "
+              << us(stats.m_pipeline.m_p99) << ", max " << us(stats.m_pipeline.m_max);
+    for (auto &transform : stats.m_transforms)
+    {
+      LOG(info) << "    " << transform.m_name << ": " << transform.m_count
+                << " entities, us p50 " << us(transform.m_latency.m_p50) << ", p99 "
+                << us(transform.m_latency.m_p99) << ", max " << us(transform.m_latency.m_max);
+    }
+
+    m_scheduleLatencies.clear();
+    m_pipelineLatencies.clear();
+    m_bytes = 0;
+
+    if (m_loop && m_replaying && !m_lines.empty())
+    {
+      begin();
+      asio::post(Source::m_strand, [this, ptr = getptr()]() { inject(); });
+    }
+  }
+}  // namespace mtconnect::source::adapter::replay
@@ -0,0 +1,173 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <boost/asio/steady_timer.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/pipeline/transform_metrics.hpp"
+#include "mtconnect/source/adapter/shdr/shdr_adapter.hpp"
+
+namespace mtconnect {
+  /// @brief namespace for SHDR replay sources
+  namespace source::adapter::replay {
+    /// @brief Percentiles of a set of latencies
+    struct AGENT_LIB_API LatencySummary
+    {
+      /// @brief Summarize latencies in nanoseconds
+      /// @param[in,out] latencies the latencies, reordered by the summary
+      /// @return the summary
+      static LatencySummary make(std::vector<int64_t> &latencies);
+      /// @brief Summarize a latency histogram
+      /// @param[in] snapshot the histogram snapshot
+      /// @return the summary
+      static LatencySummary make(const pipeline::LatencyHistogram::Snapshot &snapshot);
+
+      std::chrono::nanoseconds m_p50 {0};
+      std::chrono::nanoseconds m_p99 {0};
+      std::chrono::nanoseconds m_max {0};
+    };
+
+    /// @brief The latency of one transform in the pipeline for a pass
+    struct AGENT_LIB_API TransformLatency
+    {
+      std::string m_name;
+      uint64_t m_count {0};
+      LatencySummary m_latency;
+    };
+
+    /// @brief The results of one pass through a capture
+    struct AGENT_LIB_API ReplayStatistics
+    {
+      /// @brief ingest throughput for the pass
+      double linesPerSecond() const
+      {
+        return m_elapsed.count() > 0 ? double(m_lines) / m_elapsed.count() : 0.0;
+      }
+
+      size_t m_lines {0};
+      size_t m_bytes {0};
+      std::chrono::duration<double> m_elapsed {0.0};
+      /// @brief how late lines were injected relative to the paced schedule
+      LatencySummary m_schedule;
+      /// @brief time from injection until the pipeline delivered the line
+      LatencySummary m_pipeline;
+      /// @brief time spent in each transform, in pipeline order
+      std::vector<TransformLatency> m_transforms;
+    };
+
+    /// @brief A SHDR adapter that replays a recorded capture without a network connection
+    ///
+    /// The capture is loaded into memory when the source starts and each line is injected
+    /// directly into the SHDR pipeline on the source strand. Lines that begin with an ISO 8601
+    /// timestamp are paced by the difference between their timestamps divided by `ReplaySpeed`.
+    /// A speed of `1` replays in real time, `N` replays `N` times faster, and `0` replays as fast
+    /// as possible. Lines without a timestamp are injected with the preceding line.
+    ///
+    /// At the end of every pass the ingest throughput and the latencies of the schedule and
+    /// pipeline stages are logged and available from `getStatistics()`. The pipeline stage is
+    /// broken down by transform using the pipeline's transform metrics, which are always enabled
+    /// for a replay. If `ReplayLoop` is set the capture is replayed until the source is stopped.
+    class AGENT_LIB_API ReplayAdapter : public shdr::ShdrAdapter
+    {
+    public:
+      /// @brief The maximum number of lines injected before yielding the strand
+      static constexpr size_t BatchSize = 1024;
+
+      /// @brief Create a replay adapter
+      /// @param[in] name the name of the adapter configuration block
+      /// @param[in] io boost asio io conext
+      /// @param[in] pipelineContext pipeline context
+      /// @param[in] options configuration options
+      /// @param[in] block additional configuration options not in options
+      ReplayAdapter(const std::string &name, boost::asio::io_context &io,
+                    pipeline::PipelineContextPtr pipelineContext, const ConfigOptions &options,
+                    const boost::property_tree::ptree &block);
+      ReplayAdapter(const ReplayAdapter &) = delete;
+
+      /// @brief Factory registration method associate this source with `replay`
+      /// @param[in] factory the source factory
+      static void registerFactory(SourceFactory &factory)
+      {
+        factory.registerFactory(
+            "replay",
+            [](const std::string &name, boost::asio::io_context &io,
+               pipeline::PipelineContextPtr context, const ConfigOptions &options,
+               const boost::property_tree::ptree &block) -> source::SourcePtr {
+              auto source = std::make_shared<ReplayAdapter>(name, io, context, options, block);
+              return source;
+            });
+      }
+
+      ~ReplayAdapter() override { stop(); }
+
+      /// @name Source interface
+      ///@{
+      bool start() override;
+      void stop() override;
+      ///@}
+
+      unsigned int getPort() const override { return 0; }
+
+      /// @brief Load a capture into memory
+      /// @param[in] file the path to the capture
+      /// @return `true` if the file could be read
+      bool load(const std::string &file);
+
+      /// @brief the number of completed passes through the capture
+      auto getPasses() const { return m_passes; }
+      /// @brief the statistics for the last completed pass
+      const auto &getStatistics() const { return m_statistics; }
+
+    protected:
+      void begin();
+      void inject();
+      void finish();
+
+      /// @brief A line from the capture and its offset from the first timestamp
+      struct Line
+      {
+        std::chrono::microseconds m_offset;
+        std::string m_text;
+      };
+
+    protected:
+      std::string m_file;
+      double m_speed;
+      bool m_loop;
+
+      std::vector<Line> m_lines;
+      size_t m_next {0};
+      bool m_replaying {false};
+      size_t m_passes {0};
+
+      boost::asio::steady_timer m_timer;
+      std::chrono::steady_clock::time_point m_start;
+      std::vector<int64_t> m_scheduleLatencies;
+      std::vector<int64_t> m_pipelineLatencies;
+      std::vector<pipeline::LatencyHistogram::Snapshot> m_transformStart;
+      size_t m_bytes {0};
+      ReplayStatistics m_statistics;
+    };
+  }  // namespace source::adapter::replay
+}  // namespace mtconnect
@@ -259,12 +259,17 @@ namespace mtconnect::source::adapter::shdr {
         }
       });
 
-      asio::async_read_until(m_socket, m_incoming, '\n', [this](sys::error_code ec, size_t len) {
-        asio::dispatch(m_strand, boost::bind(&Connector::reader, this, ec, len));
-      });
+      asyncRead();
     }
   }
 
+  void Connector::asyncRead()
+  {
+    asio::async_read_until(m_socket, m_incoming, '\n', [this](sys::error_code ec, size_t len) {
+      asio::dispatch(m_strand, boost::bind(&Connector::reader, this, ec, len));
+    });
+  }
+
   void Connector::writer(sys::error_code ec, size_t length)
   {
     NAMED_SCOPE("Connector::writer");
@@ -284,7 +289,7 @@ namespace mtconnect::source::adapter::shdr {
       ;
   }
 
-  inline void Connector::setReceiveTimeout()
+  void Connector::setReceiveTimeout()
   {
     NAMED_SCOPE("Connector::setReceiveTimeout");
 
@@ -108,7 +108,13 @@ namespace mtconnect::source::adapter::shdr {
                    const boost::asio::ip::tcp::endpoint &endpoint);
     void writer(boost::system::error_code ec, std::size_t length);
     void reader(boost::system::error_code ec, std::size_t length);
-    bool parseSocketBuffer();
+    /// @brief Start an asynchronous read from the socket into the incoming buffer
+    ///
+    /// The default reads until the next line feed. Framed protocols can override.
+    virtual void asyncRead();
+    /// @brief Consume one unit of data from the incoming buffer
+    /// @return `true` if there is more data in the buffer
+    virtual bool parseSocketBuffer();
     void processLine(const std::string &line);
     void startHeartbeats(const std::string &buf);
     void heartbeat(boost::system::error_code ec);
@@ -0,0 +1,176 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "shm_adapter.hpp"
+
+#include <boost/asio/post.hpp>
+
+#include "mtconnect/configuration/config_options.hpp"
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+using namespace std::literals;
+
+namespace asio = boost::asio;
+
+namespace mtconnect::source::adapter::shm {
+  /// @brief Default the identity to the block name since there is no host and port
+  static ConfigOptions ShmOptions(const string &name, const ConfigOptions &options)
+  {
+    ConfigOptions res(options);
+    if (!HasOption(res, configuration::AdapterIdentity))
+      res[configuration::AdapterIdentity] = "_shm_"s + name;
+    return res;
+  }
+
+  ShmAdapter::ShmAdapter(const std::string &name, boost::asio::io_context &io,
+                         pipeline::PipelineContextPtr pipelineContext,
+                         const ConfigOptions &options, const boost::property_tree::ptree &block)
+    : ShdrAdapter(io, pipelineContext, ShmOptions(name, options), block)
+  {
+    AddDefaultedOptions(block, m_options,
+                        {{configuration::SharedMemoryName, "/mtconnect_"s + name},
+                         {configuration::SharedMemorySlotSize, 256},
+                         {configuration::SharedMemorySlots, 65536}});
+
+    m_ringName = *GetOption<string>(m_options, configuration::SharedMemoryName);
+    m_slotSize = uint32_t(*GetOption<int>(m_options, configuration::SharedMemorySlotSize));
+    m_slotCount = uint32_t(*GetOption<int>(m_options, configuration::SharedMemorySlots));
+
+    // Without socket heartbeats, the producer is considered disconnected if it has not written
+    // or sent a heartbeat for twice the heartbeat interval.
+    if (m_heartbeatOverride)
+      m_producerTimeout = 2 * *m_heartbeatOverride;
+    else
+      m_producerTimeout = 10s;
+
+    m_name = "shm://"s + m_ringName;
+  }
+
+  bool ShmAdapter::start()
+  {
+    NAMED_SCOPE("ShmAdapter::start");
+
+    try
+    {
+      m_consumer =
+          make_unique<ShmRingConsumer>(ShmRing::create(m_ringName, m_slotSize, m_slotCount));
+    }
+    catch (std::exception &e)
+    {
+      LOG(error) << "Cannot create shared memory ring " << m_ringName << ": " << e.what();
+      return false;
+    }
+
+    LOG(info) << "Waiting for producer on shared memory ring " << m_ringName;
+    m_pipeline.start();
+    asio::post(Source::m_strand, [this]() { connecting(); });
+
+    m_consuming = true;
+    m_thread = std::thread([this]() { consume(); });
+
+    return true;
+  }
+
+  void ShmAdapter::stop()
+  {
+    NAMED_SCOPE("ShmAdapter::stop");
+
+    {
+      lock_guard<mutex> lock(m_drainLock);
+      m_consuming = false;
+    }
+    m_drainCondition.notify_all();
+    if (m_thread.joinable())
+      m_thread.join();
+
+    if (m_producerConnected)
+    {
+      m_producerConnected = false;
+      disconnected();
+    }
+
+    ShdrAdapter::stop();
+
+    lock_guard<mutex> lock(m_drainLock);
+    m_consumer.reset();
+  }
+
+  void ShmAdapter::consume()
+  {
+    NAMED_SCOPE("ShmAdapter::consume");
+
+    auto timeout = uint64_t(chrono::nanoseconds(m_producerTimeout).count());
+    while (m_consuming)
+    {
+      bool ready = m_consumer->wait(100ms);
+
+      // Track the producer liveness and report connection status on the strand
+      auto beat = m_consumer->producerBeat();
+      bool alive = beat != 0 && SteadyNow() - beat < timeout;
+      if (alive != m_producerConnected)
+      {
+        m_producerConnected = alive;
+        if (alive)
+        {
+          LOG(info) << "Producer attached to shared memory ring " << m_ringName;
+          asio::post(Source::m_strand, [this]() { connected(); });
+        }
+        else
+        {
+          LOG(warning) << "Producer on shared memory ring " << m_ringName << " timed out";
+          asio::post(Source::m_strand, [this]() {
+            disconnected();
+            connecting();
+          });
+        }
+      }
+
+      if (ready)
+      {
+        unique_lock<mutex> lock(m_drainLock);
+        if (!m_consuming)
+          break;
+        m_drained = false;
+        asio::post(Source::m_strand, [this]() { drain(); });
+        m_drainCondition.wait(lock, [this]() { return m_drained || !m_consuming; });
+      }
+    }
+  }
+
+  void ShmAdapter::drain()
+  {
+    NAMED_SCOPE("ShmAdapter::drain");
+
+    {
+      lock_guard<mutex> lock(m_drainLock);
+      if (m_consuming && m_consumer)
+      {
+        try
+        {
+          m_consumer->drain([this](string_view record) { processData(string(record)); });
+        }
+        catch (std::exception &e)
+        {
+          LOG(error) << "Error draining shared memory ring: " << e.what();
+        }
+      }
+      m_drained = true;
+    }
+    m_drainCondition.notify_one();
+  }
+}  // namespace mtconnect::source::adapter::shm
@@ -0,0 +1,103 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/source/adapter/shdr/shdr_adapter.hpp"
+#include "shm_ring.hpp"
+
+namespace mtconnect {
+  /// @brief namespace for shared memory adapter sources
+  namespace source::adapter::shm {
+    /// @brief A SHDR adapter that reads from a shared memory ring instead of a socket
+    ///
+    /// For adapters running on the same host as the agent. The records are SHDR lines and are
+    /// handled exactly like the SHDR adapter, including protocol commands and multiline data.
+    /// The agent creates the ring and the adapter attaches to it with `ShmRingProducer`.
+    ///
+    /// A thread waits on the ring and hands each batch to the source strand, so the pipeline
+    /// runs on the strand like all other adapters.
+    class AGENT_LIB_API ShmAdapter : public shdr::ShdrAdapter
+    {
+    public:
+      /// @brief Create a shared memory adapter
+      /// @param[in] name the name of the adapter configuration block
+      /// @param[in] io boost asio io conext
+      /// @param[in] pipelineContext pipeline context
+      /// @param[in] options configuration options
+      /// @param[in] block additional configuration options not in options
+      ShmAdapter(const std::string &name, boost::asio::io_context &io,
+                 pipeline::PipelineContextPtr pipelineContext, const ConfigOptions &options,
+                 const boost::property_tree::ptree &block);
+      ShmAdapter(const ShmAdapter &) = delete;
+
+      /// @brief Factory registration method associate this source with `shm`
+      /// @param[in] factory the source factory
+      static void registerFactory(SourceFactory &factory)
+      {
+        factory.registerFactory(
+            "shm",
+            [](const std::string &name, boost::asio::io_context &io,
+               pipeline::PipelineContextPtr context, const ConfigOptions &options,
+               const boost::property_tree::ptree &block) -> source::SourcePtr {
+              auto source = std::make_shared<ShmAdapter>(name, io, context, options, block);
+              return source;
+            });
+      }
+
+      ~ShmAdapter() override { stop(); }
+
+      /// @name Source interface
+      ///@{
+      bool start() override;
+      void stop() override;
+      ///@}
+
+      unsigned int getPort() const override { return 0; }
+
+      /// @brief the shared memory object name of the ring
+      const auto &getRingName() const { return m_ringName; }
+
+    protected:
+      void consume();
+      void drain();
+
+    protected:
+      std::string m_ringName;
+      uint32_t m_slotSize;
+      uint32_t m_slotCount;
+      std::chrono::milliseconds m_producerTimeout;
+
+      std::unique_ptr<ShmRingConsumer> m_consumer;
+      std::thread m_thread;
+      std::atomic_bool m_consuming {false};
+      bool m_producerConnected {false};
+
+      std::mutex m_drainLock;
+      std::condition_variable m_drainCondition;
+      bool m_drained {true};
+    };
+  }  // namespace source::adapter::shm
+}  // namespace mtconnect
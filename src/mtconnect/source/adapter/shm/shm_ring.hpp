@@ -0,0 +1,452 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+/// @file shm_ring.hpp
+/// @brief Single producer, single consumer shared memory ring for co-located adapters
+///
+/// The ring lives in a POSIX shared memory object (`/dev/shm` on Linux) and is made of fixed
+/// size slots. Each slot has a small header with the number of bytes used and a flag if the
+/// record continues in the next slot, so records larger than a slot occupy consecutive slots.
+/// Records are SHDR lines without the line terminator.
+///
+/// The producer and consumer only share the head and tail indexes. The consumer sleeps on a
+/// futex doorbell on Linux; the producer only makes the wake system call when the consumer is
+/// waiting. On other POSIX platforms the consumer polls.
+///
+/// This header has no dependencies on the rest of the agent so it can be used as the producer
+/// library for adapters written in C++.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace mtconnect::source::adapter::shm {
+  /// @brief Identifies an initialized ring: `MTSR`
+  constexpr uint32_t RingMagic = 0x4D545352;
+  /// @brief Layout version
+  constexpr uint32_t RingVersion = 1;
+  /// @brief The slot flag indicating the record continues in the next slot
+  constexpr uint32_t SlotContinues = 0x1;
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "Shared memory ring requires lock free 64 bit atomics");
+  static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                "Shared memory ring requires lock free 32 bit atomics");
+
+  /// @brief The control block at the start of the shared memory object
+  ///
+  /// The head and tail are on separate cache lines so the producer and consumer do not contend.
+  struct RingHeader
+  {
+    std::atomic<uint32_t> m_magic;
+    uint32_t m_version;
+    uint32_t m_slotSize;
+    uint32_t m_slotCount;
+
+    /// @brief Next slot to write, only written by the producer
+    alignas(64) std::atomic<uint64_t> m_head;
+    /// @brief Next slot to read, only written by the consumer
+    alignas(64) std::atomic<uint64_t> m_tail;
+
+    /// @brief Incremented by the producer after publishing, used as the futex word
+    alignas(64) std::atomic<uint32_t> m_doorbell;
+    /// @brief Set by the consumer before it sleeps on the doorbell
+    std::atomic<uint32_t> m_waiting;
+    /// @brief Producer liveness in steady clock nanoseconds
+    std::atomic<uint64_t> m_producerBeat;
+    /// @brief Records the producer could not write because the ring was full
+    std::atomic<uint64_t> m_dropped;
+  };
+
+  /// @brief Header at the start of every slot
+  struct SlotHeader
+  {
+    uint32_t m_length;
+    uint32_t m_flags;
+  };
+
+  /// @brief The current steady clock time in nanoseconds
+  ///
+  /// `CLOCK_MONOTONIC` is shared by all processes on the host so the value can be compared
+  /// between the producer and consumer.
+  inline uint64_t SteadyNow()
+  {
+    using namespace std::chrono;
+    return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+  }
+
+  /// @brief A mapping of a shared memory ring
+  class ShmRing
+  {
+  public:
+    ShmRing(const ShmRing &) = delete;
+    ~ShmRing()
+    {
+      if (m_base != nullptr)
+        ::munmap(m_base, m_size);
+    }
+
+    /// @brief Create the ring or attach to an existing ring with the same geometry
+    ///
+    /// Used by the consumer. An existing ring is kept so a producer that is already attached
+    /// continues where it left off.
+    /// @param[in] name the shared memory object name, must start with `/`
+    /// @param[in] slotSize the size of each slot including the slot header
+    /// @param[in] slotCount the number of slots, must be a power of two
+    /// @return the mapped ring
+    static std::unique_ptr<ShmRing> create(const std::string &name, uint32_t slotSize,
+                                           uint32_t slotCount)
+    {
+      if (slotSize <= sizeof(SlotHeader) || slotSize % 8 != 0)
+        throw std::invalid_argument("Shared memory slot size must be a multiple of 8");
+      if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0)
+        throw std::invalid_argument("Shared memory slot count must be a power of two");
+
+      int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR, 0660);
+      if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+
+      auto size = sizeof(RingHeader) + size_t(slotSize) * slotCount;
+      if (::ftruncate(fd, off_t(size)) != 0)
+      {
+        auto err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "ftruncate " + name);
+      }
+
+      std::unique_ptr<ShmRing> ring(new ShmRing(fd, size));
+      auto header = ring->header();
+      if (header->m_magic.load(std::memory_order_acquire) != RingMagic ||
+          header->m_version != RingVersion || header->m_slotSize != slotSize ||
+          header->m_slotCount != slotCount)
+      {
+        header->m_magic.store(0, std::memory_order_relaxed);
+        header->m_version = RingVersion;
+        header->m_slotSize = slotSize;
+        header->m_slotCount = slotCount;
+        header->m_head.store(0, std::memory_order_relaxed);
+        header->m_tail.store(0, std::memory_order_relaxed);
+        header->m_doorbell.store(0, std::memory_order_relaxed);
+        header->m_waiting.store(0, std::memory_order_relaxed);
+        header->m_producerBeat.store(0, std::memory_order_relaxed);
+        header->m_dropped.store(0, std::memory_order_relaxed);
+        header->m_magic.store(RingMagic, std::memory_order_release);
+      }
+      ring->setGeometry();
+
+      return ring;
+    }
+
+    /// @brief Attach to a ring created by the consumer
+    /// @param[in] name the shared memory object name
+    /// @return the mapped ring or `nullptr` if the ring does not exist or is not initialized
+    static std::unique_ptr<ShmRing> open(const std::string &name)
+    {
+      int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+      if (fd < 0)
+        return nullptr;
+
+      struct stat st;
+      if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(RingHeader))
+      {
+        ::close(fd);
+        return nullptr;
+      }
+
+      std::unique_ptr<ShmRing> ring(new ShmRing(fd, size_t(st.st_size)));
+      auto header = ring->header();
+      if (header->m_magic.load(std::memory_order_acquire) != RingMagic ||
+          header->m_version != RingVersion ||
+          ring->m_size < sizeof(RingHeader) + size_t(header->m_slotSize) * header->m_slotCount)
+        return nullptr;
+      ring->setGeometry();
+
+      return ring;
+    }
+
+    /// @brief Remove the shared memory object name. Existing mappings stay valid.
+    /// @param[in] name the shared memory object name
+    static void unlink(const std::string &name) { ::shm_unlink(name.c_str()); }
+
+    /// @brief the control block
+    RingHeader *header() { return static_cast<RingHeader *>(m_base); }
+    /// @brief get the slot for a monotonically increasing index
+    char *slot(uint64_t index) { return m_slots + (index & m_mask) * m_slotSize; }
+    /// @brief the number of payload bytes in a slot
+    uint32_t payloadSize() const { return m_slotSize - uint32_t(sizeof(SlotHeader)); }
+    /// @brief the number of slots
+    uint32_t slotCount() const { return m_slotCount; }
+
+    /// @brief Wake the consumer if it is sleeping on the doorbell
+    void ring()
+    {
+      auto h = header();
+      h->m_doorbell.fetch_add(1, std::memory_order_seq_cst);
+      if (h->m_waiting.load(std::memory_order_seq_cst) != 0)
+      {
+#ifdef __linux__
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&h->m_doorbell), FUTEX_WAKE, 1,
+                  nullptr, nullptr, 0);
+#endif
+      }
+    }
+
+    /// @brief Sleep until the doorbell changes from `value` or the timeout expires
+    void sleep(uint32_t value, std::chrono::microseconds timeout)
+    {
+#ifdef __linux__
+      struct timespec ts;
+      ts.tv_sec = time_t(timeout.count() / 1000000);
+      ts.tv_nsec = long((timeout.count() % 1000000) * 1000);
+      ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&header()->m_doorbell), FUTEX_WAIT,
+                value, &ts, nullptr, 0);
+#else
+      std::this_thread::sleep_for(std::min(timeout, std::chrono::microseconds(200)));
+#endif
+    }
+
+  protected:
+    ShmRing(int fd, size_t size) : m_size(size)
+    {
+      m_base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      auto err = errno;
+      ::close(fd);
+      if (m_base == MAP_FAILED)
+      {
+        m_base = nullptr;
+        throw std::system_error(err, std::generic_category(), "mmap");
+      }
+    }
+
+    void setGeometry()
+    {
+      m_slotSize = header()->m_slotSize;
+      m_slotCount = header()->m_slotCount;
+      m_mask = m_slotCount - 1;
+      m_slots = static_cast<char *>(m_base) + sizeof(RingHeader);
+    }
+
+  protected:
+    void *m_base {nullptr};
+    size_t m_size {0};
+    char *m_slots {nullptr};
+    uint32_t m_slotSize {0};
+    uint32_t m_slotCount {0};
+    uint64_t m_mask {0};
+  };
+
+  /// @brief The adapter side of the ring
+  class ShmRingProducer
+  {
+  public:
+    /// @brief Create a producer for a mapped ring
+    /// @param[in] ring the ring, usually from `ShmRing::open`
+    ShmRingProducer(std::unique_ptr<ShmRing> &&ring) : m_ring(std::move(ring))
+    {
+      m_head = m_ring->header()->m_head.load(std::memory_order_relaxed);
+      m_tail = m_ring->header()->m_tail.load(std::memory_order_acquire);
+    }
+
+    /// @brief Attach to a ring by name
+    /// @param[in] name the shared memory object name
+    /// @return the producer or `nullptr` if the agent has not created the ring
+    static std::unique_ptr<ShmRingProducer> open(const std::string &name)
+    {
+      auto ring = ShmRing::open(name);
+      if (!ring)
+        return nullptr;
+      return std::make_unique<ShmRingProducer>(std::move(ring));
+    }
+
+    /// @brief Write a record without blocking
+    /// @param[in] record a SHDR line without the line terminator
+    /// @param[in] notify wake the consumer, set to `false` when writing a batch and call
+    ///                   `notify()` after the last record
+    /// @return `false` if there is not enough free space and the record was dropped
+    bool write(std::string_view record, bool notify = true)
+    {
+      auto payload = m_ring->payloadSize();
+      uint64_t needed = std::max<uint64_t>(1, (record.size() + payload - 1) / payload);
+      auto header = m_ring->header();
+
+      if (m_head + needed - m_tail > m_ring->slotCount())
+      {
+        m_tail = header->m_tail.load(std::memory_order_acquire);
+        if (m_head + needed - m_tail > m_ring->slotCount())
+        {
+          header->m_dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+      }
+
+      const char *data = record.data();
+      size_t remaining = record.size();
+      for (uint64_t i = 0; i < needed; i++)
+      {
+        auto slot = m_ring->slot(m_head + i);
+        auto len = uint32_t(std::min<size_t>(remaining, payload));
+        SlotHeader sh {len, (i + 1 < needed) ? SlotContinues : 0};
+        std::memcpy(slot, &sh, sizeof(sh));
+        std::memcpy(slot + sizeof(SlotHeader), data, len);
+        data += len;
+        remaining -= len;
+      }
+
+      m_head += needed;
+      header->m_head.store(m_head, std::memory_order_release);
+      header->m_producerBeat.store(SteadyNow(), std::memory_order_relaxed);
+      if (notify)
+        m_ring->ring();
+
+      return true;
+    }
+
+    /// @brief Wake the consumer after a batch of writes
+    void notify() { m_ring->ring(); }
+
+    /// @brief Tell the agent the producer is alive when there is no data to send
+    void heartbeat()
+    {
+      m_ring->header()->m_producerBeat.store(SteadyNow(), std::memory_order_relaxed);
+    }
+
+    /// @brief the number of records dropped because the ring was full
+    uint64_t dropped() const { return m_ring->header()->m_dropped.load(); }
+
+  protected:
+    std::unique_ptr<ShmRing> m_ring;
+    uint64_t m_head {0};
+    uint64_t m_tail {0};
+  };
+
+  /// @brief The agent side of the ring
+  class ShmRingConsumer
+  {
+  public:
+    /// @brief Create a consumer for a mapped ring
+    /// @param[in] ring the ring, usually from `ShmRing::create`
+    ShmRingConsumer(std::unique_ptr<ShmRing> &&ring) : m_ring(std::move(ring))
+    {
+      m_tail = m_ring->header()->m_tail.load(std::memory_order_relaxed);
+    }
+
+    /// @brief `true` if there are unread slots
+    bool available() const
+    {
+      return m_ring->header()->m_head.load(std::memory_order_acquire) != m_tail;
+    }
+
+    /// @brief Read all available records
+    ///
+    /// The string view passed to `f` is only valid for the duration of the call.
+    /// @param[in] f called with each record
+    /// @param[in] limit the maximum number of records to read
+    /// @return the number of records read
+    template <typename F>
+    size_t drain(F &&f, size_t limit = SIZE_MAX)
+    {
+      auto header = m_ring->header();
+      auto head = header->m_head.load(std::memory_order_acquire);
+      auto payload = m_ring->payloadSize();
+      size_t count = 0;
+
+      while (m_tail != head && count < limit)
+      {
+        auto slot = m_ring->slot(m_tail);
+        SlotHeader sh;
+        std::memcpy(&sh, slot, sizeof(sh));
+        std::string_view data(slot + sizeof(SlotHeader), std::min(sh.m_length, payload));
+
+        if ((sh.m_flags & SlotContinues) != 0)
+        {
+          m_partial.append(data);
+        }
+        else if (!m_partial.empty())
+        {
+          m_partial.append(data);
+          f(std::string_view(m_partial));
+          m_partial.clear();
+          count++;
+        }
+        else
+        {
+          f(data);
+          count++;
+        }
+
+        // Release slots in batches so the producer is not starved during a long drain
+        if ((++m_tail & 0x3F) == 0)
+          header->m_tail.store(m_tail, std::memory_order_release);
+      }
+      header->m_tail.store(m_tail, std::memory_order_release);
+
+      return count;
+    }
+
+    /// @brief Wait for data
+    /// @param[in] timeout the maximum time to wait
+    /// @return `true` if there is data available
+    bool wait(std::chrono::microseconds timeout)
+    {
+      if (available())
+        return true;
+
+      auto header = m_ring->header();
+      auto bell = header->m_doorbell.load(std::memory_order_seq_cst);
+      header->m_waiting.store(1, std::memory_order_seq_cst);
+      if (header->m_doorbell.load(std::memory_order_seq_cst) == bell && !available())
+        m_ring->sleep(bell, timeout);
+      header->m_waiting.store(0, std::memory_order_relaxed);
+
+      return available();
+    }
+
+    /// @brief the last time the producer wrote or sent a heartbeat in steady clock nanoseconds
+    uint64_t producerBeat() const
+    {
+      return m_ring->header()->m_producerBeat.load(std::memory_order_relaxed);
+    }
+
+    /// @brief the number of records the producer dropped because the ring was full
+    uint64_t dropped() const { return m_ring->header()->m_dropped.load(); }
+
+  protected:
+    std::unique_ptr<ShmRing> m_ring;
+    std::string m_partial;
+    uint64_t m_tail {0};
+  };
+}  // namespace mtconnect::source::adapter::shm
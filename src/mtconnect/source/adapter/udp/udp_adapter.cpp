@@ -0,0 +1,345 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "udp_adapter.hpp"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/ip/address.hpp>
+#include <boost/asio/post.hpp>
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+
+#include "mtconnect/configuration/config_options.hpp"
+#include "mtconnect/logging.hpp"
+#include "mtconnect/observation/observation.hpp"
+
+using namespace std;
+using namespace std::literals;
+
+namespace asio = boost::asio;
+using udp = boost::asio::ip::udp;
+
+namespace mtconnect::source::adapter::udp {
+  /// @brief Default the identity to the block name so it does not collide with a TCP adapter
+  static ConfigOptions UdpOptions(const string &name, const ConfigOptions &options)
+  {
+    ConfigOptions res(options);
+    if (!HasOption(res, configuration::AdapterIdentity))
+      res[configuration::AdapterIdentity] = "_udp_"s + name;
+    return res;
+  }
+
+  /// @name Agent device data item id suffixes
+  ///@{
+  static const string GapsSuffix("_sequence_gaps");
+  static const string LostSuffix("_datagrams_lost");
+  static const string LateSuffix("_datagrams_late");
+  ///@}
+
+  UdpAdapter::UdpAdapter(const std::string &name, boost::asio::io_context &io,
+                         pipeline::PipelineContextPtr pipelineContext,
+                         const ConfigOptions &options, const boost::property_tree::ptree &block)
+    : ShdrAdapter(io, pipelineContext, UdpOptions(name, options), block),
+      m_socket(io),
+      m_timer(io)
+  {
+    // There is no connection, the sender is considered disconnected if no datagrams have been
+    // received for twice the heartbeat interval or the legacy timeout.
+    if (m_heartbeatOverride)
+      m_senderTimeout = 2 * *m_heartbeatOverride;
+    else
+      m_senderTimeout = m_legacyTimeout;
+
+    m_name = "udp://"s + m_server + ':' + to_string(m_port);
+  }
+
+  std::list<entity::Properties> UdpAdapter::getAgentDataItems() const
+  {
+    std::list<entity::Properties> items;
+    for (auto &[suffix, type] : {pair {GapsSuffix, "x:SEQUENCE_GAP_COUNT"s},
+                                 pair {LostSuffix, "x:DATAGRAM_LOSS_COUNT"s},
+                                 pair {LateSuffix, "x:DATAGRAM_LATE_COUNT"s}})
+    {
+      items.push_back(
+          {{"type", type}, {"id", suffix}, {"units", "COUNT"s}, {"category", "SAMPLE"s}});
+    }
+    return items;
+  }
+
+  bool UdpAdapter::start()
+  {
+    NAMED_SCOPE("UdpAdapter::start");
+
+    boost::system::error_code ec;
+    udp::endpoint endpoint;
+    auto address = asio::ip::make_address(m_server, ec);
+    if (!ec)
+    {
+      endpoint = udp::endpoint(address, m_port);
+    }
+    else
+    {
+      udp::resolver resolver(m_socket.get_executor());
+      auto results = resolver.resolve(m_server, to_string(m_port), ec);
+      if (ec || results.empty())
+      {
+        LOG(error) << "Cannot resolve UDP address " << m_server << ": " << ec.message();
+        return false;
+      }
+      endpoint = results.begin()->endpoint();
+    }
+
+    m_socket.open(endpoint.protocol(), ec);
+    if (!ec)
+      m_socket.bind(endpoint, ec);
+    if (ec)
+    {
+      LOG(error) << "Cannot bind UDP socket to " << m_server << ':' << m_port << ": "
+                 << ec.message();
+      m_socket.close(ec);
+      return false;
+    }
+
+    // A larger receive buffer absorbs bursts while the strand is busy. The kernel may limit it.
+    m_socket.set_option(asio::socket_base::receive_buffer_size(4 * 1024 * 1024), ec);
+    m_socket.non_blocking(true, ec);
+
+    m_buffer.resize(BatchSize * MaxDatagramSize);
+#ifdef __linux__
+    m_iovecs.resize(BatchSize);
+    m_messages.resize(BatchSize);
+    for (size_t i = 0; i < BatchSize; i++)
+    {
+      m_iovecs[i].iov_base = m_buffer.data() + i * MaxDatagramSize;
+      m_iovecs[i].iov_len = MaxDatagramSize;
+      m_messages[i].msg_hdr = msghdr {};
+      m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+      m_messages[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+
+    LOG(info) << "Receiving UDP datagrams on " << m_socket.local_endpoint(ec);
+    m_pipeline.start();
+    asio::post(Source::m_strand, [this]() { connecting(); });
+
+    waitForData();
+    asio::post(Source::m_strand,
+               [this, ptr = getptr()]() { checkSender(boost::system::error_code()); });
+
+    return true;
+  }
+
+  void UdpAdapter::stop()
+  {
+    NAMED_SCOPE("UdpAdapter::stop");
+
+    boost::system::error_code ec;
+    m_timer.cancel();
+    m_socket.close(ec);
+
+    if (m_senderConnected)
+    {
+      m_senderConnected = false;
+      disconnected();
+    }
+
+    ShdrAdapter::stop();
+  }
+
+  void UdpAdapter::waitForData()
+  {
+    m_socket.async_wait(
+        udp::socket::wait_read,
+        asio::bind_executor(Source::m_strand, [this, ptr = getptr()](boost::system::error_code ec) {
+          if (ec)
+          {
+            if (ec != asio::error::operation_aborted)
+              LOG(error) << "UDP receive error: " << ec.message();
+            return;
+          }
+          receive();
+          waitForData();
+        }));
+  }
+
+  void UdpAdapter::receive()
+  {
+    NAMED_SCOPE("UdpAdapter::receive");
+
+    // Limit the work per wakeup so other sources on the strand are not starved
+    constexpr int MaxBatches = 8;
+
+#ifdef __linux__
+    for (int batch = 0; batch < MaxBatches; batch++)
+    {
+      int count = ::recvmmsg(m_socket.native_handle(), m_messages.data(), unsigned(BatchSize),
+                             MSG_DONTWAIT, nullptr);
+      if (count < 0)
+      {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+          LOG(error) << "recvmmsg failed: " << strerror(errno);
+        break;
+      }
+
+      for (int i = 0; i < count; i++)
+      {
+        auto &message = m_messages[i];
+        if ((message.msg_hdr.msg_flags & MSG_TRUNC) != 0)
+        {
+          LOG(warning) << "Truncated UDP datagram discarded";
+          continue;
+        }
+        processDatagram(string_view(m_buffer.data() + i * MaxDatagramSize, message.msg_len));
+      }
+
+      if (size_t(count) < BatchSize)
+        break;
+    }
+#else
+    for (size_t i = 0; i < MaxBatches * BatchSize; i++)
+    {
+      boost::system::error_code ec;
+      auto len = m_socket.receive(asio::buffer(m_buffer.data(), MaxDatagramSize), 0, ec);
+      if (ec)
+      {
+        if (ec != asio::error::would_block)
+          LOG(error) << "UDP receive failed: " << ec.message();
+        break;
+      }
+      processDatagram(string_view(m_buffer.data(), len));
+    }
+#endif
+  }
+
+  void UdpAdapter::processDatagram(std::string_view datagram)
+  {
+    NAMED_SCOPE("UdpAdapter::processDatagram");
+
+    m_datagrams++;
+    m_lastDatagram = chrono::steady_clock::now();
+    if (!m_senderConnected)
+    {
+      m_senderConnected = true;
+      LOG(info) << "Receiving datagrams on " << m_name;
+      connected();
+      reportCounters(true);
+    }
+
+    if (datagram.substr(0, SequencePrefix.size()) == SequencePrefix)
+    {
+      auto eol = datagram.find('\n');
+      auto line = datagram.substr(SequencePrefix.size(), eol - SequencePrefix.size());
+      while (!line.empty() && line.front() == ' ')
+        line.remove_prefix(1);
+
+      uint64_t seq;
+      auto res = from_chars(line.data(), line.data() + line.size(), seq);
+      if (res.ec == std::errc())
+      {
+        auto result = m_sequence.next(seq);
+        if (result == DatagramSequence::Result::RESTART)
+          LOG(info) << "UDP sender on " << m_name << " restarted its sequence at " << seq;
+        else if (result == DatagramSequence::Result::GAP)
+          LOG(debug) << "UDP sequence gap before " << seq;
+      }
+      else
+      {
+        LOG(warning) << "Invalid UDP sequence line: " << datagram.substr(0, eol);
+      }
+
+      if (eol == string_view::npos)
+        return;
+      datagram.remove_prefix(eol + 1);
+    }
+
+    while (!datagram.empty())
+    {
+      auto eol = datagram.find('\n');
+      auto line = datagram.substr(0, eol);
+      while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+        line.remove_suffix(1);
+      if (!line.empty())
+        processData(string(line));
+
+      if (eol == string_view::npos)
+        break;
+      datagram.remove_prefix(eol + 1);
+    }
+  }
+
+  void UdpAdapter::checkSender(boost::system::error_code ec)
+  {
+    NAMED_SCOPE("UdpAdapter::checkSender");
+
+    if (ec)
+      return;
+
+    if (m_senderConnected && chrono::steady_clock::now() - m_lastDatagram > m_senderTimeout)
+    {
+      LOG(warning) << "No datagrams received on " << m_name << " for "
+                   << m_senderTimeout.count() << "ms";
+      m_senderConnected = false;
+      m_sequence.reset();
+      disconnected();
+      connecting();
+    }
+
+    reportCounters();
+
+    m_timer.expires_after(1s);
+    m_timer.async_wait(asio::bind_executor(
+        Source::m_strand,
+        [this, ptr = getptr()](boost::system::error_code ec) { checkSender(ec); }));
+  }
+
+  void UdpAdapter::deliverCounter(const std::string &suffix, uint64_t value)
+  {
+    if (!m_pipeline.hasContract())
+      return;
+
+    auto &contract = m_pipeline.getContract();
+    auto di = contract->findDataItem("Agent", m_identity + suffix);
+    if (di == nullptr)
+      return;
+
+    entity::ErrorList errors;
+    auto obs = observation::Observation::make(di, {{"VALUE", double(value)}},
+                                              chrono::system_clock::now(), errors);
+    if (obs && errors.empty())
+      contract->deliverObservation(obs);
+  }
+
+  void UdpAdapter::reportCounters(bool force)
+  {
+    NAMED_SCOPE("UdpAdapter::reportCounters");
+
+    auto report = [this, force](const string &suffix, optional<uint64_t> &reported,
+                                uint64_t value) {
+      if (force || reported != value)
+      {
+        deliverCounter(suffix, value);
+        reported = value;
+      }
+    };
+
+    report(GapsSuffix, m_reportedGaps, m_sequence.gaps());
+    report(LostSuffix, m_reportedLost, m_sequence.lost());
+    report(LateSuffix, m_reportedLate, m_sequence.late());
+  }
+}  // namespace mtconnect::source::adapter::udp
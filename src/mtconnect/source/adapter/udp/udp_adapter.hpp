@@ -0,0 +1,214 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/source/adapter/shdr/shdr_adapter.hpp"
+
+namespace mtconnect {
+  /// @brief namespace for UDP adapter sources
+  namespace source::adapter::udp {
+    /// @brief Track datagram sequence numbers to count gaps and lost datagrams
+    ///
+    /// A datagram is lost if a later sequence number has been received before it. Datagrams that
+    /// arrive after a later one are counted as late, the lost count is not corrected since
+    /// duplicates cannot be distinguished from reordering.
+    class AGENT_LIB_API DatagramSequence
+    {
+    public:
+      /// @brief A sequence number this far behind the last is treated as a sender restart
+      static constexpr uint64_t RestartWindow = 1024;
+
+      /// @brief The classification of a sequence number
+      enum class Result
+      {
+        FIRST,     ///< The first sequence number after a reset
+        IN_ORDER,  ///< The next expected sequence number
+        GAP,       ///< One or more sequence numbers were skipped
+        LATE,      ///< Older than the last sequence number
+        RESTART    ///< The sender restarted its sequence
+      };
+
+      /// @brief Classify a sequence number and update the counters
+      /// @param[in] seq the sequence number from the datagram
+      /// @return the classification
+      Result next(uint64_t seq)
+      {
+        if (!m_last)
+        {
+          m_last = seq;
+          return Result::FIRST;
+        }
+
+        auto last = *m_last;
+        if (seq == last + 1)
+        {
+          m_last = seq;
+          return Result::IN_ORDER;
+        }
+        else if (seq > last)
+        {
+          m_gaps++;
+          m_lost += seq - last - 1;
+          m_last = seq;
+          return Result::GAP;
+        }
+        else if (last - seq > RestartWindow)
+        {
+          m_restarts++;
+          m_last = seq;
+          return Result::RESTART;
+        }
+        else
+        {
+          m_late++;
+          return Result::LATE;
+        }
+      }
+
+      /// @brief Forget the last sequence number, the counters are retained
+      void reset() { m_last.reset(); }
+
+      /// @name Counters
+      ///@{
+      uint64_t gaps() const { return m_gaps; }
+      uint64_t lost() const { return m_lost; }
+      uint64_t late() const { return m_late; }
+      uint64_t restarts() const { return m_restarts; }
+      ///@}
+
+    protected:
+      std::optional<uint64_t> m_last;
+      uint64_t m_gaps {0};
+      uint64_t m_lost {0};
+      uint64_t m_late {0};
+      uint64_t m_restarts {0};
+    };
+
+    /// @brief A SHDR adapter that receives datagrams instead of a TCP stream
+    ///
+    /// For high-rate samples where occasional loss is acceptable. Each datagram contains one or
+    /// more SHDR lines separated by `\n` and is handled exactly like the SHDR adapter. A datagram
+    /// may begin with a sequence line, `* seq: <n>`, where `n` increments by one for every
+    /// datagram. The sequence is used to count gaps, lost, and late datagrams which are reported
+    /// as data items on the Agent device.
+    ///
+    /// The adapter binds to `Host` and `Port`. On Linux, all pending datagrams are read with
+    /// `recvmmsg` in batches when the socket becomes readable.
+    class AGENT_LIB_API UdpAdapter : public shdr::ShdrAdapter
+    {
+    public:
+      /// @brief The prefix of the optional sequence line
+      static constexpr std::string_view SequencePrefix = "* seq:";
+      /// @brief The number of datagrams received with one system call
+      static constexpr size_t BatchSize = 32;
+      /// @brief The largest datagram payload
+      static constexpr size_t MaxDatagramSize = 65536;
+
+      /// @brief Create a UDP adapter
+      /// @param[in] name the name of the adapter configuration block
+      /// @param[in] io boost asio io conext
+      /// @param[in] pipelineContext pipeline context
+      /// @param[in] options configuration options
+      /// @param[in] block additional configuration options not in options
+      UdpAdapter(const std::string &name, boost::asio::io_context &io,
+                 pipeline::PipelineContextPtr pipelineContext, const ConfigOptions &options,
+                 const boost::property_tree::ptree &block);
+      UdpAdapter(const UdpAdapter &) = delete;
+
+      /// @brief Factory registration method associate this source with `udp`
+      /// @param[in] factory the source factory
+      static void registerFactory(SourceFactory &factory)
+      {
+        factory.registerFactory(
+            "udp",
+            [](const std::string &name, boost::asio::io_context &io,
+               pipeline::PipelineContextPtr context, const ConfigOptions &options,
+               const boost::property_tree::ptree &block) -> source::SourcePtr {
+              auto source = std::make_shared<UdpAdapter>(name, io, context, options, block);
+              return source;
+            });
+      }
+
+      ~UdpAdapter() override { stop(); }
+
+      /// @name Source interface
+      ///@{
+      bool start() override;
+      void stop() override;
+      ///@}
+
+      std::list<entity::Properties> getAgentDataItems() const override;
+
+      /// @brief Handle the SHDR lines in a datagram
+      /// @param[in] datagram the datagram payload
+      void processDatagram(std::string_view datagram);
+
+      /// @brief Deliver the sequence counters to the Agent device data items
+      /// @param[in] force deliver the counters even if they have not changed
+      void reportCounters(bool force = false);
+
+      /// @brief the local endpoint the socket is bound to
+      boost::asio::ip::udp::endpoint getLocalEndpoint() const { return m_socket.local_endpoint(); }
+      /// @brief the number of datagrams received
+      uint64_t getDatagramCount() const { return m_datagrams; }
+      /// @brief the sequence tracker
+      const auto &getSequence() const { return m_sequence; }
+
+    protected:
+      void waitForData();
+      void receive();
+      void checkSender(boost::system::error_code ec);
+      void deliverCounter(const std::string &suffix, uint64_t value);
+
+    protected:
+      boost::asio::ip::udp::socket m_socket;
+      boost::asio::steady_timer m_timer;
+      std::chrono::milliseconds m_senderTimeout;
+      std::chrono::steady_clock::time_point m_lastDatagram;
+      bool m_senderConnected {false};
+
+      std::vector<char> m_buffer;
+#ifdef __linux__
+      std::vector<mmsghdr> m_messages;
+      std::vector<iovec> m_iovecs;
+#endif
+
+      DatagramSequence m_sequence;
+      uint64_t m_datagrams {0};
+      std::optional<uint64_t> m_reportedGaps;
+      std::optional<uint64_t> m_reportedLost;
+      std::optional<uint64_t> m_reportedLate;
+    };
+  }  // namespace source::adapter::udp
+}  // namespace mtconnect
@@ -424,6 +424,28 @@ namespace mtconnect {
 
   using Attributes = std::map<std::string, std::string>;
 
+  /// @brief Transparent string hash allowing `std::string_view` lookups in string keyed maps
+  /// without constructing a temporary `std::string`
+  struct StringViewHash
+  {
+    using is_transparent = void;
+
+    /// @brief hash a string view
+    /// @param sv the string view
+    /// @return the hash value
+    size_t operator()(std::string_view sv) const noexcept
+    {
+      return std::hash<std::string_view> {}(sv);
+    }
+    /// @brief hash a string
+    /// @param s the string
+    /// @return the hash value
+    size_t operator()(const std::string &s) const noexcept
+    {
+      return std::hash<std::string_view> {}(s);
+    }
+  };
+
   /// @brief overloaded pattern for variant visitors using list of lambdas
   /// @tparam ...Ts list of lambda classes
   template <class... Ts>
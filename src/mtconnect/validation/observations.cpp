@@ -19,4 +19,21 @@
 
 namespace mtconnect::validation::observations {
 #include "observation_validations.hpp"
+
+  const CompiledValidation &GetCompiledVocabularies()
+  {
+    static const CompiledValidation compiled([] {
+      std::vector<std::pair<std::string, VocabularyMap>> types;
+      types.reserve(ControlledVocabularies.size());
+      for (auto &[name, values] : ControlledVocabularies)
+      {
+        std::vector<std::pair<std::string, std::pair<int32_t, int32_t>>> entries(values.begin(),
+                                                                                  values.end());
+        types.emplace_back(name, VocabularyMap(entries));
+      }
+      return types;
+    }());
+
+    return compiled;
+  }
 }
@@ -17,8 +17,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "../utilities.hpp"
 
@@ -44,6 +50,198 @@ namespace mtconnect {
       ///       * 0 if not deprecated
       ///       * SCHEMA_VERSION if deprecated
       extern Validation ControlledVocabularies;
+
+      /// @brief A read only string keyed map with a perfect hash
+      ///
+      /// Built with hash and displace (CHD): the keys are hashed into buckets of about four
+      /// keys, then each bucket, largest first, is given a displacement that moves all its keys
+      /// to free slots. The table has about 1.2 slots per key. A lookup is one hash of the key,
+      /// two integer mixes and one string comparison.
+      ///
+      /// The slot of a key is its ordinal, so values can be found again with `at()` without
+      /// hashing the key.
+      /// @tparam T the value type, must be default constructible
+      template <typename T>
+      class PerfectHashMap
+      {
+      public:
+        /// @brief The largest displacement tried for a bucket before the table is grown
+        static constexpr uint32_t MaxDisplacement = 1u << 16;
+
+        PerfectHashMap() = default;
+        /// @brief Build the map
+        /// @param[in] entries the keys and values, the keys must be unique and not empty
+        PerfectHashMap(const std::vector<std::pair<std::string, T>> &entries)
+        {
+          if (entries.empty())
+            return;
+
+          std::vector<uint64_t> hashes;
+          hashes.reserve(entries.size());
+          for (auto &entry : entries)
+            hashes.push_back(hash(entry.first));
+
+          auto n = entries.size();
+          for (size_t size = n + n / 5 + 1;; size += n / 10 + 1)
+          {
+            if (build(entries, hashes, size))
+              return;
+          }
+        }
+
+        /// @brief find the ordinal of a key
+        /// @param[in] key the key
+        /// @return the ordinal or `std::nullopt` if the key is not in the map
+        std::optional<size_t> index(std::string_view key) const
+        {
+          if (m_size == 0 || key.empty())
+            return std::nullopt;
+          auto h = hash(key);
+          auto displacement = m_displacements[mix(h, 0) % m_displacements.size()];
+          size_t slot = mix(h, displacement) % m_slots.size();
+          if (m_slots[slot].m_key == key)
+            return slot;
+          else
+            return std::nullopt;
+        }
+
+        /// @brief find the value for a key
+        /// @param[in] key the key
+        /// @return pointer to the value or `nullptr` if the key is not in the map
+        const T *find(std::string_view key) const
+        {
+          auto slot = index(key);
+          return slot ? &m_slots[*slot].m_value : nullptr;
+        }
+
+        /// @brief get the value for an ordinal from `index()`
+        /// @param[in] ordinal the ordinal
+        /// @return the value
+        const T &at(size_t ordinal) const { return m_slots[ordinal].m_value; }
+
+        /// @brief get the number of keys
+        size_t size() const { return m_size; }
+        /// @brief get the number of slots
+        size_t slots() const { return m_slots.size(); }
+
+        /// @brief FNV-1a hash of the key
+        static uint64_t hash(std::string_view key)
+        {
+          uint64_t h = 14695981039346656037ull;
+          for (auto c : key)
+          {
+            h ^= uint8_t(c);
+            h *= 1099511628211ull;
+          }
+          return h;
+        }
+
+        /// @brief Mix a key hash with a displacement, `0` selects the bucket
+        static uint32_t mix(uint64_t h, uint32_t displacement)
+        {
+          h ^= uint64_t(displacement) * 0x9E3779B97F4A7C15ull;
+          h ^= h >> 33;
+          h *= 0xFF51AFD7ED558CCDull;
+          h ^= h >> 33;
+          h *= 0xC4CEB9FE1A85EC53ull;
+          h ^= h >> 33;
+          return uint32_t(h);
+        }
+
+      protected:
+        struct Slot
+        {
+          std::string m_key;  ///< Empty if the slot is not used
+          T m_value;
+        };
+
+        bool build(const std::vector<std::pair<std::string, T>> &entries,
+                   const std::vector<uint64_t> &hashes, size_t size)
+        {
+          std::vector<std::vector<size_t>> buckets((entries.size() + 3) / 4);
+          for (size_t i = 0; i < entries.size(); i++)
+            buckets[mix(hashes[i], 0) % buckets.size()].push_back(i);
+
+          std::vector<size_t> order(buckets.size());
+          for (size_t b = 0; b < order.size(); b++)
+            order[b] = b;
+          std::stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+            return buckets[a].size() > buckets[b].size();
+          });
+
+          std::vector<uint32_t> displacements(buckets.size(), 0);
+          std::vector<bool> used(size, false);
+          std::vector<size_t> placed;
+          for (auto b : order)
+          {
+            auto &bucket = buckets[b];
+            if (bucket.empty())
+              break;
+
+            // Find the first displacement that puts every key of the bucket in a free slot
+            uint32_t displacement = 1;
+            for (; displacement <= MaxDisplacement; displacement++)
+            {
+              placed.clear();
+              for (auto i : bucket)
+              {
+                size_t slot = mix(hashes[i], displacement) % size;
+                if (used[slot] || std::find(placed.begin(), placed.end(), slot) != placed.end())
+                  break;
+                placed.push_back(slot);
+              }
+              if (placed.size() == bucket.size())
+                break;
+            }
+            if (displacement > MaxDisplacement)
+              return false;
+
+            displacements[b] = displacement;
+            for (auto slot : placed)
+              used[slot] = true;
+          }
+
+          std::vector<Slot> slots(size);
+          for (size_t i = 0; i < entries.size(); i++)
+          {
+            auto &[key, value] = entries[i];
+            auto b = mix(hashes[i], 0) % buckets.size();
+            auto &slot = slots[mix(hashes[i], displacements[b]) % size];
+            slot.m_key = key;
+            slot.m_value = value;
+          }
+
+          m_slots = std::move(slots);
+          m_displacements = std::move(displacements);
+          m_size = entries.size();
+          return true;
+        }
+
+      protected:
+        std::vector<Slot> m_slots;
+        std::vector<uint32_t> m_displacements;
+        size_t m_size {0};
+      };
+
+      /// @brief The controlled vocabulary of an event type
+      ///
+      /// Each value maps to the schema versions when it was introduced and deprecated, `0` if
+      /// not applicable. The map is empty if the event type is not controlled.
+      using VocabularyMap = PerfectHashMap<std::pair<int32_t, int32_t>>;
+
+      /// @brief The controlled vocabularies by event name
+      ///
+      /// The ordinal of an event name is stored in the data item when it is created, see
+      /// `DataItem::getVocabulary()`, so validation does not hash the name.
+      using CompiledValidation = PerfectHashMap<VocabularyMap>;
+
+      /// @brief get the perfect hash form of `ControlledVocabularies`
+      ///
+      /// Built once on first use. Event types added to `ControlledVocabularies` after that, for
+      /// example by an extension, are not included and must be looked up in the
+      /// `ControlledVocabularies` map.
+      /// @return the compiled vocabularies
+      AGENT_LIB_API const CompiledValidation &GetCompiledVocabularies();
     }  // namespace observations
   }    // namespace validation
 }  // namespace mtconnect
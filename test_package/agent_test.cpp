@@ -23,6 +23,7 @@
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
 #include <chrono>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <sstream>
@@ -955,6 +956,65 @@ TEST_F(AgentTest, should_give_correct_number_of_samples_with_to_parameter)
   // to > from
 }
 
+TEST_F(AgentTest, should_give_samples_between_times)
+{
+  QueryMap query;
+  addAdapter();
+
+  auto base = chrono::time_point_cast<chrono::seconds>(chrono::system_clock::now()) + 1h;
+  for (int i = 0; i < 10; i++)
+  {
+    auto line = format(base + chrono::seconds(i)) + "|line|" + to_string(i);
+    m_agentTestHelper->m_adapter->processData(line);
+  }
+
+  {
+    query["path"] = "//DataItem[@type='LINE']";
+    query["fromTime"] = format(base + 5s);
+
+    PARSE_XML_RESPONSE_QUERY("/sample", query);
+    ASSERT_XML_PATH_COUNT(doc, "//m:DeviceStream//m:Line", 5);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line[1]", "5");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line[5]", "9");
+  }
+
+  {
+    query["fromTime"] = format(base + 3s);
+    query["toTime"] = format(base + 7s);
+
+    PARSE_XML_RESPONSE_QUERY("/sample", query);
+    ASSERT_XML_PATH_COUNT(doc, "//m:DeviceStream//m:Line", 5);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line[1]", "3");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line[5]", "7");
+  }
+
+  {
+    // Offsets from UTC are applied
+    query["fromTime"] = date::format("%FT%T", base + 3s + 1h) + "+01:00";
+    query["toTime"] = date::format("%FT%T", base + 7s - 90min) + "-01:30";
+
+    PARSE_XML_RESPONSE_QUERY("/sample", query);
+    ASSERT_XML_PATH_COUNT(doc, "//m:DeviceStream//m:Line", 5);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line[1]", "3");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line[5]", "7");
+  }
+
+  {
+    query.erase("toTime");
+    query["fromTime"] = date::format("%FT%T", base + 3s) + " EST";
+
+    PARSE_XML_RESPONSE_QUERY("/sample", query);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Error@errorCode", "INVALID_PARAMETER_VALUE");
+  }
+
+  {
+    query["fromTime"] = "yesterday";
+
+    PARSE_XML_RESPONSE_QUERY("/sample", query);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Error@errorCode", "INVALID_PARAMETER_VALUE");
+  }
+}
+
 TEST_F(AgentTest, should_give_empty_stream_with_no_new_samples)
 {
   {
@@ -999,7 +1059,8 @@ TEST_F(AgentTest, should_not_leak_observations_when_added_to_buffer)
   auto di2 = agent->getDataItemForDevice(device, key);
   seqNum = m_agentTestHelper->addToBuffer(di2, {{"VALUE", value}}, chrono::system_clock::now());
   auto event2 = circ.getFromBuffer(seqNum);
-  ASSERT_EQ(3, event2.use_count());
+  // Held by the buffer, the latest checkpoint, the data item's latest value, and event2
+  ASSERT_EQ(4, event2.use_count());
 
   {
     PARSE_XML_RESPONSE("/current");
@@ -2658,3 +2719,121 @@ TEST_F(AgentTest, should_handle_japanese_characters)
     ASSERT_EQ("ｽﾄﾛｰｸｴﾝﾄﾞ軸あり", fault.at("/value"_json_pointer).get<string>());
   }
 }
+
+TEST_F(AgentTest, should_restore_the_latest_observations_from_a_snapshot)
+{
+  namespace fs = std::filesystem;
+  auto file = fs::path(TEST_BIN_ROOT_DIR) / "agent_snapshot.bin";
+  fs::remove(file);
+  ConfigOptions options {{configuration::SnapshotFile, file.string()}};
+
+  m_agentTestHelper = make_unique<AgentTestHelper>();
+  m_agentTestHelper->createAgent("/samples/test_config.xml", 8, 4, "2.2", 4, false, true,
+                                 options);
+  addAdapter();
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|204|avail|AVAILABLE");
+  auto sequence = m_agentTestHelper->getAgent()->getCircularBuffer().getSequence();
+
+  // Stopping the agent writes the snapshot
+  m_agentTestHelper.reset();
+  ASSERT_TRUE(fs::exists(file));
+
+  // The snapshot must be older than the agent that restores it
+  {
+    fstream snapshot(file, ios::in | ios::out | ios::binary);
+    uint64_t written = getCurrentTimeInSec() - 10;
+    snapshot.seekp(8);
+    snapshot.write(reinterpret_cast<const char *>(&written), sizeof(written));
+  }
+
+  m_agentTestHelper = make_unique<AgentTestHelper>();
+  m_agentTestHelper->createAgent("/samples/test_config.xml", 8, 4, "2.2", 4, false, true,
+                                 options);
+  ASSERT_EQ(sequence, m_agentTestHelper->getAgent()->getCircularBuffer().getFirstSequence());
+
+  {
+    PARSE_XML_RESPONSE("/current");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line", "204");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Availability", "UNAVAILABLE");
+  }
+
+  m_agentTestHelper.reset();
+  fs::remove(file);
+}
+
+namespace {
+  // Parse the test device with an additional data item so it differs from the agent's device
+  DevicePtr ChangedTestDevice(const string &id)
+  {
+    auto printer = make_unique<printer::XmlPrinter>();
+    auto parser = make_unique<parser::XmlParser>();
+    auto devices = parser->parseFile(TEST_RESOURCE_DIR "/samples/test_config.xml", printer.get());
+    for (auto &device : devices)
+    {
+      if (*device->getComponentName() == "LinuxCNC")
+      {
+        ErrorList errors;
+        auto di = DataItem::make({{"id", id}, {"type", "BLOCK"s}, {"category", "EVENT"s}}, errors);
+        device->getComponentById("path")->addDataItem(di, errors);
+        return device;
+      }
+    }
+    return nullptr;
+  }
+}  // namespace
+
+TEST_F(AgentTest, should_reference_the_new_data_items_after_a_device_update)
+{
+  addAdapter();
+  m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|204");
+
+  auto agent = m_agentTestHelper->getAgent();
+  auto &circ = agent->getCircularBuffer();
+  auto old = agent->getDataItemById("p3");
+  auto seq = circ.getSequence() - 1;
+  ASSERT_EQ(old, circ.getFromBuffer(seq)->getDataItem());
+
+  auto device = ChangedTestDevice("extra");
+  ASSERT_TRUE(device);
+  ASSERT_TRUE(agent->receiveDevice(device, false));
+
+  auto di = agent->getDataItemById("p3");
+  ASSERT_TRUE(di);
+  ASSERT_NE(old, di);
+  ASSERT_EQ(di, circ.getFromBuffer(seq)->getDataItem());
+  ASSERT_FALSE(circ.getFromBuffer(seq)->isOrphan());
+  ASSERT_EQ(di, circ.getLatest().getObservation("p3")->getDataItem());
+
+  {
+    QueryMap query {{"from", to_string(seq)}, {"count", "1"}};
+    PARSE_XML_RESPONSE_QUERY("/sample", query);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line", "204");
+  }
+}
+
+TEST_F(AgentTest, benchmark_device_update_with_a_full_buffer)
+{
+  m_agentTestHelper = make_unique<AgentTestHelper>();
+  m_agentTestHelper->createAgent("/samples/test_config.xml", 17, 4, "2.0", 25, false);
+  auto agent = m_agentTestHelper->getAgent();
+  auto &circ = agent->getCircularBuffer();
+
+  auto line = agent->getDataItemById("p3");
+  auto time = chrono::system_clock::now();
+  for (int i = 0; i < (1 << 17); i++)
+    m_agentTestHelper->addToBuffer(line, {{"VALUE", to_string(i)}}, time);
+  auto seq = circ.getSequence() - 1;
+
+  // Each device differs from the previous one
+  vector<DevicePtr> devices;
+  for (int i = 0; i < 10; i++)
+    devices.push_back(ChangedTestDevice("extra" + to_string(i)));
+
+  benchmark("device update with 131072 buffered observations", devices.size(),
+            [&](size_t i) { ASSERT_TRUE(agent->receiveDevice(devices[i], false)); });
+
+  auto di = agent->getDataItemById("p3");
+  ASSERT_NE(line, di);
+  ASSERT_EQ(di, circ.getFromBuffer(seq)->getDataItem());
+  ASSERT_EQ(di, circ.getFromBuffer(circ.getBufferFirstSequence())->getDataItem());
+}
@@ -0,0 +1,396 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <chrono>
+#include <sstream>
+
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/pipeline/binary_frame_mapper.hpp"
+#include "mtconnect/pipeline/pipeline_context.hpp"
+#include "mtconnect/pipeline/shdr_token_mapper.hpp"
+#include "mtconnect/pipeline/shdr_tokenizer.hpp"
+#include "mtconnect/pipeline/timestamp_extractor.hpp"
+#include "mtconnect/source/adapter/binary/binary_protocol.hpp"
+#include "test_utilities.hpp"
+
+using namespace mtconnect;
+using namespace mtconnect::pipeline;
+using namespace mtconnect::observation;
+using namespace mtconnect::source::adapter::binary;
+using namespace device_model;
+using namespace data_item;
+using namespace std;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class MockPipelineContract : public PipelineContract
+{
+public:
+  MockPipelineContract(std::map<string, DataItemPtr> &items, int32_t schemaVersion)
+    : m_dataItems(items), m_schemaVersion(schemaVersion)
+  {}
+  DevicePtr findDevice(const std::string &) override { return nullptr; }
+  DataItemPtr findDataItem(const std::string &device, const std::string &name) override
+  {
+    auto it = m_dataItems.find(name);
+    if (it != m_dataItems.end())
+      return it->second;
+    return nullptr;
+  }
+  void eachDataItem(EachDataItem fun) override {}
+  void deliverObservation(observation::ObservationPtr obs) override {}
+  void deliverAsset(AssetPtr) override {}
+  void deliverDevices(std::list<DevicePtr>) override {}
+  void deliverDevice(DevicePtr) override {}
+  int32_t getSchemaVersion() const override { return m_schemaVersion; }
+  bool isValidating() const override { return false; }
+  void deliverAssetCommand(entity::EntityPtr) override {}
+  void deliverCommand(entity::EntityPtr) override {}
+  void deliverConnectStatus(entity::EntityPtr, const StringList &, bool) override {}
+  void sourceFailed(const std::string &id) override {}
+  const ObservationPtr checkDuplicate(const ObservationPtr &obs) const override { return obs; }
+  uint64_t getDeviceModelVersion() const override { return m_deviceModelVersion; }
+
+  std::map<string, DataItemPtr> &m_dataItems;
+  int32_t m_schemaVersion;
+  uint64_t m_deviceModelVersion {0};
+};
+
+class BinaryAdapterTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_context = make_shared<PipelineContext>();
+    m_context->m_contract = make_unique<MockPipelineContract>(m_dataItems, SCHEMA_VERSION(2, 0));
+    m_mapper = make_shared<BinaryFrameMapper>(m_context, "");
+    m_mapper->bind(make_shared<NullTransform>(TypeGuard<Entity>(RUN)));
+  }
+
+  void TearDown() override { m_dataItems.clear(); }
+
+  DataItemPtr makeDataItem(const Properties &props)
+  {
+    Properties ps(props);
+    ErrorList errors;
+    auto di = DataItem::make(ps, errors);
+    m_dataItems.insert_or_assign(di->getId(), di);
+
+    return di;
+  }
+
+  /// @brief Split the writer buffer into frames and run each through the mapper
+  EntityPtr mapFrames(const string &buffer)
+  {
+    EntityPtr last;
+    size_t pos = 0;
+    while (pos + FrameHeaderSize <= buffer.size())
+    {
+      auto length = BinaryFrameReader::frameLength(buffer.data() + pos);
+      auto data = make_shared<Entity>(
+          "Data", Properties {{"VALUE", buffer.substr(pos + FrameHeaderSize, length)},
+                              {"source", "binary"s}});
+      last = (*m_mapper)(std::move(data));
+      pos += FrameHeaderSize + length;
+    }
+    return last;
+  }
+
+  shared_ptr<PipelineContext> m_context;
+  shared_ptr<BinaryFrameMapper> m_mapper;
+  std::map<string, DataItemPtr> m_dataItems;
+};
+
+TEST_F(BinaryAdapterTest, should_round_trip_values_with_the_reference_writer)
+{
+  BinaryFrameWriter writer;
+  Timestamp now {chrono::microseconds(1700000000123456)};
+  writer.beginObservations(now);
+  writer.value(1, 12.5);
+  writer.value(2, int64_t(-42));
+  writer.value(3, "ACTIVE"sv);
+  writer.endFrame();
+
+  auto &buffer = writer.data();
+  auto length = BinaryFrameReader::frameLength(buffer.data());
+  ASSERT_EQ(buffer.size() - FrameHeaderSize, length);
+
+  BinaryFrameReader reader({buffer.data() + FrameHeaderSize, length});
+  ASSERT_EQ(uint8_t(FrameType::OBSERVATIONS), reader.read<uint8_t>());
+  ASSERT_EQ(1700000000123456, reader.read<int64_t>());
+
+  ASSERT_EQ(1, reader.read<uint16_t>());
+  ASSERT_EQ(uint8_t(ValueType::DOUBLE), reader.read<uint8_t>());
+  ASSERT_EQ(12.5, reader.read<double>());
+
+  ASSERT_EQ(2, reader.read<uint16_t>());
+  ASSERT_EQ(uint8_t(ValueType::INTEGER), reader.read<uint8_t>());
+  ASSERT_EQ(-42, reader.read<int64_t>());
+
+  ASSERT_EQ(3, reader.read<uint16_t>());
+  ASSERT_EQ(uint8_t(ValueType::STRING), reader.read<uint8_t>());
+  ASSERT_EQ("ACTIVE", reader.readString());
+
+  ASSERT_TRUE(reader.atEnd());
+  ASSERT_THROW(reader.read<uint8_t>(), BinaryFrameError);
+}
+
+TEST_F(BinaryAdapterTest, should_map_bound_ordinals_to_observations)
+{
+  auto pos = makeDataItem({{"id", "xpos"s},
+                           {"type", "POSITION"s},
+                           {"category", "SAMPLE"s},
+                           {"units", "MILLIMETER"s}});
+  auto exec = makeDataItem({{"id", "exec"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+  auto count = makeDataItem({{"id", "count"s}, {"type", "PART_COUNT"s}, {"category", "EVENT"s}});
+
+  BinaryFrameWriter writer;
+  writer.bind(0, "xpos");
+  writer.bind(1, "exec");
+  writer.bind(2, "count");
+  Timestamp now {chrono::microseconds(1700000000000000)};
+  writer.beginObservations(now);
+  writer.value(0, 101.25);
+  writer.value(1, "ACTIVE"sv);
+  writer.value(2, int64_t(17));
+  writer.endFrame();
+
+  auto observations = mapFrames(writer.data());
+  ASSERT_TRUE(observations);
+  auto &r = *observations;
+  ASSERT_EQ(typeid(Observations), typeid(r));
+
+  auto oblist = observations->getValue<EntityList>();
+  ASSERT_EQ(3, oblist.size());
+
+  auto it = oblist.begin();
+  auto sample = dynamic_pointer_cast<Sample>(*it++);
+  ASSERT_TRUE(sample);
+  ASSERT_EQ(pos, sample->getDataItem());
+  ASSERT_EQ(101.25, sample->getValue<double>());
+  ASSERT_EQ(now, sample->getTimestamp());
+
+  auto event = dynamic_pointer_cast<Event>(*it++);
+  ASSERT_TRUE(event);
+  ASSERT_EQ(exec, event->getDataItem());
+  ASSERT_EQ("ACTIVE", event->getValue<string>());
+
+  event = dynamic_pointer_cast<Event>(*it++);
+  ASSERT_TRUE(event);
+  ASSERT_EQ(count, event->getDataItem());
+  ASSERT_EQ("17", event->getValue<string>());
+}
+
+TEST_F(BinaryAdapterTest, should_map_unavailable_and_skip_unbound_ordinals)
+{
+  makeDataItem({{"id", "exec"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+
+  BinaryFrameWriter writer;
+  writer.bind(5, "exec");
+  writer.beginObservations(chrono::system_clock::now());
+  writer.value(4, 1.0);
+  writer.unavailable(5);
+  writer.endFrame();
+
+  auto observations = mapFrames(writer.data());
+  ASSERT_TRUE(observations);
+  auto oblist = observations->getValue<EntityList>();
+  ASSERT_EQ(1, oblist.size());
+
+  auto event = dynamic_pointer_cast<Event>(oblist.front());
+  ASSERT_TRUE(event);
+  ASSERT_TRUE(event->isUnavailable());
+}
+
+TEST_F(BinaryAdapterTest, should_map_a_timeseries_from_a_float_array)
+{
+  auto di = makeDataItem({{"id", "vib"s},
+                          {"type", "DISPLACEMENT"s},
+                          {"category", "SAMPLE"s},
+                          {"units", "MILLIMETER"s},
+                          {"representation", "TIME_SERIES"s}});
+
+  float samples[] = {0.5f, 1.5f, 2.5f, 3.5f};
+
+  BinaryFrameWriter writer;
+  writer.bind(0, "vib");
+  writer.beginObservations(chrono::system_clock::now());
+  writer.timeseries(0, 4000.0, samples, 4);
+  writer.endFrame();
+
+  auto observations = mapFrames(writer.data());
+  ASSERT_TRUE(observations);
+  auto oblist = observations->getValue<EntityList>();
+  ASSERT_EQ(1, oblist.size());
+
+  auto sample = dynamic_pointer_cast<Timeseries>(oblist.front());
+  ASSERT_TRUE(sample);
+  ASSERT_EQ(di, sample->getDataItem());
+  ASSERT_EQ(entity::Vector({0.5, 1.5, 2.5, 3.5}), sample->getValue<entity::Vector>());
+  ASSERT_EQ(4, sample->get<int64_t>("sampleCount"));
+  ASSERT_EQ(4000.0, sample->get<double>("sampleRate"));
+}
+
+TEST_F(BinaryAdapterTest, should_map_a_three_space_vector_and_a_condition)
+{
+  makeDataItem({{"id", "path"s},
+                {"type", "PATH_POSITION"s},
+                {"category", "SAMPLE"s},
+                {"units", "MILLIMETER_3D"s}});
+  makeDataItem({{"id", "system"s}, {"type", "SYSTEM"s}, {"category", "CONDITION"s}});
+
+  double values[] = {1.0, 2.0, 3.0};
+
+  BinaryFrameWriter writer;
+  writer.bind(0, "path");
+  writer.bind(1, "system");
+  writer.beginObservations(chrono::system_clock::now());
+  writer.vector(0, values, 3);
+  writer.value(1, "normal"sv);
+  writer.endFrame();
+
+  auto observations = mapFrames(writer.data());
+  ASSERT_TRUE(observations);
+  auto oblist = observations->getValue<EntityList>();
+  ASSERT_EQ(2, oblist.size());
+
+  auto sample = dynamic_pointer_cast<ThreeSpaceSample>(oblist.front());
+  ASSERT_TRUE(sample);
+  ASSERT_EQ(entity::Vector({1.0, 2.0, 3.0}), sample->getValue<entity::Vector>());
+
+  auto cond = dynamic_pointer_cast<Condition>(oblist.back());
+  ASSERT_TRUE(cond);
+  ASSERT_EQ("Normal", cond->getName());
+}
+
+TEST_F(BinaryAdapterTest, should_rebind_ordinals_when_the_device_model_changes)
+{
+  auto first = makeDataItem({{"id", "exec"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+
+  BinaryFrameWriter writer;
+  writer.bind(0, "exec");
+  mapFrames(writer.data());
+  ASSERT_EQ(first, m_mapper->getDataItem(0));
+
+  auto second = makeDataItem({{"id", "exec"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+  auto *contract = dynamic_cast<MockPipelineContract *>(m_context->m_contract.get());
+  contract->m_deviceModelVersion++;
+
+  writer.clear();
+  writer.beginObservations(chrono::system_clock::now());
+  writer.value(0, "READY"sv);
+  writer.endFrame();
+
+  auto observations = mapFrames(writer.data());
+  ASSERT_TRUE(observations);
+  ASSERT_EQ(second, m_mapper->getDataItem(0));
+  auto oblist = observations->getValue<EntityList>();
+  ASSERT_EQ(1, oblist.size());
+  ASSERT_EQ(second, dynamic_pointer_cast<Observation>(oblist.front())->getDataItem());
+}
+
+TEST_F(BinaryAdapterTest, should_ignore_truncated_frames)
+{
+  makeDataItem({{"id", "exec"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+
+  BinaryFrameWriter writer;
+  writer.bind(0, "exec");
+  mapFrames(writer.data());
+
+  writer.clear();
+  writer.beginObservations(chrono::system_clock::now());
+  writer.value(0, "READY"sv);
+  writer.endFrame();
+
+  // Drop the last byte of the value
+  auto frame = writer.data().substr(FrameHeaderSize, writer.data().size() - FrameHeaderSize - 1);
+  auto data = make_shared<Entity>("Data", Properties {{"VALUE", frame}});
+  ASSERT_FALSE((*m_mapper)(std::move(data)));
+}
+
+TEST_F(BinaryAdapterTest, benchmark_binary_and_shdr_4khz_timeseries)
+{
+  constexpr size_t SampleCount = 4000;
+  constexpr size_t Iterations = 200;
+
+  makeDataItem({{"id", "vib"s},
+                {"type", "DISPLACEMENT"s},
+                {"category", "SAMPLE"s},
+                {"units", "MILLIMETER"s},
+                {"representation", "TIME_SERIES"s}});
+
+  vector<float> samples(SampleCount);
+  for (size_t i = 0; i < SampleCount; i++)
+    samples[i] = float(i % 100) * 0.001f + 0.123f;
+
+  // SHDR: format the line on the adapter side and tokenize, extract, and map in the agent
+  auto tokenizer = make_shared<ShdrTokenizer>();
+  auto extract = make_shared<ExtractTimestamp>(false);
+  auto shdrMapper = make_shared<ShdrTokenMapper>(m_context, "", 2);
+  tokenizer->bind(extract);
+  extract->bind(shdrMapper);
+  shdrMapper->bind(make_shared<NullTransform>(TypeGuard<Entity>(RUN)));
+
+  size_t shdrBytes = 0;
+  auto shdr = benchmark("shdr_timeseries_4000_samples", Iterations, [&](size_t) {
+    ostringstream line;
+    line << "2021-01-19T10:01:00.1234Z|vib|" << SampleCount << "|4000|";
+    for (size_t i = 0; i < SampleCount; i++)
+    {
+      if (i > 0)
+        line << ' ';
+      line << samples[i];
+    }
+    auto body = line.str();
+    shdrBytes = body.size();
+
+    auto data = make_shared<Entity>("Data", Properties {{"VALUE", body}, {"source", "shdr"s}});
+    auto observations = (*tokenizer)(std::move(data));
+    ASSERT_EQ(1, observations->getValue<EntityList>().size());
+  });
+
+  // Binary: write the frame on the adapter side and map it in the agent
+  BinaryFrameWriter bindings;
+  bindings.bind(0, "vib");
+  mapFrames(bindings.data());
+
+  size_t binaryBytes = 0;
+  BinaryFrameWriter writer;
+  auto binary = benchmark("binary_timeseries_4000_samples", Iterations, [&](size_t) {
+    writer.clear();
+    writer.beginObservations(chrono::system_clock::now());
+    writer.timeseries(0, 4000.0, samples.data(), uint32_t(SampleCount));
+    writer.endFrame();
+    binaryBytes = writer.data().size();
+
+    auto observations = mapFrames(writer.data());
+    ASSERT_EQ(1, observations->getValue<EntityList>().size());
+  });
+
+  cout << "[ BENCH    ] bytes per observation: shdr " << shdrBytes << ", binary " << binaryBytes
+       << "; speedup " << (shdr / binary) << "x" << endl;
+  ASSERT_LT(binaryBytes, shdrBytes);
+}
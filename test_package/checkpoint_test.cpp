@@ -21,6 +21,7 @@
 
 #include "agent_test_helper.hpp"
 #include "mtconnect/buffer/checkpoint.hpp"
+#include "test_utilities.hpp"
 
 using namespace std;
 using namespace mtconnect;
@@ -703,3 +704,252 @@ TEST_F(CheckpointTest, condition_chaining_with_condition_id_for_23)
   m_checkpoint->getObservations(list);
   ASSERT_EQ(1, (int)list.size());
 }
+
+namespace {
+  // A tool table with `rows` rows of 10 cells
+  DataSet ToolTable(int rows, int64_t value = 0)
+  {
+    DataSet table;
+    for (int r = 0; r < rows; r++)
+    {
+      TableRow row;
+      for (int c = 0; c < 10; c++)
+        row.emplace("C" + to_string(c), int64_t(r * 10 + c) + value);
+      table.emplace("T" + to_string(r), DataSetValue(row));
+    }
+    return table;
+  }
+}  // namespace
+
+TEST_F(CheckpointTest, should_share_unchanged_table_rows)
+{
+  ErrorList errors;
+  auto table = DataItem::make({{"id", "tt"s},
+                               {"type", "TOOL_OFFSET"s},
+                               {"category", "EVENT"s},
+                               {"representation", "TABLE"s}},
+                              errors);
+  m_device->addDataItem(table, errors);
+  ASSERT_TRUE(errors.empty());
+
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  auto first = Observation::make(table, {{"VALUE", ToolTable(500)}}, time, errors);
+  m_checkpoint->addObservation(first);
+
+  // Change one cell and remove one row
+  TableRow row = get<TableRow>(ToolTable(500).find("T42"s)->m_value);
+  row.erase(TableCell("C3"));
+  row.emplace("C3", int64_t(-1));
+  DataSet update {{"T42", DataSetValue(row)}, {"T7", DataSetValue(), true}};
+  auto second = Observation::make(table, {{"VALUE", update}}, time, errors);
+  m_checkpoint->addObservation(second);
+
+  auto merged = dynamic_pointer_cast<DataSetEvent>(m_checkpoint->getObservation("tt"));
+  const auto &set = merged->getDataSet();
+  const auto &original = dynamic_pointer_cast<DataSetEvent>(first)->getDataSet();
+  ASSERT_EQ(499, set.size());
+  ASSERT_EQ(499, merged->get<int64_t>("count"));
+  ASSERT_EQ(500, original.size());
+  ASSERT_TRUE(set.find("T7"s) == set.end());
+  ASSERT_EQ(-1, get<TableRow>(set.find("T42"s)->m_value).get<int64_t>("C3"));
+  ASSERT_EQ(423, get<TableRow>(original.find("T42"s)->m_value).get<int64_t>("C3"));
+
+  // The unchanged rows are the rows of the first observation
+  for (const auto &entry : set)
+  {
+    if (entry.m_key != "T42")
+    {
+      const auto &orow = get<TableRow>(original.find(entry)->m_value);
+      ASSERT_TRUE(get<TableRow>(entry.m_value).shares(orow)) << entry.m_key;
+    }
+  }
+
+  // Sending the same row again is a duplicate
+  auto third = Observation::make(table, {{"VALUE", DataSet {{"T42", DataSetValue(row)}}}}, time,
+                                 errors);
+  ASSERT_FALSE(m_checkpoint->checkDuplicate(third));
+}
+
+TEST_F(CheckpointTest, benchmark_large_table_updates)
+{
+  ErrorList errors;
+  auto table = DataItem::make({{"id", "tt"s},
+                               {"type", "TOOL_OFFSET"s},
+                               {"category", "EVENT"s},
+                               {"representation", "TABLE"s}},
+                              errors);
+  m_device->addDataItem(table, errors);
+
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  auto full = ToolTable(500);
+  m_checkpoint->addObservation(Observation::make(table, {{"VALUE", full}}, time, errors));
+
+  // Each update changes one cell of one row
+  vector<ObservationPtr> updates;
+  for (int i = 0; i < 1000; i++)
+  {
+    auto key = "T" + to_string((i * 37) % 500);
+    TableRow row = get<TableRow>(full.find(key)->m_value);
+    row.erase(TableCell("C5"));
+    row.emplace("C5", int64_t(i + 100000));
+    updates.push_back(
+        Observation::make(table, {{"VALUE", DataSet {{key, DataSetValue(row)}}}}, time, errors));
+  }
+
+  benchmark("checkpoint update of one cell in a 500 row table", updates.size(), [&](size_t i) {
+    auto obs = m_checkpoint->checkDuplicate(updates[i]);
+    ASSERT_TRUE(obs);
+    m_checkpoint->addObservation(obs);
+  });
+
+  // Every row has a changed cell, so every row is compared and kept
+  auto latest = m_checkpoint->getObservation("tt");
+  auto unchanged = Observation::make(table, {{"VALUE", ToolTable(500)}}, time, errors);
+  benchmark("duplicate check of a 500 row table", 1000,
+            [&](size_t) { ASSERT_TRUE(Checkpoint::checkDuplicate(unchanged, latest)); });
+
+  ASSERT_EQ(500, dynamic_pointer_cast<DataSetEvent>(latest)->getDataSet().size());
+}
+
+namespace {
+  // Codes of the active conditions in the order they are printed
+  vector<string> ActiveCodes(const Checkpoint &checkpoint)
+  {
+    ObservationList list;
+    checkpoint.getObservations(list);
+    vector<string> codes;
+    for (auto &obs : list)
+      codes.emplace_back(dynamic_pointer_cast<Condition>(obs)->getCode());
+    return codes;
+  }
+}  // namespace
+
+TEST_F(CheckpointTest, should_index_one_thousand_active_conditions)
+{
+  ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  auto make = [&](int code, const string &level) {
+    return Observation::make(m_dataItem1,
+                             {{"level", level},
+                              {"nativeCode", "C" + to_string(code)},
+                              {"VALUE", "Condition " + to_string(code)}},
+                             time, errors);
+  };
+
+  auto head = [&]() {
+    return dynamic_pointer_cast<Condition>(m_checkpoint->getObservation("1"));
+  };
+
+  // The expected chain, newest first
+  list<string> expected;
+  auto add = [&](int code, const string &level) {
+    auto obs = m_checkpoint->checkDuplicate(make(code, level));
+    ASSERT_TRUE(obs);
+    m_checkpoint->addObservation(obs);
+
+    expected.remove("C" + to_string(code));
+    if (level != "NORMAL")
+      expected.push_front("C" + to_string(code));
+  };
+  auto verify = [&]() {
+    if (expected.empty())
+    {
+      ASSERT_EQ(vector<string> {""}, ActiveCodes(*m_checkpoint));
+      return;
+    }
+    ASSERT_EQ(vector<string>(expected.begin(), expected.end()), ActiveCodes(*m_checkpoint));
+
+    // The condition list is oldest first
+    ConditionList conditions;
+    head()->getConditionList(conditions);
+    ASSERT_EQ(expected.size(), conditions.size());
+    auto code = expected.rbegin();
+    for (auto &cond : conditions)
+      ASSERT_EQ(*code++, cond->getCode());
+  };
+
+  for (int i = 0; i < 1000; i++)
+    add(i, "FAULT");
+  verify();
+
+  // Reactivating a condition with the same level and value is a duplicate
+  for (int i = 0; i < 1000; i++)
+    ASSERT_FALSE(m_checkpoint->checkDuplicate(make(i, "FAULT")));
+
+  // A change of level moves the condition to the front of the chain
+  add(500, "WARNING");
+  verify();
+  ASSERT_EQ(Condition::WARNING, head()->getLevel());
+  ASSERT_FALSE(m_checkpoint->checkDuplicate(make(500, "WARNING")));
+  ASSERT_TRUE(m_checkpoint->checkDuplicate(make(500, "FAULT")));
+
+  // Clear the newest, the oldest and one in the middle. A chain that was read is not changed.
+  auto printed = head();
+  auto printedCodes = ActiveCodes(*m_checkpoint);
+  add(500, "NORMAL");
+  verify();
+  add(0, "NORMAL");
+  verify();
+  add(250, "NORMAL");
+  verify();
+  vector<string> chain;
+  for (auto cond = printed; cond; cond = cond->getPrev())
+    chain.emplace_back(cond->getCode());
+  ASSERT_EQ(printedCodes, chain);
+
+  // A normal for a cleared condition is a duplicate
+  ASSERT_FALSE(m_checkpoint->checkDuplicate(make(250, "NORMAL")));
+
+  // Clear the rest alternating between the newest and the oldest
+  for (bool newest = true; !expected.empty(); newest = !newest)
+  {
+    auto code = newest ? expected.front() : expected.back();
+    add(stoi(code.substr(1)), "NORMAL");
+    if (expected.size() % 100 == 0)
+      verify();
+  }
+
+  ASSERT_EQ(Condition::NORMAL, head()->getLevel());
+  ASSERT_FALSE(head()->getPrev());
+}
+
+TEST_F(CheckpointTest, benchmark_one_thousand_active_conditions)
+{
+  ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  auto make = [&](size_t code, const string &level) {
+    return Observation::make(m_dataItem1,
+                             {{"level", level},
+                              {"nativeCode", "C" + to_string(code)},
+                              {"VALUE", "Condition " + to_string(code)}},
+                             time, errors);
+  };
+
+  vector<ObservationPtr> faults, normals;
+  for (size_t i = 0; i < 1000; i++)
+  {
+    faults.push_back(make(i, "FAULT"));
+    normals.push_back(make(i, "NORMAL"));
+  }
+
+  benchmark("activate 1,000 conditions", 1000,
+            [&](size_t i) { m_checkpoint->addObservation(faults[i]); });
+  benchmark("duplicate check with 1,000 active conditions", 1000,
+            [&](size_t i) { ASSERT_FALSE(m_checkpoint->checkDuplicate(make(i, "FAULT"))); });
+
+  // Clearing a condition copies the rest of the chain
+  benchmark("clear and reactivate the newest of 1,000 active conditions", 1000, [&](size_t) {
+    m_checkpoint->addObservation(make(999, "NORMAL"));
+    m_checkpoint->addObservation(make(999, "FAULT"));
+  });
+
+  benchmark("clear and reactivate the oldest of 1,000 active conditions", 1000, [&](size_t i) {
+    m_checkpoint->addObservation(make(i, "NORMAL"));
+    m_checkpoint->addObservation(make(i, "FAULT"));
+  });
+
+  ASSERT_EQ(1000, ActiveCodes(*m_checkpoint).size());
+  benchmark("clear 1,000 active conditions", 1000,
+            [&](size_t i) { m_checkpoint->addObservation(normals[i]); });
+  ASSERT_EQ(vector<string> {""}, ActiveCodes(*m_checkpoint));
+}
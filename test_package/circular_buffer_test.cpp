@@ -19,9 +19,14 @@
 #include <gtest/gtest.h>
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
+#include <atomic>
+#include <thread>
+
 #include "agent_test_helper.hpp"
 #include "mtconnect/buffer/checkpoint.hpp"
 #include "mtconnect/buffer/circular_buffer.hpp"
+#include "mtconnect/buffer/observation_archive.hpp"
+#include "test_utilities.hpp"
 
 using namespace std;
 using namespace mtconnect;
@@ -34,6 +39,7 @@ using namespace entity;
 using namespace data_item;
 using namespace std::literals;
 using namespace date::literals;
+namespace fs = std::filesystem;
 
 // main
 int main(int argc, char *argv[])
@@ -82,6 +88,8 @@ protected:
   void TearDown() override
   {
     m_circularBuffer.reset();
+    if (!m_archivePath.empty())
+      fs::remove_all(m_archivePath);
     m_dataItem1.reset();
     m_dataItem2.reset();
   }
@@ -125,7 +133,27 @@ protected:
     m_circularBuffer->addToBuffer(p6);
   }
 
+  void addSamples(int count)
+  {
+    entity::ErrorList errors;
+    Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+    for (int i = 1; i <= count; i++)
+    {
+      auto obs = observation::Observation::make(m_dataItem2, {{"VALUE", to_string(i)}},
+                                                time + chrono::milliseconds(i), errors);
+      m_circularBuffer->addToBuffer(obs);
+    }
+  }
+
+  void setArchive(size_t segmentSize, size_t maxSegments, bool compress = false)
+  {
+    m_archivePath = fs::path(TEST_BIN_ROOT_DIR) / "observation_archive";
+    m_circularBuffer->setArchive(
+        make_unique<ObservationArchive>(m_archivePath, segmentSize, maxSegments, compress));
+  }
+
   std::unique_ptr<CircularBuffer> m_circularBuffer;
+  fs::path m_archivePath;
   DataItemPtr m_dataItem1;
   DataItemPtr m_dataItem2;
   DevicePtr m_device;
@@ -191,3 +219,836 @@ TEST_F(CircularBufferTest, should_skip_orphaned_observations)
   ASSERT_EQ(7, end);
   ASSERT_TRUE(eob);
 }
+
+TEST_F(CircularBufferTest, should_publish_latest_observation_to_data_item)
+{
+  ASSERT_FALSE(m_dataItem1->getLatestObservation());
+  ASSERT_FALSE(m_dataItem2->getLatestObservation());
+
+  addSomeObservations();
+
+  auto &latest = m_circularBuffer->getLatest();
+  ASSERT_EQ(latest.getObservation("1"), m_dataItem1->getLatestObservation());
+  ASSERT_EQ(latest.getObservation("3"), m_dataItem2->getLatestObservation());
+
+  // The published condition is the head of the active chain
+  auto cond = dynamic_pointer_cast<Condition>(m_dataItem1->getLatestObservation());
+  ASSERT_TRUE(cond);
+  ASSERT_EQ("CODE1", cond->getCode());
+
+  entity::ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 2min;
+  auto same = observation::Observation::make(m_dataItem2, {{"VALUE", "123"s}}, time, errors);
+  ASSERT_FALSE(m_circularBuffer->checkDuplicate(same));
+
+  auto changed = observation::Observation::make(m_dataItem2, {{"VALUE", "124"s}}, time, errors);
+  ASSERT_EQ(changed, m_circularBuffer->checkDuplicate(changed));
+
+  auto warning = observation::Observation::make(m_dataItem1,
+                                                {{"level", "WARNING"s},
+                                                 {"nativeCode", "CODE1"s},
+                                                 {"qualifier", "HIGH"s},
+                                                 {"VALUE", "Over..."s}},
+                                                time, errors);
+  ASSERT_FALSE(m_circularBuffer->checkDuplicate(warning));
+}
+
+TEST_F(CircularBufferTest, should_read_evicted_observations_from_the_archive)
+{
+  setArchive(2048, 100);
+  addSamples(100);
+
+  ASSERT_EQ(101, m_circularBuffer->getSequence());
+  ASSERT_EQ(85, m_circularBuffer->getBufferFirstSequence());
+  ASSERT_EQ(1, m_circularBuffer->getFirstSequence());
+  ASSERT_LT(1, m_circularBuffer->getArchive()->getSegmentCount());
+
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  FilterSetOpt opt;
+  auto list {m_circularBuffer->getObservations(100, opt, start, stop, end, first, eob)};
+
+  ASSERT_EQ(100, list->size());
+  ASSERT_EQ(1, first);
+  ASSERT_EQ(101, end);
+  ASSERT_TRUE(eob);
+
+  SequenceNumber_t seq = 1;
+  for (auto &obs : *list)
+  {
+    ASSERT_EQ(seq, obs->getSequence());
+    ASSERT_EQ("3", obs->getDataItem()->getId());
+    ASSERT_EQ(double(seq), obs->getValue<double>());
+    seq++;
+  }
+
+  // Starting in the archive and stopping in the archive
+  start = 10;
+  list = m_circularBuffer->getObservations(20, opt, start, stop, end, first, eob);
+  ASSERT_EQ(20, list->size());
+  ASSERT_EQ(10, list->front()->getSequence());
+  ASSERT_EQ(30, end);
+  ASSERT_FALSE(eob);
+
+  // Backwards from the end of the buffer into the archive
+  list = m_circularBuffer->getObservations(-30, opt, nullopt, stop, end, first, eob);
+  ASSERT_EQ(30, list->size());
+  ASSERT_EQ(100, list->front()->getSequence());
+  ASSERT_EQ(71, list->back()->getSequence());
+  ASSERT_EQ(70, end);
+  ASSERT_FALSE(eob);
+
+  list = m_circularBuffer->getObservations(-100, opt, nullopt, stop, end, first, eob);
+  ASSERT_EQ(100, list->size());
+  ASSERT_EQ(1, list->back()->getSequence());
+  ASSERT_TRUE(eob);
+
+  // Between two sequences
+  start = 5;
+  stop = 90;
+  list = m_circularBuffer->getObservations(10, opt, start, stop, end, first, eob);
+  ASSERT_EQ(10, list->size());
+  ASSERT_EQ(90, list->front()->getSequence());
+  ASSERT_EQ(81, list->back()->getSequence());
+  ASSERT_EQ(5, first);
+}
+
+TEST_F(CircularBufferTest, should_read_the_archive_while_observations_are_archived)
+{
+  setArchive(4096, 100);
+
+  // Read forward from the first sequence while the buffer evicts to the archive. The
+  // observations waiting for the archive writer must be read from its queue.
+  atomic_bool done {false};
+  thread reader([&]() {
+    std::optional<SequenceNumber_t> start {1}, stop;
+    SequenceNumber_t first, end;
+    bool eob = false;
+    while (!done)
+    {
+      auto list {m_circularBuffer->getObservations(200, nullopt, start, stop, end, first, eob)};
+      SequenceNumber_t seq = 1;
+      for (auto &obs : *list)
+        ASSERT_EQ(seq++, obs->getSequence());
+      ASSERT_EQ(seq, end);
+    }
+  });
+
+  addSamples(5000);
+  done = true;
+  reader.join();
+
+  ASSERT_EQ(1, m_circularBuffer->getFirstSequence());
+  ASSERT_EQ(m_circularBuffer->getBufferFirstSequence(),
+            m_circularBuffer->getArchive()->getNextSequence());
+}
+
+TEST_F(CircularBufferTest, should_archive_conditions_and_data_sets)
+{
+  ErrorList errors;
+  auto dataSet = DataItem::make({{"id", "4"s},
+                                 {"type", "VARIABLE"s},
+                                 {"category", "EVENT"s},
+                                 {"representation", "DATA_SET"s}},
+                                errors);
+  m_comp2->addDataItem(dataSet, errors);
+  ASSERT_TRUE(errors.empty());
+
+  setArchive(4096, 10);
+  addSomeObservations();
+
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  DataSet set;
+  set.emplace("a", int64_t(1));
+  set.emplace("b", 2.5);
+  set.emplace("c", "text"s);
+  set.emplace("d", DataSetValue(), true);
+  auto ds = Observation::make(dataSet, {{"VALUE", set}}, time, errors);
+  m_circularBuffer->addToBuffer(ds);
+
+  std::vector<ObservationPtr> originals;
+  {
+    std::optional<SequenceNumber_t> start {1}, stop;
+    SequenceNumber_t first, end;
+    bool eob = false;
+    auto list {m_circularBuffer->getObservations(100, nullopt, start, stop, end, first, eob)};
+    originals.assign(list->begin(), list->end());
+  }
+  ASSERT_EQ(7, originals.size());
+
+  // Evict all the observations
+  addSamples(16);
+  ASSERT_EQ(8, m_circularBuffer->getBufferFirstSequence());
+
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  FilterSetOpt filter = FilterSet {"1", "4"};
+  auto list {m_circularBuffer->getObservations(100, filter, start, stop, end, first, eob)};
+  ASSERT_EQ(5, list->size());
+
+  auto it = list->begin();
+  for (auto &orig : originals)
+  {
+    if (orig->getDataItem()->getId() == "3")
+      continue;
+
+    auto &obs = *it++;
+    ASSERT_EQ(orig->getSequence(), obs->getSequence());
+    ASSERT_EQ(orig->getName(), obs->getName());
+    ASSERT_EQ(orig->getTimestamp(), obs->getTimestamp());
+    ASSERT_EQ(orig->getProperties(), obs->getProperties());
+  }
+
+  auto cond = dynamic_pointer_cast<Condition>(list->front());
+  ASSERT_TRUE(cond);
+  ASSERT_EQ(Condition::WARNING, cond->getLevel());
+  ASSERT_EQ("CODE1", cond->getCode());
+
+  auto &archived = list->back()->getValue<DataSet>();
+  ASSERT_EQ(4, archived.size());
+  ASSERT_EQ(1, archived.get<int64_t>("a"));
+  ASSERT_EQ(2.5, archived.get<double>("b"));
+  ASSERT_EQ("text", archived.get<string>("c"));
+  ASSERT_TRUE(archived.find(DataSetEntry("d"))->m_removed);
+}
+
+TEST_F(CircularBufferTest, should_drop_the_oldest_archive_segments)
+{
+  setArchive(2048, 3);
+  addSamples(1000);
+
+  auto archive = m_circularBuffer->getArchive();
+  ASSERT_EQ(3, archive->getSegmentCount());
+  ASSERT_LT(1, m_circularBuffer->getFirstSequence());
+  ASSERT_EQ(archive->getFirstSequence(), m_circularBuffer->getFirstSequence());
+  ASSERT_EQ(m_circularBuffer->getBufferFirstSequence(), archive->getNextSequence());
+
+  int files = 0;
+  for (auto &entry : fs::directory_iterator(m_archivePath))
+  {
+    ASSERT_EQ(".seg", entry.path().extension());
+    files++;
+  }
+  ASSERT_EQ(3, files);
+
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  auto list {m_circularBuffer->getObservations(10, nullopt, start, stop, end, first, eob)};
+  ASSERT_EQ(10, list->size());
+  ASSERT_EQ(m_circularBuffer->getFirstSequence(), first);
+  ASSERT_EQ(first, list->front()->getSequence());
+}
+
+TEST_F(CircularBufferTest, benchmark_archive_range_reads)
+{
+  setArchive(64 * 1024, 100);
+  addSamples(100000);
+
+  auto archive = m_circularBuffer->getArchive();
+  auto segments = archive->getSegmentCount();
+  ASSERT_LT(ObservationArchive::MappedSegments, segments);
+  auto perSegment = (archive->getNextSequence() - archive->getFirstSequence()) / segments;
+
+  std::optional<SequenceNumber_t> start, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  size_t total = 0;
+
+  // Each read starts in a segment that is not mapped
+  benchmark("archive cold range read of 100 observations", segments - 1, [&](size_t i) {
+    start = 1 + i * perSegment;
+    auto list {m_circularBuffer->getObservations(100, nullopt, start, stop, end, first, eob)};
+    total += list->size();
+  });
+
+  start = 1;
+  benchmark("archive warm range read of 100 observations", 1000, [&](size_t) {
+    auto list {m_circularBuffer->getObservations(100, nullopt, start, stop, end, first, eob)};
+    total += list->size();
+  });
+
+  benchmark("circular buffer range read of 100 observations", 1000, [&](size_t) {
+    start = m_circularBuffer->getBufferFirstSequence();
+    auto list {
+        m_circularBuffer->getObservations(100, nullopt, start, nullopt, end, first, eob)};
+    total += list->size();
+  });
+
+  ASSERT_EQ((segments - 1) * 100 + 2000 * 100, total);
+}
+
+TEST_F(CircularBufferTest, should_find_sequences_by_time)
+{
+  m_circularBuffer = make_unique<CircularBuffer>(10, 4);
+  addSamples(1000);
+
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  ASSERT_EQ(1, m_circularBuffer->getSequenceAtTime(time));
+  ASSERT_EQ(64, m_circularBuffer->getSequenceAtTime(time + 64ms));
+  ASSERT_EQ(500, m_circularBuffer->getSequenceAtTime(time + 500ms));
+  ASSERT_EQ(501, m_circularBuffer->getSequenceAtTime(time + 500ms + 1us));
+  ASSERT_EQ(1000, m_circularBuffer->getSequenceAtTime(time + 1000ms));
+  ASSERT_EQ(1001, m_circularBuffer->getSequenceAtTime(time + 2000ms));
+
+  // Times before the circular buffer give the first sequence in the buffer
+  m_circularBuffer = make_unique<CircularBuffer>(8, 4);
+  addSamples(1000);
+  ASSERT_EQ(745, m_circularBuffer->getBufferFirstSequence());
+  ASSERT_EQ(745, m_circularBuffer->getSequenceAtTime(time));
+  ASSERT_EQ(800, m_circularBuffer->getSequenceAtTime(time + 800ms));
+
+  // The last sequence at or before a time
+  ASSERT_EQ(744, m_circularBuffer->getLastSequenceAtTime(time));
+  ASSERT_EQ(800, m_circularBuffer->getLastSequenceAtTime(time + 800ms));
+  ASSERT_EQ(800, m_circularBuffer->getLastSequenceAtTime(time + 800ms + 1us));
+  ASSERT_EQ(1000, m_circularBuffer->getLastSequenceAtTime(time + 2000ms));
+}
+
+TEST_F(CircularBufferTest, should_find_sequences_with_out_of_order_timestamps)
+{
+  m_circularBuffer = make_unique<CircularBuffer>(10, 4);
+
+  entity::ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  for (int i = 1; i <= 200; i++)
+  {
+    // Observation 40 is ahead of the others and 150 is behind
+    auto offset = i == 40 ? 90ms : (i == 150 ? 10ms : chrono::milliseconds(i));
+    auto obs = observation::Observation::make(m_dataItem2, {{"VALUE", to_string(i)}},
+                                              time + offset, errors);
+    m_circularBuffer->addToBuffer(obs);
+  }
+
+  // Every observation at or after the time is at or after the sequence
+  ASSERT_EQ(40, m_circularBuffer->getSequenceAtTime(time + 60ms));
+  ASSERT_EQ(40, m_circularBuffer->getSequenceAtTime(time + 90ms));
+  ASSERT_EQ(91, m_circularBuffer->getSequenceAtTime(time + 91ms));
+  ASSERT_EQ(10, m_circularBuffer->getSequenceAtTime(time + 10ms));
+  ASSERT_EQ(151, m_circularBuffer->getSequenceAtTime(time + 151ms));
+
+  // Every observation at or before the time is at or before the sequence
+  ASSERT_EQ(0, m_circularBuffer->getLastSequenceAtTime(time));
+  ASSERT_EQ(9, m_circularBuffer->getLastSequenceAtTime(time + 9ms));
+  ASSERT_EQ(150, m_circularBuffer->getLastSequenceAtTime(time + 10ms));
+  ASSERT_EQ(150, m_circularBuffer->getLastSequenceAtTime(time + 70ms));
+  ASSERT_EQ(150, m_circularBuffer->getLastSequenceAtTime(time + 150ms));
+  ASSERT_EQ(160, m_circularBuffer->getLastSequenceAtTime(time + 160ms));
+  ASSERT_EQ(200, m_circularBuffer->getLastSequenceAtTime(time + 1h));
+}
+
+TEST_F(CircularBufferTest, benchmark_time_lookups)
+{
+  // A 2^18 buffer keeps the memory used by the test reasonable, the lookup is logarithmic
+  m_circularBuffer = make_unique<CircularBuffer>(18, 1000);
+  auto size = m_circularBuffer->getBufferSize();
+  addSamples(size + size / 2);
+
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  auto first = m_circularBuffer->getBufferFirstSequence();
+  auto offset = [&](size_t i) { return chrono::milliseconds(first + (i * 7919) % size); };
+
+  SequenceNumber_t total = 0;
+  benchmark("time index lookup", 100000, [&](size_t i) {
+    total += m_circularBuffer->getSequenceAtTime(time + offset(i));
+  });
+
+  SequenceNumber_t expected = 0;
+  benchmark("linear time lookup", 100, [&](size_t i) {
+    auto seq = first;
+    while (m_circularBuffer->getFromBuffer(seq)->getTimestamp() < time + offset(i))
+      seq++;
+    expected += seq;
+  });
+
+  ASSERT_EQ(m_circularBuffer->getSequenceAtTime(time + offset(99)), first + (99 * 7919) % size);
+  ASSERT_LT(0, total);
+  ASSERT_LT(0, expected);
+}
+
+TEST_F(CircularBufferTest, should_evict_observations_to_the_memory_limit)
+{
+  m_circularBuffer = make_unique<CircularBuffer>(10, 4);
+  addSamples(1);
+  auto size = CircularBuffer::approximateSize(m_circularBuffer->getFromBuffer(1));
+
+  m_circularBuffer = make_unique<CircularBuffer>(10, 4);
+  m_circularBuffer->setMemoryLimit(size * 10);
+  addSamples(100);
+
+  ASSERT_EQ(10, m_circularBuffer->getObservationCount());
+  ASSERT_EQ(size * 10, m_circularBuffer->getMemoryUsage());
+  ASSERT_EQ(91, m_circularBuffer->getFirstSequence());
+  ASSERT_EQ(101, m_circularBuffer->getSequence());
+
+  std::optional<SequenceNumber_t> start, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  auto list {m_circularBuffer->getObservations(100, nullopt, start, stop, end, first, eob)};
+  ASSERT_EQ(10, list->size());
+  ASSERT_EQ(91, list->front()->getSequence());
+  ASSERT_TRUE(eob);
+
+  // The checkpoints stay aligned with the first sequence
+  for (SequenceNumber_t seq = 91; seq <= 100; seq++)
+  {
+    auto checkpoint = m_circularBuffer->getCheckpointAt(seq, nullopt);
+    ASSERT_EQ(double(seq), checkpoint->getObservation("3")->getValue<double>());
+  }
+  ASSERT_EQ(91.0, m_circularBuffer->getFirst().getObservation("3")->getValue<double>());
+}
+
+TEST_F(CircularBufferTest, should_evict_small_observations_for_a_large_one)
+{
+  m_circularBuffer = make_unique<CircularBuffer>(10, 4);
+  addSamples(1);
+  auto size = CircularBuffer::approximateSize(m_circularBuffer->getFromBuffer(1));
+
+  m_circularBuffer = make_unique<CircularBuffer>(10, 4);
+  setArchive(64 * 1024, 10);
+  m_circularBuffer->setMemoryLimit(size * 10);
+  addSamples(10);
+  ASSERT_EQ(10, m_circularBuffer->getObservationCount());
+
+  ErrorList errors;
+  auto dataItem = DataItem::make({{"id", "v1"s},
+                                  {"type", "VARIABLE"s},
+                                  {"category", "EVENT"s},
+                                  {"representation", "DATA_SET"s}},
+                                 errors);
+  m_comp2->addDataItem(dataItem, errors);
+
+  DataSet set;
+  for (int i = 0; i < 100; i++)
+    set.emplace("key" + to_string(i), "a value for the data set"s);
+  auto obs = Observation::make(dataItem, {{"VALUE", set}}, Timestamp(), errors);
+  m_circularBuffer->addToBuffer(obs);
+
+  // Only the data set fits
+  ASSERT_EQ(1, m_circularBuffer->getObservationCount());
+  ASSERT_EQ(11, m_circularBuffer->getBufferFirstSequence());
+  ASSERT_LT(size * 10, m_circularBuffer->getMemoryUsage());
+
+  // The evicted observations are in the archive
+  ASSERT_EQ(1, m_circularBuffer->getFirstSequence());
+  std::optional<SequenceNumber_t> start, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  auto list {m_circularBuffer->getObservations(100, nullopt, start, stop, end, first, eob)};
+  ASSERT_EQ(11, list->size());
+  ASSERT_EQ(1, list->front()->getSequence());
+}
+
+TEST_F(CircularBufferTest, should_read_compressed_blocks_from_the_archive)
+{
+  setArchive(2048, 100, true);
+  addSamples(1000);
+
+  auto archive = m_circularBuffer->getArchive();
+  ASSERT_TRUE(archive->isCompressed());
+  ASSERT_LT(1, archive->getSegmentCount());
+  ASSERT_EQ(1, m_circularBuffer->getFirstSequence());
+  ASSERT_EQ(985, m_circularBuffer->getBufferFirstSequence());
+  ASSERT_EQ(985, archive->getNextSequence());
+
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  FilterSetOpt opt;
+  auto list {m_circularBuffer->getObservations(1000, opt, start, stop, end, first, eob)};
+
+  ASSERT_EQ(1000, list->size());
+  ASSERT_EQ(1, first);
+  ASSERT_TRUE(eob);
+
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  SequenceNumber_t seq = 1;
+  for (auto &obs : *list)
+  {
+    ASSERT_EQ(seq, obs->getSequence());
+    ASSERT_EQ("3", obs->getDataItem()->getId());
+    ASSERT_EQ(double(seq), obs->getValue<double>());
+    ASSERT_EQ(time + chrono::milliseconds(seq), obs->getTimestamp());
+    seq++;
+  }
+
+  // Starting in the middle of a block and ending in the partial block
+  start = 100;
+  list = m_circularBuffer->getObservations(880, opt, start, stop, end, first, eob);
+  ASSERT_EQ(880, list->size());
+  ASSERT_EQ(100, list->front()->getSequence());
+  ASSERT_EQ(979, list->back()->getSequence());
+  ASSERT_EQ(980, end);
+
+  // Backwards from the end of the buffer through the partial block
+  list = m_circularBuffer->getObservations(-100, opt, nullopt, stop, end, first, eob);
+  ASSERT_EQ(100, list->size());
+  ASSERT_EQ(1000, list->front()->getSequence());
+  ASSERT_EQ(901, list->back()->getSequence());
+  ASSERT_EQ(900, end);
+
+  list = m_circularBuffer->getObservations(-1000, opt, nullopt, stop, end, first, eob);
+  ASSERT_EQ(1000, list->size());
+  ASSERT_EQ(1, list->back()->getSequence());
+  ASSERT_EQ(1.0, list->back()->getValue<double>());
+}
+
+TEST_F(CircularBufferTest, should_keep_compressed_segments_in_memory)
+{
+  m_circularBuffer->setArchive(make_unique<ObservationArchive>("", 1040, 3, true));
+  addSamples(1000);
+
+  auto archive = m_circularBuffer->getArchive();
+  ASSERT_TRUE(archive->isInMemory());
+  ASSERT_EQ(3, archive->getSegmentCount());
+  ASSERT_GE(3 * 1040, archive->getSize());
+
+  // The oldest segments are dropped
+  auto firstSeq = m_circularBuffer->getFirstSequence();
+  ASSERT_LT(1, firstSeq);
+  ASSERT_EQ(985, m_circularBuffer->getBufferFirstSequence());
+
+  std::optional<SequenceNumber_t> start {firstSeq}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  FilterSetOpt opt;
+  auto list {m_circularBuffer->getObservations(1000, opt, start, stop, end, first, eob)};
+
+  ASSERT_EQ(1001 - firstSeq, list->size());
+  ASSERT_TRUE(eob);
+
+  auto seq = firstSeq;
+  for (auto &obs : *list)
+  {
+    ASSERT_EQ(seq, obs->getSequence());
+    ASSERT_EQ(double(seq), obs->getValue<double>());
+    seq++;
+  }
+
+  list = m_circularBuffer->getObservations(-100, opt, nullopt, stop, end, first, eob);
+  ASSERT_EQ(100, list->size());
+  ASSERT_EQ(1000, list->front()->getSequence());
+  ASSERT_EQ(901, list->back()->getSequence());
+}
+
+TEST_F(CircularBufferTest, should_keep_exact_values_in_compressed_blocks)
+{
+  setArchive(64 * 1024, 10, true);
+
+  vector<double> values {0.0,  -0.0,   1.0,    1.0,     1.0e10,  -1.0,    0.1,     0.3,
+                         1e300, -1e-300, 5e-324, 123.456, 123.457, -123.456, 1e15 + 0.5};
+  values.push_back(numeric_limits<double>::infinity());
+  values.push_back(-numeric_limits<double>::infinity());
+  values.push_back(numeric_limits<double>::max());
+  for (int i = 0; i < 100; i++)
+    values.push_back(100.0 + std::sin(i * 0.1));
+
+  ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  vector<Timestamp> times;
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    // Irregular intervals with out of order timestamps
+    times.push_back(time + chrono::microseconds((i * i * 37) % 100000) + chrono::seconds(i));
+    if (i % 7 == 0)
+      times.back() -= 2min;
+    auto obs = Observation::make(m_dataItem2, {{"VALUE", values[i]}}, times.back(), errors);
+    m_circularBuffer->addToBuffer(obs);
+  }
+  addSamples(16);
+  ASSERT_EQ(values.size() + 1, m_circularBuffer->getBufferFirstSequence());
+
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  auto list {m_circularBuffer->getObservations(int(values.size()), nullopt, start, stop, end,
+                                               first, eob)};
+  ASSERT_EQ(values.size(), list->size());
+
+  size_t i = 0;
+  for (auto &obs : *list)
+  {
+    auto value = obs->getValue<double>();
+    ASSERT_EQ(0, memcmp(&values[i], &value, sizeof(double))) << "value " << i;
+    ASSERT_EQ(times[i], obs->getTimestamp()) << "timestamp " << i;
+    i++;
+  }
+}
+
+TEST_F(CircularBufferTest, should_compress_conditions_and_data_sets)
+{
+  ErrorList errors;
+  auto dataSet = DataItem::make({{"id", "4"s},
+                                 {"type", "VARIABLE"s},
+                                 {"category", "EVENT"s},
+                                 {"representation", "DATA_SET"s}},
+                                errors);
+  m_comp2->addDataItem(dataSet, errors);
+  ASSERT_TRUE(errors.empty());
+
+  setArchive(4096, 10, true);
+  addSomeObservations();
+
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  DataSet set;
+  set.emplace("a", int64_t(1));
+  set.emplace("b", 2.5);
+  set.emplace("c", "text"s);
+  set.emplace("d", DataSetValue(), true);
+  auto ds = Observation::make(dataSet, {{"VALUE", set}}, time, errors);
+  m_circularBuffer->addToBuffer(ds);
+
+  std::vector<ObservationPtr> originals;
+  {
+    std::optional<SequenceNumber_t> start {1}, stop;
+    SequenceNumber_t first, end;
+    bool eob = false;
+    auto list {m_circularBuffer->getObservations(100, nullopt, start, stop, end, first, eob)};
+    originals.assign(list->begin(), list->end());
+  }
+  ASSERT_EQ(7, originals.size());
+
+  // Evict enough observations to write a full block
+  addSamples(100);
+  ASSERT_EQ(92, m_circularBuffer->getBufferFirstSequence());
+
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  FilterSetOpt filter = FilterSet {"1", "4"};
+  auto list {m_circularBuffer->getObservations(100, filter, start, stop, end, first, eob)};
+  ASSERT_EQ(5, list->size());
+
+  auto it = list->begin();
+  for (auto &orig : originals)
+  {
+    if (orig->getDataItem()->getId() == "3")
+      continue;
+
+    auto &obs = *it++;
+    ASSERT_EQ(orig->getSequence(), obs->getSequence());
+    ASSERT_EQ(orig->getName(), obs->getName());
+    ASSERT_EQ(orig->getTimestamp(), obs->getTimestamp());
+    ASSERT_EQ(orig->getProperties(), obs->getProperties());
+  }
+
+  auto cond = dynamic_pointer_cast<Condition>(list->front());
+  ASSERT_TRUE(cond);
+  ASSERT_EQ(Condition::WARNING, cond->getLevel());
+  ASSERT_EQ("CODE1", cond->getCode());
+
+  auto &archived = list->back()->getValue<DataSet>();
+  ASSERT_EQ(4, archived.size());
+  ASSERT_EQ(2.5, archived.get<double>("b"));
+  ASSERT_TRUE(archived.find(DataSetEntry("d"))->m_removed);
+}
+
+TEST_F(CircularBufferTest, benchmark_archive_compression)
+{
+  // Two hundred slowly changing samples reported in rotation every millisecond
+  ErrorList errors;
+  vector<DataItemPtr> dataItems;
+  for (int i = 0; i < 200; i++)
+  {
+    auto dataItem = DataItem::make({{"id", "x" + to_string(i)},
+                                    {"type", "POSITION"s},
+                                    {"category", "SAMPLE"s},
+                                    {"units", "MILLIMETER"s}},
+                                   errors);
+    m_comp2->addDataItem(dataItem, errors);
+    dataItems.push_back(dataItem);
+  }
+
+  const size_t count = 200000;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h;
+  vector<ObservationPtr> observations;
+  size_t memory = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    auto d = i % dataItems.size();
+    auto step = double(i / dataItems.size());
+    auto value = std::round(1000.0 * (100.0 + d + std::sin(step * 0.01))) / 1000.0;
+    auto obs = Observation::make(dataItems[d], {{"VALUE", value}},
+                                 time + chrono::milliseconds(i), errors);
+    obs->setSequence(i + 1);
+    memory += CircularBuffer::approximateSize(obs);
+    observations.push_back(obs);
+  }
+
+  auto path = fs::path(TEST_BIN_ROOT_DIR);
+  auto plain = make_unique<ObservationArchive>(path / "plain_archive", 1024 * 1024, 100);
+  // The compressed segments are kept in memory behind the circular buffer
+  auto compressed = make_unique<ObservationArchive>("", 1024 * 1024, 100, true);
+  for (auto &obs : observations)
+  {
+    plain->append(obs);
+    compressed->append(obs);
+  }
+
+  for (auto &[name, size] : {pair {"circular buffer"s, memory},
+                             pair {"archive"s, plain->getSize()},
+                             pair {"compressed segments in memory"s, compressed->getSize()}})
+  {
+    cout << "[ BENCH    ] " << name << ": " << double(size) / count << " bytes/observation"
+         << endl;
+    RecordProperty(name + " bytes/observation", to_string(double(size) / count));
+  }
+  ASSERT_GT(plain->getSize() / 2, compressed->getSize());
+
+  size_t total = 0;
+  auto visitor = [&total](SequenceNumber_t, const ObservationPtr &obs) {
+    total++;
+    return true;
+  };
+  benchmark("archive range read of 100 observations", 1000, [&](size_t i) {
+    auto from = 1 + (i * 197) % (count - 200);
+    plain->read(from, from + 100, nullopt, visitor);
+  });
+  benchmark("compressed archive range read of 100 observations", 1000, [&](size_t i) {
+    auto from = 1 + (i * 197) % (count - 200);
+    compressed->read(from, from + 100, nullopt, visitor);
+  });
+  ASSERT_EQ(200000, total);
+
+  FilterSetOpt filter = FilterSet {"x7"};
+  benchmark("compressed archive filtered read of 10000 observations", 100, [&](size_t i) {
+    auto from = 1 + (i * 1013) % (count - 10000);
+    compressed->read(from, from + 10000, filter, visitor);
+  });
+  ASSERT_EQ(200000 + 100 * 50, total);
+
+  plain.reset();
+  compressed.reset();
+  fs::remove_all(path / "plain_archive");
+}
+
+TEST_F(CircularBufferTest, should_keep_evicted_observations_while_a_reader_is_pinned)
+{
+  addSamples(16);
+  weak_ptr<Observation> oldest = m_circularBuffer->getFromBuffer(1);
+
+  ObservationPointers pointers;
+  ObservationList archived;
+  std::optional<SequenceNumber_t> start, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+
+  {
+    auto pinned = m_circularBuffer->pin();
+    m_circularBuffer->getObservations(pointers, archived, 100, nullopt, start, stop, end, first,
+                                      eob);
+    ASSERT_EQ(16, pointers.size());
+    ASSERT_TRUE(archived.empty());
+
+    // Every observation the reader has is evicted
+    addSamples(EpochManager::ReclaimInterval * 4);
+    ASSERT_FALSE(oldest.expired());
+    for (size_t i = 0; i < pointers.size(); i++)
+    {
+      ASSERT_EQ(i + 1, pointers[i]->getSequence());
+      ASSERT_EQ(double(i + 1), pointers[i]->getValue<double>());
+    }
+  }
+
+  // Released at the next reclaim after the reader leaves
+  addSamples(EpochManager::ReclaimInterval);
+  ASSERT_TRUE(oldest.expired());
+  ASSERT_GE(EpochManager::ReclaimInterval, m_circularBuffer->getEpochs().getRetiredCount());
+}
+
+TEST_F(CircularBufferTest, should_keep_archived_observations_for_a_pinned_reader)
+{
+  setArchive(64 * 1024, 10);
+  addSamples(100);
+
+  ObservationPointers pointers;
+  ObservationList archived;
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+
+  auto pinned = m_circularBuffer->pin();
+  m_circularBuffer->getObservations(pointers, archived, 100, nullopt, start, stop, end, first,
+                                    eob);
+  ASSERT_EQ(100, pointers.size());
+  ASSERT_EQ(100 - m_circularBuffer->getObservationCount(), archived.size());
+  ASSERT_EQ(archived.front().get(), pointers.front());
+  ASSERT_EQ(1, pointers.front()->getSequence());
+  ASSERT_EQ(100, pointers.back()->getSequence());
+}
+
+TEST_F(CircularBufferTest, benchmark_multi_reader_sample_throughput)
+{
+  m_circularBuffer = make_unique<CircularBuffer>(14, 1000);
+  addSamples(1 << 14);
+
+  // Takes `count` samples of 1000 observations on each of `readers` threads while another
+  // thread adds observations, reports the samples per second for all readers
+  auto run = [this](const string &name, int readers, int count, auto sample) {
+    atomic_bool done {false};
+    thread writer([this, &done]() {
+      entity::ErrorList errors;
+      auto time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 11h;
+      for (int i = 0; !done; i++)
+      {
+        auto obs = observation::Observation::make(m_dataItem2, {{"VALUE", to_string(i)}},
+                                                  time + chrono::milliseconds(i), errors);
+        m_circularBuffer->addToBuffer(obs);
+      }
+    });
+
+    atomic<size_t> total {0};
+    auto begin = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int r = 0; r < readers; r++)
+      threads.emplace_back([&]() {
+        for (int i = 0; i < count; i++)
+          total += sample();
+      });
+    for (auto &t : threads)
+      t.join();
+    auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    done = true;
+    writer.join();
+
+    ASSERT_EQ(size_t(readers) * count * 1000, total);
+    auto rate = double(readers * count) / elapsed;
+    cout << "[ BENCH    ] " << name << " with " << readers << " readers: " << rate
+         << " samples/second" << endl;
+    RecordProperty(name + " with " + to_string(readers) + " readers", to_string(rate));
+  };
+
+  // Reads the most recent observations and touches each one the way a printer would
+  auto shared = [this]() {
+    SequenceNumber_t first, end;
+    bool eob = false;
+    auto list {m_circularBuffer->getObservations(-1000, nullopt, nullopt, nullopt, end, first,
+                                                 eob)};
+    size_t count = 0;
+    for (auto &o : *list)
+      count += o->getSequence() > 0;
+    return count;
+  };
+
+  auto pinned = [this]() {
+    SequenceNumber_t first, end;
+    bool eob = false;
+    ObservationPointers pointers;
+    ObservationList archived;
+    auto guard = m_circularBuffer->pin();
+    m_circularBuffer->getObservations(pointers, archived, -1000, nullopt, nullopt, nullopt, end,
+                                      first, eob);
+    size_t count = 0;
+    for (auto o : pointers)
+      count += o->getSequence() > 0;
+    return count;
+  };
+
+  for (int readers : {1, 4, 8})
+  {
+    run("shared observation sample", readers, 500, shared);
+    run("pinned observation sample", readers, 500, pinned);
+  }
+}
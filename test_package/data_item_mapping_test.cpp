@@ -25,6 +25,7 @@
 #include "mtconnect/pipeline/pipeline_context.hpp"
 #include "mtconnect/pipeline/shdr_token_mapper.hpp"
 #include "mtconnect/pipeline/timestamp_extractor.hpp"
+#include "test_utilities.hpp"
 
 using namespace mtconnect;
 using namespace mtconnect::pipeline;
@@ -50,7 +51,11 @@ public:
   DevicePtr findDevice(const std::string &) override { return nullptr; }
   DataItemPtr findDataItem(const std::string &device, const std::string &name) override
   {
-    return m_dataItems[name];
+    m_lookups++;
+    auto it = m_dataItems.find(name);
+    if (it != m_dataItems.end())
+      return it->second;
+    return nullptr;
   }
   void eachDataItem(EachDataItem fun) override {}
   void deliverObservation(observation::ObservationPtr obs) override {}
@@ -64,9 +69,12 @@ public:
   void deliverConnectStatus(entity::EntityPtr, const StringList &, bool) override {}
   void sourceFailed(const std::string &id) override {}
   const ObservationPtr checkDuplicate(const ObservationPtr &obs) const override { return obs; }
+  uint64_t getDeviceModelVersion() const override { return m_deviceModelVersion; }
 
   std::map<string, DataItemPtr> &m_dataItems;
   int32_t m_schemaVersion;
+  uint64_t m_deviceModelVersion {0};
+  int m_lookups {0};
 };
 
 class DataItemMappingTest : public testing::Test
@@ -673,3 +681,72 @@ TEST_F(DataItemMappingTest, version_23_condition_behavior_with_only_condition_id
   ASSERT_EQ("HIGH", cond->get<string>("qualifier"));
   ASSERT_EQ("Fault", cond->getName());
 }
+
+TEST_F(DataItemMappingTest, should_cache_data_item_resolution_until_device_model_changes)
+{
+  auto *contract = dynamic_cast<MockPipelineContract *>(m_context->m_contract.get());
+  auto di = makeDataItem({{"id", "a"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+
+  auto observations = (*m_mapper)(makeTimestamped({"a", "READY"}));
+  ASSERT_EQ(1, observations->getValue<EntityList>().size());
+  ASSERT_EQ(1, contract->m_lookups);
+  ASSERT_EQ(1, m_mapper->getResolutionCacheSize());
+
+  observations = (*m_mapper)(makeTimestamped({"a", "ACTIVE"}));
+  ASSERT_EQ(1, observations->getValue<EntityList>().size());
+  ASSERT_EQ(1, contract->m_lookups);
+
+  // Replace the data item and change the model version
+  m_dataItems.clear();
+  auto di2 = makeDataItem({{"id", "a"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+  contract->m_deviceModelVersion++;
+
+  observations = (*m_mapper)(makeTimestamped({"a", "STOPPED"}));
+  auto oblist = observations->getValue<EntityList>();
+  ASSERT_EQ(1, oblist.size());
+  ASSERT_EQ(2, contract->m_lookups);
+
+  auto event = dynamic_pointer_cast<Event>(oblist.front());
+  ASSERT_TRUE(event);
+  ASSERT_EQ(di2, event->getDataItem());
+  ASSERT_EQ("STOPPED", event->getValue<string>());
+}
+
+TEST_F(DataItemMappingTest, should_resolve_device_qualified_keys)
+{
+  auto *contract = dynamic_cast<MockPipelineContract *>(m_context->m_contract.get());
+  auto di = makeDataItem({{"id", "a"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+
+  auto observations = (*m_mapper)(makeTimestamped({"dev:a", "READY", "a", "ACTIVE"}));
+  auto oblist = observations->getValue<EntityList>();
+  ASSERT_EQ(2, oblist.size());
+  ASSERT_EQ(2, contract->m_lookups);
+  ASSERT_EQ(2, m_mapper->getResolutionCacheSize());
+
+  for (auto &o : oblist)
+    ASSERT_EQ(di, dynamic_pointer_cast<Observation>(o)->getDataItem());
+}
+
+TEST_F(DataItemMappingTest, benchmark_data_item_resolution_with_2000_keys)
+{
+  constexpr int KeyCount = 2000;
+  TokenList tokens;
+  for (int i = 0; i < KeyCount; i++)
+  {
+    auto id = "di"s + to_string(i);
+    makeDataItem({{"id", id}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+    tokens.emplace_back(id);
+    tokens.emplace_back("READY");
+  }
+
+  auto *contract = dynamic_cast<MockPipelineContract *>(m_context->m_contract.get());
+  auto ts = makeTimestamped(tokens);
+
+  benchmark("shdr_resolution_2000_keys", 20, [&](size_t) {
+    auto observations = (*m_mapper)(ts);
+    ASSERT_EQ(KeyCount, observations->getValue<EntityList>().size());
+  });
+
+  ASSERT_EQ(KeyCount, contract->m_lookups);
+  ASSERT_EQ(KeyCount, m_mapper->getResolutionCacheSize());
+}
@@ -38,6 +38,7 @@
 #include <mruby/string.h>
 #include <mruby/variable.h>
 #include <string>
+#include <thread>
 
 #include "mtconnect/agent.hpp"
 #include "mtconnect/configuration/agent_config.hpp"
@@ -46,6 +47,7 @@
 #include "mtconnect/pipeline/shdr_tokenizer.hpp"
 #include "mtconnect/printer//xml_printer.hpp"
 #include "mtconnect/ruby/ruby_smart_ptr.hpp"
+#include "mtconnect/ruby/ruby_transform.hpp"
 #include "mtconnect/ruby/ruby_vm.hpp"
 #include "mtconnect/sink/rest_sink/rest_service.hpp"
 #include "mtconnect/source/adapter/shdr/shdr_adapter.hpp"
@@ -129,6 +131,39 @@ namespace {
       m_config->loadConfig(str);
     }
 
+    /// @brief load a module with one adapter per pipeline and several interpreters
+    void loadWithAdapters(AgentConfiguration &config, const char *file, int adapters,
+                          int interpreters)
+    {
+      string str("Devices = " TEST_RESOURCE_DIR "/samples/test_config.xml\n"
+                 "Adapters {\n");
+      for (int i = 0; i < adapters; i++)
+        str += "  a" + to_string(i) + " {\n    Device = LinuxCNC\n    Port = " +
+               to_string(7900 + i) + "\n  }\n";
+      str += "}\nRuby {\n  module = " TEST_RESOURCE_DIR "/ruby/" + string(file) +
+             "\n  Interpreters = " + to_string(interpreters) + "\n}\n";
+      config.loadConfig(str);
+    }
+
+    /// @brief get the ruby transforms named `name` in the adapter pipelines
+    std::vector<shared_ptr<RubyTransform>> rubyTransforms(AgentConfiguration &config,
+                                                          const string &name)
+    {
+      std::vector<shared_ptr<RubyTransform>> transforms;
+      for (auto &source : config.getAgent()->getSources())
+      {
+        if (!dynamic_pointer_cast<source::adapter::Adapter>(source))
+          continue;
+        for (auto &[prev, trans] : source->getPipeline()->find(name))
+        {
+          auto rt = dynamic_pointer_cast<RubyTransform>(trans);
+          if (rt)
+            transforms.emplace_back(rt);
+        }
+      }
+      return transforms;
+    }
+
     void TearDown() override
     {
       m_config.reset();
@@ -464,4 +499,322 @@ $source.pipeline.splice_after('Start', $trans)
     ASSERT_TRUE(di);
     ASSERT_EQ("000/Controller:Controller/Path/Events/ControllerMode:mode", di->getTopic());
   }
+
+  TEST_F(EmbeddedRubyTest, should_run_transforms_on_replica_interpreters)
+  {
+    loadWithAdapters(*m_config, "should_run_on_replicas.rb", 4, 4);
+
+    auto mrb = RubyVM::rubyVM().state();
+    ASSERT_NE(nullptr, mrb);
+    ASSERT_TRUE(mrb_test(mrb_gv_get(mrb, mrb_intern_lit(mrb, "$primary"))));
+
+    auto transforms = rubyTransforms(*m_config, "Passthrough");
+    ASSERT_EQ(4, transforms.size());
+    for (auto &trans : transforms)
+      ASSERT_EQ(3, trans->getReplicaCount());
+
+    auto di = m_config->getAgent()->getDataItemForDevice("LinuxCNC", "execution");
+    ASSERT_TRUE(di);
+
+    // Each thread is assigned an interpreter, all of them must forward to the primary pipeline
+    std::atomic<int> forwarded {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < 100; i++)
+        {
+          ErrorList errors;
+          auto obs = Observation::make(di, {{"VALUE", "READY"s}}, chrono::system_clock::now(),
+                                       errors);
+          auto res = (*transforms[t])(std::move(obs));
+          if (res)
+            forwarded++;
+        }
+      });
+    }
+    for (auto &th : threads)
+      th.join();
+
+    ASSERT_EQ(400, forwarded);
+    ASSERT_EQ("READY", m_config->getAgent()->getLatest(di)->getValue<string>());
+  }
+
+  TEST_F(EmbeddedRubyTest, should_only_use_the_primary_when_replicas_splice_differently)
+  {
+    loadWithAdapters(*m_config, "should_not_bind_diverging_replicas.rb", 4, 4);
+
+    auto transforms = rubyTransforms(*m_config, "Passthrough");
+    ASSERT_EQ(4, transforms.size());
+    for (auto &trans : transforms)
+      ASSERT_EQ(0, trans->getReplicaCount());
+    ASSERT_EQ(4, rubyTransforms(*m_config, "Primary").size());
+
+    auto di = m_config->getAgent()->getDataItemForDevice("LinuxCNC", "execution");
+    ASSERT_TRUE(di);
+
+    ErrorList errors;
+    auto obs = Observation::make(di, {{"VALUE", "READY"s}}, chrono::system_clock::now(), errors);
+    ASSERT_TRUE((*transforms[0])(std::move(obs)));
+    ASSERT_EQ("READY", m_config->getAgent()->getLatest(di)->getValue<string>());
+  }
+
+  TEST_F(EmbeddedRubyTest, benchmark_trivial_transform_across_8_adapters)
+  {
+    using namespace std::chrono;
+
+    constexpr int Adapters = 8;
+    constexpr int Iterations = 20000;
+
+    for (auto interpreters : {1, Adapters})
+    {
+      auto config = std::make_unique<AgentConfiguration>();
+      loadWithAdapters(*config, "should_run_on_replicas.rb", Adapters, interpreters);
+
+      auto transforms = rubyTransforms(*config, "Passthrough");
+      ASSERT_EQ(Adapters, transforms.size());
+      auto di = config->getAgent()->getDataItemForDevice("LinuxCNC", "execution");
+      ASSERT_TRUE(di);
+
+      std::vector<std::thread> threads;
+      auto start = steady_clock::now();
+      for (int t = 0; t < Adapters; t++)
+      {
+        threads.emplace_back([&, t]() {
+          for (int i = 0; i < Iterations; i++)
+          {
+            ErrorList errors;
+            auto obs = Observation::make(di, {{"VALUE", (i % 2) ? "READY"s : "ACTIVE"s}},
+                                         system_clock::now(), errors);
+            (*transforms[t])(std::move(obs));
+          }
+        });
+      }
+      for (auto &th : threads)
+        th.join();
+      auto elapsed = duration_cast<microseconds>(steady_clock::now() - start);
+
+      auto total = double(Adapters) * Iterations;
+      cout << "[ BENCH    ] Ruby transform, " << Adapters << " adapters, " << interpreters
+           << " interpreters: " << (total / (elapsed.count() / 1e6)) << " observations/s"
+           << endl;
+      RecordProperty("interpreters_" + to_string(interpreters) + "_us",
+                     to_string(elapsed.count()));
+
+      config.reset();
+    }
+  }
+
+  TEST_F(EmbeddedRubyTest, should_transform_observations_in_batches)
+  {
+    load("should_batch_transform.rb");
+
+    auto mrb = RubyVM::rubyVM().state();
+    ASSERT_NE(nullptr, mrb);
+
+    auto trans = MRubySharedPtr<Transform>::unwrap<RubyBatchTransform>(
+        mrb, mrb_gv_get(mrb, mrb_intern_lit(mrb, "$batch")));
+    ASSERT_TRUE(trans);
+
+    auto di = m_config->getAgent()->getDataItemForDevice("LinuxCNC", "Xact");
+    ASSERT_TRUE(di);
+
+    auto now = chrono::system_clock::now();
+    for (auto v : {1.0, 2.0, 3.0})
+    {
+      ErrorList errors;
+      auto obs = Observation::make(di, {{"VALUE", v}}, now, errors);
+      ASSERT_FALSE((*trans)(std::move(obs)));
+    }
+
+    auto marker = make_shared<Observations>("Observations", Properties {});
+    marker->setValue(EntityList {});
+    auto res = (*trans)(marker);
+    ASSERT_EQ(marker, res);
+
+    auto &list = marker->getValue<EntityList>();
+    ASSERT_EQ(3, list.size());
+    auto it = list.begin();
+    for (auto v : {2.0, 4.0, 6.0})
+    {
+      ASSERT_EQ(v, (*it++)->getValue<double>());
+    }
+  }
+
+  TEST_F(EmbeddedRubyTest, batch_should_keep_the_results_of_a_full_batch_for_the_marker)
+  {
+    load("should_batch_transform.rb");
+
+    auto mrb = RubyVM::rubyVM().state();
+    auto trans = MRubySharedPtr<Transform>::unwrap<RubyBatchTransform>(
+        mrb, mrb_gv_get(mrb, mrb_intern_lit(mrb, "$batch")));
+    ASSERT_TRUE(trans);
+
+    auto di = m_config->getAgent()->getDataItemForDevice("LinuxCNC", "Xact");
+    ASSERT_TRUE(di);
+
+    auto now = chrono::system_clock::now();
+    auto count = RubyBatchTransform::MaxBatchSize + 2;
+    for (size_t i = 0; i < count; i++)
+    {
+      ErrorList errors;
+      auto obs = Observation::make(di, {{"VALUE", double(i)}}, now, errors);
+      ASSERT_FALSE((*trans)(std::move(obs)));
+    }
+
+    auto marker = make_shared<Observations>("Observations", Properties {});
+    marker->setValue(EntityList {});
+    ASSERT_EQ(marker, (*trans)(marker));
+
+    auto &list = marker->getValue<EntityList>();
+    ASSERT_EQ(count, list.size());
+    ASSERT_EQ(2.0, list.front()->getValue<double>());
+    ASSERT_EQ(double(count - 1) * 2.0, list.back()->getValue<double>());
+  }
+
+  TEST_F(EmbeddedRubyTest, batch_should_keep_the_entities_of_each_thread_apart)
+  {
+    load("should_batch_transform.rb");
+
+    auto mrb = RubyVM::rubyVM().state();
+    auto trans = MRubySharedPtr<Transform>::unwrap<RubyBatchTransform>(
+        mrb, mrb_gv_get(mrb, mrb_intern_lit(mrb, "$batch")));
+    ASSERT_TRUE(trans);
+
+    auto di = m_config->getAgent()->getDataItemForDevice("LinuxCNC", "Xact");
+    ASSERT_TRUE(di);
+
+    auto now = chrono::system_clock::now();
+    auto send = [&](double value) {
+      ErrorList errors;
+      return (*trans)(Observation::make(di, {{"VALUE", value}}, now, errors));
+    };
+    auto end = [&]() {
+      auto marker = make_shared<Observations>("Observations", Properties {});
+      marker->setValue(EntityList {});
+      (*trans)(marker);
+      return marker->getValue<EntityList>();
+    };
+
+    // Another pipeline is half way through a line on another thread
+    thread other([&]() { send(10.0); });
+    other.join();
+
+    send(1.0);
+    auto list = end();
+    ASSERT_EQ(1, list.size());
+    ASSERT_EQ(2.0, list.front()->getValue<double>());
+
+    EntityList otherList;
+    thread finish([&]() { otherList = end(); });
+    finish.join();
+    ASSERT_EQ(1, otherList.size());
+    ASSERT_EQ(20.0, otherList.front()->getValue<double>());
+  }
+
+  TEST_F(EmbeddedRubyTest, batch_should_pack_numeric_values)
+  {
+    load("should_batch_transform.rb");
+
+    auto mrb = RubyVM::rubyVM().state();
+    auto trans = MRubySharedPtr<Transform>::unwrap<RubyBatchTransform>(
+        mrb, mrb_gv_get(mrb, mrb_intern_lit(mrb, "$numbers")));
+    ASSERT_TRUE(trans);
+
+    auto di = m_config->getAgent()->getDataItemForDevice("LinuxCNC", "Xact");
+    ASSERT_TRUE(di);
+
+    auto now = chrono::system_clock::now();
+    for (auto v : {1.0, 2.5, -3.0})
+    {
+      ErrorList errors;
+      (*trans)(Observation::make(di, {{"VALUE", v}}, now, errors));
+    }
+
+    auto forwarded = trans->flush();
+    ASSERT_EQ(3, forwarded.size());
+    auto it = forwarded.begin();
+    for (auto v : {2.0, 5.0, -6.0})
+    {
+      ASSERT_EQ(v, (*it++)->getValue<double>());
+    }
+  }
+
+  TEST_F(EmbeddedRubyTest, batch_should_expose_data_items_and_drop_entities)
+  {
+    load("should_batch_transform.rb");
+
+    auto mrb = RubyVM::rubyVM().state();
+    auto trans = MRubySharedPtr<Transform>::unwrap<RubyBatchTransform>(
+        mrb, mrb_gv_get(mrb, mrb_intern_lit(mrb, "$ids")));
+    ASSERT_TRUE(trans);
+
+    auto now = chrono::system_clock::now();
+    for (auto name : {"Xact", "Yact", "Zact"})
+    {
+      auto di = m_config->getAgent()->getDataItemForDevice("LinuxCNC", name);
+      ASSERT_TRUE(di) << name;
+      ErrorList errors;
+      (*trans)(Observation::make(di, {{"VALUE", 1.0}}, now, errors));
+    }
+
+    auto forwarded = trans->flush();
+    ASSERT_EQ(2, forwarded.size());
+
+    mrb_value seen = mrb_gv_get(mrb, mrb_intern_lit(mrb, "$seen"));
+    ASSERT_TRUE(mrb_array_p(seen));
+    ASSERT_EQ(3, RARRAY_LEN(seen));
+  }
+
+  TEST_F(EmbeddedRubyTest, benchmark_batched_transform)
+  {
+    using namespace std::chrono;
+
+    load("should_batch_transform.rb");
+
+    auto mrb = RubyVM::rubyVM().state();
+    auto single = MRubySharedPtr<Transform>::unwrap<RubyTransform>(
+        mrb, mrb_gv_get(mrb, mrb_intern_lit(mrb, "$scale")));
+    auto batch = MRubySharedPtr<Transform>::unwrap<RubyBatchTransform>(
+        mrb, mrb_gv_get(mrb, mrb_intern_lit(mrb, "$batch")));
+    ASSERT_TRUE(single);
+    ASSERT_TRUE(batch);
+
+    auto di = m_config->getAgent()->getDataItemForDevice("LinuxCNC", "Xact");
+    ASSERT_TRUE(di);
+
+    // Lines of 20 observations, as a high rate adapter would send
+    constexpr int Lines = 5000;
+    constexpr int PerLine = 20;
+    auto now = system_clock::now();
+
+    auto run = [&](auto &&f) {
+      auto start = steady_clock::now();
+      for (int l = 0; l < Lines; l++)
+      {
+        for (int i = 0; i < PerLine; i++)
+        {
+          ErrorList errors;
+          f(Observation::make(di, {{"VALUE", double(i)}}, now, errors));
+        }
+        f(make_shared<Observations>("Observations", Properties {}));
+      }
+      return duration_cast<microseconds>(steady_clock::now() - start).count();
+    };
+
+    auto singleTime = run([&](EntityPtr &&e) {
+      if (dynamic_pointer_cast<Observations>(e))
+        return;
+      (*single)(std::move(e));
+    });
+    auto batchTime = run([&](EntityPtr &&e) { (*batch)(std::move(e)); });
+
+    auto total = double(Lines) * PerLine;
+    cout << "[ BENCH    ] Ruby transform per entity: " << (total / (singleTime / 1e6))
+         << " observations/s" << endl;
+    cout << "[ BENCH    ] Ruby transform batched by line: " << (total / (batchTime / 1e6))
+         << " observations/s" << endl;
+    RecordProperty("single_us", to_string(singleTime));
+    RecordProperty("batch_us", to_string(batchTime));
+  }
 }  // namespace
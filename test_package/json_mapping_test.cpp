@@ -29,6 +29,8 @@
 #include "mtconnect/observation/observation.hpp"
 #include "mtconnect/pipeline/json_mapper.hpp"
 #include "mtconnect/pipeline/pipeline_context.hpp"
+#include "mtconnect/pipeline/shdr_token_mapper.hpp"
+#include "test_utilities.hpp"
 
 using namespace mtconnect;
 using namespace mtconnect::pipeline;
@@ -159,6 +161,9 @@ TEST_F(JsonMappingTest, should_parse_simple_observations)
   auto res = (*m_mapper)(std::move(msg));
   ASSERT_TRUE(res);
 
+  // The message ends like an SHDR line
+  ASSERT_TRUE(dynamic_pointer_cast<Observations>(res));
+
   auto value = res->getValue();
   ASSERT_TRUE(std::holds_alternative<EntityList>(value));
   auto list = get<EntityList>(value);
@@ -1223,3 +1228,108 @@ TEST_F(JsonMappingTest, should_ignore_Invalid_make_DataItem)
 
 /// @test verify the json mapper can an asset in json
 TEST_F(JsonMappingTest, should_parse_json_asset) { GTEST_SKIP(); }
+
+/// @test verify keys are resolved once per device and reused for later messages
+TEST_F(JsonMappingTest, should_cache_key_resolution)
+{
+  auto dev1 =
+      makeDevice("Device", {{"id", "device1"s}, {"name", "device1"s}, {"uuid", "device1"s}});
+  makeDevice("Device", {{"id", "device2"s}, {"name", "device2"s}, {"uuid", "device2"s}});
+  makeDataItem("device1", {{"id", "a"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+  makeDataItem("device2", {{"id", "b"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+
+  auto body = R"(
+{
+  "timestamp": "2023-11-09T11:20:00Z",
+  "a": "ACTIVE",
+  "c": "UNKNOWN",
+  "device2": {
+    "b": "READY"
+  }
+})"s;
+
+  for (int i = 0; i < 2; i++)
+  {
+    auto jmsg = std::make_shared<JsonMessage>("JsonMessage", Properties {{"VALUE", body}});
+    jmsg->m_device = dev1;
+
+    auto res = (*m_mapper)(std::move(jmsg));
+    ASSERT_TRUE(res);
+
+    auto list = res->getValue<EntityList>();
+    ASSERT_EQ(2, list.size());
+
+    auto obs = dynamic_pointer_cast<Observation>(list.front());
+    ASSERT_EQ("a", obs->getDataItem()->getId());
+    ASSERT_EQ("ACTIVE", obs->getValue<string>());
+
+    obs = dynamic_pointer_cast<Observation>(list.back());
+    ASSERT_EQ("b", obs->getDataItem()->getId());
+    ASSERT_EQ("READY", obs->getValue<string>());
+
+    // a and device2 for device1, b for device2. c is not cached.
+    ASSERT_EQ(3, m_mapper->getResolutionCacheSize());
+  }
+}
+
+/// @test verify escaped strings are decoded when the message is parsed in place
+TEST_F(JsonMappingTest, should_decode_escaped_strings_in_place)
+{
+  auto dev = makeDevice("Device", {{"id", "device"s}, {"name", "device"s}, {"uuid", "device"s}});
+  makeDataItem("device", {{"id", "a"s}, {"type", "PROGRAM"s}, {"category", "EVENT"s}});
+  makeDataItem("device", {{"id", "b"s}, {"type", "BLOCK"s}, {"category", "EVENT"s}});
+
+  Properties props {{"VALUE", R"(
+{
+  "timestamp": "2023-11-09T11:20:00Z",
+  "a": "O\u00e9 \"main\"",
+  "b": "G01 X1.0\tY2.0"
+})"s}};
+
+  auto jmsg = std::make_shared<JsonMessage>("JsonMessage", props);
+  jmsg->m_device = dev;
+
+  auto res = (*m_mapper)(std::move(jmsg));
+  ASSERT_TRUE(res);
+
+  auto list = res->getValue<EntityList>();
+  ASSERT_EQ(2, list.size());
+
+  auto obs = dynamic_pointer_cast<Observation>(list.front());
+  ASSERT_EQ("O\xc3\xa9 \"main\"", obs->getValue<string>());
+  obs = dynamic_pointer_cast<Observation>(list.back());
+  ASSERT_EQ("G01 X1.0\tY2.0", obs->getValue<string>());
+}
+
+TEST_F(JsonMappingTest, benchmark_json_ingest_throughput)
+{
+  constexpr int KeyCount = 50;
+  constexpr size_t Iterations = 2000;
+
+  auto dev = makeDevice("Device", {{"id", "device"s}, {"name", "device"s}, {"uuid", "device"s}});
+
+  ostringstream str;
+  str << R"({"timestamp": "2023-11-09T11:20:00.123456Z")";
+  for (int i = 0; i < KeyCount; i++)
+  {
+    auto id = to_string(i);
+    makeDataItem("device", {{"id", "pos"s + id}, {"type", "POSITION"s}, {"category", "SAMPLE"s}});
+    makeDataItem("device", {{"id", "exec"s + id}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+    str << R"(, "pos)" << id << R"(": )" << (i * 1.125 + 0.001);
+    str << R"(, "exec)" << id << R"(": {"value": "ACTIVE"})";
+  }
+  str << "}";
+  auto body = str.str();
+
+  auto perMessage = benchmark("json_ingest_100_observations", Iterations, [&](size_t) {
+    // Each message owns its own copy of the body like a message from the broker
+    auto jmsg = std::make_shared<JsonMessage>("JsonMessage", Properties {{"VALUE", body}});
+    jmsg->m_device = dev;
+    auto res = (*m_mapper)(std::move(jmsg));
+    ASSERT_EQ(KeyCount * 2, res->getValue<EntityList>().size());
+  });
+
+  cout << "[ BENCH    ] json ingest: " << body.size() << " bytes per message, "
+       << (double(body.size()) * 1000.0 / perMessage) << " MB/s" << endl;
+  ASSERT_EQ(KeyCount * 2, m_mapper->getResolutionCacheSize());
+}
@@ -535,3 +535,46 @@ TEST_F(ObservationTest, should_represent_negative_inf_values_in_json_correctly)
       R"DOC({"Temperature":{"dataItemId":"x","timestamp":"2021-01-19T10:01:00Z","value":"-Infinity"}})DOC",
       buffer.str());
 }
+
+TEST_F(ObservationTest, should_orphan_observations_when_the_data_item_is_removed)
+{
+  ErrorList errors;
+  auto dataItem = DataItem::make({{"id", "x"s}, {"type", "PROGRAM"s}, {"category", "EVENT"s}},
+                                 errors);
+  auto obs = Observation::make(dataItem, {{"VALUE", "Test"s}}, m_time, errors);
+  ASSERT_EQ(dataItem.get(), obs->getDataItemPointer());
+  ASSERT_EQ(dataItem, obs->getDataItem());
+  ASSERT_FALSE(obs->isOrphan());
+
+  auto key = dataItem->getRegistryKey();
+  dataItem.reset();
+  ASSERT_TRUE(obs->isOrphan());
+  ASSERT_FALSE(obs->getDataItem());
+
+  // The slot is reused with a new generation
+  auto other = DataItem::make({{"id", "y"s}, {"type", "PROGRAM"s}, {"category", "EVENT"s}},
+                              errors);
+  ASSERT_EQ(key.m_ordinal, other->getRegistryKey().m_ordinal);
+  ASSERT_NE(key.m_generation, other->getRegistryKey().m_generation);
+  ASSERT_TRUE(obs->isOrphan());
+  ASSERT_EQ(nullptr, obs->getDataItemPointer());
+}
+
+TEST_F(ObservationTest, should_reference_the_data_item_that_replaces_the_original)
+{
+  ErrorList errors;
+  Properties props {{"id", "x"s}, {"type", "PROGRAM"s}, {"category", "EVENT"s}};
+  auto original = DataItem::make(props, errors);
+  auto obs = Observation::make(original, {{"VALUE", "Test"s}}, m_time, errors);
+
+  auto replacement = DataItem::make(props, errors);
+  replacement->replace(*original);
+  ASSERT_EQ(replacement, obs->getDataItem());
+
+  original.reset();
+  ASSERT_FALSE(obs->isOrphan());
+  ASSERT_EQ(replacement, obs->getDataItem());
+
+  replacement.reset();
+  ASSERT_TRUE(obs->isOrphan());
+}
@@ -32,6 +32,7 @@
 #include "mtconnect/pipeline/shdr_token_mapper.hpp"
 #include "mtconnect/pipeline/timestamp_extractor.hpp"
 #include "mtconnect/pipeline/validator.hpp"
+#include "test_utilities.hpp"
 
 using namespace mtconnect;
 using namespace mtconnect::pipeline;
@@ -432,3 +433,133 @@ TEST_F(ObservationValidationTest, should_validate_sample_double_value)
   auto quality = evt->get<string>("quality");
   ASSERT_EQ("VALID", quality);
 }
+
+/// @test the compiled vocabularies have every value of the controlled vocabularies
+TEST_F(ObservationValidationTest, compiled_vocabularies_should_match_controlled_vocabularies)
+{
+  using namespace mtconnect::validation::observations;
+
+  auto &compiled = GetCompiledVocabularies();
+  ASSERT_EQ(ControlledVocabularies.size(), compiled.size());
+  ASSERT_LE(compiled.slots(), compiled.size() * 13 / 10 + 1);
+  for (auto &[name, values] : ControlledVocabularies)
+  {
+    auto ordinal = compiled.index(name);
+    ASSERT_TRUE(ordinal) << name;
+    ASSERT_LT(*ordinal, compiled.slots()) << name;
+    auto lits = compiled.find(name);
+    ASSERT_EQ(&compiled.at(*ordinal), lits) << name;
+    ASSERT_EQ(values.size(), lits->size()) << name;
+    for (auto &[value, versions] : values)
+    {
+      auto lit = lits->find(value);
+      ASSERT_TRUE(lit) << name << ": " << value;
+      ASSERT_EQ(versions, *lit) << name << ": " << value;
+    }
+    ASSERT_FALSE(lits->find("NOT_A_VALUE"));
+    ASSERT_FALSE(lits->find(""));
+  }
+  ASSERT_FALSE(compiled.find("NotAnEvent"));
+  ASSERT_FALSE(compiled.index("NotAnEvent"));
+
+  ASSERT_EQ(compiled.index("Execution"), m_dataItem->getVocabulary());
+  ErrorList errors;
+  auto sample = DataItem::make(
+      {{"id", "pos"s}, {"category", "SAMPLE"s}, {"type", "POSITION"s}, {"units", "MILLIMETER"s}},
+      errors);
+  ASSERT_FALSE(sample->getVocabulary());
+}
+
+/// @test event types added to the controlled vocabularies at runtime are validated
+TEST_F(ObservationValidationTest, should_validate_event_types_added_at_runtime)
+{
+  using namespace mtconnect::validation::observations;
+
+  ErrorList errors;
+  m_dataItem =
+      DataItem::make({{"id", "flabor"s}, {"category", "EVENT"s}, {"type", "x:FLABOR"s}}, errors);
+
+  auto event = Observation::make(m_dataItem, {{"VALUE", "GOOD"s}}, m_time, errors);
+  string name = event->getName();
+  ControlledVocabularies[name] = {{"GOOD", {SCHEMA_VERSION(2, 0), 0}}};
+
+  auto evt = (*m_validator)(std::move(event));
+  ASSERT_EQ("VALID", evt->get<string>("quality"));
+
+  event = Observation::make(m_dataItem, {{"VALUE", "BAD"s}}, m_time, errors);
+  evt = (*m_validator)(std::move(event));
+  ASSERT_EQ("INVALID", evt->get<string>("quality"));
+
+  ControlledVocabularies.erase(name);
+}
+
+TEST_F(ObservationValidationTest, benchmark_validation_ingest_overhead)
+{
+  constexpr size_t TokenCount = 100;
+  constexpr size_t Iterations = 500;
+  static const vector<string> values {"READY", "ACTIVE", "INTERRUPTED", "STOPPED",
+                                      "FEED_HOLD"};
+
+  auto contract = static_cast<MockPipelineContract *>(m_context->m_contract.get());
+
+  auto ts = make_shared<Timestamped>();
+  for (size_t i = 0; i < TokenCount; i++)
+  {
+    ts->m_tokens.emplace_back("exec");
+    ts->m_tokens.emplace_back(values[i % values.size()]);
+  }
+  ts->m_timestamp = chrono::system_clock::now();
+  ts->setProperty("timestamp", ts->m_timestamp);
+
+  auto run = [&](const string &name, TransformPtr next) {
+    auto mapper = make_shared<ShdrTokenMapper>(m_context, "", 2);
+    mapper->bind(next);
+    return benchmark(name, Iterations, [&](size_t) {
+      auto observations = (*mapper)(ts);
+      ASSERT_EQ(TokenCount, observations->getValue<EntityList>().size());
+    });
+  };
+
+  contract->m_validation = false;
+  auto off =
+      run("shdr_100_events_validation_off", make_shared<NullTransform>(TypeGuard<Entity>(RUN)));
+  contract->m_validation = true;
+  auto on = run("shdr_100_events_validation_on", m_validator);
+
+  cout << "[ BENCH    ] validation overhead: " << ((on - off) * 100.0 / off) << "%, "
+       << ((on - off) / double(TokenCount)) << " ns/event" << endl;
+}
+
+TEST_F(ObservationValidationTest, benchmark_vocabulary_lookup)
+{
+  using namespace mtconnect::validation::observations;
+
+  // The ordinal is resolved once per data item, so only the value is hashed per observation
+  auto &compiled = GetCompiledVocabularies();
+  vector<tuple<string, size_t, string>> keys;
+  for (auto &[name, values] : ControlledVocabularies)
+  {
+    for (auto &[value, versions] : values)
+      keys.emplace_back(name, *compiled.index(name), value);
+  }
+
+  size_t found = 0;
+  auto hashed = benchmark("vocabulary_unordered_map", 200, [&](size_t) {
+    for (auto &[name, ordinal, value] : keys)
+    {
+      auto vocab = ControlledVocabularies.find(name);
+      found += vocab->second.count(value);
+    }
+  });
+  auto perfect = benchmark("vocabulary_perfect_hash", 200, [&](size_t) {
+    for (auto &[name, ordinal, value] : keys)
+    {
+      if (compiled.at(ordinal).find(value))
+        found++;
+    }
+  });
+
+  cout << "[ BENCH    ] " << keys.size() << " values, perfect hash speedup " << (hashed / perfect)
+       << "x" << endl;
+  ASSERT_EQ(keys.size() * 400, found);
+}
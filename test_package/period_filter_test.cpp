@@ -20,6 +20,7 @@
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
 #include <chrono>
+#include <thread>
 
 #include "mtconnect/observation/observation.hpp"
 #include "mtconnect/pipeline/deliver.hpp"
@@ -28,6 +29,7 @@
 #include "mtconnect/pipeline/period_filter.hpp"
 #include "mtconnect/pipeline/pipeline.hpp"
 #include "mtconnect/pipeline/shdr_token_mapper.hpp"
+#include "mtconnect/pipeline/timing_wheel.hpp"
 
 using namespace mtconnect;
 using namespace mtconnect::pipeline;
@@ -126,14 +128,15 @@ protected:
     return (*m_mapper)(ts);
   }
 
-  void createDataItem()
+  void createDataItem(const string &id = "a"s, double period = 1.0)
   {
     ErrorList errors;
-    auto f = Filter::getFactory()->create("Filter", {{"type", "PERIOD"s}, {"VALUE", 1.0}}, errors);
+    auto f =
+        Filter::getFactory()->create("Filter", {{"type", "PERIOD"s}, {"VALUE", period}}, errors);
     EntityList list {f};
     auto filters = DataItem::getFactory()->factoryFor("DataItem")->create("Filters", list, errors);
 
-    makeDataItem({{"id", "a"s},
+    makeDataItem({{"id", id},
                   {"type", "POSITION"s},
                   {"category", "SAMPLE"s},
                   {"units", "MILLIMETER"s},
@@ -721,3 +724,110 @@ TEST_F(PeriodFilterTest, unavailable_behavior)
   ASSERT_TRUE(obs[2]->isUnavailable());
   ASSERT_EQ(2.0, obs[3]->getValue<double>());
 }
+
+TEST_F(PeriodFilterTest, timing_wheel_should_expire_deadlines_in_order)
+{
+  vector<pair<string, uint64_t>> expired;
+  TimingWheel wheel(m_strand, [&expired](const string &key, uint64_t token) {
+    expired.emplace_back(key, token);
+  });
+
+  auto now = chrono::system_clock::now();
+  auto c = wheel.schedule("c", now + 30ms);
+  auto a = wheel.schedule("a", now + 5ms);
+  auto b = wheel.schedule("b", now + 15ms);
+  auto late = wheel.schedule("late", now + 2s);
+  ASSERT_EQ(4, wheel.size());
+  ASSERT_NE(a, b);
+
+  m_ioContext.run_for(100ms);
+  ASSERT_EQ(1, wheel.size());
+  ASSERT_EQ(3, expired.size());
+  ASSERT_EQ(make_pair("a"s, a), expired[0]);
+  ASSERT_EQ(make_pair("b"s, b), expired[1]);
+  ASSERT_EQ(make_pair("c"s, c), expired[2]);
+
+  // A deadline in the past expires on the next tick
+  auto past = wheel.schedule("past", now - 1s);
+  m_ioContext.run_for(20ms);
+  ASSERT_EQ(4, expired.size());
+  ASSERT_EQ(make_pair("past"s, past), expired[3]);
+
+  m_ioContext.run_for(2s);
+  ASSERT_EQ(0, wheel.size());
+  ASSERT_EQ(make_pair("late"s, late), expired.back());
+  ASSERT_LE(now + 2s, chrono::system_clock::now());
+}
+
+TEST_F(PeriodFilterTest, timing_wheel_should_accept_deadlines_from_other_threads)
+{
+  constexpr int Threads = 4;
+  constexpr int PerThread = 500;
+
+  atomic_int count {0};
+  TimingWheel wheel(m_strand, [&count](const string &, uint64_t) { count++; });
+
+  // Run the wheel on its own thread while other threads schedule deadlines
+  thread runner([this] { m_ioContext.run_for(500ms); });
+  vector<thread> schedulers;
+  for (int i = 0; i < Threads; i++)
+  {
+    schedulers.emplace_back([&wheel, i] {
+      for (int j = 0; j < PerThread; j++)
+      {
+        auto deadline = chrono::system_clock::now() + chrono::milliseconds(j % 20);
+        wheel.schedule("t" + to_string(i), deadline);
+      }
+    });
+  }
+  for (auto &t : schedulers)
+    t.join();
+  runner.join();
+
+  ASSERT_EQ(Threads * PerThread, count);
+  ASSERT_EQ(0, wheel.size());
+}
+
+TEST_F(PeriodFilterTest, benchmark_period_filter_10k_data_items_at_100hz)
+{
+  constexpr int Items = 10000;
+  constexpr int Rounds = 20;
+
+  vector<string> ids;
+  for (int i = 0; i < Items; i++)
+  {
+    ids.emplace_back("p" + to_string(i));
+    createDataItem(ids.back(), 0.05);
+  }
+  makeFilter();
+
+  // Send each data item at 100Hz with a period of 50ms, so most observations are delayed
+  // and most delayed sends are replaced before they expire. The timing wheel delivers the
+  // expired sends between rounds.
+  chrono::nanoseconds elapsed {0};
+  for (int round = 0; round < Rounds; round++)
+  {
+    auto roundStart = chrono::steady_clock::now();
+    auto ts = chrono::system_clock::now();
+    for (auto &id : ids)
+      observe({id, to_string(round + 1)}, ts);
+    elapsed += chrono::steady_clock::now() - roundStart;
+
+    m_ioContext.poll();
+    m_ioContext.run_until(roundStart + 10ms);
+  }
+
+  auto perObservation = double(elapsed.count()) / double(Items * Rounds);
+  cout << "[ BENCH    ] period_filter_10k_items_100hz: " << Items * Rounds << " observations, "
+       << perObservation << " ns/observation" << endl;
+  RecordProperty("period_filter_10k_items_100hz", to_string(perObservation));
+
+  // Let the delayed sends expire and make sure the last value for every item was delivered
+  m_ioContext.run_for(500ms);
+  map<string, double> last;
+  for (auto &o : observations())
+    last[o->getDataItem()->getId()] = o->getValue<double>();
+  ASSERT_EQ(Items, last.size());
+  for (auto &[id, value] : last)
+    ASSERT_EQ(double(Rounds), value) << id;
+}
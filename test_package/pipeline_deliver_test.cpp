@@ -20,6 +20,7 @@
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
 #include <chrono>
+#include <thread>
 
 #include "agent_test_helper.hpp"
 #include "mtconnect/observation/observation.hpp"
@@ -59,6 +60,71 @@ protected:
 
   void TearDown() override { m_agentTestHelper.reset(); }
 
+  /// @brief Ingest from stand-in adapters, each sending its own data item like separate
+  /// machines, on 1..N threads
+  /// @param name the benchmark name
+  /// @param options the adapter options
+  /// @param repeat the number of times each value is sent
+  void parallelIngest(const string &name, ConfigOptions options, size_t repeat)
+  {
+    using namespace std::chrono;
+
+    const vector<string> ids {"dcbc0570", "f646f730", "ac6b69c0", "vee9c2d0",
+                              "r1841b70", "e25c1130", "qb9212c0", "o63fcd30"};
+    vector<shared_ptr<shdr::ShdrAdapter>> adapters;
+    for (size_t i = 0; i < ids.size(); i++)
+      adapters.emplace_back(
+          m_agentTestHelper->addAdapter(options, "localhost", uint16_t(7878 + i)));
+
+    constexpr size_t Lines = 4000;
+    vector<vector<string>> lines(ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+      for (size_t j = 0; j < Lines; j++)
+        lines[i].emplace_back("2021-01-22T12:33:45.123Z|" + ids[i] + "|" +
+                              to_string(j / repeat + 1));
+
+    auto &circ = m_agentTestHelper->getAgent()->getCircularBuffer();
+    const size_t maxThreads = std::clamp<size_t>(thread::hardware_concurrency(), 1, 8);
+    const size_t expected = ids.size() * ((Lines + repeat - 1) / repeat);
+
+    double base = 0.0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+      auto seq = circ.getSequence();
+      auto start = steady_clock::now();
+
+      // A source is only ever run by one thread at a time, the same as its strand
+      vector<thread> workers;
+      for (size_t t = 0; t < threads; t++)
+        workers.emplace_back([&, t]() {
+          for (size_t i = t; i < adapters.size(); i += threads)
+            for (auto &line : lines[i])
+              adapters[i]->processData(line);
+        });
+      for (auto &w : workers)
+        w.join();
+
+      auto elapsed = duration<double>(steady_clock::now() - start).count();
+      ASSERT_EQ(seq + expected, circ.getSequence());
+
+      // Observations for each data item are delivered in order
+      for (auto &id : ids)
+      {
+        auto latest = circ.getLatest().getObservation(id);
+        ASSERT_TRUE(latest);
+        ASSERT_EQ(double((Lines - 1) / repeat + 1), latest->getValue<double>());
+      }
+
+      auto rate = double(ids.size() * Lines) / elapsed;
+      if (threads == 1)
+        base = rate;
+      auto label = name + "_"s + to_string(threads) + "_threads";
+      cout << "[ BENCH    ] " << label << ": " << rate << " lines/second, " << rate / base
+           << "x speedup" << endl;
+      RecordProperty(label, to_string(rate));
+    }
+  }
+
   std::unique_ptr<AgentTestHelper> m_agentTestHelper;
   std::string m_agentId;
   DevicePtr m_device {nullptr};
@@ -121,3 +187,78 @@ TEST_F(PipelineDeliverTest, filter_upcase)
   auto obs2 = circ.getFromBuffer(seq + 1);
   ASSERT_EQ(101.0, obs2->getValue<double>());
 }
+
+TEST_F(PipelineDeliverTest, should_record_transform_metrics_when_enabled)
+{
+  ConfigOptions options {{configuration::PipelineMetrics, true}};
+  auto adapter = m_agentTestHelper->addAdapter(options);
+  auto pipeline = adapter->getPipeline();
+  ASSERT_TRUE(pipeline->hasTransformMetrics());
+  pipeline->start();
+
+  for (int i = 0; i < 10; i++)
+    adapter->processData("2021-01-22T12:33:45.123Z|Xpos|" + to_string(100 + i));
+
+  map<string, TransformMetricsPtr> metrics;
+  for (auto &m : pipeline->getTransformMetrics())
+    metrics.emplace(m->getName(), m);
+
+  ASSERT_EQ(1, metrics.count("ShdrTokenizer"));
+  ASSERT_EQ(10, metrics["ShdrTokenizer"]->getCount());
+  ASSERT_EQ(1, metrics.count("DeliverObservation"));
+  ASSERT_EQ(10, metrics["DeliverObservation"]->getCount());
+
+  auto agent = m_agentTestHelper->getAgent();
+  auto latency = agent->getDataItemById(adapter->getIdentity() + "_pipeline_latency");
+  ASSERT_TRUE(latency);
+  ASSERT_TRUE(latency->isDataSet());
+  ASSERT_EQ("x"s, string(latency->getObservationName().getNs()));
+  ASSERT_TRUE(agent->getDataItemById(adapter->getIdentity() + "_pipeline_throughput"));
+
+  {
+    PARSE_JSON_RESPONSE("/pipeline/metrics");
+    auto pipelines = doc["pipelines"];
+    ASSERT_EQ(1, pipelines.size());
+    ASSERT_EQ(adapter->getIdentity(), pipelines[0]["source"].get<string>());
+
+    auto transforms = pipelines[0]["transforms"];
+    auto tokenizer = find_if(transforms.begin(), transforms.end(), [](auto &t) {
+      return t["name"].template get<string>() == "ShdrTokenizer";
+    });
+    ASSERT_NE(transforms.end(), tokenizer);
+    ASSERT_EQ(10, (*tokenizer)["count"].get<int>());
+    ASSERT_EQ("MICROSECOND", (*tokenizer)["latency"]["units"].get<string>());
+    ASSERT_LE((*tokenizer)["latency"]["p50"].get<double>(),
+              (*tokenizer)["latency"]["p99"].get<double>());
+  }
+}
+
+TEST_F(PipelineDeliverTest, should_not_instrument_transforms_by_default)
+{
+  auto adapter = m_agentTestHelper->addAdapter();
+  auto pipeline = adapter->getPipeline();
+  ASSERT_FALSE(pipeline->hasTransformMetrics());
+  pipeline->start();
+
+  adapter->processData("2021-01-22T12:33:45.123Z|Xpos|100.0");
+  ASSERT_TRUE(pipeline->getTransformMetrics().empty());
+
+  auto agent = m_agentTestHelper->getAgent();
+  ASSERT_FALSE(agent->getDataItemById(adapter->getIdentity() + "_pipeline_latency"));
+
+  {
+    PARSE_JSON_RESPONSE("/pipeline/metrics");
+    ASSERT_EQ(0, doc["pipelines"].size());
+  }
+}
+
+TEST_F(PipelineDeliverTest, benchmark_parallel_adapter_ingest)
+{
+  parallelIngest("parallel_adapter_ingest", {}, 1);
+}
+
+TEST_F(PipelineDeliverTest, benchmark_parallel_adapter_ingest_with_duplicate_filter)
+{
+  parallelIngest("parallel_adapter_ingest_filter_duplicates",
+                 {{configuration::FilterDuplicates, true}}, 2);
+}
@@ -20,6 +20,7 @@
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
 #include <chrono>
+#include <thread>
 
 #include "agent_test_helper.hpp"
 #include "mtconnect/observation/observation.hpp"
@@ -61,7 +62,6 @@ public:
 
   EntityPtr operator()(EntityPtr &&ptr) override { return m_function(std::move(ptr)); }
 
-  void setGuard(Guard &guard) { m_guard = guard; }
   TransformFun m_function;
 };
 using TestTransformPtr = shared_ptr<TestTransform>;
@@ -196,3 +196,268 @@ TEST_F(PipelineEditTest, append_R_last_after_B)
 
   ASSERT_EQ("SABC", result->getValue<string>());
 }
+
+class EntityA : public Entity
+{
+public:
+  using Entity::Entity;
+};
+
+class EntityB : public EntityA
+{
+public:
+  using EntityA::EntityA;
+};
+
+class EntityC : public Entity
+{
+public:
+  using Entity::Entity;
+};
+
+class CountingTransform : public Transform
+{
+public:
+  CountingTransform(const std::string &name, Guard guard) : Transform(name) { m_guard = guard; }
+
+  EntityPtr operator()(EntityPtr &&entity) override
+  {
+    m_count++;
+    if (m_next.empty())
+      return entity;
+    return next(std::move(entity));
+  }
+
+  int m_count {0};
+};
+using CountingTransformPtr = shared_ptr<CountingTransform>;
+
+TEST_F(PipelineEditTest, compiled_routing_should_match_guard_evaluation)
+{
+  auto a = make_shared<CountingTransform>(
+      "A", LambdaGuard<EntityA, ExactTypeGuard<EntityA>>(
+               [](const EntityA &e) { return e.getValue<string>() == "run"; }, RUN) ||
+               TypeGuard<EntityA>(SKIP));
+  auto b = make_shared<CountingTransform>("B", EntityNameGuard("Data", RUN));
+  auto c = make_shared<CountingTransform>("C", TypeGuard<EntityC>(RUN) || GuardCls(SKIP));
+  auto end = make_shared<CountingTransform>("End", GuardCls(RUN));
+
+  auto start = m_pipeline->getStart();
+  start->unlink();
+  start->bind(a);
+  start->bind(b);
+  start->bind(c);
+  a->bind(end);
+  b->bind(end);
+  c->bind(end);
+  start->compile();
+
+  auto run = [this](EntityPtr entity) { return m_pipeline->run(std::move(entity)); };
+
+  // Exact type and the lambda matches
+  run(make_shared<EntityA>("X", Properties {{"VALUE", "run"s}}));
+  ASSERT_EQ(1, a->m_count);
+  ASSERT_EQ(1, end->m_count);
+
+  // Exact type and the lambda does not match, falls through to the alternative
+  run(make_shared<EntityA>("X", Properties {{"VALUE", "skip"s}}));
+  ASSERT_EQ(1, a->m_count);
+  ASSERT_EQ(2, end->m_count);
+
+  // Subclass is not the exact type but matches the type guard
+  run(make_shared<EntityB>("X", Properties {{"VALUE", "run"s}}));
+  ASSERT_EQ(1, a->m_count);
+  ASSERT_EQ(3, end->m_count);
+
+  run(make_shared<Entity>("Data", Properties {{"VALUE", "S"s}}));
+  ASSERT_EQ(1, b->m_count);
+  ASSERT_EQ(4, end->m_count);
+
+  // Another name with the same type must not use the route for `Data`
+  run(make_shared<Entity>("Other", Properties {{"VALUE", "S"s}}));
+  ASSERT_EQ(1, b->m_count);
+  ASSERT_EQ(0, c->m_count);
+  ASSERT_EQ(5, end->m_count);
+
+  run(make_shared<EntityC>("Other", Properties {{"VALUE", "S"s}}));
+  ASSERT_EQ(1, c->m_count);
+  ASSERT_EQ(6, end->m_count);
+
+  // Repeating the same entities uses the cached routes with the same results
+  run(make_shared<EntityA>("X", Properties {{"VALUE", "run"s}}));
+  run(make_shared<Entity>("Data", Properties {{"VALUE", "S"s}}));
+  run(make_shared<EntityC>("Other", Properties {{"VALUE", "S"s}}));
+  ASSERT_EQ(2, a->m_count);
+  ASSERT_EQ(2, b->m_count);
+  ASSERT_EQ(2, c->m_count);
+  ASSERT_EQ(9, end->m_count);
+}
+
+TEST_F(PipelineEditTest, compiled_routing_should_update_when_guard_or_pipeline_changes)
+{
+  m_pipeline->getStart()->compile();
+
+  auto entity = shared_ptr<Entity>(new Entity("X", Properties {{"VALUE", "S"s}}));
+  ASSERT_EQ("SABC", m_pipeline->run(std::move(entity))->getValue<string>());
+
+  auto tb = dynamic_pointer_cast<TestTransform>(m_pipeline->find("B").front().second);
+  Guard guard = EntityNameGuard("X", SKIP);
+  tb->setGuard(guard);
+
+  entity = shared_ptr<Entity>(new Entity("X", Properties {{"VALUE", "S"s}}));
+  ASSERT_EQ("SAC", m_pipeline->run(std::move(entity))->getValue<string>());
+
+  TestTransformPtr tr = make_shared<TestTransform>("R"s, EntityNameGuard("X", RUN));
+  tr->m_function = [&tr](EntityPtr &&entity) {
+    EntityPtr ret = shared_ptr<Entity>(new Entity(*entity));
+    ret->setValue(ret->getValue<string>() + "R"s);
+    return tr->next(std::move(ret));
+  };
+  ASSERT_TRUE(m_pipeline->spliceAfter("B", tr));
+
+  entity = shared_ptr<Entity>(new Entity("X", Properties {{"VALUE", "S"s}}));
+  ASSERT_EQ("SARC", m_pipeline->run(std::move(entity))->getValue<string>());
+}
+
+TEST_F(PipelineEditTest, benchmark_compiled_routing_per_stage)
+{
+  constexpr int Stages = 10;
+  constexpr size_t Iterations = 200000;
+
+  // Build the same chain twice, once with guards that can be compiled and once with
+  // the same guards wrapped in lambdas so they are evaluated for every entity.
+  auto build = [](bool opaque) {
+    auto start = make_shared<CountingTransform>("Start", Guard());
+    TransformPtr cur = start;
+    for (int i = 0; i < Stages; i++)
+    {
+      Guard guard = TypeGuard<EntityC>(SKIP) || EntityNameGuard("Y", SKIP) ||
+                    TypeGuard<EntityA>(RUN) || GuardCls(CONTINUE);
+      if (opaque)
+        guard = [guard](const Entity *e) { return guard(e); };
+      auto t = make_shared<CountingTransform>("S" + to_string(i), guard);
+      cur->bind(t);
+      cur = t;
+    }
+    auto end = make_shared<CountingTransform>("End", GuardCls(RUN));
+    cur->bind(end);
+    start->compile();
+    return make_pair(start, end);
+  };
+
+  auto compiled = build(false);
+  auto evaluated = build(true);
+  auto entity = make_shared<EntityB>("X", Properties {{"VALUE", "S"s}});
+
+  auto guards = benchmark("evaluated_guards", Iterations,
+                          [&](size_t) { evaluated.first->next(EntityPtr(entity)); }) /
+                Stages;
+  auto routes = benchmark("compiled_routes", Iterations,
+                          [&](size_t) { compiled.first->next(EntityPtr(entity)); }) /
+                Stages;
+
+  cout << "[ BENCH    ] per stage: evaluated " << guards << " ns, compiled " << routes << " ns"
+       << endl;
+  RecordProperty("evaluated_ns_per_stage", to_string(guards));
+  RecordProperty("compiled_ns_per_stage", to_string(routes));
+
+  ASSERT_EQ(int(Iterations), compiled.second->m_count);
+  ASSERT_EQ(int(Iterations), evaluated.second->m_count);
+}
+
+TEST_F(PipelineEditTest, latency_histogram_should_report_percentiles_within_bucket_precision)
+{
+  LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 1000; i++)
+    histogram.record(i * 1000);
+
+  auto snapshot = histogram.snapshot();
+  ASSERT_EQ(1000, snapshot.m_count);
+  ASSERT_EQ(1000000, snapshot.m_max);
+  ASSERT_NEAR(500500.0, snapshot.mean(), 0.1);
+
+  for (auto [p, expected] : {pair {0.5, 500000.0}, pair {0.9, 900000.0}, pair {0.99, 990000.0}})
+  {
+    auto value = double(snapshot.percentile(p));
+    ASSERT_GE(value, expected);
+    ASSERT_LE(value, expected * 1.125);
+  }
+
+  for (uint64_t i = 0; i < 100; i++)
+    histogram.record(10);
+  auto interval = histogram.snapshot().since(snapshot);
+  ASSERT_EQ(100, interval.m_count);
+  ASSERT_EQ(10, interval.percentile(0.99));
+}
+
+TEST_F(PipelineEditTest, transform_metrics_should_exclude_time_in_following_transforms)
+{
+  auto first = make_shared<CountingTransform>("First", GuardCls(RUN));
+  auto sleep = make_shared<TestTransform>("Sleep", GuardCls(RUN));
+  sleep->m_function = [](EntityPtr &&entity) {
+    this_thread::sleep_for(5ms);
+    return entity;
+  };
+
+  auto start = m_pipeline->getStart();
+  start->unlink();
+  start->bind(first);
+  first->bind(sleep);
+
+  m_pipeline->setTransformMetrics(true);
+  m_pipeline->start();
+
+  auto metrics = m_pipeline->getTransformMetrics();
+  ASSERT_EQ(2, metrics.size());
+  ASSERT_EQ("First", metrics.front()->getName());
+  ASSERT_EQ("Sleep", metrics.back()->getName());
+
+  m_pipeline->run(make_shared<Entity>("X", Properties {{"VALUE", "S"s}}));
+
+  ASSERT_EQ(1, metrics.front()->getCount());
+  ASSERT_EQ(1, metrics.back()->getCount());
+
+  // The five milliseconds are only attributed to the sleeping transform
+  ASSERT_LT(metrics.front()->getLatency().snapshot().m_max, 5000000);
+  ASSERT_GE(metrics.back()->getLatency().snapshot().m_max, 5000000);
+}
+
+TEST_F(PipelineEditTest, benchmark_transform_metrics_overhead)
+{
+  constexpr int Stages = 10;
+  constexpr size_t Iterations = 200000;
+
+  auto build = [this]() {
+    auto start = m_pipeline->getStart();
+    start->unlink();
+    TransformPtr cur = start;
+    for (int i = 0; i < Stages; i++)
+      cur = cur->bind(make_shared<CountingTransform>("S" + to_string(i), TypeGuard<Entity>(RUN)));
+    return start;
+  };
+
+  auto entity = make_shared<Entity>("X", Properties {{"VALUE", "S"s}});
+
+  build();
+  m_pipeline->start();
+  ASSERT_TRUE(m_pipeline->getTransformMetrics().empty());
+  auto disabled = benchmark("transform_metrics_disabled", Iterations,
+                            [&](size_t) { m_pipeline->run(EntityPtr(entity)); }) /
+                  Stages;
+
+  build();
+  m_pipeline->setTransformMetrics(true);
+  m_pipeline->start();
+  ASSERT_EQ(Stages, m_pipeline->getTransformMetrics().size());
+  auto enabled = benchmark("transform_metrics_enabled", Iterations,
+                           [&](size_t) { m_pipeline->run(EntityPtr(entity)); }) /
+                 Stages;
+
+  cout << "[ BENCH    ] per stage: disabled " << disabled << " ns, enabled " << enabled << " ns"
+       << endl;
+  RecordProperty("disabled_ns_per_stage", to_string(disabled));
+  RecordProperty("enabled_ns_per_stage", to_string(enabled));
+
+  for (auto &m : m_pipeline->getTransformMetrics())
+    ASSERT_EQ(Iterations, m->getCount());
+}
@@ -0,0 +1,269 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mtconnect/configuration/config_options.hpp"
+#include "mtconnect/device_model/data_item/data_item.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/pipeline/pipeline_context.hpp"
+#include "mtconnect/source/adapter/replay/replay_adapter.hpp"
+#include "test_utilities.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::pipeline;
+using namespace mtconnect::source::adapter;
+using namespace mtconnect::source::adapter::replay;
+using namespace device_model;
+using namespace data_item;
+namespace asio = boost::asio;
+using namespace std::literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class MockPipelineContract : public PipelineContract
+{
+public:
+  MockPipelineContract(std::map<string, DataItemPtr> &items) : m_dataItems(items) {}
+  DevicePtr findDevice(const std::string &) override { return nullptr; }
+  DataItemPtr findDataItem(const std::string &device, const std::string &name) override
+  {
+    auto it = m_dataItems.find(name);
+    if (it != m_dataItems.end())
+      return it->second;
+    return nullptr;
+  }
+  void eachDataItem(EachDataItem fun) override {}
+  void deliverObservation(observation::ObservationPtr obs) override { m_delivered++; }
+  void deliverAsset(AssetPtr) override {}
+  void deliverDevices(std::list<DevicePtr>) override {}
+  void deliverDevice(DevicePtr) override {}
+  int32_t getSchemaVersion() const override { return SCHEMA_VERSION(2, 0); }
+  bool isValidating() const override { return false; }
+  void deliverAssetCommand(entity::EntityPtr) override {}
+  void deliverCommand(entity::EntityPtr) override {}
+  void deliverConnectStatus(entity::EntityPtr, const StringList &, bool) override {}
+  void sourceFailed(const std::string &id) override {}
+  const ObservationPtr checkDuplicate(const ObservationPtr &obs) const override { return obs; }
+
+  std::map<string, DataItemPtr> &m_dataItems;
+  size_t m_delivered {0};
+};
+
+class ReplayAdapterTest : public testing::Test
+{
+protected:
+  void SetUp() override { m_context = make_shared<PipelineContext>(); }
+
+  void TearDown() override
+  {
+    if (m_adapter)
+      m_adapter->stop();
+  }
+
+  void makeAdapter(const string &file, const string &speed, bool loop = false)
+  {
+    boost::property_tree::ptree tree;
+    tree.put(configuration::ReplayFile, file);
+    tree.put(configuration::ReplaySpeed, speed);
+    tree.put(configuration::ReplayLoop, loop ? "yes" : "no");
+    m_adapter = make_shared<ReplayAdapter>("test", m_ioc, m_context, ConfigOptions {}, tree);
+  }
+
+  void collect()
+  {
+    auto handler = make_unique<Handler>();
+    handler->m_processData = [this](const string &d, const string &s) { m_data.emplace_back(d); };
+    m_adapter->setHandler(handler);
+  }
+
+  void runUntilPasses(size_t passes, chrono::milliseconds timeout = 10s)
+  {
+    auto end = chrono::steady_clock::now() + timeout;
+    while (m_adapter->getPasses() < passes && chrono::steady_clock::now() < end)
+      m_ioc.run_for(5ms);
+  }
+
+  asio::io_context m_ioc;
+  PipelineContextPtr m_context;
+  shared_ptr<ReplayAdapter> m_adapter;
+  vector<string> m_data;
+};
+
+const string ReplayFile(TEST_RESOURCE_DIR "/samples/replay.txt");
+
+TEST_F(ReplayAdapterTest, should_replay_a_capture_as_fast_as_possible)
+{
+  makeAdapter(ReplayFile, "0");
+  collect();
+  ASSERT_EQ("_replay_test", m_adapter->getIdentity());
+  ASSERT_EQ("replay://" + ReplayFile, m_adapter->getName());
+
+  ASSERT_TRUE(m_adapter->start());
+  runUntilPasses(1);
+
+  ASSERT_EQ(1, m_adapter->getPasses());
+  // The multiline message is forwarded as a single line
+  ASSERT_EQ(11, m_data.size());
+  ASSERT_EQ("2021-01-19T10:01:00.000Z|exec|READY|line|0", m_data[0]);
+  ASSERT_EQ("2021-01-19T10:01:00.500Z|message|\nfirst\nsecond", m_data[5]);
+  ASSERT_EQ("2021-01-19T10:01:01.000Z|exec|READY|line|10", m_data[10]);
+
+  auto &stats = m_adapter->getStatistics();
+  ASSERT_EQ(14, stats.m_lines);
+  ASSERT_LT(stats.m_elapsed, 500ms);
+  ASSERT_GT(stats.linesPerSecond(), 0.0);
+  ASSERT_EQ(0ns, stats.m_schedule.m_max);
+}
+
+TEST_F(ReplayAdapterTest, should_pace_the_capture_by_timestamps)
+{
+  // The capture spans one second, at 10x it should take about 100ms
+  makeAdapter(ReplayFile, "10");
+  collect();
+
+  ASSERT_TRUE(m_adapter->start());
+  runUntilPasses(1);
+
+  ASSERT_EQ(1, m_adapter->getPasses());
+  ASSERT_EQ(11, m_data.size());
+  auto &stats = m_adapter->getStatistics();
+  ASSERT_GE(stats.m_elapsed, 95ms);
+  ASSERT_LT(stats.m_elapsed, 1s);
+}
+
+TEST_F(ReplayAdapterTest, should_loop_until_stopped)
+{
+  makeAdapter(ReplayFile, "0", true);
+  collect();
+
+  ASSERT_TRUE(m_adapter->start());
+  runUntilPasses(3);
+  m_adapter->stop();
+
+  ASSERT_LE(3, m_adapter->getPasses());
+  ASSERT_LE(33, m_data.size());
+}
+
+TEST_F(ReplayAdapterTest, should_fail_to_start_without_a_capture)
+{
+  makeAdapter(TEST_RESOURCE_DIR "/samples/no_such_capture.txt", "0");
+  ASSERT_FALSE(m_adapter->start());
+}
+
+TEST_F(ReplayAdapterTest, should_summarize_latencies)
+{
+  vector<int64_t> latencies;
+  for (int64_t i = 1; i <= 1000; i++)
+    latencies.push_back(1001 - i);
+
+  auto summary = LatencySummary::make(latencies);
+  ASSERT_EQ(501ns, summary.m_p50);
+  ASSERT_EQ(991ns, summary.m_p99);
+  ASSERT_EQ(1000ns, summary.m_max);
+
+  // Histogram percentiles are within a bucket of the value
+  LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 1000; i++)
+    histogram.record(i);
+  summary = LatencySummary::make(histogram.snapshot());
+  ASSERT_LE(500ns, summary.m_p50);
+  ASSERT_GT(575ns, summary.m_p50);
+  ASSERT_LE(990ns, summary.m_p99);
+  ASSERT_EQ(1000ns, summary.m_max);
+}
+
+/// Replays a generated capture through the full SHDR pipeline to the delivery stage.
+TEST_F(ReplayAdapterTest, benchmark_replay_through_the_shdr_pipeline)
+{
+  constexpr size_t Count = 100000;
+
+  std::map<string, DataItemPtr> dataItems;
+  {
+    entity::ErrorList errors;
+    dataItems.emplace("exec", DataItem::make({{"id", "exec"s},
+                                              {"type", "EXECUTION"s},
+                                              {"category", "EVENT"s}},
+                                             errors));
+    dataItems.emplace("pos", DataItem::make({{"id", "pos"s},
+                                             {"type", "POSITION"s},
+                                             {"units", "MILLIMETER"s},
+                                             {"category", "SAMPLE"s}},
+                                            errors));
+  }
+  m_context->m_contract = make_unique<MockPipelineContract>(dataItems);
+
+  auto file = filesystem::temp_directory_path() / "mtconnect_replay_benchmark.txt";
+  {
+    ofstream out(file);
+    for (size_t i = 0; i < Count; i++)
+    {
+      out << "2021-01-19T10:01:00.000Z|pos|" << i * 0.001;
+      if (i % 100 == 0)
+        out << "|exec|" << ((i / 100) % 2 ? "ACTIVE" : "READY");
+      out << '\n';
+    }
+  }
+
+  makeAdapter(file.string(), "0");
+  ASSERT_TRUE(m_adapter->start());
+  runUntilPasses(1, 60s);
+  filesystem::remove(file);
+  ASSERT_EQ(1, m_adapter->getPasses());
+
+  auto &stats = m_adapter->getStatistics();
+  auto contract = static_cast<MockPipelineContract *>(m_context->m_contract.get());
+  cout << "[ BENCH    ] replay_shdr_pipeline: " << stats.m_lines << " lines, "
+       << contract->m_delivered << " observations, " << stats.linesPerSecond()
+       << " lines/s, pipeline p50 " << stats.m_pipeline.m_p50.count() / 1000.0 << " us, p99 "
+       << stats.m_pipeline.m_p99.count() / 1000.0 << " us" << endl;
+  RecordProperty("replay_shdr_pipeline_lines_per_second", to_string(stats.linesPerSecond()));
+  RecordProperty("replay_shdr_pipeline_p99_ns", to_string(stats.m_pipeline.m_p99.count()));
+
+  ASSERT_EQ(Count, stats.m_lines);
+  ASSERT_LE(Count, contract->m_delivered);
+
+  // The pipeline stage is broken down by transform
+  auto tokenizer = find_if(stats.m_transforms.begin(), stats.m_transforms.end(),
+                           [](auto &t) { return t.m_name == "ShdrTokenizer"; });
+  ASSERT_NE(stats.m_transforms.end(), tokenizer);
+  ASSERT_EQ(Count, tokenizer->m_count);
+  for (auto &transform : stats.m_transforms)
+  {
+    cout << "[ BENCH    ]   " << transform.m_name << ": p50 "
+         << transform.m_latency.m_p50.count() / 1000.0 << " us, p99 "
+         << transform.m_latency.m_p99.count() / 1000.0 << " us" << endl;
+  }
+}
@@ -0,0 +1,27 @@
+MTConnect::Logger.info "Declaring Scale and BatchScale"
+
+$scale = MTConnect::RubyTransform.new("Scale", :Sample) do |obs|
+  obs.value = obs.value * 2.0
+  forward(obs)
+end
+
+$batch = MTConnect::RubyBatchTransform.new("BatchScale", :Sample) do |batch|
+  batch.size.times do |i|
+    batch.set_value(i, batch.value(i) * 2.0)
+  end
+  batch
+end
+
+$ids = MTConnect::RubyBatchTransform.new("BatchIds", :Sample) do |batch|
+  $seen = batch.map { |obs| obs.data_item.id }
+  $seen.each_with_index do |id, i|
+    raise "Bad id" unless batch.data_item_id(i) == id
+  end
+  batch.delete_at(0)
+  batch.to_a
+end
+
+$numbers = MTConnect::RubyBatchTransform.new("BatchNumbers", :Sample) do |batch|
+  batch.numbers = batch.numbers.unpack('d*').map { |v| v * 2.0 }.pack('d*')
+  batch
+end
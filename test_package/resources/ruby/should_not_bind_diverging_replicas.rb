@@ -0,0 +1,15 @@
+MTConnect::Logger.info "Splicing Passthrough, and Primary only on the primary interpreter"
+
+MTConnect.agent.sources.each do |s|
+  trans = MTConnect::RubyTransform.new("Passthrough", :Event) do |obs|
+    forward(obs)
+  end
+  s.pipeline.splice_before('DeliverObservation', trans)
+
+  if MTConnect.primary?
+    extra = MTConnect::RubyTransform.new("Primary", :Event) do |obs|
+      forward(obs)
+    end
+    s.pipeline.splice_before('DeliverObservation', extra)
+  end
+end
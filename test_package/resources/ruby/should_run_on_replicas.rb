@@ -0,0 +1,12 @@
+MTConnect::Logger.info "Splicing Passthrough into each adapter pipeline"
+
+if MTConnect.primary?
+  $primary = true
+end
+
+MTConnect.agent.sources.each do |s|
+  trans = MTConnect::RubyTransform.new("Passthrough", :Event) do |obs|
+    forward(obs)
+  end
+  s.pipeline.splice_before('DeliverObservation', trans)
+end
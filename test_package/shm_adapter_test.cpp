@@ -0,0 +1,363 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "mtconnect/configuration/config_options.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/pipeline/pipeline_context.hpp"
+#include "mtconnect/pipeline/shdr_token_mapper.hpp"
+#include "mtconnect/pipeline/shdr_tokenizer.hpp"
+#include "mtconnect/pipeline/timestamp_extractor.hpp"
+#include "mtconnect/source/adapter/shm/shm_adapter.hpp"
+#include "test_utilities.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::pipeline;
+using namespace mtconnect::source::adapter;
+using namespace mtconnect::source::adapter::shm;
+using namespace device_model;
+using namespace data_item;
+namespace asio = boost::asio;
+using tcp = boost::asio::ip::tcp;
+using namespace std::literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class MockPipelineContract : public PipelineContract
+{
+public:
+  MockPipelineContract(std::map<string, DataItemPtr> &items) : m_dataItems(items) {}
+  DevicePtr findDevice(const std::string &) override { return nullptr; }
+  DataItemPtr findDataItem(const std::string &device, const std::string &name) override
+  {
+    auto it = m_dataItems.find(name);
+    if (it != m_dataItems.end())
+      return it->second;
+    return nullptr;
+  }
+  void eachDataItem(EachDataItem fun) override {}
+  void deliverObservation(observation::ObservationPtr obs) override {}
+  void deliverAsset(AssetPtr) override {}
+  void deliverDevices(std::list<DevicePtr>) override {}
+  void deliverDevice(DevicePtr) override {}
+  int32_t getSchemaVersion() const override { return SCHEMA_VERSION(2, 0); }
+  bool isValidating() const override { return false; }
+  void deliverAssetCommand(entity::EntityPtr) override {}
+  void deliverCommand(entity::EntityPtr) override {}
+  void deliverConnectStatus(entity::EntityPtr, const StringList &, bool) override {}
+  void sourceFailed(const std::string &id) override {}
+  const ObservationPtr checkDuplicate(const ObservationPtr &obs) const override { return obs; }
+
+  std::map<string, DataItemPtr> &m_dataItems;
+};
+
+class ShmAdapterTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_ringName = "/mtconnect_test_"s + to_string(getpid());
+    ShmRing::unlink(m_ringName);
+  }
+
+  void TearDown() override { ShmRing::unlink(m_ringName); }
+
+  string m_ringName;
+};
+
+TEST_F(ShmAdapterTest, should_pass_records_through_the_ring)
+{
+  ShmRingConsumer consumer(ShmRing::create(m_ringName, 64, 16));
+  auto producer = ShmRingProducer::open(m_ringName);
+  ASSERT_TRUE(producer);
+
+  ASSERT_TRUE(producer->write("2021-01-19T10:01:00Z|exec|READY"));
+  ASSERT_TRUE(producer->write("2021-01-19T10:01:01Z|exec|ACTIVE"));
+
+  vector<string> records;
+  ASSERT_TRUE(consumer.available());
+  ASSERT_EQ(2, consumer.drain([&](string_view r) { records.emplace_back(r); }));
+  ASSERT_FALSE(consumer.available());
+
+  ASSERT_EQ(2, records.size());
+  ASSERT_EQ("2021-01-19T10:01:00Z|exec|READY", records[0]);
+  ASSERT_EQ("2021-01-19T10:01:01Z|exec|ACTIVE", records[1]);
+}
+
+TEST_F(ShmAdapterTest, should_split_large_records_across_slots)
+{
+  ShmRingConsumer consumer(ShmRing::create(m_ringName, 64, 16));
+  auto producer = ShmRingProducer::open(m_ringName);
+  ASSERT_TRUE(producer);
+
+  string large = "2021-01-19T10:01:00Z|vib|100|4000|";
+  for (int i = 0; i < 100; i++)
+    large += to_string(i) + " ";
+
+  // Write enough to wrap the ring a few times
+  for (int i = 0; i < 10; i++)
+  {
+    ASSERT_TRUE(producer->write(large));
+    ASSERT_TRUE(producer->write("short"));
+
+    vector<string> records;
+    ASSERT_EQ(2, consumer.drain([&](string_view r) { records.emplace_back(r); }));
+    ASSERT_EQ(large, records[0]);
+    ASSERT_EQ("short", records[1]);
+  }
+}
+
+TEST_F(ShmAdapterTest, should_drop_records_when_the_ring_is_full)
+{
+  ShmRingConsumer consumer(ShmRing::create(m_ringName, 64, 4));
+  auto producer = ShmRingProducer::open(m_ringName);
+  ASSERT_TRUE(producer);
+
+  for (int i = 0; i < 4; i++)
+    ASSERT_TRUE(producer->write("record " + to_string(i)));
+  ASSERT_FALSE(producer->write("record 4"));
+  ASSERT_EQ(1, producer->dropped());
+  ASSERT_EQ(1, consumer.dropped());
+
+  ASSERT_EQ(4, consumer.drain([](string_view) {}));
+  ASSERT_TRUE(producer->write("record 5"));
+}
+
+TEST_F(ShmAdapterTest, should_not_attach_producer_before_the_ring_is_created)
+{
+  ASSERT_FALSE(ShmRingProducer::open(m_ringName));
+  ASSERT_THROW(ShmRing::create(m_ringName, 64, 3), std::invalid_argument);
+}
+
+TEST_F(ShmAdapterTest, should_wake_the_consumer_when_data_arrives)
+{
+  ShmRingConsumer consumer(ShmRing::create(m_ringName, 64, 16));
+  auto producer = ShmRingProducer::open(m_ringName);
+  ASSERT_TRUE(producer);
+
+  ASSERT_FALSE(consumer.wait(1ms));
+
+  thread writer([&]() {
+    this_thread::sleep_for(20ms);
+    producer->write("wake up");
+  });
+
+  auto start = chrono::steady_clock::now();
+  ASSERT_TRUE(consumer.wait(5s));
+  ASSERT_LT(chrono::steady_clock::now() - start, 2s);
+  writer.join();
+}
+
+TEST_F(ShmAdapterTest, should_deliver_shdr_lines_from_the_ring_to_the_handler)
+{
+  asio::io_context ioc;
+  ConfigOptions options {{configuration::SharedMemoryName, m_ringName},
+                         {configuration::SharedMemorySlotSize, 128},
+                         {configuration::SharedMemorySlots, 64}};
+  boost::property_tree::ptree tree;
+  pipeline::PipelineContextPtr context = make_shared<pipeline::PipelineContext>();
+  auto adapter = make_shared<ShmAdapter>("test", ioc, context, options, tree);
+  ASSERT_EQ("_shm_test", adapter->getIdentity());
+  ASSERT_EQ("shm://" + m_ringName, adapter->getName());
+
+  auto handler = make_unique<Handler>();
+  vector<string> data;
+  bool connected = false;
+  handler->m_processData = [&](const string &d, const string &s) { data.emplace_back(d); };
+  handler->m_connected = [&](const string &) { connected = true; };
+  adapter->setHandler(handler);
+
+  ASSERT_TRUE(adapter->start());
+  auto producer = ShmRingProducer::open(m_ringName);
+  ASSERT_TRUE(producer);
+
+  producer->write("2021-01-19T10:01:00Z|exec|READY");
+  producer->write("2021-01-19T10:01:00Z|message|--multiline--AAA");
+  producer->write("line 1");
+  producer->write("--multiline--AAA");
+
+  for (int i = 0; i < 200 && data.size() < 2; i++)
+    ioc.run_for(10ms);
+
+  adapter->stop();
+
+  ASSERT_TRUE(connected);
+  ASSERT_EQ(2, data.size());
+  ASSERT_EQ("2021-01-19T10:01:00Z|exec|READY", data[0]);
+  ASSERT_EQ("2021-01-19T10:01:00Z|message|\nline 1", data[1]);
+}
+
+/// @brief Pace records at a fixed rate and measure latency and consumer CPU time
+struct TransportResult
+{
+  vector<uint64_t> m_latencies;
+  double m_cpuMs {0.0};
+};
+
+static double ThreadCpuMs()
+{
+#ifdef RUSAGE_THREAD
+  struct rusage usage;
+  getrusage(RUSAGE_THREAD, &usage);
+  return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+         double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+#else
+  return 0.0;
+#endif
+}
+
+static void ReportTransport(const string &name, TransportResult &result)
+{
+  auto &lat = result.m_latencies;
+  sort(lat.begin(), lat.end());
+  auto p50 = lat[lat.size() / 2];
+  auto p99 = lat[lat.size() * 99 / 100];
+  cout << "[ BENCH    ] " << name << ": " << lat.size() << " observations, p50 " << p50 / 1000.0
+       << " us, p99 " << p99 / 1000.0 << " us, consumer cpu " << result.m_cpuMs << " ms"
+       << endl;
+  ::testing::Test::RecordProperty(name + "_p50_ns", to_string(p50));
+  ::testing::Test::RecordProperty(name + "_p99_ns", to_string(p99));
+}
+
+TEST_F(ShmAdapterTest, benchmark_shm_and_tcp_at_100k_observations_per_second)
+{
+  constexpr size_t Count = 50000;
+  constexpr size_t PerMillisecond = 100;
+
+  std::map<string, DataItemPtr> dataItems;
+  ErrorList errors;
+  Properties props {{"id", "count"s}, {"type", "PART_COUNT"s}, {"category", "EVENT"s}};
+  dataItems.emplace("count", DataItem::make(props, errors));
+
+  auto context = make_shared<PipelineContext>();
+  context->m_contract = make_unique<MockPipelineContract>(dataItems);
+
+  // The same stages the SHDR pipeline runs before filtering and delivery
+  auto tokenizer = make_shared<ShdrTokenizer>();
+  auto extract = make_shared<ExtractTimestamp>(false);
+  auto mapper = make_shared<ShdrTokenMapper>(context, "", 2);
+  tokenizer->bind(extract);
+  extract->bind(mapper);
+  mapper->bind(make_shared<NullTransform>(TypeGuard<Entity>(RUN)));
+
+  vector<uint64_t> sent(Count);
+  auto process = [&](string_view record, TransportResult &result) {
+    auto data = make_shared<Entity>("Data", Properties {{"VALUE", string(record)}});
+    (*tokenizer)(std::move(data));
+    auto seq = stoull(string(record.substr(record.rfind('|') + 1)));
+    result.m_latencies.push_back(SteadyNow() - sent[seq]);
+  };
+
+  auto pace = [&](auto &&write) {
+    auto next = chrono::steady_clock::now();
+    for (size_t i = 0; i < Count; i++)
+    {
+      if (i % PerMillisecond == 0)
+      {
+        this_thread::sleep_until(next);
+        next += 1ms;
+      }
+      sent[i] = SteadyNow();
+      write("2021-01-19T10:01:00.1234Z|count|" + to_string(i));
+    }
+  };
+
+  // Shared memory ring
+  TransportResult shmResult;
+  {
+    ShmRingConsumer consumer(ShmRing::create(m_ringName, 128, 65536));
+    auto producer = ShmRingProducer::open(m_ringName);
+    ASSERT_TRUE(producer);
+
+    thread reader([&]() {
+      auto start = ThreadCpuMs();
+      while (shmResult.m_latencies.size() < Count)
+      {
+        if (consumer.wait(100ms))
+          consumer.drain([&](string_view r) { process(r, shmResult); });
+      }
+      shmResult.m_cpuMs = ThreadCpuMs() - start;
+    });
+    pace([&](const string &line) {
+      while (!producer->write(line))
+        this_thread::yield();
+    });
+    reader.join();
+  }
+
+  // TCP loopback, one line per write like a SHDR adapter
+  TransportResult tcpResult;
+  {
+    asio::io_context ioc;
+    tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    tcp::socket client(ioc);
+    client.connect(acceptor.local_endpoint());
+    client.set_option(tcp::no_delay(true));
+    tcp::socket server = acceptor.accept();
+
+    thread reader([&]() {
+      auto start = ThreadCpuMs();
+      asio::streambuf buffer;
+      while (tcpResult.m_latencies.size() < Count)
+      {
+        asio::read_until(server, buffer, '\n');
+        auto begin = static_cast<const char *>(buffer.data().data());
+        string_view available(begin, buffer.size());
+        size_t consumed = 0;
+        for (auto eol = available.find('\n'); eol != string_view::npos;
+             eol = available.find('\n', consumed))
+        {
+          process(available.substr(consumed, eol - consumed), tcpResult);
+          consumed = eol + 1;
+        }
+        buffer.consume(consumed);
+      }
+      tcpResult.m_cpuMs = ThreadCpuMs() - start;
+    });
+    pace([&](string line) {
+      line.push_back('\n');
+      asio::write(client, asio::buffer(line));
+    });
+    reader.join();
+  }
+
+  ReportTransport("shm_shdr_100k_per_second", shmResult);
+  ReportTransport("tcp_shdr_100k_per_second", tcpResult);
+
+  ASSERT_EQ(Count, shmResult.m_latencies.size());
+  ASSERT_EQ(Count, tcpResult.m_latencies.size());
+}
@@ -0,0 +1,272 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <fstream>
+
+#include "agent_test_helper.hpp"
+#include "mtconnect/asset/asset_buffer.hpp"
+#include "mtconnect/buffer/circular_buffer.hpp"
+#include "mtconnect/buffer/snapshot.hpp"
+#include "mtconnect/entity/xml_parser.hpp"
+#include "test_utilities.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::buffer;
+using namespace mtconnect::observation;
+using namespace mtconnect::asset;
+using namespace device_model;
+using namespace entity;
+using namespace data_item;
+using namespace std::literals;
+using namespace date::literals;
+namespace fs = std::filesystem;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class SnapshotTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_circularBuffer = make_unique<CircularBuffer>(8, 4);
+    m_file = fs::path(TEST_BIN_ROOT_DIR) / "snapshot.bin";
+    fs::remove(m_file);
+    m_snapshot = make_unique<Snapshot>(m_file);
+
+    ErrorList errors;
+    m_condition = DataItem::make(
+        {{"id", "c1"s}, {"type", "LOAD"s}, {"category", "CONDITION"s}, {"name", "load"s}},
+        errors);
+    m_event = DataItem::make(
+        {{"id", "e1"s}, {"type", "PROGRAM"s}, {"category", "EVENT"s}, {"name", "program"s}},
+        errors);
+    m_sample = DataItem::make({{"id", "s1"s},
+                               {"type", "POSITION"s},
+                               {"category", "SAMPLE"s},
+                               {"subType", "ACTUAL"s},
+                               {"units", "MILLIMETER"s}},
+                              errors);
+
+    for (auto &di : {m_condition, m_event, m_sample})
+      m_dataItems.emplace(di->getId(), di);
+  }
+
+  void TearDown() override
+  {
+    m_circularBuffer.reset();
+    fs::remove(m_file);
+  }
+
+  void add(DataItemPtr dataItem, const Properties &props)
+  {
+    ErrorList errors;
+    auto obs = Observation::make(dataItem, props, m_time, errors);
+    m_circularBuffer->addToBuffer(obs);
+  }
+
+  AssetPtr parseAsset(const string &xml)
+  {
+    ErrorList errors;
+    return dynamic_pointer_cast<Asset>(XmlParser::parse(Asset::getRoot(), xml, errors));
+  }
+
+  Timestamp m_time {Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h};
+  unique_ptr<CircularBuffer> m_circularBuffer;
+  unique_ptr<Snapshot> m_snapshot;
+  fs::path m_file;
+  DataItemPtr m_condition;
+  DataItemPtr m_event;
+  DataItemPtr m_sample;
+  ObservationCodec::DataItemMap m_dataItems;
+};
+
+TEST_F(SnapshotTest, should_save_and_restore_the_latest_observations)
+{
+  add(m_event, {{"VALUE", "first.ngc"s}});
+  add(m_sample, {{"VALUE", 1.5}});
+  add(m_event, {{"VALUE", "second.ngc"s}});
+  add(m_sample, {{"VALUE", 2.5}});
+  ASSERT_EQ(5, m_circularBuffer->getSequence());
+
+  ASSERT_TRUE(m_snapshot->save(*m_circularBuffer, nullptr));
+
+  auto contents = m_snapshot->load(m_dataItems);
+  ASSERT_TRUE(contents);
+  ASSERT_EQ(5, contents->m_sequence);
+  ASSERT_LE(contents->m_written, getCurrentTimeInSec());
+  ASSERT_EQ(2, contents->m_observations.size());
+
+  CircularBuffer restored(8, 4);
+  restored.setSequence(contents->m_sequence);
+  for (auto &obs : contents->m_observations)
+    restored.addToBuffer(obs);
+
+  ASSERT_EQ(7, restored.getSequence());
+  ASSERT_EQ(5, restored.getFirstSequence());
+
+  auto &latest = restored.getLatest();
+  ASSERT_EQ("second.ngc", latest.getObservation("e1")->getValue<string>());
+  ASSERT_EQ(2.5, latest.getObservation("s1")->getValue<double>());
+  ASSERT_EQ(m_time, latest.getObservation("s1")->getTimestamp());
+}
+
+TEST_F(SnapshotTest, should_restore_active_conditions_in_order)
+{
+  add(m_condition, {{"level", "WARNING"s}, {"nativeCode", "A"s}, {"VALUE", "Over"s}});
+  add(m_condition, {{"level", "FAULT"s}, {"nativeCode", "B"s}, {"VALUE", "Way over"s}});
+
+  ASSERT_TRUE(m_snapshot->save(*m_circularBuffer, nullptr));
+  auto contents = m_snapshot->load(m_dataItems);
+  ASSERT_TRUE(contents);
+  ASSERT_EQ(2, contents->m_observations.size());
+
+  CircularBuffer restored(8, 4);
+  restored.setSequence(contents->m_sequence);
+  for (auto &obs : contents->m_observations)
+    restored.addToBuffer(obs);
+
+  auto cond = dynamic_pointer_cast<Condition>(restored.getLatest().getObservation("c1"));
+  ASSERT_TRUE(cond);
+  ASSERT_EQ("B", cond->getCode());
+  ASSERT_EQ(Condition::FAULT, cond->getLevel());
+  ASSERT_TRUE(cond->getPrev());
+  ASSERT_EQ("A", cond->getPrev()->getCode());
+  ASSERT_EQ(Condition::WARNING, cond->getPrev()->getLevel());
+}
+
+TEST_F(SnapshotTest, should_skip_observations_for_unknown_data_items)
+{
+  add(m_event, {{"VALUE", "first.ngc"s}});
+  add(m_sample, {{"VALUE", 1.5}});
+
+  ASSERT_TRUE(m_snapshot->save(*m_circularBuffer, nullptr));
+
+  m_dataItems.erase("s1");
+  auto contents = m_snapshot->load(m_dataItems);
+  ASSERT_TRUE(contents);
+  ASSERT_EQ(1, contents->m_observations.size());
+  ASSERT_EQ("e1", contents->m_observations.front()->getDataItem()->getId());
+}
+
+TEST_F(SnapshotTest, should_save_and_restore_assets)
+{
+  AssetBuffer assets(8);
+  assets.addAsset(parseAsset(R"(<Part assetId="P1" deviceUuid="000" )"
+                             R"(timestamp="2021-01-19T10:00:00Z"><Name>one</Name></Part>)"));
+  assets.addAsset(parseAsset(R"(<Part assetId="P2" deviceUuid="000" )"
+                             R"(timestamp="2021-01-19T10:01:00Z"><Name>two</Name></Part>)"));
+  assets.removeAsset("P1");
+
+  ASSERT_TRUE(m_snapshot->save(*m_circularBuffer, &assets));
+  auto contents = m_snapshot->load(m_dataItems);
+  ASSERT_TRUE(contents);
+  ASSERT_EQ(2, contents->m_assets.size());
+
+  auto &first = contents->m_assets.front();
+  ASSERT_EQ("P1", first->getAssetId());
+  ASSERT_TRUE(first->isRemoved());
+
+  auto &second = contents->m_assets.back();
+  ASSERT_EQ("P2", second->getAssetId());
+  ASSERT_FALSE(second->isRemoved());
+  ASSERT_EQ("two", second->get<string>("Name"));
+}
+
+TEST_F(SnapshotTest, should_ignore_missing_and_invalid_snapshots)
+{
+  ASSERT_FALSE(m_snapshot->load(m_dataItems));
+
+  {
+    std::ofstream file(m_file, ios::binary);
+    file << "not a snapshot";
+  }
+  ASSERT_FALSE(m_snapshot->load(m_dataItems));
+
+  add(m_event, {{"VALUE", "first.ngc"s}});
+  add(m_sample, {{"VALUE", 1.5}});
+  ASSERT_TRUE(m_snapshot->save(*m_circularBuffer, nullptr));
+
+  // Cut the last record in half
+  fs::resize_file(m_file, fs::file_size(m_file) - 8);
+  ASSERT_FALSE(m_snapshot->load(m_dataItems));
+}
+
+TEST_F(SnapshotTest, benchmark_warm_restore_of_50000_data_items)
+{
+  constexpr int count = 50000;
+
+  ErrorList errors;
+  vector<DataItemPtr> dataItems;
+  ObservationCodec::DataItemMap map;
+  dataItems.reserve(count);
+  for (int i = 0; i < count; i++)
+  {
+    auto di = DataItem::make({{"id", "x" + to_string(i)},
+                              {"type", "POSITION"s},
+                              {"category", "SAMPLE"s},
+                              {"units", "MILLIMETER"s}},
+                             errors);
+    map.emplace(di->getId(), di);
+    dataItems.emplace_back(di);
+  }
+
+  CircularBuffer buffer(17, 1000);
+  for (int i = 0; i < count; i++)
+  {
+    auto obs = Observation::make(dataItems[i], {{"VALUE", double(i)}}, m_time, errors);
+    buffer.addToBuffer(obs);
+  }
+
+  benchmark("snapshot save of 50000 data items", 5,
+            [&](size_t) { ASSERT_TRUE(m_snapshot->save(buffer, nullptr)); });
+
+  // Time until the current request returns the last values
+  ObservationList current;
+  benchmark("warm restore of 50000 data items", 5, [&](size_t) {
+    auto contents = m_snapshot->load(map);
+    CircularBuffer restored(17, 1000);
+    restored.setSequence(contents->m_sequence);
+    for (auto &obs : contents->m_observations)
+      restored.addToBuffer(obs);
+    current.clear();
+    restored.getLatest().getObservations(current, nullopt);
+  });
+  ASSERT_EQ(count, current.size());
+
+  // Time until the current request returns UNAVAILABLE for every data item
+  benchmark("cold start of 50000 data items", 5, [&](size_t) {
+    CircularBuffer restored(17, 1000);
+    for (auto &di : dataItems)
+    {
+      auto obs = Observation::make(di, {{"VALUE", "UNAVAILABLE"s}}, m_time, errors);
+      restored.addToBuffer(obs);
+    }
+    current.clear();
+    restored.getLatest().getObservations(current, nullopt);
+  });
+  ASSERT_EQ(count, current.size());
+}
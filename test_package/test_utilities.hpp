@@ -21,6 +21,7 @@
 #include <gtest/gtest.h>
 // Here
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -48,6 +49,32 @@ inline std::string getFile(std::string file)
   return stream.str();
 }
 
+/// @brief Time a function over a number of iterations and report the result
+///
+/// The average time per iteration is printed and recorded as a test property so benchmark
+/// results appear in the test output and the gtest XML report.
+/// @param name the name of the benchmark
+/// @param iterations the number of times to call `f`
+/// @param f the function to time, called with the iteration index
+/// @returns the average number of nanoseconds per iteration
+template <typename F>
+inline double benchmark(const std::string &name, size_t iterations, F &&f)
+{
+  using namespace std::chrono;
+
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < iterations; i++)
+    f(i);
+  auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+  double perIteration = double(elapsed) / double(iterations);
+  std::cout << "[ BENCH    ] " << name << ": " << iterations << " iterations, " << perIteration
+            << " ns/iteration" << std::endl;
+  ::testing::Test::RecordProperty(name, std::to_string(perIteration));
+
+  return perIteration;
+}
+
 // Fill the error
 inline void fillErrorText(std::string &errorXml, const std::string &text)
 {
@@ -25,6 +25,7 @@
 #include "mtconnect/observation/observation.hpp"
 #include "mtconnect/pipeline/pipeline_context.hpp"
 #include "mtconnect/pipeline/topic_mapper.hpp"
+#include "test_utilities.hpp"
 
 using namespace mtconnect;
 using namespace mtconnect::pipeline;
@@ -52,7 +53,12 @@ public:
   {
     return m_dataItems[name];
   }
-  void eachDataItem(EachDataItem fun) override {}
+  void eachDataItem(EachDataItem fun) override
+  {
+    for (auto &[id, di] : m_dataItems)
+      if (di)
+        fun(di);
+  }
   void deliverObservation(observation::ObservationPtr obs) override {}
   void deliverAsset(AssetPtr) override {}
   void deliverDevices(std::list<DevicePtr>) override {}
@@ -64,9 +70,11 @@ public:
   void sourceFailed(const std::string &id) override {}
   const ObservationPtr checkDuplicate(const ObservationPtr &obs) const override { return obs; }
   bool isValidating() const override { return false; }
+  uint64_t getDeviceModelVersion() const override { return m_version; }
 
   std::map<string, DataItemPtr> &m_dataItems;
   std::map<string, DevicePtr> &m_devices;
+  uint64_t m_version {0};
 };
 
 class TopicMappingTest : public testing::Test
@@ -98,7 +106,7 @@ protected:
     Properties ps(props);
     ErrorList errors;
     auto di = DataItem::make(ps, errors);
-    m_dataItems.emplace(di->getId(), di);
+    m_dataItems[di->getId()] = di;
 
     dev->second->addDataItem(di, errors);
 
@@ -116,6 +124,13 @@ protected:
     return d;
   }
 
+  PipelineMessagePtr mapTopic(TopicMapper &mapper, const std::string &topic,
+                               const std::string &value = "ACTIVE")
+  {
+    auto msg = make_shared<Entity>("Message", Properties {{"VALUE", value}, {"topic", topic}});
+    return dynamic_pointer_cast<PipelineMessage>(mapper(std::move(msg)));
+  }
+
   shared_ptr<PipelineContext> m_context;
   shared_ptr<TopicMapper> m_mapper;
   std::map<string, DataItemPtr> m_dataItems;
@@ -130,3 +145,131 @@ TEST_F(TopicMappingTest, should_find_data_item_for_topic)
   Properties props {{"id", "a"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}};
   auto di = makeDataItem("device", props);
 }
+
+TEST_F(TopicMappingTest, topic_trie_should_match_mqtt_wildcards)
+{
+  TopicTrie<int> trie;
+  ASSERT_TRUE(trie.insert("a/b/c", 1));
+  ASSERT_TRUE(trie.insert("a/+/c", 2));
+  ASSERT_TRUE(trie.insert("a/#", 3));
+  ASSERT_TRUE(trie.insert("+/+", 4));
+  ASSERT_FALSE(trie.insert("a/b/c", 5));
+  ASSERT_EQ(4, trie.size());
+
+  auto match = [&](const char *topic) {
+    auto v = trie.match(topic);
+    return v ? *v : 0;
+  };
+
+  ASSERT_EQ(1, match("a/b/c"));
+  ASSERT_EQ(2, match("a/x/c"));
+  ASSERT_EQ(3, match("a/x/d"));
+  ASSERT_EQ(3, match("a/b/c/d"));
+  ASSERT_EQ(3, match("a"));
+  ASSERT_EQ(3, match("a/b"));
+  ASSERT_EQ(4, match("b/c"));
+  ASSERT_EQ(4, match("b/"));
+  ASSERT_EQ(0, match("c/d/e"));
+  ASSERT_EQ(0, match("b"));
+
+  trie.clear();
+  ASSERT_TRUE(trie.empty());
+  ASSERT_EQ(0, match("a/b/c"));
+}
+
+TEST_F(TopicMappingTest, should_resolve_topics_below_the_subscription_prefix)
+{
+  auto dev = makeDevice("Device", {{"id", "device"s}, {"name", "device"s}, {"uuid", "device"s}});
+  auto di = makeDataItem(
+      "device", {{"id", "a"s}, {"name", "exec"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+
+  TopicMapper mapper(m_context, "device"s, {"factory/+/#"});
+  mapper.bind(make_shared<NullTransform>(TypeGuard<Entity>(RUN)));
+
+  for (auto topic : {"factory/line1/device/exec", "factory/line1/device/a", "factory/line2/exec",
+                     "device/a"})
+  {
+    auto msg = mapTopic(mapper, topic);
+    ASSERT_TRUE(msg) << topic;
+    ASSERT_EQ(di, msg->m_dataItem) << topic;
+    ASSERT_EQ(dev, msg->m_device.lock()) << topic;
+  }
+
+  // device and prefix qualified by name and id, and prefix qualified for the default device
+  ASSERT_EQ(6, mapper.getTrieSize());
+  ASSERT_EQ(4, mapper.getResolvedCount());
+}
+
+TEST_F(TopicMappingTest, should_remember_unresolved_topics_until_the_device_model_changes)
+{
+  auto dev = makeDevice("Device", {{"id", "device"s}, {"name", "device"s}, {"uuid", "device"s}});
+  makeDataItem("device", {{"id", "a"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+
+  auto msg = mapTopic(*m_mapper, "device/b");
+  ASSERT_FALSE(msg->m_dataItem);
+  ASSERT_EQ(1, m_mapper->getResolvedCount());
+
+  auto di = makeDataItem("device", {{"id", "b"s}, {"type", "EXECUTION"s}, {"category", "EVENT"s}});
+
+  msg = mapTopic(*m_mapper, "device/b");
+  ASSERT_FALSE(msg->m_dataItem);
+
+  auto *contract = dynamic_cast<MockPipelineContract *>(m_context->m_contract.get());
+  contract->m_version++;
+
+  msg = mapTopic(*m_mapper, "device/b");
+  ASSERT_EQ(di, msg->m_dataItem);
+  ASSERT_EQ(dev, msg->m_device.lock());
+  ASSERT_EQ(1, m_mapper->getResolvedCount());
+}
+
+TEST_F(TopicMappingTest, benchmark_topic_resolution_with_2000_topics)
+{
+  constexpr int DeviceCount = 10;
+  constexpr int DataItemCount = 200;
+
+  std::vector<std::string> topics;
+  for (int d = 0; d < DeviceCount; d++)
+  {
+    auto name = "dev"s + to_string(d);
+    makeDevice("Device", {{"id", name}, {"name", name}, {"uuid", "uuid"s + to_string(d)}});
+    for (int i = 0; i < DataItemCount; i++)
+    {
+      auto id = name + "_pos" + to_string(i);
+      makeDataItem(name, {{"id", id}, {"type", "POSITION"s}, {"category", "SAMPLE"s}});
+      topics.emplace_back("factory/line1/" + name + "/" + id);
+    }
+  }
+
+  TopicMapper mapper(m_context, nullopt, {"factory/+/#"});
+  mapper.bind(make_shared<NullTransform>(TypeGuard<Entity>(RUN)));
+
+  auto scan = benchmark("topic_scan_2000_topics", 5, [&](size_t) {
+    for (auto &topic : topics)
+      ASSERT_TRUE(get<1>(mapper.resolve(topic)));
+  });
+
+  auto trie = benchmark("topic_trie_2000_topics", 5, [&](size_t) {
+    for (auto &topic : topics)
+    {
+      auto &res = mapper.lookup(topic);
+      ASSERT_TRUE(res.m_dataItem);
+    }
+    // Forget the exact topics so every iteration rebuilds and matches the trie
+    dynamic_cast<MockPipelineContract *>(m_context->m_contract.get())->m_version++;
+  });
+
+  for (auto &topic : topics)
+    mapper.lookup(topic);
+  auto memo = benchmark("topic_memoized_2000_topics", 20, [&](size_t) {
+    for (auto &topic : topics)
+    {
+      auto &res = mapper.lookup(topic);
+      ASSERT_TRUE(res.m_dataItem);
+    }
+  });
+
+  cout << "[ BENCH    ] topic resolution speedup: trie " << (scan / trie) << "x, memoized "
+       << (scan / memo) << "x" << endl;
+  ASSERT_EQ(DeviceCount * DataItemCount, mapper.getResolvedCount());
+}
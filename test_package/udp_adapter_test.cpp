@@ -0,0 +1,248 @@
+//
+// Copyright Copyright 2009-2025, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <boost/asio.hpp>
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mtconnect/configuration/config_options.hpp"
+#include "mtconnect/device_model/data_item/data_item.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/pipeline/pipeline_context.hpp"
+#include "mtconnect/source/adapter/udp/udp_adapter.hpp"
+#include "test_utilities.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::pipeline;
+using namespace mtconnect::source::adapter;
+using namespace mtconnect::source::adapter::udp;
+using namespace device_model;
+using namespace data_item;
+namespace asio = boost::asio;
+using udp_socket = boost::asio::ip::udp;
+using namespace std::literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class MockPipelineContract : public PipelineContract
+{
+public:
+  MockPipelineContract(std::map<string, DataItemPtr> &items) : m_dataItems(items) {}
+  DevicePtr findDevice(const std::string &) override { return nullptr; }
+  DataItemPtr findDataItem(const std::string &device, const std::string &name) override
+  {
+    auto it = m_dataItems.find(name);
+    if (it != m_dataItems.end())
+      return it->second;
+    return nullptr;
+  }
+  void eachDataItem(EachDataItem fun) override {}
+  void deliverObservation(observation::ObservationPtr obs) override
+  {
+    m_observations[obs->getDataItem()->getId()] = obs->getValue<double>();
+  }
+  void deliverAsset(AssetPtr) override {}
+  void deliverDevices(std::list<DevicePtr>) override {}
+  void deliverDevice(DevicePtr) override {}
+  int32_t getSchemaVersion() const override { return SCHEMA_VERSION(2, 0); }
+  bool isValidating() const override { return false; }
+  void deliverAssetCommand(entity::EntityPtr) override {}
+  void deliverCommand(entity::EntityPtr) override {}
+  void deliverConnectStatus(entity::EntityPtr, const StringList &, bool) override {}
+  void sourceFailed(const std::string &id) override {}
+  const ObservationPtr checkDuplicate(const ObservationPtr &obs) const override { return obs; }
+
+  std::map<string, DataItemPtr> &m_dataItems;
+  std::map<string, double> m_observations;
+};
+
+class UdpAdapterTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_context = make_shared<PipelineContext>();
+    m_context->m_contract = make_unique<MockPipelineContract>(m_dataItems);
+
+    // Bind to an ephemeral port on loopback
+    ConfigOptions options;
+    boost::property_tree::ptree tree;
+    tree.put(configuration::Host, "127.0.0.1");
+    tree.put(configuration::Port, "0");
+    m_adapter = make_shared<UdpAdapter>("test", m_ioc, m_context, options, tree);
+
+    // Create the Agent device data items the same way the agent device does
+    for (auto props : m_adapter->getAgentDataItems())
+    {
+      entity::ErrorList errors;
+      props["id"] = m_adapter->getIdentity() + get<string>(props["id"]);
+      auto di = DataItem::make(props, errors);
+      ASSERT_TRUE(errors.empty());
+      m_dataItems.emplace(di->getId(), di);
+    }
+
+    auto handler = make_unique<Handler>();
+    handler->m_processData = [this](const string &d, const string &s) { m_data.emplace_back(d); };
+    handler->m_connected = [this](const string &) { m_connected = true; };
+    m_adapter->setHandler(handler);
+  }
+
+  void TearDown() override { m_adapter->stop(); }
+
+  auto contract() { return static_cast<MockPipelineContract *>(m_context->m_contract.get()); }
+
+  void send(udp_socket::socket &sender, const string &datagram)
+  {
+    sender.send_to(asio::buffer(datagram), m_adapter->getLocalEndpoint());
+  }
+
+  void runUntil(size_t lines)
+  {
+    for (int i = 0; i < 200 && m_data.size() < lines; i++)
+      m_ioc.run_for(10ms);
+  }
+
+  asio::io_context m_ioc;
+  std::map<string, DataItemPtr> m_dataItems;
+  PipelineContextPtr m_context;
+  shared_ptr<UdpAdapter> m_adapter;
+  vector<string> m_data;
+  bool m_connected {false};
+};
+
+TEST_F(UdpAdapterTest, should_classify_sequence_numbers)
+{
+  DatagramSequence seq;
+  ASSERT_EQ(DatagramSequence::Result::FIRST, seq.next(10));
+  ASSERT_EQ(DatagramSequence::Result::IN_ORDER, seq.next(11));
+  ASSERT_EQ(DatagramSequence::Result::GAP, seq.next(15));
+  ASSERT_EQ(1, seq.gaps());
+  ASSERT_EQ(3, seq.lost());
+
+  ASSERT_EQ(DatagramSequence::Result::LATE, seq.next(13));
+  ASSERT_EQ(1, seq.late());
+  ASSERT_EQ(DatagramSequence::Result::IN_ORDER, seq.next(16));
+
+  seq.next(5000);
+  ASSERT_EQ(DatagramSequence::Result::RESTART, seq.next(1));
+  ASSERT_EQ(1, seq.restarts());
+  ASSERT_EQ(DatagramSequence::Result::IN_ORDER, seq.next(2));
+
+  seq.reset();
+  ASSERT_EQ(DatagramSequence::Result::FIRST, seq.next(100));
+  ASSERT_EQ(2, seq.gaps());
+}
+
+TEST_F(UdpAdapterTest, should_deliver_lines_from_loopback_datagrams)
+{
+  ASSERT_EQ("_udp_test", m_adapter->getIdentity());
+  ASSERT_TRUE(m_adapter->start());
+  ASSERT_NE(0, m_adapter->getLocalEndpoint().port());
+
+  udp_socket::socket sender(m_ioc, udp_socket::endpoint(udp_socket::v4(), 0));
+  send(sender, "2021-01-19T10:01:00Z|exec|READY");
+  send(sender, "2021-01-19T10:01:01Z|exec|ACTIVE\n2021-01-19T10:01:01Z|line|10\r\n\n");
+  send(sender,
+       "2021-01-19T10:01:02Z|message|--multiline--AAA\nline 1\nline 2\n--multiline--AAA\n");
+
+  runUntil(4);
+
+  ASSERT_TRUE(m_connected);
+  ASSERT_EQ(3, m_adapter->getDatagramCount());
+  ASSERT_EQ(4, m_data.size());
+  ASSERT_EQ("2021-01-19T10:01:00Z|exec|READY", m_data[0]);
+  ASSERT_EQ("2021-01-19T10:01:01Z|exec|ACTIVE", m_data[1]);
+  ASSERT_EQ("2021-01-19T10:01:01Z|line|10", m_data[2]);
+  ASSERT_EQ("2021-01-19T10:01:02Z|message|\nline 1\nline 2", m_data[3]);
+}
+
+TEST_F(UdpAdapterTest, should_count_gaps_and_lost_datagrams)
+{
+  ASSERT_TRUE(m_adapter->start());
+
+  udp_socket::socket sender(m_ioc, udp_socket::endpoint(udp_socket::v4(), 0));
+  for (uint64_t seq : {1, 2, 5, 6, 4, 10})
+    send(sender, "* seq: "s + to_string(seq) + "\n2021-01-19T10:01:00Z|x|" + to_string(seq));
+
+  runUntil(6);
+  ASSERT_EQ(6, m_data.size());
+  ASSERT_EQ("2021-01-19T10:01:00Z|x|1", m_data[0]);
+
+  auto &sequence = m_adapter->getSequence();
+  ASSERT_EQ(2, sequence.gaps());
+  ASSERT_EQ(5, sequence.lost());
+  ASSERT_EQ(1, sequence.late());
+
+  // Counters are reported to the Agent device data items
+  m_adapter->reportCounters();
+  auto &obs = contract()->m_observations;
+  ASSERT_EQ(2.0, obs["_udp_test_sequence_gaps"]);
+  ASSERT_EQ(5.0, obs["_udp_test_datagrams_lost"]);
+  ASSERT_EQ(1.0, obs["_udp_test_datagrams_late"]);
+
+  // The counters are not MTConnect types and use an extension prefix
+  auto gaps = m_dataItems["_udp_test_sequence_gaps"];
+  ASSERT_EQ("SequenceGapCount"s, string(gaps->getObservationName().getName()));
+  ASSERT_EQ("x"s, string(gaps->getObservationName().getNs()));
+}
+
+TEST_F(UdpAdapterTest, should_accept_a_sequence_only_datagram)
+{
+  m_adapter->processDatagram("* seq: 7");
+  m_adapter->processDatagram("* seq: 9\n2021-01-19T10:01:00Z|x|1");
+
+  ASSERT_EQ(1, m_data.size());
+  ASSERT_EQ(1, m_adapter->getSequence().lost());
+}
+
+TEST_F(UdpAdapterTest, benchmark_udp_batched_receive)
+{
+  ASSERT_TRUE(m_adapter->start());
+
+  udp_socket::socket sender(m_ioc, udp_socket::endpoint(udp_socket::v4(), 0));
+  const int lines = 10;
+  string body;
+  for (int i = 0; i < lines; i++)
+    body += "2021-01-19T10:01:00Z|vib|" + to_string(i) + "\n";
+
+  uint64_t seq = 0;
+  size_t expected = 0;
+  benchmark("udp 10 lines per datagram, 64 datagrams", 100, [&]() {
+    for (int i = 0; i < 64; i++)
+      send(sender, "* seq: "s + to_string(++seq) + "\n" + body);
+    expected += 64 * lines;
+    runUntil(expected);
+  });
+
+  // Loopback can drop under load, a datagram is either delivered, counted as lost, or was the
+  // last one sent
+  ASSERT_GT(m_adapter->getDatagramCount(), 0);
+  ASSERT_LE(m_adapter->getDatagramCount() + m_adapter->getSequence().lost(), seq);
+}
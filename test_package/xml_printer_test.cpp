@@ -961,3 +961,25 @@ TEST_F(XmlPrinterTest, PrintDataItemRelationships)
   ASSERT_XML_PATH_EQUAL(
       doc, "//m:DataItem[@id='xlcpl']/m:Relationships/m:DataItemRelationship@idRef", "xlc");
 }
+
+TEST_F(XmlPrinterTest, benchmark_print_a_large_sample)
+{
+  const char *names[] = {"Xact", "Xcom", "Yact", "Ycom", "Zact", "Zcom", "line", "block"};
+  ObservationList events;
+  for (uint64_t i = 0; i < 100000; i++)
+    events.push_back(newEvent(names[i % 8], i + 1, Properties {{"VALUE", to_string(i)}}));
+
+  size_t length = 0;
+  benchmark("print a sample of 100000 observations", 5, [&](size_t) {
+    ObservationList list(events);
+    length += m_printer->printSample(123, 131072, 100001, 1, 100000, list).size();
+  });
+  ASSERT_LT(0, length);
+
+  ObservationList list(events);
+  benchmark("sort 100000 observations", 5, [&](size_t) {
+    list = events;
+    list.sort(ObservationCompare);
+  });
+  ASSERT_EQ(1, list.front()->getSequence());
+}